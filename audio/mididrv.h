@@ -457,7 +457,15 @@ public:
 		 * False: note offs for OPL rhythm mode instruments are processed.
 		 * True: note offs for OPL rhythm mode instruments are ignored.
 		 */
-		PROP_OPL_RHYTHM_MODE_IGNORE_NOTE_OFF = 10
+		PROP_OPL_RHYTHM_MODE_IGNORE_NOTE_OFF = 10,
+		/**
+		 * Query this property (using 0xFFFF as the parameter) to get the
+		 * number of times an emulated driver rendering ahead of the mixer
+		 * ran out of samples, and had to render them on the mixer thread.
+		 * Setting it to any other value resets the counter.
+		 * Currently only the MT-32 emulator renders ahead.
+		 */
+		PROP_RENDER_UNDERRUNS = 11
 	};
 
 	/**
@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIX_H
+#define AUDIO_MIX_H
+
+#include "audio/rate.h"
+
+class MixKernelTestSuite;
+class RateConverterTestSuite;
+
+namespace Audio {
+
+/**
+ * @defgroup audio_mix Sample mixing kernels
+ * @ingroup audio
+ *
+ * @brief Volume scaling and saturating accumulation of sample blocks.
+ * @{
+ */
+
+// This is a class so that we can declare certain things as private
+class MixKernel {
+private:
+#ifdef SCUMMVM_NEON
+	static void mixNEON(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo);
+	static int32 dotProductNEON(const int16 *a, const int16 *b, uint length);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void mixSSE2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo);
+	static int32 dotProductSSE2(const int16 *a, const int16 *b, uint length);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void mixAVX2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo);
+	static int32 dotProductAVX2(const int16 *a, const int16 *b, uint length);
+#endif
+	static void mixGeneric(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo);
+	static int32 dotProductGeneric(const int16 *a, const int16 *b, uint length);
+
+	static void selectFuncs();
+
+	typedef void(*MixFunc)(st_sample_t *, const st_sample_t *, uint, st_volume_t, st_volume_t, bool, bool);
+	static MixFunc mixFunc;
+	typedef int32(*DotProductFunc)(const int16 *, const int16 *, uint);
+	static DotProductFunc dotProductFunc;
+	friend class ::MixKernelTestSuite;
+	friend class ::RateConverterTestSuite;
+
+public:
+	/**
+	 * Scales a block of samples by the given channel volumes and adds them,
+	 * with saturation, to an interleaved stereo output buffer.
+	 *
+	 * Every implementation produces exactly the same output as
+	 * scaling each sample with (sample * vol) / Mixer::kMaxMixerVolume
+	 * and accumulating it with clampedAdd().
+	 *
+	 * @param dst           Stereo output buffer, at least 2 * @p numFrames samples.
+	 * @param src           Input samples, @p numFrames frames of 1 or 2 samples each.
+	 * @param numFrames     Number of sample frames to mix.
+	 * @param volL          Volume for left channel.
+	 * @param volR          Volume for right channel.
+	 * @param inStereo      Whether @p src holds interleaved stereo samples.
+	 * @param reverseStereo Whether to swap left and right when writing to @p dst.
+	 */
+	static void mixStereo(st_sample_t *dst, const st_sample_t *src, uint numFrames,
+	                      st_volume_t volL, st_volume_t volR,
+	                      bool inStereo, bool reverseStereo);
+
+	/**
+	 * Computes the sum of the element-wise products of two sample arrays,
+	 * as used for evaluating FIR filters.
+	 *
+	 * The sum is accumulated in 32 bits, so the caller has to make sure it
+	 * can not overflow.
+	 *
+	 * @param a      First array.
+	 * @param b      Second array.
+	 * @param length Number of elements in both arrays, must be a multiple of 16.
+	 */
+	static int32 dotProduct(const int16 *a, const int16 *b, uint length) {
+		if (!dotProductFunc)
+			selectFuncs();
+		return dotProductFunc(a, b, length);
+	}
+}; // End of class MixKernel
+
+/** @} */
+} // End of namespace Audio
+
+#endif
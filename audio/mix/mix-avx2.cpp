@@ -0,0 +1,116 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Audio {
+
+// Computes (a * b) / Mixer::kMaxMixerVolume for sixteen pairs of 16-bit
+// values, rounding towards zero like the C division in the generic code path.
+// Unpacking and packing both work per 128-bit lane, so the sample order is
+// preserved.
+static FORCEINLINE __m256i avx2_scale(__m256i a, __m256i b) {
+	__m256i lo = _mm256_mullo_epi16(a, b);
+	__m256i hi = _mm256_mulhi_epi16(a, b);
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+	p0 = _mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), _mm256_set1_epi32(255)));
+	p1 = _mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), _mm256_set1_epi32(255)));
+	return _mm256_packs_epi32(_mm256_srai_epi32(p0, 8), _mm256_srai_epi32(p1, 8));
+}
+
+template<bool inStereo, bool reverseStereo>
+static void mixAVX2T(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	// Swapping the channels is done on the input, so the volumes have to
+	// be swapped along with them.
+	const __m256i vol = reverseStereo ? _mm256_set1_epi32((volL << 16) | volR)
+	                                  : _mm256_set1_epi32((volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 8 <= numFrames; i += 8) {
+		__m256i in;
+		if (inStereo) {
+			in = _mm256_loadu_si256((const __m256i *)src);
+			if (reverseStereo)
+				in = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			src += 16;
+		} else {
+			__m128i mono = _mm_loadu_si128((const __m128i *)src);
+			in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(mono, mono)), _mm_unpackhi_epi16(mono, mono), 1);
+			src += 8;
+		}
+
+		__m256i out = _mm256_loadu_si256((const __m256i *)dst);
+		out = _mm256_adds_epi16(out, avx2_scale(in, vol));
+		_mm256_storeu_si256((__m256i *)dst, out);
+		dst += 16;
+	}
+
+	for (; i < numFrames; i++) {
+		st_sample_t inL, inR;
+		inL = *src++;
+		inR = (inStereo ? *src++ : inL);
+
+		clampedAdd(dst[reverseStereo    ], (st_sample_t)((inL * (int)volL) / Audio::Mixer::kMaxMixerVolume));
+		clampedAdd(dst[reverseStereo ^ 1], (st_sample_t)((inR * (int)volR) / Audio::Mixer::kMaxMixerVolume));
+		dst += 2;
+	}
+}
+
+void MixKernel::mixAVX2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo) {
+	if (inStereo) {
+		if (reverseStereo)
+			mixAVX2T<true, true>(dst, src, numFrames, volL, volR);
+		else
+			mixAVX2T<true, false>(dst, src, numFrames, volL, volR);
+	} else {
+		if (reverseStereo)
+			mixAVX2T<false, true>(dst, src, numFrames, volL, volR);
+		else
+			mixAVX2T<false, false>(dst, src, numFrames, volL, volR);
+	}
+}
+
+int32 MixKernel::dotProductAVX2(const int16 *a, const int16 *b, uint length) {
+	__m256i sum = _mm256_setzero_si256();
+	for (uint i = 0; i < length; i += 16)
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
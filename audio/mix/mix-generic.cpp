@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+
+namespace Audio {
+
+template<bool inStereo, bool reverseStereo>
+static void mixGenericT(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	for (uint i = 0; i < numFrames; i++) {
+		st_sample_t inL, inR;
+		inL = *src++;
+		inR = (inStereo ? *src++ : inL);
+
+		st_sample_t outL, outR;
+		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
+		// Output left channel
+		clampedAdd(dst[reverseStereo    ], outL);
+
+		// Output right channel
+		clampedAdd(dst[reverseStereo ^ 1], outR);
+
+		dst += 2;
+	}
+}
+
+void MixKernel::mixGeneric(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo) {
+	if (inStereo) {
+		if (reverseStereo)
+			mixGenericT<true, true>(dst, src, numFrames, volL, volR);
+		else
+			mixGenericT<true, false>(dst, src, numFrames, volL, volR);
+	} else {
+		if (reverseStereo)
+			mixGenericT<false, true>(dst, src, numFrames, volL, volR);
+		else
+			mixGenericT<false, false>(dst, src, numFrames, volL, volR);
+	}
+}
+
+int32 MixKernel::dotProductGeneric(const int16 *a, const int16 *b, uint length) {
+	int32 sum = 0;
+	for (uint i = 0; i < length; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+} // End of namespace Audio
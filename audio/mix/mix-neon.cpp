@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Audio {
+
+// Computes (a * b) / Mixer::kMaxMixerVolume for eight 16-bit values, rounding
+// towards zero like the C division in the generic code path.
+static inline int16x8_t neon_scale(int16x8_t a, int16x4_t b) {
+	int32x4_t p0 = vmull_s16(vget_low_s16(a), b);
+	int32x4_t p1 = vmull_s16(vget_high_s16(a), b);
+	p0 = vaddq_s32(p0, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p0, 31)), 24)));
+	p1 = vaddq_s32(p1, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p1, 31)), 24)));
+	return vcombine_s16(vmovn_s32(vshrq_n_s32(p0, 8)), vmovn_s32(vshrq_n_s32(p1, 8)));
+}
+
+template<bool inStereo, bool reverseStereo>
+static void mixNEONT(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const int16x4_t vl = vdup_n_s16(volL);
+	const int16x4_t vr = vdup_n_s16(volR);
+
+	uint i = 0;
+	for (; i + 8 <= numFrames; i += 8) {
+		int16x8_t inL, inR;
+		if (inStereo) {
+			int16x8x2_t in = vld2q_s16(src);
+			inL = in.val[0];
+			inR = in.val[1];
+			src += 16;
+		} else {
+			inL = inR = vld1q_s16(src);
+			src += 8;
+		}
+
+		int16x8x2_t out = vld2q_s16(dst);
+		out.val[reverseStereo    ] = vqaddq_s16(out.val[reverseStereo    ], neon_scale(inL, vl));
+		out.val[reverseStereo ^ 1] = vqaddq_s16(out.val[reverseStereo ^ 1], neon_scale(inR, vr));
+		vst2q_s16(dst, out);
+		dst += 16;
+	}
+
+	for (; i < numFrames; i++) {
+		st_sample_t inL, inR;
+		inL = *src++;
+		inR = (inStereo ? *src++ : inL);
+
+		clampedAdd(dst[reverseStereo    ], (st_sample_t)((inL * (int)volL) / Audio::Mixer::kMaxMixerVolume));
+		clampedAdd(dst[reverseStereo ^ 1], (st_sample_t)((inR * (int)volR) / Audio::Mixer::kMaxMixerVolume));
+		dst += 2;
+	}
+}
+
+void MixKernel::mixNEON(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo) {
+	if (inStereo) {
+		if (reverseStereo)
+			mixNEONT<true, true>(dst, src, numFrames, volL, volR);
+		else
+			mixNEONT<true, false>(dst, src, numFrames, volL, volR);
+	} else {
+		if (reverseStereo)
+			mixNEONT<false, true>(dst, src, numFrames, volL, volR);
+		else
+			mixNEONT<false, false>(dst, src, numFrames, volL, volR);
+	}
+}
+
+int32 MixKernel::dotProductNEON(const int16 *a, const int16 *b, uint length) {
+	int32x4_t sum0 = vdupq_n_s32(0);
+	int32x4_t sum1 = vdupq_n_s32(0);
+	for (uint i = 0; i < length; i += 8) {
+		int16x8_t va = vld1q_s16(a + i);
+		int16x8_t vb = vld1q_s16(b + i);
+		sum0 = vmlal_s16(sum0, vget_low_s16(va), vget_low_s16(vb));
+		sum1 = vmlal_s16(sum1, vget_high_s16(va), vget_high_s16(vb));
+	}
+	int32x4_t sum = vaddq_s32(sum0, sum1);
+	int32x2_t sum2 = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(sum2, sum2), 0);
+}
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Audio {
+
+// Computes (a * b) / Mixer::kMaxMixerVolume for eight pairs of 16-bit values,
+// rounding towards zero like the C division in the generic code path.
+static FORCEINLINE __m128i sse2_scale(__m128i a, __m128i b) {
+	__m128i lo = _mm_mullo_epi16(a, b);
+	__m128i hi = _mm_mulhi_epi16(a, b);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), _mm_set1_epi32(255)));
+	p1 = _mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), _mm_set1_epi32(255)));
+	return _mm_packs_epi32(_mm_srai_epi32(p0, 8), _mm_srai_epi32(p1, 8));
+}
+
+template<bool inStereo, bool reverseStereo>
+static void mixSSE2T(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	// Swapping the channels is done on the input, so the volumes have to
+	// be swapped along with them.
+	const __m128i vol = reverseStereo ? _mm_set_epi16(volL, volR, volL, volR, volL, volR, volL, volR)
+	                                  : _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	uint i = 0;
+	for (; i + 4 <= numFrames; i += 4) {
+		__m128i in;
+		if (inStereo) {
+			in = _mm_loadu_si128((const __m128i *)src);
+			if (reverseStereo)
+				in = _mm_shufflehi_epi16(_mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			src += 8;
+		} else {
+			in = _mm_loadl_epi64((const __m128i *)src);
+			in = _mm_unpacklo_epi16(in, in);
+			src += 4;
+		}
+
+		__m128i out = _mm_loadu_si128((const __m128i *)dst);
+		out = _mm_adds_epi16(out, sse2_scale(in, vol));
+		_mm_storeu_si128((__m128i *)dst, out);
+		dst += 8;
+	}
+
+	for (; i < numFrames; i++) {
+		st_sample_t inL, inR;
+		inL = *src++;
+		inR = (inStereo ? *src++ : inL);
+
+		clampedAdd(dst[reverseStereo    ], (st_sample_t)((inL * (int)volL) / Audio::Mixer::kMaxMixerVolume));
+		clampedAdd(dst[reverseStereo ^ 1], (st_sample_t)((inR * (int)volR) / Audio::Mixer::kMaxMixerVolume));
+		dst += 2;
+	}
+}
+
+void MixKernel::mixSSE2(st_sample_t *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR, bool inStereo, bool reverseStereo) {
+	if (inStereo) {
+		if (reverseStereo)
+			mixSSE2T<true, true>(dst, src, numFrames, volL, volR);
+		else
+			mixSSE2T<true, false>(dst, src, numFrames, volL, volR);
+	} else {
+		if (reverseStereo)
+			mixSSE2T<false, true>(dst, src, numFrames, volL, volR);
+		else
+			mixSSE2T<false, false>(dst, src, numFrames, volL, volR);
+	}
+}
+
+int32 MixKernel::dotProductSSE2(const int16 *a, const int16 *b, uint length) {
+	__m128i sum0 = _mm_setzero_si128();
+	__m128i sum1 = _mm_setzero_si128();
+	for (uint i = 0; i < length; i += 16) {
+		sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+		sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i + 8)), _mm_loadu_si128((const __m128i *)(b + i + 8))));
+	}
+	__m128i sum = _mm_add_epi32(sum0, sum1);
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,74 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/system.h"
+
+#include "audio/mix.h"
+
+namespace Audio {
+
+// Initialize these to nullptr at the start
+MixKernel::MixFunc MixKernel::mixFunc = nullptr;
+MixKernel::DotProductFunc MixKernel::dotProductFunc = nullptr;
+
+// Detect at runtime whether or not the cpu has certain SIMD feature enabled
+// or not, and pick the matching implementations.
+void MixKernel::selectFuncs() {
+	mixFunc = mixGeneric;
+	dotProductFunc = dotProductGeneric;
+	// The SIMD kernels operate on signed samples only
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) {
+		mixFunc = mixNEON;
+		dotProductFunc = dotProductNEON;
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+		mixFunc = mixSSE2;
+		dotProductFunc = dotProductSSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+		mixFunc = mixAVX2;
+		dotProductFunc = dotProductAVX2;
+	}
+#endif
+#endif
+}
+
+// Jump to whatever function is in MixKernel::mixFunc.
+void MixKernel::mixStereo(st_sample_t *dst, const st_sample_t *src, uint numFrames,
+                          st_volume_t volL, st_volume_t volR,
+                          bool inStereo, bool reverseStereo) {
+	if (numFrames == 0)
+		return;
+
+	// If no function has been selected yet, detect and select
+	if (!mixFunc)
+		selectFuncs();
+
+	mixFunc(dst, src, numFrames, volL, volR, inStereo, reverseStereo);
+}
+
+} // End of namespace Audio
@@ -18,6 +18,8 @@ MODULE_OBJS := \
 	midiplayer.o \
 	miles_adlib.o \
 	miles_midi.o \
+	mix/mix.o \
+	mix/mix-generic.o \
 	mixer.o \
 	mpu401.o \
 	mt32gm.o \
@@ -97,6 +99,19 @@ MODULE_OBJS += \
 	decoders/ac3.o
 endif
 
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	mix/mix-neon.o
+endif
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	mix/mix-sse2.o
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	mix/mix-avx2.o
+endif
+
 ifdef USE_ALSA
 MODULE_OBJS += \
 	alsa_opl.o
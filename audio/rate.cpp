@@ -29,7 +29,11 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/mix.h"
 #include "audio/mixer.h"
+#include "common/config-manager.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
 #include "common/util.h"
 
 namespace Audio {
@@ -45,6 +49,149 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Polyphase windowed-sinc low-pass filter for one pair of input and output
+ * rates. Converters using the same rates share one instance through the
+ * SincFilterCache, as computing the coefficients is comparatively expensive.
+ */
+struct SincFilter {
+	enum {
+		/** Maximum number of phases (sub-sample positions) */
+		kMaxPhases = 512,
+		/** Zero crossings of the sinc function on each side of the center */
+		kZeroCrossings = 8,
+		/** Maximum filter length, used when strongly downsampling */
+		kMaxTaps = 256
+	};
+
+	st_rate_t inRate, outRate;
+
+	/** Number of phases, exact when the reduced output rate allows it */
+	uint numPhases;
+
+	/** Filter length, always a multiple of 16 for the SIMD kernels */
+	uint numTaps;
+
+	/** Phase increment per output sample, in 16.16 fixed point */
+	uint32 phaseStep;
+
+	/** numPhases sets of numTaps coefficients, in 1.15 fixed point */
+	Common::Array<int16> coeffs;
+
+	int refCount;
+
+	SincFilter(st_rate_t in, st_rate_t out);
+};
+
+SincFilter::SincFilter(st_rate_t in, st_rate_t out) : inRate(in), outRate(out), refCount(0) {
+	st_rate_t a = in, b = out;
+	while (b) {
+		st_rate_t t = a % b;
+		a = b;
+		b = t;
+	}
+
+	numPhases = MIN<uint>(out / a, kMaxPhases);
+	phaseStep = (uint32)(((uint64)in * numPhases << 16) / out);
+
+	// Cut off slightly below the Nyquist frequency of the lower rate, in
+	// cycles per input sample.
+	const double cutoff = 0.45 * MIN<double>(1.0, (double)out / in);
+	const uint halfTaps = (uint)ceil(kZeroCrossings / (2.0 * cutoff));
+	numTaps = MIN<uint>((2 * halfTaps + 15) & ~15, kMaxTaps);
+
+	// The tap at index center multiplies the input sample the output is
+	// aligned to when the phase is zero.
+	const int center = numTaps / 2 - 1;
+
+	coeffs.resize(numPhases * numTaps);
+	double *taps = new double[numTaps];
+	for (uint phase = 0; phase < numPhases; phase++) {
+		const double frac = (double)phase / numPhases;
+
+		double sum = 0.0;
+		for (uint i = 0; i < numTaps; i++) {
+			const double t = (double)((int)i - center) - frac;
+			const double x = 2.0 * cutoff * t;
+			const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			// Blackman window spanning the whole filter
+			const double w = (t + numTaps / 2.0) / numTaps;
+			const double window = 0.42 - 0.5 * cos(2.0 * M_PI * w) + 0.08 * cos(4.0 * M_PI * w);
+			taps[i] = sinc * window;
+			sum += taps[i];
+		}
+
+		// Normalize every phase to unity gain, and put the rounding error
+		// into the largest tap so that DC passes through unchanged.
+		int16 *dst = &coeffs[phase * numTaps];
+		int total = 0, largest = 0;
+		for (uint i = 0; i < numTaps; i++) {
+			dst[i] = (int16)floor(taps[i] / sum * 32768.0 + 0.5);
+			total += dst[i];
+			if (ABS(dst[i]) > ABS(dst[largest]))
+				largest = i;
+		}
+		dst[largest] += 32768 - total;
+	}
+	delete[] taps;
+}
+
+/**
+ * Hands out shared SincFilter instances. Converters get created on the
+ * engine thread but destroyed on the mixer thread, so access is serialized.
+ */
+class SincFilterCache : public Common::Singleton<SincFilterCache> {
+public:
+	const SincFilter *acquire(st_rate_t inRate, st_rate_t outRate);
+	void release(const SincFilter *filter);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	SincFilterCache() {}
+	~SincFilterCache();
+
+	Common::Mutex _mutex;
+	Common::Array<SincFilter *> _filters;
+};
+
+SincFilterCache::~SincFilterCache() {
+	for (uint i = 0; i < _filters.size(); i++)
+		delete _filters[i];
+}
+
+const SincFilter *SincFilterCache::acquire(st_rate_t inRate, st_rate_t outRate) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _filters.size(); i++) {
+		if (_filters[i]->inRate == inRate && _filters[i]->outRate == outRate) {
+			_filters[i]->refCount++;
+			return _filters[i];
+		}
+	}
+
+	SincFilter *filter = new SincFilter(inRate, outRate);
+	filter->refCount = 1;
+	_filters.push_back(filter);
+	return filter;
+}
+
+void SincFilterCache::release(const SincFilter *filter) {
+	if (!filter)
+		return;
+
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _filters.size(); i++) {
+		if (_filters[i] == filter) {
+			if (--_filters[i]->refCount == 0) {
+				delete _filters[i];
+				_filters.remove_at(i);
+			}
+			return;
+		}
+	}
+}
+
 template<bool inStereo, bool outStereo, bool reverseStereo>
 class RateConverter_Impl : public RateConverter {
 private:
@@ -76,13 +223,56 @@ private:
 	/** Current sample(s) in the input stream (left/right channel) */
 	st_sample_t _inCurL, _inCurR;
 
+	/**
+	 * Resampled, but not yet volume scaled, frames waiting to be mixed into
+	 * the output buffer. Only used for stereo output, where the frames are
+	 * handed over to MixKernel in blocks.
+	 */
+	st_sample_t _mixBuffer[512];
+
+	/** Resampling algorithm to use when the rates differ */
+	ResamplerMode _mode;
+
+	/** Filter used by sincConvert, shared with other converters */
+	const SincFilter *_sincFilter;
+
+	/**
+	 * Input history of the sinc filter (left/right channel). Every sample is
+	 * stored twice, numTaps apart, so the last numTaps samples can always be
+	 * read in one piece starting at _sincPos.
+	 */
+	int16 _sincHistL[2 * SincFilter::kMaxTaps], _sincHistR[2 * SincFilter::kMaxTaps];
+
+	/** Position of the oldest sample in the sinc filter history */
+	uint _sincPos;
+
+	/** Filter phase of the next output sample, in 16.16 fixed point */
+	uint32 _sincPhase;
+
+	/** Input samples to feed to the filter before the next output sample */
+	uint _sincPending;
+
+	/** Silent samples to feed to the filter once the input stream ended */
+	uint _sincTail;
+
 	int copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
 	int simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	template<bool nearest>
 	int interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	int sincConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+
+	/** Make sure _sincFilter matches the current rates */
+	void updateSincFilter();
+
+	/** Mix the frames queued in _mixBuffer into the output, starting at @p mixStart */
+	void flushMixBuffer(st_sample_t *&mixStart, st_sample_t *outBuffer, st_volume_t vol_l, st_volume_t vol_r);
 
 public:
-	RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate);
-	virtual ~RateConverter_Impl() {}
+	RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerMode mode);
+	virtual ~RateConverter_Impl() {
+		if (_sincFilter)
+			SincFilterCache::instance().release(_sincFilter);
+	}
 
 	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
 
@@ -92,7 +282,7 @@ public:
 	st_rate_t getInputRate() const override { return _inRate; }
 	st_rate_t getOutputRate() const override { return _outRate; }
 
-	bool needsDraining() const override { return _bufferSize != 0; }
+	bool needsDraining() const override { return _bufferSize != 0 || (_sincFilter && _sincTail != 0); }
 };
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
@@ -112,6 +302,17 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStr
 				return (outBuffer - outStart) / (outStereo ? 2 : 1);
 		}
 
+		if (outStereo) {
+			// Mix as many frames as both buffers allow in one go
+			const int numFrames = MIN<int>(_bufferSize / (inStereo ? 2 : 1), (outEnd - outBuffer) / 2);
+			MixKernel::mixStereo(outBuffer, _bufferPos, numFrames, volL, volR, inStereo, reverseStereo);
+
+			_bufferPos += numFrames * (inStereo ? 2 : 1);
+			_bufferSize -= numFrames * (inStereo ? 2 : 1);
+			outBuffer += numFrames * 2;
+			continue;
+		}
+
 		// Mix the data into the output buffer
 		st_sample_t inL, inR;
 		inL = *_bufferPos++;
@@ -122,35 +323,34 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStr
 		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
 		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
 
-		if (outStereo) {
-			// Output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// Output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-			outBuffer += 2;
-		} else {
-			// Output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
+		// Output mono channel
+		clampedAdd(outBuffer[0], (outL + outR) / 2);
 
-			outBuffer += 1;
-		}
+		outBuffer += 1;
 	}
 
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
 }
 
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void RateConverter_Impl<inStereo, outStereo, reverseStereo>::flushMixBuffer(st_sample_t *&mixStart, st_sample_t *outBuffer, st_volume_t volL, st_volume_t volR) {
+	MixKernel::mixStereo(mixStart, _mixBuffer, (outBuffer - mixStart) / 2, volL, volR, inStereo, reverseStereo);
+	mixStart = outBuffer;
+}
+
 template<bool inStereo, bool outStereo, bool reverseStereo>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	// How much to increment _outPos by
 	frac_t outPos_inc = _inRate / _outRate;
 
-	st_sample_t *outStart, *outEnd;
+	st_sample_t *outStart, *outEnd, *mixStart;
 
 	outStart = outBuffer;
 	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
 
+	// Start of the output frames which are still pending in _mixBuffer
+	mixStart = outBuffer;
+
 	while (outBuffer < outEnd) {
 		// Read enough input samples so that _outPos >= 0
 		do {
@@ -159,8 +359,11 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 				_bufferPos = _buffer;
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
-				if (_bufferSize <= 0)
+				if (_bufferSize <= 0) {
+					if (outStereo)
+						flushMixBuffer(mixStart, outBuffer, volL, volR);
 					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				}
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -178,37 +381,47 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 		// Increment output position
 		_outPos += outPos_inc;
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
 		if (outStereo) {
-			// output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+			// Queue the frame, the volume is applied when mixing the block
+			st_sample_t *mixPos = _mixBuffer + ((outBuffer - mixStart) / 2) * (inStereo ? 2 : 1);
+			mixPos[0] = inL;
+			if (inStereo)
+				mixPos[1] = inR;
 
 			outBuffer += 2;
+
+			if (mixPos + (inStereo ? 2 : 1) == _mixBuffer + ARRAYSIZE(_mixBuffer))
+				flushMixBuffer(mixStart, outBuffer, volL, volR);
 		} else {
+			st_sample_t outL, outR;
+			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
 			// output mono channel
 			clampedAdd(outBuffer[0], (outL + outR) / 2);
 
 			outBuffer += 1;
 		}
 	}
+
+	if (outStereo)
+		flushMixBuffer(mixStart, outBuffer, volL, volR);
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
+template<bool nearest>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	// How much to increment _outPosFrac by
 	frac_t outPos_inc = (_inRate << FRAC_BITS_LOW) / _outRate;
 
-	st_sample_t *outStart, *outEnd;
+	st_sample_t *outStart, *outEnd, *mixStart;
 	outStart = outBuffer;
 	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
 
+	// Start of the output frames which are still pending in _mixBuffer
+	mixStart = outBuffer;
+
 	while (outBuffer < outEnd) {
 		// Read enough input samples so that _outPosFrac < 0
 		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
@@ -217,8 +430,11 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 				_bufferPos = _buffer;
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
-				if (_bufferSize <= 0)
+				if (_bufferSize <= 0) {
+					if (outStereo)
+						flushMixBuffer(mixStart, outBuffer, volL, volR);
 					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				}
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -236,26 +452,37 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 		// Loop as long as the _outPos trails behind, and as long as there is
 		// still space in the output buffer.
 		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && outBuffer < outEnd) {
-			// Interpolate
 			st_sample_t inL, inR;
-			inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			inR = (inStereo ?
-						(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						inL);
-
-			st_sample_t outL, outR;
-			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+			if (nearest) {
+				// Pick the closest input sample
+				inL = (_outPosFrac < (frac_t)FRAC_HALF_LOW) ? _inLastL : _inCurL;
+				inR = (inStereo ?
+							((_outPosFrac < (frac_t)FRAC_HALF_LOW) ? _inLastR : _inCurR) :
+							inL);
+			} else {
+				// Interpolate
+				inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				inR = (inStereo ?
+							(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
+							inL);
+			}
 
 			if (outStereo) {
-				// Output left channel
-				clampedAdd(outBuffer[reverseStereo    ], outL);
-
-				// Output right channel
-				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+				// Queue the frame, the volume is applied when mixing the block
+				st_sample_t *mixPos = _mixBuffer + ((outBuffer - mixStart) / 2) * (inStereo ? 2 : 1);
+				mixPos[0] = inL;
+				if (inStereo)
+					mixPos[1] = inR;
 
 				outBuffer += 2;
+
+				if (mixPos + (inStereo ? 2 : 1) == _mixBuffer + ARRAYSIZE(_mixBuffer))
+					flushMixBuffer(mixStart, outBuffer, volL, volR);
 			} else {
+				st_sample_t outL, outR;
+				outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+				outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
 				// Output mono channel
 				clampedAdd(outBuffer[0], (outL + outR) / 2);
 
@@ -266,11 +493,149 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 			_outPosFrac += outPos_inc;
 		}
 	}
+
+	if (outStereo)
+		flushMixBuffer(mixStart, outBuffer, volL, volR);
 	return (outBuffer - outStart) / (outStereo ? 2 : 1);
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate) :
+void RateConverter_Impl<inStereo, outStereo, reverseStereo>::updateSincFilter() {
+	if (_sincFilter && _sincFilter->inRate == _inRate && _sincFilter->outRate == _outRate)
+		return;
+
+	const SincFilter *oldFilter = _sincFilter;
+	_sincFilter = SincFilterCache::instance().acquire(_inRate, _outRate);
+
+	const uint numTaps = _sincFilter->numTaps;
+
+	if (!oldFilter) {
+		// Start from silence, and read enough input for the filter center
+		// to line up with the first input sample.
+		memset(_sincHistL, 0, sizeof(_sincHistL));
+		memset(_sincHistR, 0, sizeof(_sincHistR));
+		_sincPos = 0;
+		_sincPhase = 0;
+		_sincPending = numTaps / 2 + 1;
+	} else {
+		// Keep the most recent input, so that changing the rate does not
+		// produce a click.
+		if (oldFilter->numTaps != numTaps) {
+			const uint oldTaps = oldFilter->numTaps;
+			int16 histL[SincFilter::kMaxTaps], histR[SincFilter::kMaxTaps];
+			memcpy(histL, _sincHistL + _sincPos, oldTaps * sizeof(int16));
+			memcpy(histR, _sincHistR + _sincPos, oldTaps * sizeof(int16));
+
+			memset(_sincHistL, 0, sizeof(_sincHistL));
+			memset(_sincHistR, 0, sizeof(_sincHistR));
+
+			const uint keep = MIN(oldTaps, numTaps);
+			for (uint i = 0; i < keep; i++) {
+				const uint dst = numTaps - keep + i;
+				_sincHistL[dst] = _sincHistL[dst + numTaps] = histL[oldTaps - keep + i];
+				_sincHistR[dst] = _sincHistR[dst + numTaps] = histR[oldTaps - keep + i];
+			}
+			_sincPos = 0;
+		}
+
+		_sincPhase = (uint32)(((uint64)_sincPhase * _sincFilter->numPhases) / oldFilter->numPhases);
+		SincFilterCache::instance().release(oldFilter);
+	}
+
+	_sincTail = numTaps / 2;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::sincConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	updateSincFilter();
+
+	const uint numTaps = _sincFilter->numTaps;
+	const uint32 phaseEnd = _sincFilter->numPhases << 16;
+	const int16 *coeffs = _sincFilter->coeffs.data();
+
+	st_sample_t *outStart, *outEnd, *mixStart;
+	outStart = outBuffer;
+	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+
+	// Start of the output frames which are still pending in _mixBuffer
+	mixStart = outBuffer;
+
+	while (outBuffer < outEnd) {
+		// Feed the filter until its center reaches the next output position
+		while (_sincPending > 0) {
+			// Check if we have to refill the buffer
+			if (_bufferSize == 0) {
+				_bufferPos = _buffer;
+				_bufferSize = MAX(input.readBuffer(_buffer, ARRAYSIZE(_buffer)), 0);
+			}
+
+			st_sample_t inL, inR;
+			if (_bufferSize > 0) {
+				_bufferSize -= (inStereo ? 2 : 1);
+				inL = *_bufferPos++;
+				inR = (inStereo ? *_bufferPos++ : inL);
+			} else if (_sincTail > 0 && input.endOfStream()) {
+				// Push out the samples held back by the filter delay
+				_sincTail--;
+				inL = inR = 0;
+			} else {
+				if (outStereo)
+					flushMixBuffer(mixStart, outBuffer, volL, volR);
+				return (outBuffer - outStart) / (outStereo ? 2 : 1);
+			}
+
+			_sincHistL[_sincPos] = _sincHistL[_sincPos + numTaps] = inL;
+			if (inStereo)
+				_sincHistR[_sincPos] = _sincHistR[_sincPos + numTaps] = inR;
+			if (++_sincPos == numTaps)
+				_sincPos = 0;
+
+			_sincPending--;
+		}
+
+		// Filter
+		const int16 *phaseCoeffs = coeffs + (_sincPhase >> 16) * numTaps;
+		st_sample_t inL, inR;
+		inL = (st_sample_t)CLIP<int32>((MixKernel::dotProduct(_sincHistL + _sincPos, phaseCoeffs, numTaps) + (1 << 14)) >> 15, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		inR = (inStereo ?
+					(st_sample_t)CLIP<int32>((MixKernel::dotProduct(_sincHistR + _sincPos, phaseCoeffs, numTaps) + (1 << 14)) >> 15, ST_SAMPLE_MIN, ST_SAMPLE_MAX) :
+					inL);
+
+		if (outStereo) {
+			// Queue the frame, the volume is applied when mixing the block
+			st_sample_t *mixPos = _mixBuffer + ((outBuffer - mixStart) / 2) * (inStereo ? 2 : 1);
+			mixPos[0] = inL;
+			if (inStereo)
+				mixPos[1] = inR;
+
+			outBuffer += 2;
+
+			if (mixPos + (inStereo ? 2 : 1) == _mixBuffer + ARRAYSIZE(_mixBuffer))
+				flushMixBuffer(mixStart, outBuffer, volL, volR);
+		} else {
+			st_sample_t outL, outR;
+			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
+			// Output mono channel
+			clampedAdd(outBuffer[0], (outL + outR) / 2);
+
+			outBuffer += 1;
+		}
+
+		// Increment output position
+		_sincPhase += _sincFilter->phaseStep;
+		_sincPending = _sincPhase / phaseEnd;
+		_sincPhase %= phaseEnd;
+	}
+
+	if (outStereo)
+		flushMixBuffer(mixStart, outBuffer, volL, volR);
+	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerMode mode) :
 	_inRate(inputRate),
 	_outRate(outputRate),
 	_outPos(1),
@@ -280,38 +645,70 @@ RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_ra
 	_inCurL(0),
 	_inCurR(0),
 	_bufferSize(0),
-	_bufferPos(nullptr) {}
+	_bufferPos(nullptr),
+	_mode(mode),
+	_sincFilter(nullptr),
+	_sincPos(0),
+	_sincPhase(0),
+	_sincPending(0),
+	_sincTail(0) {}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
 int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	assert(input.isStereo() == inStereo);
 
+	if (_mode == kResamplerSinc && _inRate != _outRate)
+		return sincConvert(input, outBuffer, numSamples, volL, volR);
+
+	// The filter history is useless once the rates match again
+	if (_sincFilter) {
+		SincFilterCache::instance().release(_sincFilter);
+		_sincFilter = nullptr;
+	}
+
 	if (_inRate == _outRate) {
 		return copyConvert(input, outBuffer, numSamples, volL, volR);
 	} else {
 		if ((_inRate % _outRate) == 0 && (_inRate < 65536)) {
 			return simpleConvert(input, outBuffer, numSamples, volL, volR);
+		} else if (_mode == kResamplerFast) {
+			return interpolateConvert<true>(input, outBuffer, numSamples, volL, volR);
 		} else {
-			return interpolateConvert(input, outBuffer, numSamples, volL, volR);
+			return interpolateConvert<false>(input, outBuffer, numSamples, volL, volR);
 		}
 	}
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+ResamplerMode getResamplerModeFromConfig() {
+	if (ConfMan.hasKey("audio_resampler")) {
+		const Common::String &mode = ConfMan.get("audio_resampler");
+		if (mode.equalsIgnoreCase("fast"))
+			return kResamplerFast;
+		if (mode.equalsIgnoreCase("sinc"))
+			return kResamplerSinc;
+	}
+	return kResamplerLinear;
+}
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerMode mode) {
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
-				return new RateConverter_Impl<true, true, true>(inRate, outRate);
+				return new RateConverter_Impl<true, true, true>(inRate, outRate, mode);
 			else
-				return new RateConverter_Impl<true, true, false>(inRate, outRate);
+				return new RateConverter_Impl<true, true, false>(inRate, outRate, mode);
 		} else
-			return new RateConverter_Impl<true, false, false>(inRate, outRate);
+			return new RateConverter_Impl<true, false, false>(inRate, outRate, mode);
 	} else {
 		if (outStereo) {
-			return new RateConverter_Impl<false, true, false>(inRate, outRate);
+			return new RateConverter_Impl<false, true, false>(inRate, outRate, mode);
 		} else
-			return new RateConverter_Impl<false, false, false>(inRate, outRate);
+			return new RateConverter_Impl<false, false, false>(inRate, outRate, mode);
 	}
 }
 
 } // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterCache);
+}
@@ -66,6 +66,23 @@ static inline void clampedAdd(int16& a, int b) {
 #endif
 }
 
+/**
+ * Resampling algorithms available to RateConverter.
+ */
+enum ResamplerMode {
+	kResamplerFast,   ///< Nearest neighbour, cheapest but aliases the most.
+	kResamplerLinear, ///< Linear interpolation.
+	kResamplerSinc    ///< Polyphase windowed-sinc filter, highest quality.
+};
+
+/**
+ * Get the resampling algorithm selected by the "audio_resampler"
+ * configuration key ("fast", "linear" or "sinc").
+ *
+ * @return kResamplerLinear when the key is not set or holds an unknown value.
+ */
+ResamplerMode getResamplerModeFromConfig();
+
 /**
  * Helper class that handles resampling an AudioStream between an input and output
  * sample rate. Its regular use case is upsampling from the native stream rate
@@ -104,7 +121,7 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerMode mode = kResamplerLinear);
 
 /** @} */
 } // End of namespace Audio
@@ -37,6 +37,7 @@
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
+#include "common/thread.h"
 #include "common/translation.h"
 #include "common/osd_message_queue.h"
 
@@ -118,6 +119,30 @@ private:
 
 	int _outputRate;
 
+	// Rendering ahead of the mixer. The render thread fills the free part of
+	// the ring, the mixer thread takes the frames rendered so far. MIDI events
+	// are queued in the synth with the time at which the mixer plays them.
+	Common::ThreadInternal *_renderThread;
+	Common::SemaphoreInternal *_ringSpace;	// Posted when the render thread waits for free frames
+	Common::Mutex _ringMutex;
+	Common::Mutex _eventMutex;
+	int16 *_ring;
+	uint32 _ringSize;
+	uint32 _ringStart;
+	uint32 _ringCount;
+	uint32 _framesPlayed;
+	bool _stopRendering;
+	bool _renderWaiting;
+	uint32 _underruns;
+	uint32 _underrunFrames;
+
+	static void renderThread(void *param);
+	void startRendering();
+	void stopRendering();
+	uint32 takeRenderedFrames(int16 *data, uint32 len);
+	uint32 getEventTimestamp();
+	void writeSysex(byte device, const byte *data, uint32 len);
+
 protected:
 	void generateSamples(int16 *buf, int len) override;
 
@@ -155,6 +180,17 @@ MidiDriver_MT32::MidiDriver_MT32(Audio::Mixer *mixer) : MidiDriver_Emulated(mixe
 	_outputRate = 0;
 	_controlData = nullptr;
 	_pcmData = nullptr;
+	_renderThread = nullptr;
+	_ringSpace = nullptr;
+	_ring = nullptr;
+	_ringSize = 0;
+	_ringStart = 0;
+	_ringCount = 0;
+	_framesPlayed = 0;
+	_stopRendering = false;
+	_renderWaiting = false;
+	_underruns = 0;
+	_underrunFrames = 0;
 }
 
 MidiDriver_MT32::~MidiDriver_MT32() {
@@ -220,6 +256,8 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
+	startRendering();
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
@@ -228,8 +266,13 @@ int MidiDriver_MT32::open() {
 void MidiDriver_MT32::send(uint32 b) {
 	midiDriverCommonSend(b);
 
-	Common::StackLock lock(_mutex);
-	_service.playMsg(b);
+	if (_renderThread) {
+		Common::StackLock lock(_eventMutex);
+		_service.playMsgAt(b, getEventTimestamp());
+	} else {
+		Common::StackLock lock(_mutex);
+		_service.playMsg(b);
+	}
 }
 
 // Indiana Jones and the Fate of Atlantis (including the demo) uses
@@ -239,15 +282,19 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
 	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
-	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	writeSysex(channel, benderRangeSysex, 4);
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 	midiDriverCommonSysEx(msg, length);
 	if (msg[0] == 0xf0) {
-		Common::StackLock lock(_mutex);
-		_service.playSysex(msg, length);
+		if (_renderThread) {
+			Common::StackLock lock(_eventMutex);
+			_service.playSysexAt(msg, length, getEventTimestamp());
+		} else {
+			Common::StackLock lock(_mutex);
+			_service.playSysex(msg, length);
+		}
 	} else {
 		enum {
 			SYSEX_CMD_DT1 = 0x12,
@@ -255,8 +302,7 @@ void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 		};
 
 		if (msg[3] == SYSEX_CMD_DT1 || msg[3] == SYSEX_CMD_DAT) {
-			Common::StackLock lock(_mutex);
-			_service.writeSysex(msg[1], msg + 4, length - 5);
+			writeSysex(msg[1], msg + 4, length - 5);
 		} else {
 			warning("Unused sysEx command %d", msg[3]);
 		}
@@ -273,6 +319,8 @@ void MidiDriver_MT32::close() {
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
 
+	stopRendering();
+
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
 	_service.freeContext();
@@ -283,8 +331,172 @@ void MidiDriver_MT32::close() {
 }
 
 void MidiDriver_MT32::generateSamples(int16 *data, int len) {
-	Common::StackLock lock(_mutex);
-	_service.renderBit16s(data, len);
+	if (!_renderThread) {
+		Common::StackLock lock(_mutex);
+		_service.renderBit16s(data, len);
+		return;
+	}
+
+	uint32 done = takeRenderedFrames(data, len);
+	if (done < (uint32)len) {
+		// The render thread fell behind. Once it has finished the frames it
+		// is working on, render the rest here, which keeps the stream in
+		// order since the render thread continues after them.
+		Common::StackLock lock(_mutex);
+		done += takeRenderedFrames(data + done * 2, len - done);
+		if (done < (uint32)len) {
+			_service.renderBit16s(data + done * 2, len - done);
+
+			Common::StackLock ringLock(_ringMutex);
+			_framesPlayed += len - done;
+			_underruns++;
+			_underrunFrames += len - done;
+		}
+	}
+}
+
+void MidiDriver_MT32::writeSysex(byte device, const byte *data, uint32 len) {
+	if (!_renderThread) {
+		Common::StackLock lock(_mutex);
+		_service.writeSysex(device, data, len);
+		return;
+	}
+
+	// Queue the write as a complete DT1 message, so that it is played in
+	// order with the other events
+	byte *sysex = new byte[len + 7];
+	sysex[0] = 0xF0;
+	sysex[1] = 0x41;
+	sysex[2] = device;
+	sysex[3] = 0x16;
+	sysex[4] = 0x12;
+	memcpy(sysex + 5, data, len);
+
+	byte checksum = 0;
+	for (uint32 i = 0; i < len; i++)
+		checksum -= data[i];
+	sysex[len + 5] = checksum & 0x7F;
+	sysex[len + 6] = 0xF7;
+
+	{
+		Common::StackLock lock(_eventMutex);
+		_service.playSysexAt(sysex, len + 7, getEventTimestamp());
+	}
+	delete[] sysex;
+}
+
+void MidiDriver_MT32::startRendering() {
+	int millis = ConfMan.getInt("mt32_render_ahead");
+	if (millis <= 0)
+		return;
+
+	_ringSize = MAX<uint32>(_outputRate * millis / 1000, 256);
+	_ring = new int16[_ringSize * 2];
+	_ringStart = 0;
+	_ringCount = 0;
+	_framesPlayed = 0;
+	_stopRendering = false;
+	_renderWaiting = false;
+	_underruns = 0;
+	_underrunFrames = 0;
+
+	_ringSpace = g_system->createSemaphore();
+	if (_ringSpace)
+		_renderThread = g_system->createThread(renderThread, this);
+	if (!_renderThread) {
+		debug(3, "MT32emu: Threads are not supported, samples are rendered by the mixer");
+		delete _ringSpace;
+		_ringSpace = nullptr;
+		delete[] _ring;
+		_ring = nullptr;
+	}
+}
+
+void MidiDriver_MT32::stopRendering() {
+	if (!_renderThread)
+		return;
+
+	{
+		Common::StackLock lock(_ringMutex);
+		_stopRendering = true;
+		if (_renderWaiting) {
+			_renderWaiting = false;
+			_ringSpace->post();
+		}
+	}
+	_renderThread->wait();
+	delete _renderThread;
+	_renderThread = nullptr;
+	delete _ringSpace;
+	_ringSpace = nullptr;
+
+	debug(1, "MT32emu: %u underruns, %u of %u frames rendered by the mixer", _underruns, _underrunFrames, _framesPlayed);
+
+	delete[] _ring;
+	_ring = nullptr;
+}
+
+void MidiDriver_MT32::renderThread(void *param) {
+	MidiDriver_MT32 *driver = (MidiDriver_MT32 *)param;
+
+	for (;;) {
+		uint32 end, len;
+		{
+			Common::StackLock lock(driver->_ringMutex);
+			if (driver->_stopRendering)
+				return;
+
+			end = (driver->_ringStart + driver->_ringCount) % driver->_ringSize;
+			len = MIN(driver->_ringSize - driver->_ringCount, driver->_ringSize - end);
+			driver->_renderWaiting = !len;
+		}
+
+		if (!len) {
+			// The ring is full, wait for the mixer to take some frames
+			driver->_ringSpace->wait();
+			continue;
+		}
+
+		// Render in small chunks, so that the mixer never waits long for
+		// the synth when it runs out of frames
+		len = MIN<uint32>(len, 256);
+
+		// The free part of the ring is not used by the mixer until the
+		// frames are counted, which happens before the synth is unlocked
+		Common::StackLock lock(driver->_mutex);
+		driver->_service.renderBit16s(driver->_ring + end * 2, len);
+
+		Common::StackLock ringLock(driver->_ringMutex);
+		driver->_ringCount += len;
+	}
+}
+
+uint32 MidiDriver_MT32::takeRenderedFrames(int16 *data, uint32 len) {
+	Common::StackLock lock(_ringMutex);
+
+	uint32 done = 0;
+	while (done < len && _ringCount) {
+		const uint32 count = MIN(len - done, MIN(_ringCount, _ringSize - _ringStart));
+		memcpy(data + done * 2, _ring + _ringStart * 2, count * 2 * sizeof(int16));
+		_ringStart = (_ringStart + count) % _ringSize;
+		_ringCount -= count;
+		done += count;
+	}
+	_framesPlayed += done;
+
+	if (done && _renderWaiting) {
+		_renderWaiting = false;
+		_ringSpace->post();
+	}
+	return done;
+}
+
+uint32 MidiDriver_MT32::getEventTimestamp() {
+	// The render thread is never more than the size of the ring ahead of the
+	// mixer, so events played that much later are never late, and keep the
+	// timing they were sent with
+	Common::StackLock lock(_ringMutex);
+	return _service.convertOutputToSynthTimestamp(_framesPlayed + _ringSize);
 }
 
 uint32 MidiDriver_MT32::property(int prop, uint32 param) {
@@ -292,6 +504,14 @@ uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 	case PROP_CHANNEL_MASK:
 		_channelMask = param & 0xFFFF;
 		return 1;
+	case PROP_RENDER_UNDERRUNS: {
+		Common::StackLock lock(_ringMutex);
+		if (param == 0xFFFF)
+			return _underruns;
+		_underruns = 0;
+		_underrunFrames = 0;
+		return 0;
+	}
 	default:
 		break;
 	}
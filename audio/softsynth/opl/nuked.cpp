@@ -26,6 +26,7 @@
 // version: 1.8
 //
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include "audio/mixer.h"
@@ -1121,15 +1122,92 @@ static void OPL3_ProcessSlot(opl3_slot *slot)
     OPL3_SlotGenerate(slot);
 }
 
+static void OPL3_UpdateTimers(opl3_chip *chip)
+{
+    uint8_t shift = 0;
+
+    if ((chip->timer & 0x3f) == 0x3f)
+    {
+        chip->tremolopos = (chip->tremolopos + 1) % 210;
+    }
+    if (chip->tremolopos < 105)
+    {
+        chip->tremolo = chip->tremolopos >> chip->tremoloshift;
+    }
+    else
+    {
+        chip->tremolo = (210 - chip->tremolopos) >> chip->tremoloshift;
+    }
+
+    if ((chip->timer & 0x3ff) == 0x3ff)
+    {
+        chip->vibpos = (chip->vibpos + 1) & 7;
+    }
+
+    chip->timer++;
+
+    chip->eg_add = 0;
+    if (chip->eg_timer)
+    {
+        while (shift < 36 && ((chip->eg_timer >> shift) & 1) == 0)
+        {
+            shift++;
+        }
+        if (shift > 12)
+        {
+            chip->eg_add = 0;
+        }
+        else
+        {
+            chip->eg_add = shift + 1;
+        }
+    }
+
+    if (chip->eg_timerrem || chip->eg_state)
+    {
+        if (chip->eg_timer == UINT64_C(0xfffffffff))
+        {
+            chip->eg_timer = 0;
+            chip->eg_timerrem = 1;
+        }
+        else
+        {
+            chip->eg_timer++;
+            chip->eg_timerrem = 0;
+        }
+    }
+
+    chip->eg_state ^= 1;
+}
+
+/* Returns non-zero if registers were written */
+static uint8_t OPL3_ProcessWriteBuf(opl3_chip *chip)
+{
+    opl3_writebuf *writebuf;
+    uint8_t written = 0;
+
+    while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
+    {
+        if (!(writebuf->reg & 0x200))
+        {
+            break;
+        }
+        writebuf->reg &= 0x1ff;
+        OPL3_WriteReg(chip, writebuf->reg, writebuf->data);
+        chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL_WRITEBUF_SIZE;
+        written = 1;
+    }
+    chip->writebuf_samplecnt++;
+    return written;
+}
+
 inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
 {
     opl3_channel *channel;
-    opl3_writebuf *writebuf;
     int16_t **out;
     int32_t mix[2];
     uint8_t ii;
     int16_t accm;
-    uint8_t shift = 0;
 
     buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
     buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
@@ -1199,70 +1277,8 @@ inline void OPL3_Generate4Ch(opl3_chip *chip, int16_t *buf4)
     }
 #endif
 
-    if ((chip->timer & 0x3f) == 0x3f)
-    {
-        chip->tremolopos = (chip->tremolopos + 1) % 210;
-    }
-    if (chip->tremolopos < 105)
-    {
-        chip->tremolo = chip->tremolopos >> chip->tremoloshift;
-    }
-    else
-    {
-        chip->tremolo = (210 - chip->tremolopos) >> chip->tremoloshift;
-    }
-
-    if ((chip->timer & 0x3ff) == 0x3ff)
-    {
-        chip->vibpos = (chip->vibpos + 1) & 7;
-    }
-
-    chip->timer++;
-
-    chip->eg_add = 0;
-    if (chip->eg_timer)
-    {
-        while (shift < 36 && ((chip->eg_timer >> shift) & 1) == 0)
-        {
-            shift++;
-        }
-        if (shift > 12)
-        {
-            chip->eg_add = 0;
-        }
-        else
-        {
-            chip->eg_add = shift + 1;
-        }
-    }
-
-    if (chip->eg_timerrem || chip->eg_state)
-    {
-        if (chip->eg_timer == UINT64_C(0xfffffffff))
-        {
-            chip->eg_timer = 0;
-            chip->eg_timerrem = 1;
-        }
-        else
-        {
-            chip->eg_timer++;
-            chip->eg_timerrem = 0;
-        }
-    }
-
-    chip->eg_state ^= 1;
-
-    while ((writebuf = &chip->writebuf[chip->writebuf_cur]), writebuf->time <= chip->writebuf_samplecnt)
-    {
-        if (!(writebuf->reg & 0x200))
-        {
-            break;
-        }
-        writebuf->reg &= 0x1ff;
-        OPL3_WriteReg(chip, writebuf->reg, writebuf->data);
-        chip->writebuf_cur = (chip->writebuf_cur + 1) % OPL_WRITEBUF_SIZE;
-    }
-    chip->writebuf_samplecnt++;
+    OPL3_UpdateTimers(chip);
+    OPL3_ProcessWriteBuf(chip);
 }
 
 void OPL3_Generate(opl3_chip *chip, int16_t *buf)
@@ -1548,6 +1564,631 @@ void OPL3_GenerateStream(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
     }
 }
 
+#if !OPL_ENABLE_STEREOEXT
+
+/*
+    Block generation
+
+    Renders the samples between buffered register writes with the slot
+    state in a structure of arrays. Everything that only depends on the
+    registers is derived once per write, and the feedback, envelope and
+    phase stages run as loops over all 36 slots before the operators are
+    evaluated in slot order. The output is identical to OPL3_Generate4Ch.
+*/
+
+#define OPL_BLOCK_FBMOD     36
+#define OPL_BLOCK_ZEROMOD   72
+#define OPL_BLOCK_NATIVE    512
+
+typedef struct _opl3_block {
+    /* Slot outputs, then feedback values, then zero */
+    int16_t val[73];
+    int16_t prout[36];
+    uint16_t eg_rout[36];
+    uint16_t eg_out[36];
+    uint8_t eg_gen[36];
+    uint8_t pg_reset[36];
+    uint32_t pg_phase[36];
+    uint16_t pg_phase_out[36];
+
+    /* Derived from the registers */
+    uint16_t eg_base[36];
+    uint8_t eg_trem[36];
+    uint8_t ks[36];
+    uint8_t reg_type[36];
+    uint8_t reg_ar[36];
+    uint8_t reg_dr[36];
+    uint8_t reg_sl[36];
+    uint8_t reg_rr[36];
+    uint8_t key[36];
+    uint8_t fb[36];
+    uint8_t reg_vib[36];
+    uint8_t reg_mult[36];
+    uint8_t reg_wf[36];
+    uint8_t mod[36];
+    uint8_t block[36];
+    uint16_t f_num[36];
+    uint32_t pg_inc[36];
+    uint8_t out[18][4];
+    uint16_t cha[18];
+    uint16_t chb[18];
+    uint16_t chc[18];
+    uint16_t chd[18];
+} opl3_block;
+
+static uint8_t OPL3_BlockIndex(const opl3_chip *chip, const int16_t *ptr)
+{
+    size_t offset;
+
+    if (ptr == &chip->zeromod)
+    {
+        return OPL_BLOCK_ZEROMOD;
+    }
+    offset = (const uint8_t *)ptr - (const uint8_t *)chip->slot;
+    if (offset % sizeof(opl3_slot) == offsetof(opl3_slot, fbmod))
+    {
+        return (uint8_t)(OPL_BLOCK_FBMOD + offset / sizeof(opl3_slot));
+    }
+    return (uint8_t)(offset / sizeof(opl3_slot));
+}
+
+static void OPL3_BlockLoad(opl3_chip *chip, opl3_block *block)
+{
+    opl3_slot *slot;
+    uint8_t ii;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        slot = &chip->slot[ii];
+        block->val[ii] = slot->out;
+        block->val[OPL_BLOCK_FBMOD + ii] = slot->fbmod;
+        block->prout[ii] = slot->prout;
+        block->eg_rout[ii] = slot->eg_rout;
+        block->eg_out[ii] = slot->eg_out;
+        block->eg_gen[ii] = slot->eg_gen;
+        block->pg_reset[ii] = (uint8_t)slot->pg_reset;
+        block->pg_phase[ii] = slot->pg_phase;
+        block->pg_phase_out[ii] = slot->pg_phase_out;
+    }
+    block->val[OPL_BLOCK_ZEROMOD] = chip->zeromod;
+}
+
+static void OPL3_BlockStore(opl3_chip *chip, const opl3_block *block)
+{
+    opl3_slot *slot;
+    uint8_t ii;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        slot = &chip->slot[ii];
+        slot->out = block->val[ii];
+        slot->fbmod = block->val[OPL_BLOCK_FBMOD + ii];
+        slot->prout = block->prout[ii];
+        slot->eg_rout = block->eg_rout[ii];
+        slot->eg_out = block->eg_out[ii];
+        slot->eg_gen = block->eg_gen[ii];
+        slot->pg_reset = block->pg_reset[ii];
+        slot->pg_phase = block->pg_phase[ii];
+        slot->pg_phase_out = block->pg_phase_out[ii];
+    }
+}
+
+/* Register writes only change the fields set up here */
+static void OPL3_BlockSetup(opl3_chip *chip, opl3_block *block)
+{
+    opl3_slot *slot;
+    opl3_channel *channel;
+    uint32_t basefreq;
+    uint8_t ii, jj;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        slot = &chip->slot[ii];
+        channel = slot->channel;
+        block->eg_base[ii] = (slot->reg_tl << 2) + (slot->eg_ksl >> kslshift[slot->reg_ksl]);
+        block->eg_trem[ii] = (slot->trem == &chip->tremolo);
+        block->ks[ii] = channel->ksv >> ((slot->reg_ksr ^ 1) << 1);
+        block->reg_type[ii] = slot->reg_type;
+        block->reg_ar[ii] = slot->reg_ar;
+        block->reg_dr[ii] = slot->reg_dr;
+        block->reg_sl[ii] = slot->reg_sl;
+        block->reg_rr[ii] = slot->reg_rr;
+        block->key[ii] = slot->key;
+        block->fb[ii] = channel->fb;
+        block->reg_vib[ii] = slot->reg_vib;
+        block->reg_mult[ii] = slot->reg_mult;
+        block->reg_wf[ii] = slot->reg_wf;
+        block->mod[ii] = OPL3_BlockIndex(chip, slot->mod);
+        block->block[ii] = channel->block;
+        block->f_num[ii] = channel->f_num;
+        basefreq = (channel->f_num << channel->block) >> 1;
+        block->pg_inc[ii] = (basefreq * mt[slot->reg_mult]) >> 1;
+    }
+    for (ii = 0; ii < 18; ii++)
+    {
+        channel = &chip->channel[ii];
+        for (jj = 0; jj < 4; jj++)
+        {
+            block->out[ii][jj] = OPL3_BlockIndex(chip, channel->out[jj]);
+        }
+        block->cha[ii] = channel->cha;
+        block->chb[ii] = channel->chb;
+        block->chc[ii] = channel->chc;
+        block->chd[ii] = channel->chd;
+    }
+}
+
+static void OPL3_BlockCalcFB(opl3_block *block)
+{
+    uint8_t ii;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (block->fb[ii] != 0x00)
+        {
+            block->val[OPL_BLOCK_FBMOD + ii] = (block->prout[ii] + block->val[ii]) >> (0x09 - block->fb[ii]);
+        }
+        else
+        {
+            block->val[OPL_BLOCK_FBMOD + ii] = 0;
+        }
+        block->prout[ii] = block->val[ii];
+    }
+}
+
+static void OPL3_BlockEnvelopeCalc(const opl3_chip *chip, opl3_block *block)
+{
+    uint8_t ii;
+    uint8_t nonzero;
+    uint8_t rate;
+    uint8_t rate_hi;
+    uint8_t rate_lo;
+    uint8_t reg_rate;
+    uint8_t eg_shift, shift;
+    uint16_t eg_rout;
+    int16_t eg_inc;
+    uint8_t eg_off;
+    uint8_t reset;
+    uint8_t eg_gen;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        eg_gen = block->eg_gen[ii];
+        block->eg_out[ii] = block->eg_rout[ii] + block->eg_base[ii]
+                          + (block->eg_trem[ii] ? chip->tremolo : 0);
+        /* A released slot which is off stays that way */
+        if (!block->key[ii] && eg_gen == envelope_gen_num_release && block->eg_rout[ii] == 0x1ff)
+        {
+            block->pg_reset[ii] = 0;
+            continue;
+        }
+        reset = 0;
+        reg_rate = 0;
+        if (block->key[ii] && eg_gen == envelope_gen_num_release)
+        {
+            reset = 1;
+            reg_rate = block->reg_ar[ii];
+        }
+        else
+        {
+            switch (eg_gen)
+            {
+            case envelope_gen_num_attack:
+                reg_rate = block->reg_ar[ii];
+                break;
+            case envelope_gen_num_decay:
+                reg_rate = block->reg_dr[ii];
+                break;
+            case envelope_gen_num_sustain:
+                if (!block->reg_type[ii])
+                {
+                    reg_rate = block->reg_rr[ii];
+                }
+                break;
+            case envelope_gen_num_release:
+                reg_rate = block->reg_rr[ii];
+                break;
+            default:
+                break;
+            }
+        }
+        block->pg_reset[ii] = reset;
+        nonzero = (reg_rate != 0);
+        rate = block->ks[ii] + (reg_rate << 2);
+        rate_hi = rate >> 2;
+        rate_lo = rate & 0x03;
+        if (rate_hi & 0x10)
+        {
+            rate_hi = 0x0f;
+        }
+        eg_shift = rate_hi + chip->eg_add;
+        shift = 0;
+        if (nonzero)
+        {
+            if (rate_hi < 12)
+            {
+                if (chip->eg_state)
+                {
+                    switch (eg_shift)
+                    {
+                    case 12:
+                        shift = 1;
+                        break;
+                    case 13:
+                        shift = (rate_lo >> 1) & 0x01;
+                        break;
+                    case 14:
+                        shift = rate_lo & 0x01;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                shift = (rate_hi & 0x03) + eg_incstep[rate_lo][chip->timer & 0x03u];
+                if (shift & 0x04)
+                {
+                    shift = 0x03;
+                }
+                if (!shift)
+                {
+                    shift = chip->eg_state;
+                }
+            }
+        }
+        eg_rout = block->eg_rout[ii];
+        eg_inc = 0;
+        eg_off = 0;
+        /* Instant attack */
+        if (reset && rate_hi == 0x0f)
+        {
+            eg_rout = 0x00;
+        }
+        /* Envelope off */
+        if ((block->eg_rout[ii] & 0x1f8) == 0x1f8)
+        {
+            eg_off = 1;
+        }
+        if (eg_gen != envelope_gen_num_attack && !reset && eg_off)
+        {
+            eg_rout = 0x1ff;
+        }
+        switch (eg_gen)
+        {
+        case envelope_gen_num_attack:
+            if (!block->eg_rout[ii])
+            {
+                eg_gen = envelope_gen_num_decay;
+            }
+            else if (block->key[ii] && shift > 0 && rate_hi != 0x0f)
+            {
+                eg_inc = ~block->eg_rout[ii] >> (4 - shift);
+            }
+            break;
+        case envelope_gen_num_decay:
+            if ((block->eg_rout[ii] >> 4) == block->reg_sl[ii])
+            {
+                eg_gen = envelope_gen_num_sustain;
+            }
+            else if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        case envelope_gen_num_sustain:
+        case envelope_gen_num_release:
+            if (!eg_off && !reset && shift > 0)
+            {
+                eg_inc = 1 << (shift - 1);
+            }
+            break;
+        default:
+            break;
+        }
+        block->eg_rout[ii] = (eg_rout + eg_inc) & 0x1ff;
+        /* Key off */
+        if (reset)
+        {
+            eg_gen = envelope_gen_num_attack;
+        }
+        if (!block->key[ii])
+        {
+            eg_gen = envelope_gen_num_release;
+        }
+        block->eg_gen[ii] = eg_gen;
+    }
+}
+
+static void OPL3_BlockPhaseGenerate(opl3_chip *chip, opl3_block *block)
+{
+    uint8_t ii;
+    uint16_t f_num;
+    uint32_t basefreq;
+    uint32_t noise;
+    uint32_t noise_hh = 0, noise_sd = 0;
+    uint8_t rm_xor, n_bit;
+    uint16_t phase;
+
+    for (ii = 0; ii < 36; ii++)
+    {
+        phase = (uint16_t)(block->pg_phase[ii] >> 9);
+        if (block->pg_reset[ii])
+        {
+            block->pg_phase[ii] = 0;
+        }
+        block->pg_phase[ii] += block->pg_inc[ii];
+        block->pg_phase_out[ii] = phase;
+    }
+
+    /* Vibrato changes the increment of the slots which use it */
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (block->reg_vib[ii])
+        {
+            int8_t range;
+            uint8_t vibpos;
+
+            f_num = block->f_num[ii];
+            range = (f_num >> 7) & 7;
+            vibpos = chip->vibpos;
+
+            if (!(vibpos & 3))
+            {
+                range = 0;
+            }
+            else if (vibpos & 1)
+            {
+                range >>= 1;
+            }
+            range >>= chip->vibshift;
+
+            if (vibpos & 4)
+            {
+                range = -range;
+            }
+            f_num += range;
+            basefreq = (f_num << block->block[ii]) >> 1;
+            block->pg_phase[ii] += ((basefreq * mt[block->reg_mult[ii]]) >> 1) - block->pg_inc[ii];
+        }
+    }
+
+    /* The noise generator steps once for each slot */
+    noise = chip->noise;
+    for (ii = 0; ii < 36; ii++)
+    {
+        if (ii == 13)
+        {
+            noise_hh = noise;
+        }
+        else if (ii == 16)
+        {
+            noise_sd = noise;
+        }
+        n_bit = ((noise >> 14) ^ noise) & 0x01;
+        noise = (noise >> 1) | (n_bit << 22);
+    }
+    chip->noise = noise;
+
+    /* Rhythm mode */
+    phase = block->pg_phase_out[13];
+    chip->rm_hh_bit2 = (phase >> 2) & 1;
+    chip->rm_hh_bit3 = (phase >> 3) & 1;
+    chip->rm_hh_bit7 = (phase >> 7) & 1;
+    chip->rm_hh_bit8 = (phase >> 8) & 1;
+    if (chip->rhy & 0x20)
+    {
+        rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+               | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+               | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+        block->pg_phase_out[13] = rm_xor << 9;
+        if (rm_xor ^ (noise_hh & 1))
+        {
+            block->pg_phase_out[13] |= 0xd0;
+        }
+        else
+        {
+            block->pg_phase_out[13] |= 0x34;
+        }
+
+        block->pg_phase_out[16] = (chip->rm_hh_bit8 << 9)
+                                | ((chip->rm_hh_bit8 ^ (noise_sd & 1)) << 8);
+
+        phase = block->pg_phase_out[17];
+        chip->rm_tc_bit3 = (phase >> 3) & 1;
+        chip->rm_tc_bit5 = (phase >> 5) & 1;
+        rm_xor = (chip->rm_hh_bit2 ^ chip->rm_hh_bit7)
+               | (chip->rm_hh_bit3 ^ chip->rm_tc_bit5)
+               | (chip->rm_tc_bit3 ^ chip->rm_tc_bit5);
+        block->pg_phase_out[17] = (rm_xor << 9) | 0x80;
+    }
+}
+
+static void OPL3_BlockSlotGenerate(opl3_block *block, uint8_t first, uint8_t last)
+{
+    uint8_t ii;
+    uint16_t phase;
+
+    for (ii = first; ii < last; ii++)
+    {
+        phase = block->pg_phase_out[ii] + block->val[block->mod[ii]];
+        /*
+            From this attenuation on, the exp table lookup is shifted out
+            completely, and only the sign of the waveform is left
+        */
+        if (block->eg_out[ii] >= 0x180)
+        {
+            switch (block->reg_wf[ii])
+            {
+            case 0:
+            case 6:
+            case 7:
+                block->val[ii] = (phase & 0x200) ? -1 : 0;
+                break;
+            case 4:
+                block->val[ii] = ((phase & 0x300) == 0x100) ? -1 : 0;
+                break;
+            default:
+                block->val[ii] = 0;
+                break;
+            }
+        }
+        else
+        {
+            block->val[ii] = envelope_sin[block->reg_wf[ii]](phase, block->eg_out[ii]);
+        }
+    }
+}
+
+static void OPL3_BlockMix(const opl3_block *block, const uint16_t *mask0, const uint16_t *mask1, int32_t *mix)
+{
+    uint8_t ii;
+    int16_t accm;
+
+    mix[0] = mix[1] = 0;
+    for (ii = 0; ii < 18; ii++)
+    {
+        accm = block->val[block->out[ii][0]] + block->val[block->out[ii][1]]
+             + block->val[block->out[ii][2]] + block->val[block->out[ii][3]];
+        mix[0] += (int16_t)(accm & mask0[ii]);
+        mix[1] += (int16_t)(accm & mask1[ii]);
+    }
+}
+
+static void OPL3_BlockGenerate4Ch(opl3_chip *chip, opl3_block *block, int16_t *buf4)
+{
+    int32_t mix[2];
+
+    buf4[1] = OPL3_ClipSample(chip->mixbuff[1]);
+    buf4[3] = OPL3_ClipSample(chip->mixbuff[3]);
+
+    /*
+        These stages of a slot only depend on its own state, so running
+        them for all slots before generating any output does not change
+        the result
+    */
+    OPL3_BlockCalcFB(block);
+    OPL3_BlockEnvelopeCalc(chip, block);
+    OPL3_BlockPhaseGenerate(chip, block);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    OPL3_BlockSlotGenerate(block, 0, 15);
+#else
+    OPL3_BlockSlotGenerate(block, 0, 36);
+#endif
+
+    OPL3_BlockMix(block, block->cha, block->chc, mix);
+    chip->mixbuff[0] = mix[0];
+    chip->mixbuff[2] = mix[1];
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    OPL3_BlockSlotGenerate(block, 15, 18);
+#endif
+
+    buf4[0] = OPL3_ClipSample(chip->mixbuff[0]);
+    buf4[2] = OPL3_ClipSample(chip->mixbuff[2]);
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    OPL3_BlockSlotGenerate(block, 18, 33);
+#endif
+
+    OPL3_BlockMix(block, block->chb, block->chd, mix);
+    chip->mixbuff[1] = mix[0];
+    chip->mixbuff[3] = mix[1];
+
+#if OPL_QUIRK_CHANNELSAMPLEDELAY
+    OPL3_BlockSlotGenerate(block, 33, 36);
+#endif
+
+    OPL3_UpdateTimers(chip);
+}
+
+#endif /* !OPL_ENABLE_STEREOEXT */
+
+void OPL3_Generate4ChBlock(opl3_chip *chip, int16_t *buf4, uint32_t numsamples)
+{
+#if OPL_ENABLE_STEREOEXT
+    uint_fast32_t i;
+
+    for (i = 0; i < numsamples; i++)
+    {
+        OPL3_Generate4Ch(chip, buf4);
+        buf4 += 4;
+    }
+#else
+    opl3_block block;
+    uint_fast32_t i;
+
+    OPL3_BlockLoad(chip, &block);
+    OPL3_BlockSetup(chip, &block);
+    for (i = 0; i < numsamples; i++)
+    {
+        OPL3_BlockGenerate4Ch(chip, &block, buf4);
+        if (OPL3_ProcessWriteBuf(chip))
+        {
+            OPL3_BlockSetup(chip, &block);
+        }
+        buf4 += 4;
+    }
+    OPL3_BlockStore(chip, &block);
+#endif
+}
+
+void OPL3_GenerateStreamBlock(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples)
+{
+    int16_t native[OPL_BLOCK_NATIVE * 4];
+    const int16_t *next;
+    uint32_t maxnative, count, i, j;
+    int32_t samplecnt;
+
+    /* Native samples needed for one output sample at most */
+    maxnative = chip->rateratio ? ((1 << RSM_FRAC) / chip->rateratio) + 1 : OPL_BLOCK_NATIVE;
+    if (maxnative > OPL_BLOCK_NATIVE / 2)
+    {
+        OPL3_GenerateStream(chip, sndptr, numsamples);
+        return;
+    }
+
+    while (numsamples > 0)
+    {
+        /* Find how many output samples the native buffer can provide */
+        samplecnt = chip->samplecnt;
+        count = 0;
+        for (i = 0; i < numsamples && count + maxnative <= OPL_BLOCK_NATIVE; i++)
+        {
+            while (samplecnt >= chip->rateratio)
+            {
+                samplecnt -= chip->rateratio;
+                count++;
+            }
+            samplecnt += 1 << RSM_FRAC;
+        }
+
+        OPL3_Generate4ChBlock(chip, native, count);
+
+        /* Same as OPL3_GenerateResampled */
+        next = native;
+        for (j = 0; j < i; j++)
+        {
+            while (chip->samplecnt >= chip->rateratio)
+            {
+                memcpy(chip->oldsamples, chip->samples, sizeof(chip->samples));
+                memcpy(chip->samples, next, sizeof(chip->samples));
+                next += 4;
+                chip->samplecnt -= chip->rateratio;
+            }
+            sndptr[0] = (int16_t)((chip->oldsamples[0] * (chip->rateratio - chip->samplecnt)
+                                  + chip->samples[0] * chip->samplecnt) / chip->rateratio);
+            sndptr[1] = (int16_t)((chip->oldsamples[1] * (chip->rateratio - chip->samplecnt)
+                                  + chip->samples[1] * chip->samplecnt) / chip->rateratio);
+            chip->samplecnt += 1 << RSM_FRAC;
+            sndptr += 2;
+        }
+        numsamples -= i;
+    }
+}
+
 OPL::OPL(Config::OplType type) : _type(type), _rate(0) {
 }
 
@@ -1643,7 +2284,7 @@ void OPL::dualWrite(uint8 index, uint8 reg, uint8 val) {
 }
 
 void OPL::generateSamples(int16*buffer, int length) {
-	OPL3_GenerateStream(&chip, (int16_t*)buffer, (uint16_t)length / 2);
+	OPL3_GenerateStreamBlock(&chip, (int16_t*)buffer, (uint16_t)length / 2);
 }
 
 }
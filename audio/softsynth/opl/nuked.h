@@ -163,6 +163,10 @@ void OPL3_Generate4Ch(opl3_chip *chpi, int16_t *buf4);
 void OPL3_Generate4ChResampled(opl3_chip *chip, int16_t *buf4);
 void OPL3_Generate4ChStream(opl3_chip *chip, int16_t *sndptr1, int16_t *sndptr2, uint32_t numsamples);
 
+/* Same output as the functions above, rendered in blocks between register writes */
+void OPL3_Generate4ChBlock(opl3_chip *chip, int16_t *buf4, uint32_t numsamples);
+void OPL3_GenerateStreamBlock(opl3_chip *chip, int16_t *sndptr, uint32_t numsamples);
+
 class OPL : public ::OPL::OPL, public Audio::EmulatedChip {
 private:
 	Config::OplType _type;
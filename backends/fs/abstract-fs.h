@@ -172,6 +172,15 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the last modification time of the file referred
+	 * by this node, without opening it. The modification time is only meant
+	 * to be compared with earlier results for the same file.
+	 *
+	 * @return true if both could be determined, false otherwise.
+	 */
+	virtual bool getFileStats(int64 &size, int64 &modificationTime) const;
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
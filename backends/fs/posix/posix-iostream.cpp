@@ -24,6 +24,18 @@
 #include "backends/fs/posix/posix-iostream.h"
 
 #include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#include <sys/mman.h>
+#define USE_POSIX_MMAP
+#endif
+
+#ifdef USE_POSIX_MMAP
+// Leave enough of the address space to the rest of the process on 32-bit
+// systems. MemoryReadStream is limited to 32-bit sizes anyway.
+static const off_t kMaxMappedSize = sizeof(void *) >= 8 ? (off_t)0xFFFFFFFF : (off_t)256 * 1024 * 1024;
+#endif
 
 PosixIoStream *PosixIoStream::makeFromPath(const Common::String &path, bool writeMode) {
 #if defined(HAS_FOPEN64)
@@ -32,15 +44,46 @@ PosixIoStream *PosixIoStream::makeFromPath(const Common::String &path, bool writ
 	FILE *handle = fopen(path.c_str(), writeMode ? "wb" : "rb");
 #endif
 
-	if (handle)
-		return new PosixIoStream(handle);
+	if (!handle)
+		return nullptr;
 
-	return nullptr;
+	PosixIoStream *stream = new PosixIoStream(handle);
+	stream->_mappable = !writeMode;
+	return stream;
 }
 
 
 PosixIoStream::PosixIoStream(void *handle) :
-		StdioStream(handle) {
+		StdioStream(handle), _mappable(false), _mappedData(nullptr), _mappedSize(0) {
+}
+
+PosixIoStream::~PosixIoStream() {
+#ifdef USE_POSIX_MMAP
+	if (_mappedData)
+		munmap(_mappedData, _mappedSize);
+#endif
+}
+
+const byte *PosixIoStream::getMappedData() const {
+#ifdef USE_POSIX_MMAP
+	// Only files opened for reading are mapped, and only once asked to. The
+	// stream itself keeps reading through stdio.
+	if (_mappable) {
+		_mappable = false;
+
+		int fd = fileno((FILE *)_handle);
+		struct stat st;
+		if (fd != -1 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= kMaxMappedSize) {
+			void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED) {
+				_mappedData = data;
+				_mappedSize = st.st_size;
+			}
+		}
+	}
+#endif
+
+	return (const byte *)_mappedData;
 }
 
 int64 PosixIoStream::size() const {
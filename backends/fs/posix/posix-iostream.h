@@ -31,8 +31,20 @@ class PosixIoStream final : public StdioStream {
 public:
 	static PosixIoStream *makeFromPath(const Common::String &path, bool writeMode);
 	PosixIoStream(void *handle);
+	~PosixIoStream() override;
 
 	int64 size() const override;
+
+	/**
+	 * Map the file into memory on the first call, if it was opened for
+	 * reading by makeFromPath() and it is a regular file.
+	 */
+	const byte *getMappedData() const override;
+
+private:
+	mutable bool _mappable;
+	mutable void *_mappedData;
+	mutable size_t _mappedSize;
 };
 
 #endif
@@ -30,6 +30,7 @@
 #include "graphics/opengl/debug.h"
 
 #include "common/array.h"
+#include "common/debug.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/algorithm.h"
@@ -678,6 +679,11 @@ void OpenGLGraphicsManager::updateScreen() {
 	}
 	_overlay->updateGLTexture();
 
+	const uint32 uploadedBytes = GLTexture::takeUploadedBytes();
+	if (uploadedBytes) {
+		debug(9, "OpenGL: Uploaded %u bytes of texture data", uploadedBytes);
+	}
+
 #if !USE_FORCED_GLES
 	if (_libretroPipeline) {
 		_libretroPipeline->beginScaling();
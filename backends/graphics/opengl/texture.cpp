@@ -39,16 +39,23 @@
 
 namespace OpenGL {
 
+uint32 GLTexture::_uploadedBytes = 0;
+
 GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
 	: _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
 	  _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
 	  _texCoords(), _glFilter(GL_NEAREST),
-	  _glTexture(0) {
+	  _glTexture(0), _glPixelBuffer(0) {
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (_glPixelBuffer) {
+		GL_CALL_SAFE(glDeleteBuffers, (1, &_glPixelBuffer));
+	}
+#endif
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -113,6 +120,12 @@ void GLTexture::setWrapMode(WrapMode wrapMode) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (_glPixelBuffer) {
+		GL_CALL(glDeleteBuffers(1, &_glPixelBuffer));
+		_glPixelBuffer = 0;
+	}
+#endif
 }
 
 void GLTexture::create() {
@@ -196,16 +209,72 @@ bool GLTexture::setSize(uint width, uint height) {
 }
 
 void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &src) {
+	if (area.isEmpty()) {
+		return;
+	}
+
 	// Set the texture on the active texture unit.
 	bind();
 
+	const uint bytesPerPixel = src.format.bytesPerPixel;
+
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	// Copy the area into a pixel buffer object. The driver transfers it to
+	// the texture while the CPU goes on with rendering. Re-specifying the
+	// buffer storage every time lets the driver hand out fresh memory instead
+	// of waiting for the previous transfer to finish.
+	if (OpenGLContext.pixelBufferObjectSupported) {
+		const uint rowSize = area.width() * bytesPerPixel;
+		const uint size = rowSize * area.height();
+
+		if (!_glPixelBuffer) {
+			GL_CALL(glGenBuffers(1, &_glPixelBuffer));
+		}
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _glPixelBuffer));
+		GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+
+		byte *dst;
+		GL_ASSIGN(dst, (byte *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		if (dst) {
+			const byte *srcRow = (const byte *)src.getBasePtr(area.left, area.top);
+			for (int y = area.top; y < area.bottom; ++y) {
+				memcpy(dst, srcRow, rowSize);
+				dst += rowSize;
+				srcRow += src.pitch;
+			}
+			GL_CALL(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+			GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+			                        _glFormat, _glType, nullptr));
+			GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+			_uploadedBytes += size;
+			return;
+		}
+
+		// Mapping failed, upload from client memory instead.
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	}
+#endif
+
+#if !USE_FORCED_GLES
+	// Update only the area itself when we can specify the pitch of the
+	// source data.
+	if (OpenGLContext.unpackSubImageSupported) {
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, src.pitch / bytesPerPixel));
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                        _glFormat, _glType, src.getBasePtr(area.left, area.top)));
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+		_uploadedBytes += area.width() * area.height() * bytesPerPixel;
+		return;
+	}
+#endif
+
 	// Update the actual texture.
-	// Although we have the area of the texture buffer we want to update we
-	// cannot take advantage of the left/right boundaries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
-	// with the following options:
+	// Without GL_UNPACK_ROW_LENGTH (OpenGL ES 1.0 and OpenGL ES 2.0 without
+	// GL_EXT_unpack_subimage) it is not possible to specify a pitch to
+	// glTexSubImage2D. Thus, we are left with the following options:
 	//
 	// 1) (As we do right now) Simply always update the whole texture lines of
 	//    rect changed. This is simplest to implement. In case performance is
@@ -219,6 +288,14 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	//    graphics manager did but it is much slower! Thus, we do not use it.
 	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
 	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+
+	_uploadedBytes += src.w * area.height() * bytesPerPixel;
+}
+
+uint32 GLTexture::takeUploadedBytes() {
+	const uint32 bytes = _uploadedBytes;
+	_uploadedBytes = 0;
+	return bytes;
 }
 
 //
@@ -226,7 +303,7 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 //
 
 Surface::Surface()
-	: _allDirty(false), _dirtyArea() {
+	: _allDirty(false), _dirtyRects() {
 }
 
 void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
@@ -266,24 +343,90 @@ void Surface::fill(const Common::Rect &r, uint32 color) {
 	addDirtyArea(r);
 }
 
+namespace {
+
+// The maximum number of separately uploaded rects per surface. Once it is
+// reached, new areas are merged into the rect which grows the least.
+const uint kMaxDirtyRects = 16;
+
+// Two rects are merged when the merged rect covers at most this many pixels
+// more than the two rects themselves, or a quarter of their area if that is
+// more. This keeps neighbouring updates in one upload.
+const uint kDirtyRectMergeSlack = 32 * 32;
+
+uint rectArea(const Common::Rect &r) {
+	return r.width() * r.height();
+}
+
+// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
+// parameters is an empty rect, but dirty rects are never empty.
+Common::Rect unionRect(const Common::Rect &a, const Common::Rect &b) {
+	Common::Rect r(a);
+	r.extend(b);
+	return r;
+}
+
+bool shouldMergeRects(const Common::Rect &a, const Common::Rect &b) {
+	const uint area = rectArea(a) + rectArea(b);
+	const uint merged = rectArea(unionRect(a, b));
+	return merged <= area + MAX(kDirtyRectMergeSlack, area / 4);
+}
+
+} // End of anonymous namespace
+
 void Surface::addDirtyArea(const Common::Rect &r) {
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = r;
-	} else {
-		_dirtyArea.extend(r);
+	if (r.isEmpty() || _allDirty) {
+		return;
 	}
+
+	for (uint i = 0; i < _dirtyRects.size(); ++i) {
+		if (shouldMergeRects(_dirtyRects[i], r)) {
+			_dirtyRects[i].extend(r);
+			mergeDirtyRect(i);
+			return;
+		}
+	}
+
+	if (_dirtyRects.size() < kMaxDirtyRects) {
+		_dirtyRects.push_back(r);
+		return;
+	}
+
+	uint best = 0;
+	uint bestGrowth = 0xFFFFFFFF;
+	for (uint i = 0; i < _dirtyRects.size(); ++i) {
+		const uint growth = rectArea(unionRect(_dirtyRects[i], r)) - rectArea(_dirtyRects[i]);
+		if (growth < bestGrowth) {
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+	_dirtyRects[best].extend(r);
+	mergeDirtyRect(best);
 }
 
-Common::Rect Surface::getDirtyArea() const {
+void Surface::mergeDirtyRect(uint index) {
+	// A grown rect may now be worth merging with others as well.
+	for (uint i = 0; i < _dirtyRects.size();) {
+		if (i != index && shouldMergeRects(_dirtyRects[index], _dirtyRects[i])) {
+			_dirtyRects[index].extend(_dirtyRects[i]);
+			_dirtyRects.remove_at(i);
+			if (i < index) {
+				--index;
+			}
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+}
+
+const Common::Array<Common::Rect> &Surface::getDirtyRects() {
 	if (_allDirty) {
-		return Common::Rect(getWidth(), getHeight());
-	} else {
-		return _dirtyArea;
+		_dirtyRects.clear();
+		_dirtyRects.push_back(Common::Rect(getWidth(), getHeight()));
 	}
+	return _dirtyRects;
 }
 
 //
@@ -343,9 +486,14 @@ void Texture::updateGLTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+	for (uint i = 0; i < dirtyRects.size(); ++i) {
+		Common::Rect dirtyArea = dirtyRects[i];
+		updateGLTexture(dirtyArea);
+	}
 
-	updateGLTexture(dirtyArea);
+	// We should have handled everything, thus not dirty anymore.
+	clearDirty();
 }
 
 void Texture::updateGLTexture(Common::Rect &dirtyArea) {
@@ -379,9 +527,6 @@ void Texture::updateGLTexture(Common::Rect &dirtyArea) {
 	}
 
 	_glTexture.updateArea(dirtyArea, _textureData);
-
-	// We should have handled everything, thus not dirty anymore.
-	clearDirty();
 }
 
 FakeTexture::FakeTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format, const Graphics::PixelFormat &fakeFormat)
@@ -460,15 +605,18 @@ void FakeTexture::updateGLTexture() {
 		return;
 	}
 
-	// Convert color space.
+	// Convert color space, only in the damaged areas.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+	for (uint i = 0; i < dirtyRects.size(); ++i) {
+		const Common::Rect &dirtyArea = dirtyRects[i];
 
-	byte *dst = (byte *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		byte *dst = (byte *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
 
-	applyPaletteAndMask(dst, src, outSurf->pitch, _rgbData.pitch, _rgbData.w, dirtyArea, outSurf->format, _rgbData.format);
+		applyPaletteAndMask(dst, src, outSurf->pitch, _rgbData.pitch, _rgbData.w, dirtyArea, outSurf->format, _rgbData.format);
+	}
 
 	// Do generic handling of updating the texture.
 	Texture::updateGLTexture();
@@ -520,25 +668,28 @@ void TextureRGB555::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+	for (uint i = 0; i < dirtyRects.size(); ++i) {
+		const Common::Rect &dirtyArea = dirtyRects[i];
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+		uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
 
-	const uint16 *src = (const uint16 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgbData.pitch - 2 * dirtyArea.width();
+		const uint16 *src = (const uint16 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgbData.pitch - 2 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint16 color = *src++;
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint16 color = *src++;
 
-			*dst++ =   ((color & 0x7C00) << 1)                             // R
-			         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
-			         | (color & 0x001F);                                   // B
-		}
+				*dst++ =   ((color & 0x7C00) << 1)                             // R
+				         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
+				         | (color & 0x001F);                                   // B
+			}
 
-		src = (const uint16 *)((const byte *)src + srcAdd);
-		dst = (uint16 *)((byte *)dst + dstAdd);
+			src = (const uint16 *)((const byte *)src + srcAdd);
+			dst = (uint16 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -562,23 +713,26 @@ void TextureRGBA8888Swap::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+	for (uint i = 0; i < dirtyRects.size(); ++i) {
+		const Common::Rect &dirtyArea = dirtyRects[i];
 
-	uint32 *dst = (uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 4 * dirtyArea.width();
+		uint32 *dst = (uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 4 * dirtyArea.width();
 
-	const uint32 *src = (const uint32 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgbData.pitch - 4 * dirtyArea.width();
+		const uint32 *src = (const uint32 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgbData.pitch - 4 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint32 color = *src++;
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint32 color = *src++;
 
-			*dst++ = SWAP_BYTES_32(color);
-		}
+				*dst++ = SWAP_BYTES_32(color);
+			}
 
-		src = (const uint32 *)((const byte *)src + srcAdd);
-		dst = (uint32 *)((byte *)dst + dstAdd);
+			src = (const uint32 *)((const byte *)src + srcAdd);
+			dst = (uint32 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -629,46 +783,52 @@ void ScaledTexture::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
+	const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+	for (uint i = 0; i < dirtyRects.size(); ++i) {
+		Common::Rect dirtyArea = dirtyRects[i];
 
-	// Extend the dirty region for scalers
-	// that "smear" the screen, e.g. 2xSAI
-	dirtyArea.grow(_extraPixels);
-	dirtyArea.clip(Common::Rect(0, 0, _rgbData.w, _rgbData.h));
+		// Extend the dirty region for scalers
+		// that "smear" the screen, e.g. 2xSAI
+		dirtyArea.grow(_extraPixels);
+		dirtyArea.clip(Common::Rect(0, 0, _rgbData.w, _rgbData.h));
 
-	const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	uint srcPitch = _rgbData.pitch;
-	byte *dst;
-	uint dstPitch;
+		const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		uint srcPitch = _rgbData.pitch;
+		byte *dst;
+		uint dstPitch;
 
-	if (_convData) {
-		dst = (byte *)_convData->getBasePtr(dirtyArea.left + _extraPixels, dirtyArea.top + _extraPixels);
-		dstPitch = _convData->pitch;
+		if (_convData) {
+			dst = (byte *)_convData->getBasePtr(dirtyArea.left + _extraPixels, dirtyArea.top + _extraPixels);
+			dstPitch = _convData->pitch;
 
-		applyPaletteAndMask(dst, src, dstPitch, srcPitch, _rgbData.w, dirtyArea, _convData->format, _rgbData.format);
+			applyPaletteAndMask(dst, src, dstPitch, srcPitch, _rgbData.w, dirtyArea, _convData->format, _rgbData.format);
 
-		src = dst;
-		srcPitch = dstPitch;
-	}
+			src = dst;
+			srcPitch = dstPitch;
+		}
 
-	dst = (byte *)outSurf->getBasePtr(dirtyArea.left * _scaleFactor, dirtyArea.top * _scaleFactor);
-	dstPitch = outSurf->pitch;
+		dst = (byte *)outSurf->getBasePtr(dirtyArea.left * _scaleFactor, dirtyArea.top * _scaleFactor);
+		dstPitch = outSurf->pitch;
 
-	if (_scaler && (uint)dirtyArea.height() >= _extraPixels) {
-		_scaler->scale(src, srcPitch, dst, dstPitch, dirtyArea.width(), dirtyArea.height(), dirtyArea.left, dirtyArea.top);
-	} else {
-		Graphics::scaleBlit(dst, src, dstPitch, srcPitch,
-		                    dirtyArea.width() * _scaleFactor, dirtyArea.height() * _scaleFactor,
-		                    dirtyArea.width(), dirtyArea.height(), outSurf->format);
-	}
+		if (_scaler && (uint)dirtyArea.height() >= _extraPixels) {
+			_scaler->scale(src, srcPitch, dst, dstPitch, dirtyArea.width(), dirtyArea.height(), dirtyArea.left, dirtyArea.top);
+		} else {
+			Graphics::scaleBlit(dst, src, dstPitch, srcPitch,
+			                    dirtyArea.width() * _scaleFactor, dirtyArea.height() * _scaleFactor,
+			                    dirtyArea.width(), dirtyArea.height(), outSurf->format);
+		}
 
-	dirtyArea.left   *= _scaleFactor;
-	dirtyArea.right  *= _scaleFactor;
-	dirtyArea.top    *= _scaleFactor;
-	dirtyArea.bottom *= _scaleFactor;
+		dirtyArea.left   *= _scaleFactor;
+		dirtyArea.right  *= _scaleFactor;
+		dirtyArea.top    *= _scaleFactor;
+		dirtyArea.bottom *= _scaleFactor;
 
-	// Do generic handling of updating the texture.
-	Texture::updateGLTexture(dirtyArea);
+		// Do generic handling of updating the texture.
+		Texture::updateGLTexture(dirtyArea);
+	}
+
+	// We should have handled everything, thus not dirty anymore.
+	clearDirty();
 }
 
 void ScaledTexture::setScaler(uint scalerIndex, int scaleFactor) {
@@ -683,6 +843,7 @@ void ScaledTexture::setScaler(uint scalerIndex, int scaleFactor) {
 
 	if (!_scaler) {
 		_scaler = scalerPlugin.createInstance(_format);
+		_scaler->setThreadCount(0);
 	}
 	_scaler->setFactor(scaleFactor);
 
@@ -828,7 +989,10 @@ void TextureCLUT8GPU::updateGLTexture() {
 
 	// Update CLUT8 texture if necessary.
 	if (Surface::isDirty()) {
-		_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		const Common::Array<Common::Rect> &dirtyRects = getDirtyRects();
+		for (uint i = 0; i < dirtyRects.size(); ++i) {
+			_clut8Texture.updateArea(dirtyRects[i], _clut8Data);
+		}
 		clearDirty();
 	}
 
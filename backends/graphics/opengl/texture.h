@@ -28,6 +28,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 class Scaler;
@@ -107,6 +108,9 @@ public:
 	/**
 	 * Copy image data to the texture.
 	 *
+	 * When pixel buffer objects are available the data is copied into one
+	 * and the call returns without waiting for the transfer to finish.
+	 *
 	 * @param area     The area to update.
 	 * @param src      Surface for the whole texture containing the pixel data
 	 *                 to upload. Only the area described by area will be
@@ -114,6 +118,12 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Query the number of bytes uploaded to all textures since the last
+	 * call, and reset the counter.
+	 */
+	static uint32 takeUploadedBytes();
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -158,6 +168,9 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+	GLuint _glPixelBuffer;
+
+	static uint32 _uploadedBytes;
 };
 
 /**
@@ -224,7 +237,7 @@ public:
 	void fill(const Common::Rect &r, uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || !_dirtyRects.empty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -264,13 +277,23 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _allDirty = false; _dirtyRects.clear(); }
 
+	/**
+	 * Add an area to the damaged region. Areas close to each other are
+	 * merged, as each separately uploaded rect has a fixed cost.
+	 */
 	void addDirtyArea(const Common::Rect &r);
-	Common::Rect getDirtyArea() const;
+
+	/**
+	 * @return The rects of the damaged region. They may overlap.
+	 */
+	const Common::Array<Common::Rect> &getDirtyRects();
 private:
+	void mergeDirtyRect(uint index);
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	Common::Array<Common::Rect> _dirtyRects;
 };
 
 /**
@@ -314,6 +337,9 @@ public:
 protected:
 	const Graphics::PixelFormat _format;
 
+	/**
+	 * Upload one area of the texture data, without clearing the dirty state.
+	 */
 	void updateGLTexture(Common::Rect &dirtyArea);
 
 private:
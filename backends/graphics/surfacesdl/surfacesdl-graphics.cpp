@@ -683,6 +683,7 @@ void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 
 		_scalerPlugin = &_scalerPlugins[_videoMode.scalerIndex]->get<ScalerPluginObject>();
 		_scaler = _scalerPlugin->createInstance(format);
+		_scaler->setThreadCount(0);
 
 		if (_mouseScaler != nullptr) {
 			delete _mouseScaler;
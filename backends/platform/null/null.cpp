@@ -49,14 +49,20 @@ typedef void (*sighandler_t)(int);
 #if defined(USE_NULL_DRIVER)
 #include "backends/modular-backend.h"
 #include "backends/mutex/null/null-mutex.h"
+#include "backends/graphics/null/null-graphics.h"
 #include "base/main.h"
 
+#if defined(POSIX) && defined(NULL_DRIVER_USE_FOR_TEST)
+#define NULL_DRIVER_USE_PTHREADS
+#include "common/thread.h"
+#include <pthread.h>
+#endif
+
 #ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
-#include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
 
@@ -75,6 +81,92 @@ typedef void (*sighandler_t)(int);
 	#include "backends/fs/windows/windows-fs-factory.h"
 #endif
 
+#ifdef NULL_DRIVER_USE_PTHREADS
+/*
+ * Tests check code which spreads its work across threads, so they get
+ * real threads and mutexes.
+ */
+class NullPthreadMutexInternal final : public Common::MutexInternal {
+public:
+	NullPthreadMutexInternal() {
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&_mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+	~NullPthreadMutexInternal() override { pthread_mutex_destroy(&_mutex); }
+
+	bool lock() override { return pthread_mutex_lock(&_mutex) == 0; }
+	bool unlock() override { return pthread_mutex_unlock(&_mutex) == 0; }
+
+private:
+	pthread_mutex_t _mutex;
+};
+
+class NullPthreadThreadInternal final : public Common::ThreadInternal {
+public:
+	NullPthreadThreadInternal(void (*proc)(void *param), void *param) : _proc(proc), _param(param), _running(false) {}
+	~NullPthreadThreadInternal() override { wait(); }
+
+	bool start() {
+		_running = pthread_create(&_thread, nullptr, threadProc, this) == 0;
+		return _running;
+	}
+
+	void wait() override {
+		if (_running) {
+			pthread_join(_thread, nullptr);
+			_running = false;
+		}
+	}
+
+private:
+	static void *threadProc(void *data) {
+		NullPthreadThreadInternal *thread = (NullPthreadThreadInternal *)data;
+		thread->_proc(thread->_param);
+		return nullptr;
+	}
+
+	void (*_proc)(void *param);
+	void *_param;
+	pthread_t _thread;
+	bool _running;
+};
+
+class NullPthreadSemaphoreInternal final : public Common::SemaphoreInternal {
+public:
+	NullPthreadSemaphoreInternal() : _count(0) {
+		pthread_mutex_init(&_mutex, nullptr);
+		pthread_cond_init(&_cond, nullptr);
+	}
+	~NullPthreadSemaphoreInternal() override {
+		pthread_cond_destroy(&_cond);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	void wait() override {
+		pthread_mutex_lock(&_mutex);
+		while (_count == 0)
+			pthread_cond_wait(&_cond, &_mutex);
+		_count--;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	void post() override {
+		pthread_mutex_lock(&_mutex);
+		_count++;
+		pthread_cond_signal(&_cond);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _count;
+};
+#endif
+
 class OSystem_NULL : public ModularMixerBackend, public ModularGraphicsBackend, Common::EventSource {
 public:
 	OSystem_NULL(bool silenceLogs);
@@ -85,6 +177,10 @@ public:
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual Common::MutexInternal *createMutex();
+#ifdef NULL_DRIVER_USE_PTHREADS
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *param), void *param);
+	virtual Common::SemaphoreInternal *createSemaphore();
+#endif
 	virtual uint32 getMillis(bool skipRecord = false);
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &td, bool skipRecord = false) const;
@@ -119,6 +215,12 @@ OSystem_NULL::OSystem_NULL(bool silenceLogs) :
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// Tests do not call initBackend(), but code like the video decoders
+	// still asks for the screen format.
+	_graphicsManager = new NullGraphicsManager();
+#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
@@ -187,9 +289,28 @@ bool OSystem_NULL::pollEvent(Common::Event &event) {
 }
 
 Common::MutexInternal *OSystem_NULL::createMutex() {
+#ifdef NULL_DRIVER_USE_PTHREADS
+	return new NullPthreadMutexInternal();
+#else
 	return new NullMutexInternal();
+#endif
 }
 
+#ifdef NULL_DRIVER_USE_PTHREADS
+Common::ThreadInternal *OSystem_NULL::createThread(void (*proc)(void *param), void *param) {
+	NullPthreadThreadInternal *thread = new NullPthreadThreadInternal(proc, param);
+	if (!thread->start()) {
+		delete thread;
+		return nullptr;
+	}
+	return thread;
+}
+
+Common::SemaphoreInternal *OSystem_NULL::createSemaphore() {
+	return new NullPthreadSemaphoreInternal();
+}
+#endif
+
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #ifdef POSIX
 	timeval curTime;
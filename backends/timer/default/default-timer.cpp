@@ -23,6 +23,7 @@
 #include "backends/timer/default/default-timer.h"
 #include "common/util.h"
 #include "common/system.h"
+#include "common/thread.h"
 
 struct TimerSlot {
 	Common::TimerManager::TimerProc callback;
@@ -30,88 +31,265 @@ struct TimerSlot {
 	Common::String id;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+	uint64 deadline;	// in microseconds
+	uint heapIndex;
+
+	// Run the callback on the worker thread
+	bool heavy;
+	// A call is waiting in the worker queue
+	bool queued;
+	// The callback removed the timer while it was running
+	bool removed;
+
+	uint32 calls;
+	uint64 totalTime;
+	uint32 maxTime;
+	uint64 totalLateness;
+	uint32 maxLateness;
+	uint32 skipped;
+	uint32 coalesced;
+
+	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), deadline(0), heapIndex(0), heavy(false), queued(false), removed(false) {
+		resetStats();
+	}
 
-	TimerSlot *next;
+	void resetStats() {
+		calls = 0;
+		totalTime = 0;
+		maxTime = 0;
+		totalLateness = 0;
+		maxLateness = 0;
+		skipped = 0;
+		coalesced = 0;
+	}
 
-	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), nextFireTimeMicro(0), next(nullptr) {}
+	void addCall(uint64 due, uint64 start, uint64 end) {
+		calls++;
+		totalTime += end - start;
+		maxTime = MAX<uint32>(maxTime, MIN<uint64>(end - start, 0xFFFFFFFF));
+		if (start > due) {
+			totalLateness += start - due;
+			maxLateness = MAX<uint32>(maxLateness, MIN<uint64>(start - due, 0xFFFFFFFF));
+		}
+	}
 };
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
+DefaultTimerManager::DefaultTimerManager() :
+	_timerCallbackNext(0),
+	_running(nullptr),
+	_lastMillis(0),
+	_millisHigh(0),
+	_worker(nullptr),
+	_workerQueued(nullptr),
+	_stopWorker(false),
+	_workerAllowed(false) {
+}
+
+DefaultTimerManager::~DefaultTimerManager() {
+	stopWorker();
+
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _heap.size(); i++)
+		delete _heap[i];
+	_heap.clear();
+}
+
+uint64 DefaultTimerManager::getMicros() {
+	Common::StackLock lock(_clockMutex);
+
+	// getMillis() wraps around after 49 days
+	const uint32 millis = g_system->getMillis(true);
+	if (millis < _lastMillis)
+		_millisHigh += (uint64)1 << 32;
+	_lastMillis = millis;
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = nullptr;
+	return (_millisHigh + millis) * 1000;
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
+void DefaultTimerManager::siftUp(uint index) {
+	TimerSlot *slot = _heap[index];
+	while (index > 0) {
+		const uint parent = (index - 1) / 2;
+		if (_heap[parent]->deadline <= slot->deadline)
+			break;
+		_heap[index] = _heap[parent];
+		_heap[index]->heapIndex = index;
+		index = parent;
+	}
+	_heap[index] = slot;
+	slot->heapIndex = index;
+}
+
+void DefaultTimerManager::siftDown(uint index) {
+	TimerSlot *slot = _heap[index];
+	const uint size = _heap.size();
 	while (true) {
-		assert(slot);
-		if (slot->next == nullptr || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
+		uint child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && _heap[child + 1]->deadline < _heap[child]->deadline)
+			child++;
+		if (slot->deadline <= _heap[child]->deadline)
+			break;
+		_heap[index] = _heap[child];
+		_heap[index]->heapIndex = index;
+		index = child;
 	}
+	_heap[index] = slot;
+	slot->heapIndex = index;
 }
 
+void DefaultTimerManager::heapPush(TimerSlot *slot) {
+	_heap.push_back(slot);
+	siftUp(_heap.size() - 1);
+}
 
-DefaultTimerManager::DefaultTimerManager() :
-	_timerCallbackNext(0),
-	_head(nullptr) {
+void DefaultTimerManager::heapRemove(uint index) {
+	TimerSlot *last = _heap.back();
+	_heap.pop_back();
+	if (index == _heap.size())
+		return;
 
-	_head = new TimerSlot();
+	_heap[index] = last;
+	last->heapIndex = index;
+	if (index > 0 && last->deadline < _heap[(index - 1) / 2]->deadline)
+		siftUp(index);
+	else
+		siftDown(index);
 }
 
-DefaultTimerManager::~DefaultTimerManager() {
+uint32 DefaultTimerManager::handler() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	const uint64 curTime = getMicros();
+
+	// On slow systems this could still be run after destructor, in which
+	// case the heap is empty.
+	//
+	// Repeat as long as there is a timer that is scheduled to fire. Each one
+	// is rescheduled from its previous deadline rather than from the current
+	// time, so that late calls do not make the timer drift.
+	while (!_heap.empty() && _heap[0]->deadline <= curTime) {
+		TimerSlot *slot = _heap[0];
+		const uint64 deadline = slot->deadline;
+
+		assert(slot->interval > 0);
+		const uint64 behind = curTime - deadline;
+		if (behind > kMaxCatchUp) {
+			// Too far behind, e.g. after the process was suspended: drop the
+			// missed calls instead of running them all in a burst.
+			const uint64 missed = behind / slot->interval;
+			slot->skipped += MIN<uint64>(missed, 0xFFFFFFFF);
+			slot->deadline += (missed + 1) * slot->interval;
+		} else {
+			slot->deadline += slot->interval;
+		}
+		siftDown(0);
+
+		if (slot->heavy && _worker)
+			queueForWorker(slot, deadline);
+		else
+			runCallback(slot, deadline);
 	}
-	_head = nullptr;
+
+	if (_heap.empty())
+		return kMaxCatchUp;
+
+	const uint64 now = getMicros();
+	return _heap[0]->deadline > now ? MIN<uint64>(_heap[0]->deadline - now, kMaxCatchUp) : 0;
 }
 
-void DefaultTimerManager::handler() {
-	Common::StackLock lock(_mutex);
+void DefaultTimerManager::runCallback(TimerSlot *slot, uint64 deadline) {
+	assert(slot->callback);
+
+	TimerSlot *running = _running;
+	_running = slot;
+
+	const uint64 start = getMicros();
+	slot->callback(slot->refCon);
+	const uint64 end = getMicros();
 
-	uint32 curTime = g_system->getMillis(true);
+	_running = running;
+	if (slot->removed)
+		delete slot;
+	else
+		slot->addCall(deadline, start, end);
+}
+
+void DefaultTimerManager::queueForWorker(TimerSlot *slot, uint64 deadline) {
+	Common::StackLock lock(_workerQueueMutex);
 
-	// On slow systems this could still be run after destructor
-	if (!_head)
+	// A callback slower than its interval would otherwise queue calls
+	// faster than the worker runs them
+	if (slot->queued) {
+		slot->coalesced++;
 		return;
+	}
+	slot->queued = true;
+
+	WorkerJob job;
+	job.slot = slot;
+	job.deadline = deadline;
+	_workerQueue.push_back(job);
+	_workerQueued->post();
+}
 
-	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
+void DefaultTimerManager::workerProc(void *param) {
+	DefaultTimerManager *manager = (DefaultTimerManager *)param;
 
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
-		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
+	while (true) {
+		manager->_workerQueued->wait();
+		{
+			Common::StackLock lock(manager->_workerQueueMutex);
+			if (manager->_stopWorker)
+				break;
 		}
-		insertPrioQueue(_head, slot);
 
-		// Invoke the timer callback
-		assert(slot->callback);
-		slot->callback(slot->refCon);
+		// The call may have been removed from the queue in the meantime
+		manager->runWorkerCallback();
+	}
+}
+
+bool DefaultTimerManager::runWorkerCallback() {
+	// Held while the callback runs, so that removeTimerProc() can wait for it
+	Common::StackLock runLock(_workerRunMutex);
+
+	WorkerJob job;
+	{
+		Common::StackLock lock(_workerQueueMutex);
+		if (_workerQueue.empty())
+			return false;
+		job = _workerQueue.remove_at(0);
+		job.slot->queued = false;
+	}
+
+	const uint64 start = getMicros();
+	job.slot->callback(job.slot->refCon);
+	const uint64 end = getMicros();
+
+	Common::StackLock lock(_workerQueueMutex);
+	job.slot->addCall(job.deadline, start, end);
+	return true;
+}
+
+void DefaultTimerManager::stopWorker() {
+	if (!_worker)
+		return;
 
-		// Look at the next scheduled timer
-		slot = _head->next;
+	{
+		Common::StackLock lock(_workerQueueMutex);
+		_stopWorker = true;
 	}
+	_workerQueued->post();
+	_worker->wait();
+	delete _worker;
+	_worker = nullptr;
+	delete _workerQueued;
+	_workerQueued = nullptr;
+	for (uint i = 0; i < _workerQueue.size(); i++)
+		_workerQueue[i].slot->queued = false;
+	_workerQueue.clear();
 }
 
 void DefaultTimerManager::checkTimers(uint32 interval) {
@@ -147,28 +325,44 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->refCon = refCon;
 	slot->id = id;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = nullptr;
+	slot->deadline = getMicros() + interval;
 
-	insertPrioQueue(_head, slot);
+	heapPush(slot);
 
 	return true;
 }
 
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	Common::StackLock lock(_mutex);
+	// Wait until the worker is done with the callback, and keep it from
+	// starting another one
+	Common::StackLock runLock(_workerRunMutex);
+
+	uint i = 0;
+	while (i < _heap.size()) {
+		TimerSlot *slot = _heap[i];
+		if (slot->callback != callback) {
+			i++;
+			continue;
+		}
 
-	TimerSlot *slot = _head;
+		heapRemove(i);
 
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
-		} else {
-			slot = slot->next;
+		{
+			Common::StackLock queueLock(_workerQueueMutex);
+			for (uint j = 0; j < _workerQueue.size();) {
+				if (_workerQueue[j].slot == slot)
+					_workerQueue.remove_at(j);
+				else
+					j++;
+			}
 		}
+
+		// A timer removing itself is deleted once its callback returns
+		if (slot == _running)
+			slot->removed = true;
+		else
+			delete slot;
 	}
 
 	// We need to remove all names referencing the timer proc here.
@@ -183,8 +377,62 @@ void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	// name and causing installTimerProc to error out.
 	// A good test case is running a SCUMM with ALSA output and then a KYRA
 	// game for example.
-	for (TimerSlotMap::iterator i = _callbacks.begin(), end = _callbacks.end(); i != end; ++i) {
-		if (i->_value == callback)
-			_callbacks.erase(i);
+	for (TimerSlotMap::iterator it = _callbacks.begin(), end = _callbacks.end(); it != end; ++it) {
+		if (it->_value == callback)
+			_callbacks.erase(it);
+	}
+}
+
+void DefaultTimerManager::setHeavyTimerProc(TimerProc callback, bool heavy) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _heap.size(); i++) {
+		if (_heap[i]->callback == callback)
+			_heap[i]->heavy = heavy;
 	}
+
+	// Without threads, heavy timers are run by handler() like the others
+	if (heavy && _workerAllowed && !_worker) {
+		_workerQueued = g_system->createSemaphore();
+		if (!_workerQueued)
+			return;
+
+		_stopWorker = false;
+		_worker = g_system->createThread(workerProc, this);
+		if (!_worker) {
+			delete _workerQueued;
+			_workerQueued = nullptr;
+		}
+	}
+}
+
+void DefaultTimerManager::getTimerStats(Common::Array<TimerStats> &stats) {
+	Common::StackLock lock(_mutex);
+	Common::StackLock queueLock(_workerQueueMutex);
+
+	stats.clear();
+	for (uint i = 0; i < _heap.size(); i++) {
+		const TimerSlot *slot = _heap[i];
+
+		TimerStats timer;
+		timer.id = slot->id;
+		timer.interval = slot->interval;
+		timer.heavy = slot->heavy && _worker;
+		timer.calls = slot->calls;
+		timer.totalTime = slot->totalTime;
+		timer.maxTime = slot->maxTime;
+		timer.totalLateness = slot->totalLateness;
+		timer.maxLateness = slot->maxLateness;
+		timer.skipped = slot->skipped;
+		timer.coalesced = slot->coalesced;
+		stats.push_back(timer);
+	}
+}
+
+void DefaultTimerManager::resetTimerStats() {
+	Common::StackLock lock(_mutex);
+	Common::StackLock queueLock(_workerQueueMutex);
+
+	for (uint i = 0; i < _heap.size(); i++)
+		_heap[i]->resetStats();
 }
@@ -22,39 +22,130 @@
 #ifndef BACKENDS_TIMER_DEFAULT_H
 #define BACKENDS_TIMER_DEFAULT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
 #include "common/mutex.h"
 
+namespace Common {
+class SemaphoreInternal;
+class ThreadInternal;
+}
+
 struct TimerSlot;
 
+/**
+ * Execution statistics of an installed timer, as returned by
+ * DefaultTimerManager::getTimerStats(). All times are in microseconds.
+ */
+struct TimerStats {
+	Common::String id;
+	uint32 interval;
+	bool heavy;         ///< Whether the timer runs on the worker thread
+
+	uint32 calls;
+	uint64 totalTime;   ///< Time spent in the callback
+	uint32 maxTime;
+	uint64 totalLateness; ///< Delay between the deadlines and the calls
+	uint32 maxLateness;
+	uint32 skipped;     ///< Calls dropped when the timer fell too far behind
+	uint32 coalesced;   ///< Calls dropped while a call was queued for the worker
+};
+
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
 
 	Common::Mutex _mutex;
-	TimerSlot *_head;
+	// Binary min-heap of the installed timers, ordered by deadline
+	Common::Array<TimerSlot *> _heap;
 	TimerSlotMap _callbacks;
 
 	uint32 _timerCallbackNext;
 
+	// The timer whose callback handler() is running
+	TimerSlot *_running;
+
+	// Extends getMillis() to 64 bits
+	Common::Mutex _clockMutex;
+	uint32 _lastMillis;
+	uint64 _millisHigh;
+
+	// Heavy timers are queued for the worker thread instead of being run by
+	// handler(). _workerRunMutex is held while the worker runs a callback,
+	// _workerQueueMutex protects the queue, and _workerQueued is posted for
+	// each queued call, which the worker waits for. Each timer has at most
+	// one call in the queue.
+	Common::Mutex _workerRunMutex;
+	Common::Mutex _workerQueueMutex;
+	struct WorkerJob {
+		TimerSlot *slot;
+		uint64 deadline;
+	};
+	Common::Array<WorkerJob> _workerQueue;
+	Common::ThreadInternal *_worker;
+	Common::SemaphoreInternal *_workerQueued;
+	bool _stopWorker;
+
+	void heapPush(TimerSlot *slot);
+	void heapRemove(uint index);
+	void siftUp(uint index);
+	void siftDown(uint index);
+
+	void runCallback(TimerSlot *slot, uint64 deadline);
+	void queueForWorker(TimerSlot *slot, uint64 deadline);
+	void stopWorker();
+	static void workerProc(void *param);
+	bool runWorkerCallback();
+
+protected:
+	/**
+	 * Whether heavy timers may run on a thread of their own. Only backends
+	 * which call handler() from a thread should enable this, since it
+	 * makes the order in which callbacks run depend on thread scheduling.
+	 */
+	bool _workerAllowed;
+
+	/**
+	 * Get the current time in microseconds, from which the timer deadlines
+	 * are computed. By default, this is based on getMillis(), and backends
+	 * with a more precise clock should override it.
+	 */
+	virtual uint64 getMicros();
+
 public:
+	/**
+	 * Number of microseconds a timer may fall behind its deadline before the
+	 * calls it missed are dropped. Until then, late timers are called
+	 * repeatedly to catch up, so that they keep their average rate.
+	 */
+	static const uint32 kMaxCatchUp = 100000;
+
 	DefaultTimerManager();
 	virtual ~DefaultTimerManager();
 	virtual bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id);
 	virtual void removeTimerProc(TimerProc proc);
+	virtual void setHeavyTimerProc(TimerProc proc, bool heavy);
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
+	 *
+	 * @return The number of microseconds until the next timer is due, which
+	 *         backends may use to schedule the next call more precisely.
 	 */
-	void handler();
+	uint32 handler();
 
 	/*
 	 * Ensure that the callback is called at regular time intervals.
 	 * Should be called from pollEvents() on backends without threads.
 	 */
 	void checkTimers(uint32 interval = 10);
+
+	/** Get the execution statistics of all installed timers. */
+	void getTimerStats(Common::Array<TimerStats> &stats);
+	/** Reset the execution statistics of all installed timers. */
+	void resetTimerStats();
 };
 
 #endif
@@ -27,10 +27,13 @@
 #include "backends/timer/sdl/sdl-timer.h"
 
 #include "common/textconsole.h"
+#include "common/util.h"
 
 static Uint32 timer_handler(Uint32 interval, void *param) {
-	((DefaultTimerManager *)param)->handler();
-	return interval;
+	// Wake up again when the next timer is due, but at least every 10 ms
+	// to pick up newly installed timers
+	const uint32 wait = ((DefaultTimerManager *)param)->handler();
+	return CLIP<uint32>((wait + 999) / 1000, 1, 10);
 }
 
 SdlTimerManager::SdlTimerManager() {
@@ -39,6 +42,14 @@ SdlTimerManager::SdlTimerManager() {
 		error("Could not initialize SDL: %s", SDL_GetError());
 	}
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_counterStart = SDL_GetPerformanceCounter();
+	_counterFrequency = SDL_GetPerformanceFrequency();
+#endif
+
+	// Heavy timers get a thread of their own
+	_workerAllowed = true;
+
 	// Creates the timer callback
 	_timerID = SDL_AddTimer(10, &timer_handler, this);
 }
@@ -50,4 +61,11 @@ SdlTimerManager::~SdlTimerManager() {
 	SDL_QuitSubSystem(SDL_INIT_TIMER);
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+uint64 SdlTimerManager::getMicros() {
+	const uint64 counter = SDL_GetPerformanceCounter() - _counterStart;
+	return counter / _counterFrequency * 1000000 + counter % _counterFrequency * 1000000 / _counterFrequency;
+}
+#endif
+
 #endif
@@ -37,6 +37,13 @@ public:
 
 protected:
 	SDL_TimerID _timerID;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	uint64 _counterStart;
+	uint64 _counterFrequency;
+
+	virtual uint64 getMicros();
+#endif
 };
 
 
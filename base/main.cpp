@@ -30,6 +30,7 @@
 // FIXME: Avoid using printf
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "engines/advancedDetector.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
@@ -37,6 +38,7 @@
 #include "base/version.h"
 
 #include "common/archive.h"
+#include "common/compression/unzip.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
 #include "common/debug-channels.h" /* for debug manager */
@@ -48,6 +50,7 @@
 #endif
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/thread.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
 #include "common/text-to-speech.h"
@@ -519,6 +522,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		if (res.getCode() != Common::kNoError)
 			warning("%s", res.getDesc().c_str());
 
+		AdvancedDetectorCacheManager::destroy();
 		PluginManager::destroy();
 
 		return res.getCode();
@@ -890,6 +894,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Cloud::CloudManager::destroy();
 #endif
 #endif
+	AdvancedDetectorCacheManager::destroy();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
 	Common::ConfigManager::destroy();
@@ -899,6 +904,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	GUI::EventRecorder::destroy();
 #endif
 	Common::SearchManager::destroy();
+	Common::clearZipIndexCache();
 #ifdef USE_TRANSLATION
 	Common::MainTranslationManager::destroy();
 #endif
@@ -910,6 +916,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 #endif
 	EngineManager::destroy();
 	Graphics::YUVToRGBManager::destroy();
+	Common::shutdownThreads();
 
 	return 0;
 }
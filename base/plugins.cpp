@@ -25,6 +25,7 @@
 #include "common/debug.h"
 #include "common/debug-channels.h"
 #include "common/config-manager.h"
+#include "common/thread.h"
 
 #ifdef DYNAMIC_MODULES
 #include "common/fs.h"
@@ -689,6 +690,22 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 	// Clear md5 cache before each detection starts, just in case.
 	ADCacheMan.clear();
 
+	// Let all engines queue the files they are going to look at, so they
+	// can be read at once, spread over several threads. The detection below
+	// then finds their MD5s in the cache, so it returns the same results
+	// however the reads were scheduled.
+	// Without threads, this would only read the files ahead of the
+	// detection, which finds them in the cache just the same.
+	uint threads = ConfMan.hasKey("detection_threads") ? MAX(ConfMan.getInt("detection_threads"), 0) : 0;
+	if (threads == 0)
+		threads = Common::getMaxThreads();
+	if (threads > 1 && !fslist.empty()) {
+		for (iter = plugins.begin(); iter != plugins.end(); ++iter)
+			(*iter)->get<MetaEngineDetection>().queueDetectionReads(fslist);
+
+		ADCacheMan.runQueuedReads(threads);
+	}
+
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
 	for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
@@ -706,6 +723,10 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 
 	// Close all archives that were opened during detection
 	ADCacheMan.clearArchives();
+	ADCacheMan.clearDirectories();
+
+	debugC(2, kDebugGlobalDetection, "MD5 cache: %u hits, %u misses", ADCacheMan.getPersistentHits(), ADCacheMan.getPersistentMisses());
+	ADCacheMan.flushPersistentCache();
 
 	return DetectionResults(candidates);
 }
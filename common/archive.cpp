@@ -230,15 +230,115 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	// Now we have a valid contents reference. Make stream for it.
 	Common::MemoryReadStream *memStream = new Common::MemoryReadStream(entry->getContents(), entry->getSize());
 
-	// If the entry was just created and it's too big for strong caching,
-	// mark the copy in cache as weak
-	if (isNew && entry->getSize() > _maxStronglyCachedSize) {
-		entry->makeWeak();
+	// If the entry is too big for strong caching, keep it in the recently
+	// used members if it fits, and otherwise mark the copy in cache as weak
+	// if it was just created
+	if (entry->getSize() > _maxStronglyCachedSize) {
+		if (entry->getSize() <= _maxRecentSize)
+			keepRecent(cacheKey, entry->getSize());
+		else if (isNew)
+			entry->makeWeak();
 	}
 
 	return memStream;
 }
 
+void MemcachingCaseInsensitiveArchive::setMemberCacheSize(uint32 size) {
+	_maxRecentSize = size;
+	while (_recentSize > _maxRecentSize) {
+		const RecentEntry &oldest = _recent.back();
+		_cache[oldest.key].makeWeak();
+		_recentSize -= oldest.size;
+		_recent.pop_back();
+	}
+}
+
+void MemcachingCaseInsensitiveArchive::keepRecent(const CacheKey &key, uint32 size) const {
+	CacheKey_EqualTo equal;
+	for (List<RecentEntry>::iterator i = _recent.begin(); i != _recent.end(); ++i) {
+		if (equal(i->key, key)) {
+			RecentEntry recent = *i;
+			_recent.erase(i);
+			_recent.push_front(recent);
+			return;
+		}
+	}
+
+	RecentEntry recent;
+	recent.key = key;
+	recent.size = size;
+	_recent.push_front(recent);
+	_recentSize += size;
+
+	while (_recentSize > _maxRecentSize) {
+		const RecentEntry &oldest = _recent.back();
+		_cache[oldest.key].makeWeak();
+		_recentSize -= oldest.size;
+		_recent.pop_back();
+	}
+}
+
+void MemcachingCaseInsensitiveArchive::prefetchMembers(const ArchiveMemberList &list) const {
+	if (_maxRecentSize == 0)
+		return;
+
+	Array<Path> paths;
+	for (ArchiveMemberList::const_iterator i = list.begin(); i != list.end(); ++i) {
+		CacheKey cacheKey;
+		cacheKey.path = translatePath((*i)->getPathInArchive());
+
+		// Skip the members which are already in memory
+		if (_cache.contains(cacheKey) && _cache[cacheKey].makeStrong()) {
+			SharedArchiveContents &entry = _cache[cacheKey];
+			if (entry.getSize() > _maxStronglyCachedSize) {
+				if (entry.getSize() <= _maxRecentSize)
+					keepRecent(cacheKey, entry.getSize());
+				else
+					entry.makeWeak();
+			}
+			continue;
+		}
+
+		paths.push_back(cacheKey.path);
+	}
+
+	Array<SharedArchiveContents> contents;
+	contents.resize(paths.size());
+	readContentsForPaths(paths, contents, _maxRecentSize);
+
+	for (uint i = 0; i < paths.size(); i++) {
+		// Missing members are not cached here, in case the archive could not
+		// read them ahead for another reason
+		if (contents[i].isFileMissing())
+			continue;
+
+		CacheKey cacheKey;
+		cacheKey.path = paths[i];
+		_cache[cacheKey] = contents[i];
+		if (contents[i].getSize() > _maxStronglyCachedSize) {
+			if (contents[i].getSize() <= _maxRecentSize)
+				keepRecent(cacheKey, contents[i].getSize());
+			else
+				_cache[cacheKey].makeWeak();
+		}
+	}
+}
+
+void MemcachingCaseInsensitiveArchive::readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents, uint32 maxSize) const {
+	uint32 size = 0;
+	for (uint i = 0; i < translatedPaths.size() && size < maxSize; i++) {
+		SharedArchiveContents readResult = readContentsForPath(translatedPaths[i]);
+		if (readResult._bypass) {
+			// Streamed members are not kept in memory
+			delete readResult._bypass;
+			continue;
+		}
+
+		contents[i] = readResult;
+		size += readResult.getSize();
+	}
+}
+
 SharedArchiveContents MemcachingCaseInsensitiveArchive::readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const {
 	return SharedArchiveContents();
 }
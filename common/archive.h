@@ -22,6 +22,7 @@
 #ifndef COMMON_ARCHIVE_H
 #define COMMON_ARCHIVE_H
 
+#include "common/array.h"
 #include "common/error.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -202,6 +203,14 @@ public:
 		return createReadStreamForMember(path);
 	}
 
+	/**
+	 * Hint that the given members are about to be read. Archives which have
+	 * to decompress their members can use this to decompress several of them
+	 * at once, possibly on several threads. The default implementation does
+	 * nothing.
+	 */
+	virtual void prefetchMembers(const ArchiveMemberList &list) const {}
+
 	/**
 	 * Dump all files from the archive to the given directory
 	 */
@@ -268,10 +277,24 @@ private:
  */
 class MemcachingCaseInsensitiveArchive : public Archive {
 public:
-	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512) : _maxStronglyCachedSize(maxStronglyCachedSize) {}
+	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512) : _maxStronglyCachedSize(maxStronglyCachedSize), _maxRecentSize(0), _recentSize(0) {}
 	SeekableReadStream *createReadStreamForMember(const Path &path) const;
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, Common::AltStreamType altStreamType) const;
 
+	/**
+	 * Keep up to @p size bytes of the most recently read members in memory
+	 * after their streams are deleted, so that opening them again does not
+	 * read them again. 0, the default, only keeps the members which are
+	 * still open, or which are smaller than the strong caching limit.
+	 */
+	void setMemberCacheSize(uint32 size);
+
+	/**
+	 * Read the given members into the member cache, up to the size set with
+	 * setMemberCacheSize(). Nothing is read when that size is 0.
+	 */
+	void prefetchMembers(const ArchiveMemberList &list) const override;
+
 	virtual Path translatePath(const Path &path) const {
 		return path.normalize();
 	}
@@ -279,6 +302,14 @@ public:
 	virtual SharedArchiveContents readContentsForPath(const Path &translatedPath) const = 0;
 	virtual SharedArchiveContents readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const;
 
+	/**
+	 * Read the contents of several members for prefetchMembers(). Reading
+	 * stops once @p maxSize bytes have been read, and the remaining entries
+	 * of @p contents are left as missing files. The default implementation
+	 * calls readContentsForPath() for each of them.
+	 */
+	virtual void readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents, uint32 maxSize) const;
+
 private:
 	struct CacheKey {
 		CacheKey();
@@ -295,10 +326,22 @@ private:
 		uint operator()(const CacheKey &x) const;
 	};
 
+	struct RecentEntry {
+		CacheKey key;
+		uint32 size;
+	};
+
 	SeekableReadStream *createReadStreamForMemberImpl(const Path &path, bool isAltStream, Common::AltStreamType altStreamType) const;
+	void keepRecent(const CacheKey &key, uint32 size) const;
 
 	mutable HashMap<CacheKey, SharedArchiveContents, CacheKey_Hash, CacheKey_EqualTo> _cache;
 	uint32 _maxStronglyCachedSize;
+
+	// Members kept strongly cached because they were read recently, the
+	// most recent first
+	mutable List<RecentEntry> _recent;
+	uint32 _maxRecentSize;
+	mutable uint32 _recentSize;
 };
 
 /**
@@ -98,6 +98,9 @@ typedef Byte Bytef;
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/thread.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -321,6 +324,40 @@ typedef struct {
 typedef Common::HashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCase_Hash,
 	Common::Path::IgnoreCase_EqualTo> ZipHash;
 
+/* compressed_file_in_zip contain the data of a file in the zipfile, before
+	it is decompressed */
+typedef struct {
+	const byte *compressed;			/* the compressed data */
+	byte *buffer;					/* the buffer to free, if the data was copied */
+	uLong compression_method;
+	uLong compressed_size;
+	uLong uncompressed_size;
+	uLong crc;
+} compressed_file_in_zip;
+
+/* The parsed central directories of the zipfiles opened so far. Opening the
+	same zipfile again reuses them, instead of parsing the directory again.
+	They are keyed by the end of central directory record and a CRC of the
+	central directory, so a modified zipfile is parsed again. */
+typedef struct {
+	Common::HashMap<Common::String, Common::SharedPtr<ZipHash> > indexes;
+	Common::List<Common::String> order;	/* the oldest index first */
+	uint hits;
+	uint misses;
+} zip_index_cache;
+
+#define MAXCACHEDINDEXES (32)
+
+static zip_index_cache *g_zipIndexCache = nullptr;
+
+/* Guards g_zipIndexCache, and the reference counts of the indexes in it, as
+	zipfiles may be opened and closed from several threads. It is created on
+	first use, as it needs the backend. */
+static Common::Mutex &getZipIndexCacheMutex() {
+	static Common::Mutex *mutex = new Common::Mutex();
+	return *mutex;
+}
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
@@ -339,7 +376,7 @@ typedef struct {
 	unz_file_info cur_file_info;					/* public info about the current file in zip*/
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
 
-	ZipHash _hash;
+	Common::SharedPtr<ZipHash> _hash;	/* the files in the zipfile, which may be shared with other unz_s */
 } unz_s;
 
 /* ===========================================================================
@@ -432,6 +469,165 @@ static uLong unzlocal_SearchCentralDir(Common::SeekableReadStream &fin) {
 	return uPosFound;
 }
 
+/*
+  Add the files of the central directory in dir to hash. Parsing stops at the
+	first invalid entry, like the unzGoToNextFile loop it replaces.
+*/
+static void unzlocal_ParseCentralDir(const byte *dir, uLong size, uLong number_entry,
+									 uLong offset_central_dir, bool flattenTree, ZipHash &hash) {
+	uLong pos = 0;
+	for (uLong num_file = 0; num_file < number_entry; num_file++) {
+		if (pos + SIZECENTRALDIRITEM > size || READ_LE_UINT32(dir + pos) != 0x02014b50)
+			break;
+
+		const byte *item = dir + pos;
+		cached_file_in_zip fe;
+		fe.num_file = num_file;
+		fe.pos_in_central_dir = offset_central_dir + pos;
+		fe.current_file_ok = 1;
+
+		unz_file_info &file_info = fe.cur_file_info;
+		file_info.version = READ_LE_UINT16(item + 4);
+		file_info.version_needed = READ_LE_UINT16(item + 6);
+		file_info.flag = READ_LE_UINT16(item + 8);
+		file_info.compression_method = READ_LE_UINT16(item + 10);
+		file_info.dosDate = READ_LE_UINT32(item + 12);
+		file_info.crc = READ_LE_UINT32(item + 16);
+		file_info.compressed_size = READ_LE_UINT32(item + 20);
+		file_info.uncompressed_size = READ_LE_UINT32(item + 24);
+		file_info.size_filename = READ_LE_UINT16(item + 28);
+		file_info.size_file_extra = READ_LE_UINT16(item + 30);
+		file_info.size_file_comment = READ_LE_UINT16(item + 32);
+		file_info.disk_num_start = READ_LE_UINT16(item + 34);
+		file_info.internal_fa = READ_LE_UINT16(item + 36);
+		file_info.external_fa = READ_LE_UINT32(item + 38);
+		fe.cur_file_info_internal.offset_curfile = READ_LE_UINT32(item + 42);
+
+		pos += SIZECENTRALDIRITEM + file_info.size_filename + file_info.size_file_extra + file_info.size_file_comment;
+		if (pos > size)
+			break;
+
+		// Get the file name
+		char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
+		uLong nameLength = MIN<uLong>(file_info.size_filename, UNZ_MAXFILENAMEINZIP);
+		memcpy(szCurrentFileName, item + SIZECENTRALDIRITEM, nameLength);
+		szCurrentFileName[nameLength] = '\0';
+
+		bool isDirectory = false;
+		if (*szCurrentFileName) {
+			char *szCurrentFileNameSuffix = szCurrentFileName + strlen(szCurrentFileName) - 1;
+			if (*szCurrentFileNameSuffix == '/' || *szCurrentFileNameSuffix == '\\') {
+				isDirectory = true;
+				// Strip trailing path terminator
+				*szCurrentFileNameSuffix = '\0';
+			}
+		}
+
+		// If platform is specified as MS-DOS or Unix, check the directory flag
+		if (!isDirectory) {
+			int platform = (file_info.version >> 8) & 0xff;
+			switch (platform) {
+			case 1: // Amiga
+				isDirectory = ((file_info.external_fa & 0xc000000u) == 0x8000000u); // ((external_fa >> 16) & IFMT) == IFDIR
+				break;
+			case 0: // FAT (MS-DOS)
+			case 6: // HPFS (OS/2)
+			case 11: // NTFS
+			case 14: // VFAT
+				isDirectory = ((file_info.external_fa & 0x10) == 0x10); // external_fa & FILE_ATTRIBUTE_DIRECTORY
+				break;
+			case 3: // Unix
+				isDirectory = ((file_info.external_fa & 0xf0000000u) == 0x40000000u); // S_ISDIR(external_fa >> 16)
+				break;
+			default:
+				break;
+			}
+		}
+
+		const char *name = szCurrentFileName;
+		if (flattenTree) {
+			if (isDirectory)
+				continue;
+
+			for (const char *p = szCurrentFileName; *p; p++)
+				if (*p == '\\' || *p == '/')
+					name = p + 1;
+		} else {
+			for (char *p = szCurrentFileName; *p; p++)
+				if (*p == '\\')
+					*p = '/';
+		}
+
+		hash[Common::Path(name)] = fe;
+	}
+}
+
+/*
+  Read the central directory of the zipfile into us->_hash, or reuse the one
+	parsed when the same zipfile was opened before.
+*/
+static int unzlocal_ReadCentralDir(unz_s *us, bool flattenTree) {
+	const uLong start = us->offset_central_dir + us->byte_before_the_zipfile;
+	const int64 zipSize = us->_stream->size();
+	if (zipSize < 0 || (uint64)start + us->size_central_dir > (uint64)zipSize)
+		return UNZ_BADZIPFILE;
+
+	// Read the whole directory at once, or use it in place if the zipfile
+	// is in memory
+	const byte *dir = us->_stream->getMappedData();
+	byte *buffer = nullptr;
+	if (dir) {
+		dir += start;
+	} else {
+		buffer = new byte[us->size_central_dir + 1];
+		us->_stream->seek(start, SEEK_SET);
+		if (us->_stream->read(buffer, us->size_central_dir) != us->size_central_dir) {
+			delete[] buffer;
+			return UNZ_ERRNO;
+		}
+		dir = buffer;
+	}
+
+#ifdef USE_ZLIB
+	uint32 dirCrc = crc32(0, dir, us->size_central_dir);
+#else
+	uint32 dirCrc = Common::CRC32().crcFast(dir, us->size_central_dir);
+#endif
+	Common::String key = Common::String::format("%llu:%lu:%lu:%lu:%lu:%08x:%d", (unsigned long long)zipSize,
+	                                            us->central_pos, us->offset_central_dir, us->size_central_dir,
+	                                            us->gi.number_entry, dirCrc, flattenTree);
+
+	Common::StackLock lock(getZipIndexCacheMutex());
+
+	if (!g_zipIndexCache) {
+		g_zipIndexCache = new zip_index_cache;
+		g_zipIndexCache->hits = 0;
+		g_zipIndexCache->misses = 0;
+	}
+
+	if (g_zipIndexCache->indexes.contains(key)) {
+		us->_hash = g_zipIndexCache->indexes[key];
+		g_zipIndexCache->hits++;
+	} else {
+		us->_hash = Common::SharedPtr<ZipHash>(new ZipHash());
+		unzlocal_ParseCentralDir(dir, us->size_central_dir, us->gi.number_entry, us->offset_central_dir, flattenTree, *us->_hash);
+		g_zipIndexCache->misses++;
+
+		g_zipIndexCache->indexes[key] = us->_hash;
+		g_zipIndexCache->order.push_back(key);
+		if (g_zipIndexCache->order.size() > MAXCACHEDINDEXES) {
+			g_zipIndexCache->indexes.erase(g_zipIndexCache->order.front());
+			g_zipIndexCache->order.pop_front();
+		}
+	}
+
+	delete[] buffer;
+
+	// unzLocateFile only works when there is a valid first file
+	us->current_file_ok = !us->_hash->empty();
+	return UNZ_OK;
+}
+
 /*
   Open a Zip file. path contain the full pathname (by example,
 	 on a Windows NT computer "c:\\test\\zlib109.zip" or on an Unix computer
@@ -519,71 +715,10 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		                    (us->offset_central_dir + us->size_central_dir);
 	us->central_pos = central_pos;
 
-	err = unzGoToFirstFile((unzFile)us);
-
-	while (err == UNZ_OK) {
-		// Get the file details
-		char szCurrentFileName[UNZ_MAXFILENAMEINZIP+1];
-		unzGetCurrentFileInfo(us, nullptr, szCurrentFileName, sizeof(szCurrentFileName) - 1,
-							nullptr, 0, nullptr, 0);
-
-		// Save details into the hash
-		cached_file_in_zip fe;
-		fe.num_file = us->num_file;
-		fe.pos_in_central_dir = us->pos_in_central_dir;
-		fe.current_file_ok = us->current_file_ok;
-		fe.cur_file_info = us->cur_file_info;
-		fe.cur_file_info_internal = us->cur_file_info_internal;
-
-		bool isDirectory = false;
-		if (*szCurrentFileName) {
-			char *szCurrentFileNameSuffix = szCurrentFileName + strlen(szCurrentFileName) - 1;
-			if (*szCurrentFileNameSuffix == '/' || *szCurrentFileNameSuffix == '\\') {
-				isDirectory = true;
-				// Strip trailing path terminator
-				*szCurrentFileNameSuffix = '\0';
-			}
-		}
-
-		// If platform is specified as MS-DOS or Unix, check the directory flag
-		if (!isDirectory) {
-			int platform = (us->cur_file_info.version >> 8) & 0xff;
-			switch (platform) {
-			case 1: // Amiga
-				isDirectory = ((us->cur_file_info.external_fa & 0xc000000u) == 0x8000000u); // ((external_fa >> 16) & IFMT) == IFDIR
-				break;
-			case 0: // FAT (MS-DOS)
-			case 6: // HPFS (OS/2)
-			case 11: // NTFS
-			case 14: // VFAT
-				isDirectory = ((us->cur_file_info.external_fa & 0x10) == 0x10); // external_fa & FILE_ATTRIBUTE_DIRECTORY
-				break;
-			case 3: // Unix
-				isDirectory = ((us->cur_file_info.external_fa & 0xf0000000u) == 0x40000000u); // S_ISDIR(external_fa >> 16)
-				break;
-			default:
-				break;
-			}
-		}
-
-		const char *name = szCurrentFileName;
-		if (flattenTree) {
-			if (isDirectory)
-				continue;
-
-			for (const char *p = szCurrentFileName; *p; p++)
-				if (*p == '\\' || *p == '/')
-					name = p + 1;
-		} else {
-			for (char *p = szCurrentFileName; *p; p++)
-				if (*p == '\\')
-					*p = '/';
-		}
-
-		us->_hash[Common::Path(name)] = fe;
-
-		// Move to the next file
-		err = unzGoToNextFile((unzFile)us);
+	if (unzlocal_ReadCentralDir(us, flattenTree) != UNZ_OK) {
+		delete us->_stream;
+		delete us;
+		return nullptr;
 	}
 	return (unzFile)us;
 }
@@ -601,6 +736,10 @@ int unzClose(unzFile file) {
 	s = (unz_s *)file;
 
 	delete s->_stream;
+	{
+		Common::StackLock lock(getZipIndexCacheMutex());
+		s->_hash.reset();
+	}
 	delete s;
 	return UNZ_OK;
 }
@@ -846,8 +985,8 @@ int unzLocateFile(unzFile file, const Common::Path &szFileName, int iCaseSensiti
 		return UNZ_END_OF_LIST_OF_FILE;
 
 	// Check to see if the entry exists
-	ZipHash::iterator i = s->_hash.find(szFileName);
-	if (i == s->_hash.end())
+	ZipHash::iterator i = s->_hash->find(szFileName);
+	if (i == s->_hash->end())
 		return UNZ_END_OF_LIST_OF_FILE;
 
 	// Found it, so reset the details in the main structure
@@ -953,69 +1092,119 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s *s, uInt *piSizeVar,
 }
 
 /*
-  Open for reading data the current file in the zipfile.
-  If there is no error and the file is opened, the return value is UNZ_OK.
+  Read the compressed data of the current file in the zipfile. If the zipfile
+	is in memory, and the data does not have to be copied, it is used in
+	place. This only accesses the zipfile stream, so the data of several
+	files can be read first, and decompressed afterwards.
+  return UNZ_OK if there is no problem.
 */
-Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
-#ifndef USE_ZLIB
-		, const Common::CRC32 &crc
-#endif
-		) {
+static int unzlocal_ReadCurrentFile(unz_s *s, compressed_file_in_zip *file) {
 	uInt iSizeVar;
-	unz_s *s;
 	uLong offset_local_extrafield;  /* offset of the local extra field */
 	uInt  size_local_extrafield;    /* size of the local extra field */
 
-	if (file == nullptr)
-		return Common::SharedArchiveContents();
-	s = (unz_s *)file;
+	file->compressed = nullptr;
+	file->buffer = nullptr;
+
 	if (!s->current_file_ok)
-		return Common::SharedArchiveContents();
+		return UNZ_PARAMERROR;
 
 	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
 				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
-		return Common::SharedArchiveContents();
+		return UNZ_BADZIPFILE;
 
 	if (s->cur_file_info.compression_method != 0 && s->cur_file_info.compression_method != Z_DEFLATED) {
 		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
-		return Common::SharedArchiveContents();
+		return UNZ_BADZIPFILE;
+	}
+
+	file->compression_method = s->cur_file_info.compression_method;
+	file->compressed_size = s->cur_file_info.compressed_size;
+	file->uncompressed_size = s->cur_file_info.uncompressed_size;
+	file->crc = s->cur_file_info.crc;
+
+	const uLong offset = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+	const byte *mapped = s->_stream->getMappedData();
+	if (mapped && file->compression_method == Z_DEFLATED && offset + file->compressed_size <= (uint64)s->_stream->size()) {
+		file->compressed = mapped + offset;
+	} else {
+		// Stored files are returned in this buffer
+		file->buffer = new byte[file->compressed_size];
+		s->_stream->seek(offset);
+		s->_stream->read(file->buffer, file->compressed_size);
+		file->compressed = file->buffer;
 	}
 
-	uint32 crc32_wait = s->cur_file_info.crc;
+	return UNZ_OK;
+}
 
-	byte *compressedBuffer = new byte[s->cur_file_info.compressed_size];
-	s->_stream->seek(s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar);
-	s->_stream->read(compressedBuffer, s->cur_file_info.compressed_size);
+/*
+  Decompress a file read by unzlocal_ReadCurrentFile, and check its CRC. The
+	compressed data is freed. This does not access the zipfile, so several
+	files can be decompressed at the same time.
+*/
+static Common::SharedArchiveContents unzlocal_DecompressFile(compressed_file_in_zip *file
+#ifndef USE_ZLIB
+		, const Common::CRC32 &crc
+#endif
+		) {
 	byte *uncompressedBuffer = nullptr;
 
-	switch (s->cur_file_info.compression_method) {
+	switch (file->compression_method) {
 	case 0: // Store
-		uncompressedBuffer = compressedBuffer;
+		uncompressedBuffer = file->buffer;
+		file->buffer = nullptr;
 		break;
 	case Z_DEFLATED:
-		uncompressedBuffer = new byte[s->cur_file_info.uncompressed_size];
-		assert(s->cur_file_info.uncompressed_size == 0 || uncompressedBuffer != nullptr);
-		Common::inflateZlibHeaderless(uncompressedBuffer, s->cur_file_info.uncompressed_size, compressedBuffer, s->cur_file_info.compressed_size);
-		delete[] compressedBuffer;
-		compressedBuffer = nullptr;
+		uncompressedBuffer = new byte[file->uncompressed_size];
+		assert(file->uncompressed_size == 0 || uncompressedBuffer != nullptr);
+		Common::inflateZlibHeaderless(uncompressedBuffer, file->uncompressed_size, file->compressed, file->compressed_size);
+		delete[] file->buffer;
+		file->buffer = nullptr;
 		break;
 	default:
-		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
-		delete[] compressedBuffer;
+		warning("Unknown compression algoritthm %d", (int)file->compression_method);
+		delete[] file->buffer;
+		file->buffer = nullptr;
 		return Common::SharedArchiveContents();
 	}
+	file->compressed = nullptr;
+
 #ifndef USE_ZLIB
-	uint32 crc32_data = crc.crcFast(uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	uint32 crc32_data = crc.crcFast(uncompressedBuffer, file->uncompressed_size);
 #else
-	uint32 crc32_data = crc32(0, uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	uint32 crc32_data = crc32(0, uncompressedBuffer, file->uncompressed_size);
 #endif
-	if (crc32_data != crc32_wait) {
+	if (crc32_data != file->crc) {
 		delete[] uncompressedBuffer;
-		warning("CRC32 mismatch: %08x, %08x", crc32_data, crc32_wait);
+		warning("CRC32 mismatch: %08x, %08x", crc32_data, (uint32)file->crc);
 		return Common::SharedArchiveContents();
 	}
 
-	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	return Common::SharedArchiveContents(uncompressedBuffer, file->uncompressed_size);
+}
+
+/*
+  Open for reading data the current file in the zipfile.
+  If there is no error and the file is opened, the return value is UNZ_OK.
+*/
+Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
+#ifndef USE_ZLIB
+		, const Common::CRC32 &crc
+#endif
+		) {
+	if (file == nullptr)
+		return Common::SharedArchiveContents();
+
+	compressed_file_in_zip compressed;
+	if (unzlocal_ReadCurrentFile((unz_s *)file, &compressed) != UNZ_OK)
+		return Common::SharedArchiveContents();
+
+#ifndef USE_ZLIB
+	return unzlocal_DecompressFile(&compressed, crc);
+#else
+	return unzlocal_DecompressFile(&compressed);
+#endif
 }
 
 
@@ -1040,9 +1229,21 @@ public:
 	int listMembers(ArchiveMemberList &list) const override;
 	const ArchiveMemberPtr getMember(const Path &path) const override;
 	Common::SharedArchiveContents readContentsForPath(const Common::Path &translated) const override;
+	void readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents, uint32 maxSize) const override;
 	Common::Path translatePath(const Common::Path &path) const override {
 		return _flattenTree ? path.getLastComponent() : path;
 	}
+
+private:
+	struct DecompressJob {
+		Array<compressed_file_in_zip> files;
+		Array<SharedArchiveContents> results;
+#ifndef USE_ZLIB
+		const Common::CRC32 *crc;
+#endif
+	};
+
+	static void decompressFile(void *param, uint task);
 };
 
 /*
@@ -1090,7 +1291,7 @@ int ZipArchive::listMembers(ArchiveMemberList &list) const {
 	int members = 0;
 
 	const unz_s *const archive = (const unz_s *)_zipFile;
-	for (ZipHash::const_iterator i = archive->_hash.begin(), end = archive->_hash.end();
+	for (ZipHash::const_iterator i = archive->_hash->begin(), end = archive->_hash->end();
 	     i != end; ++i) {
 		list.push_back(ArchiveMemberList::value_type(new GenericArchiveMember(i->_key, *this)));
 		++members;
@@ -1116,15 +1317,51 @@ Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path
 #endif
 }
 
-Archive *makeZipArchive(const Path &name, bool flattenTree) {
-	return makeZipArchive(SearchMan.createReadStreamForMember(name), flattenTree);
+void ZipArchive::readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents, uint32 maxSize) const {
+	// Reading the compressed data uses the zipfile stream, so it is done
+	// here, and only the decompression is spread across threads
+	DecompressJob job;
+	Array<uint> indices;
+	uint32 size = 0;
+	for (uint i = 0; i < translatedPaths.size() && size < maxSize; i++) {
+		compressed_file_in_zip file;
+		if (unzLocateFile(_zipFile, translatedPaths[i], 2) != UNZ_OK ||
+		    unzlocal_ReadCurrentFile((unz_s *)_zipFile, &file) != UNZ_OK)
+			continue;
+
+		job.files.push_back(file);
+		indices.push_back(i);
+		size += file.uncompressed_size;
+	}
+
+	job.results.resize(job.files.size());
+#ifndef USE_ZLIB
+	job.crc = &_crc;
+#endif
+	Common::runTasks(decompressFile, &job, job.files.size());
+
+	for (uint i = 0; i < indices.size(); i++)
+		contents[indices[i]] = job.results[i];
+}
+
+void ZipArchive::decompressFile(void *param, uint task) {
+	DecompressJob *job = (DecompressJob *)param;
+#ifndef USE_ZLIB
+	job->results[task] = unzlocal_DecompressFile(&job->files[task], *job->crc);
+#else
+	job->results[task] = unzlocal_DecompressFile(&job->files[task]);
+#endif
 }
 
-Archive *makeZipArchive(const FSNode &node, bool flattenTree) {
-	return makeZipArchive(node.createReadStream(), flattenTree);
+Archive *makeZipArchive(const Path &name, bool flattenTree, uint32 cacheSize) {
+	return makeZipArchive(SearchMan.createReadStreamForMember(name), flattenTree, cacheSize);
 }
 
-Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree) {
+Archive *makeZipArchive(const FSNode &node, bool flattenTree, uint32 cacheSize) {
+	return makeZipArchive(node.createReadStream(), flattenTree, cacheSize);
+}
+
+Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree, uint32 cacheSize) {
 	if (!stream)
 		return nullptr;
 	unzFile zipFile = unzOpen(stream, flattenTree);
@@ -1133,7 +1370,22 @@ Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree) {
 		// goes wrong.
 		return nullptr;
 	}
-	return new ZipArchive(zipFile, flattenTree);
+	ZipArchive *archive = new ZipArchive(zipFile, flattenTree);
+	archive->setMemberCacheSize(cacheSize);
+	return archive;
+}
+
+void getZipIndexCacheStats(ZipIndexCacheStats &stats) {
+	StackLock lock(getZipIndexCacheMutex());
+	stats.indexes = g_zipIndexCache ? g_zipIndexCache->indexes.size() : 0;
+	stats.hits = g_zipIndexCache ? g_zipIndexCache->hits : 0;
+	stats.misses = g_zipIndexCache ? g_zipIndexCache->misses : 0;
+}
+
+void clearZipIndexCache() {
+	StackLock lock(getZipIndexCacheMutex());
+	delete g_zipIndexCache;
+	g_zipIndexCache = nullptr;
 }
 
 } // End of namespace Common
@@ -43,9 +43,15 @@ class SeekableReadStream;
  * This factory method creates an Archive instance corresponding to the content
  * of the ZIP compressed file with the given name.
  *
+ * @param cacheSize The number of bytes of decompressed members the archive
+ *                  keeps in memory after they are closed, see
+ *                  MemcachingCaseInsensitiveArchive::setMemberCacheSize().
+ *                  This also allows Archive::prefetchMembers() to decompress
+ *                  members ahead, on several threads.
+ *
  * May return 0 in case of a failure.
  */
-Archive *makeZipArchive(const Path &name, bool flattenTree = false);
+Archive *makeZipArchive(const Path &name, bool flattenTree = false, uint32 cacheSize = 0);
 
 /**
  * This factory method creates an Archive instance corresponding to the content
@@ -53,7 +59,7 @@ Archive *makeZipArchive(const Path &name, bool flattenTree = false);
  *
  * May return 0 in case of a failure.
  */
-Archive *makeZipArchive(const FSNode &node, bool flattenTree = false);
+Archive *makeZipArchive(const FSNode &node, bool flattenTree = false, uint32 cacheSize = 0);
 
 /**
  * This factory method creates an Archive instance corresponding to the content
@@ -63,7 +69,28 @@ Archive *makeZipArchive(const FSNode &node, bool flattenTree = false);
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
-Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree = false);
+Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree = false, uint32 cacheSize = 0);
+
+/**
+ * Statistics of the central directory index cache.
+ *
+ * The central directory of each ZIP archive opened is parsed only once, and
+ * kept for the archives opened later with the same contents.
+ */
+struct ZipIndexCacheStats {
+	uint indexes; ///< Number of central directories in the cache
+	uint hits;    ///< Number of archives opened with a cached central directory
+	uint misses;  ///< Number of archives which had their central directory parsed
+};
+
+/** Get the statistics of the central directory index cache. */
+void getZipIndexCacheStats(ZipIndexCacheStats &stats);
+
+/**
+ * Free the central directory index cache. Archives which are open keep
+ * using their index.
+ */
+void clearZipIndexCache();
 
 /** @} */
 
@@ -252,6 +252,17 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and the last modification time of the file referred
+	 * by this node, without opening it. Not all backends support this.
+	 *
+	 * The modification time is in a backend specific unit, so it is only
+	 * useful to find out whether a file changed since it was last looked at.
+	 *
+	 * @return True if both could be determined, false otherwise.
+	 */
+	bool getFileStats(int64 &size, int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -742,6 +742,500 @@ void HashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
 
 #undef HASHMAP_DUMMY_NODE
 
+/**
+ * FlatHashMap<Key,Val> is a drop-in alternative to HashMap<Key,Val>, with
+ * the same API and requirements on Key and Val.
+ *
+ * Instead of allocating a node per element, keys and values are stored inline
+ * in a single array, using open addressing with Robin Hood linear probing.
+ * Next to each element its hash is kept, so most mismatches are rejected
+ * without comparing keys, and erasing shifts the following elements back
+ * instead of leaving dummy nodes behind. This mostly pays off for large maps
+ * and maps with expensive keys such as strings, where HashMap spends its time
+ * on cache misses and key comparisons. It comes with some differences to
+ * HashMap though:
+ *
+ * - Inserting an element may move all others, so it invalidates references
+ *   to values and all iterators.
+ * - Erasing an element may move others, so it invalidates all iterators.
+ *   Do not erase elements while iterating over the map.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Val _value;
+		const Key _key;
+		explicit Node(const Key &key) : _key(key), _value() {}
+		Node(const Key &key, const Val &value) : _key(key), _value(value) {}
+		Node(Key &&key, Val &&value) : _key(Common::move(key)), _value(Common::move(value)) {}
+	};
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> HM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// Robin Hood probing keeps probe sequences short up to a higher
+		// load factor than HashMap uses, see there for their meaning.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	/**
+	 * A slot of the hashtable. The node is only constructed if the slot is
+	 * in use, slots are allocated and freed as raw memory.
+	 */
+	struct Slot {
+		uint32 _hash;           ///< Scrambled hash of the key, 0 for free slots
+		union {
+			Node _node;
+		};
+	};
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	Slot *_storage;
+	size_type _mask;        ///< Capacity of the FlatHashMap minus one; capacity must be a power of two
+	size_type _size;
+	uint _shift;            ///< Shift turning a scrambled hash into its home slot
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Returned by lookup() if the key is not in the map. */
+	size_type none() const { return _mask + 1; }
+
+	uint32 scrambleHash(const Key &key) const {
+		// Fibonacci hashing spreads hash functions which return the key
+		// itself, as most of the integer ones do. The home slot is taken
+		// from the top bits, which keeps 0 free to mark unused slots.
+		uint32 hash = (uint32)_hash(key) * 2654435769U;
+		return hash ? hash : 1;
+	}
+
+	/** Return how far the element in slot @p ctr is away from its home slot. */
+	size_type distance(size_type ctr, uint32 hash) const {
+		return (ctr - (hash >> _shift)) & _mask;
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const HM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type reserveSlot(uint32 hash);
+	size_type lookupAndCreateIfMissing(const Key &key);
+	void expandStorage(size_type newCapacity);
+	void moveNode(size_type from, size_type to);
+	void eraseSlot(size_type idx);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_storage[_idx]._hash != 0);
+			return &_hashmap->_storage[_idx]._node;
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && _hashmap->_storage[_idx]._hash == 0);
+			if (_idx > _hashmap->_mask)
+				_idx = (size_type)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const HM_t &map);
+	~FlatHashMap();
+
+	HM_t &operator=(const HM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const {
+		return lookup(key) != none();
+	}
+
+	Val &operator[](const Key &key) { return getOrCreateVal(key); }
+	const Val &operator[](const Key &key) const { return getVal(key); }
+
+	Val &getOrCreateVal(const Key &key) {
+		// Creating the value may reallocate the storage, so look it up first
+		size_type ctr = lookupAndCreateIfMissing(key);
+		return _storage[ctr]._node._value;
+	}
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getValOrDefault(const Key &key) const {
+		return getValOrDefault(key, _defaultVal);
+	}
+	const Val &getValOrDefault(const Key &key, const Val &defaultVal) const {
+		size_type ctr = lookup(key);
+		return ctr != none() ? _storage[ctr]._node._value : defaultVal;
+	}
+	bool tryGetVal(const Key &key, Val &out) const {
+		size_type ctr = lookup(key);
+		if (ctr == none())
+			return false;
+		out = _storage[ctr]._node._value;
+		return true;
+	}
+	void setVal(const Key &key, const Val &val) {
+		size_type ctr = lookupAndCreateIfMissing(key);
+		_storage[ctr]._node._value = val;
+	}
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry) {
+		// Check whether we have a valid iterator
+		assert(entry._hashmap == this);
+		assert(entry._idx <= _mask);
+		assert(_storage[entry._idx]._hash != 0);
+		eraseSlot(entry._idx);
+	}
+	void erase(const Key &key) {
+		size_type ctr = lookup(key);
+		if (ctr != none())
+			eraseSlot(ctr);
+	}
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_storage[ctr]._hash)
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (_storage[ctr]._hash)
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (ctr != none())
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (ctr != none())
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const HM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+/**
+ * Internal method for allocating empty storage. The previous storage is
+ * *not* freed here -- the caller is responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_mask = capacity - 1;
+	_size = 0;
+	_shift = 32;
+	for (size_type c = capacity; c > 1; c >>= 1)
+		_shift--;
+
+	_storage = (Slot *)malloc(capacity * sizeof(Slot));
+	if (!_storage)
+		error("FlatHashMap: Failed to allocate storage for %u elements", capacity);
+	for (size_type ctr = 0; ctr < capacity; ++ctr)
+		_storage[ctr]._hash = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_storage[ctr]._hash)
+			_storage[ctr]._node.~Node();
+	}
+	free(_storage);
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note The previous storage here is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// Both maps hash the same way, so the layout can simply be cloned
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		const Slot &slot = map._storage[ctr];
+		if (slot._hash) {
+			new ((void *)&_storage[ctr]._node) Node(slot._node._key, slot._node._value);
+			_storage[ctr]._hash = slot._hash;
+		}
+	}
+	_size = map._size;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_storage[ctr]._hash) {
+			_storage[ctr]._node.~Node();
+			_storage[ctr]._hash = 0;
+		}
+	}
+	_size = 0;
+}
+
+/**
+ * Internal method moving the element in slot @p from into the free slot @p to.
+ * Slot @p from is left free.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::moveNode(size_type from, size_type to) {
+	Node &node = _storage[from]._node;
+	new ((void *)&_storage[to]._node) Node(Common::move(const_cast<Key &>(node._key)), Common::move(node._value));
+	node.~Node();
+	_storage[to]._hash = _storage[from]._hash;
+	_storage[from]._hash = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity > _mask + 1);
+
+	const size_type old_size = _size;
+	const size_type old_mask = _mask;
+	Slot *old_storage = _storage;
+
+	allocStorage(newCapacity);
+
+	// Move all the old elements over. They are distinct, so they can be
+	// put in place without comparing any keys.
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		Slot &slot = old_storage[ctr];
+		if (!slot._hash)
+			continue;
+
+		size_type idx = reserveSlot(slot._hash);
+		new ((void *)&_storage[idx]._node) Node(Common::move(const_cast<Key &>(slot._node._key)), Common::move(slot._node._value));
+		slot._node.~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == old_size);
+
+	free(old_storage);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	const uint32 hash = scrambleHash(key);
+	size_type ctr = hash >> _shift;
+
+	// The elements of a probe sequence are ordered by their distance to
+	// their home slot, so the search can stop as soon as an element is
+	// closer to its home slot than the key would be.
+	for (size_type dist = 0; ; dist++) {
+		const uint32 slotHash = _storage[ctr]._hash;
+		if (!slotHash || distance(ctr, slotHash) < dist)
+			return none();
+		if (slotHash == hash && _equal(_storage[ctr]._node._key, key))
+			return ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+}
+
+/**
+ * Internal method reserving the slot for a key with the given scrambled hash,
+ * which is not in the map yet. The elements behind it are shifted to keep the
+ * probe sequences ordered. The node in the returned slot is not constructed
+ * yet and the size is not updated.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserveSlot(uint32 hash) {
+	size_type ctr = hash >> _shift;
+	for (size_type dist = 0; _storage[ctr]._hash && distance(ctr, _storage[ctr]._hash) >= dist; dist++)
+		ctr = (ctr + 1) & _mask;
+
+	// Move the rest of the cluster back by one slot
+	size_type last = ctr;
+	while (_storage[last]._hash)
+		last = (last + 1) & _mask;
+
+	while (last != ctr) {
+		size_type prev = (last - 1) & _mask;
+		moveNode(prev, last);
+		last = prev;
+	}
+
+	_storage[ctr]._hash = hash;
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != none())
+		return ctr;
+
+	// Keep the load factor below a certain threshold.
+	size_type capacity = _mask + 1;
+	if ((_size + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		expandStorage(capacity * 2);
+
+	ctr = reserveSlot(scrambleHash(key));
+	new ((void *)&_storage[ctr]._node) Node(key);
+	_size++;
+	return ctr;
+}
+
+/**
+ * Internal method erasing the element in slot @p idx. The elements behind it
+ * are shifted back, so no dummy marker is needed.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type idx) {
+	_storage[idx]._node.~Node();
+	_storage[idx]._hash = 0;
+	_size--;
+
+	size_type next = (idx + 1) & _mask;
+	while (_storage[next]._hash && distance(next, _storage[next]._hash) != 0) {
+		moveNode(next, idx);
+		idx = next;
+		next = (next + 1) & _mask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != none())
+		return _storage[ctr]._node._value;
+	else
+		// See comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	size_type ctr = lookup(key);
+	if (ctr != none())
+		return _storage[ctr]._node._value;
+	else
+		// See comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
 /** @} */
 
 } // End of namespace Common
@@ -792,6 +792,22 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Obtain a pointer to the whole contents of the stream, for streams
+	 * which keep them in memory, such as memory streams. Some file streams
+	 * map the file into memory when this is first called.
+	 *
+	 * This allows reading the data without copying it. The pointer remains
+	 * valid for as long as the stream exists, and does not depend on the
+	 * stream position. Only use it for read-only data, such as game files:
+	 * accessing a mapped file after it was truncated, or after its medium
+	 * went away, crashes instead of returning a read error.
+	 *
+	 * @return Pointer to size() bytes, or nullptr if the stream does not
+	 *         support direct access.
+	 */
+	virtual const byte *getMappedData() const { return nullptr; }
+
 	/**
 	 * Read at most one less than the number of characters specified
 	 * by @p bufSize from the stream and store them in the string buffer.
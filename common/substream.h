@@ -86,6 +86,11 @@ public:
 	virtual int64 size() const { return _end - _begin; }
 
 	virtual bool seek(int64 offset, int whence = SEEK_SET);
+
+	virtual const byte *getMappedData() const {
+		const byte *data = _parentStream->getMappedData();
+		return data ? data + _begin : nullptr;
+	}
 };
 
 /**
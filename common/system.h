@@ -55,6 +55,8 @@ class Store;
 namespace Common {
 class EventManager;
 class MutexInternal;
+class ThreadInternal;
+class SemaphoreInternal;
 struct Rect;
 class SaveFileManager;
 class SearchSet;
@@ -1586,6 +1588,10 @@ public:
 	 *
 	 * Hence, backends that do not use threads to implement the timers can simply
 	 * use dummy implementations for these methods.
+	 *
+	 * Some CPU heavy subsystems can additionally spread their work across
+	 * threads with Common::runTasks(). This is optional: backends that do not
+	 * implement createThread() run that work on the calling thread instead.
 	 */
 
 	/**
@@ -1595,6 +1601,32 @@ public:
 	 */
 	virtual Common::MutexInternal *createMutex() = 0;
 
+	/**
+	 * Create a new thread running @p proc with @p param.
+	 *
+	 * The caller has to wait for the returned thread and delete it.
+	 * Use Common::runTasks() rather than calling this directly.
+	 *
+	 * @return The newly created thread, or nullptr if threads are not
+	 *         supported or an error occurred.
+	 */
+	virtual Common::ThreadInternal *createThread(void (*proc)(void *param), void *param) { return nullptr; }
+
+	/**
+	 * Create a new semaphore with a count of 0, which threads created with
+	 * createThread() can wait on.
+	 *
+	 * @return The newly created semaphore, or nullptr if threads are not
+	 *         supported or an error occurred.
+	 */
+	virtual Common::SemaphoreInternal *createSemaphore() { return nullptr; }
+
+	/**
+	 * Return the number of logical CPUs threads created with createThread()
+	 * can run on.
+	 */
+	virtual uint getCpuCount() { return 1; }
+
 	/** @} */
 
 
@@ -0,0 +1,195 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/thread.h"
+#include "common/array.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+namespace {
+
+struct TaskQueue {
+	TaskProc proc;
+	void *param;
+	uint numTasks;
+	uint nextTask;
+	Mutex mutex;
+};
+
+void runTaskQueue(void *param) {
+	TaskQueue *queue = (TaskQueue *)param;
+
+	for (;;) {
+		uint task;
+		{
+			StackLock lock(queue->mutex);
+			task = queue->nextTask++;
+		}
+		if (task >= queue->numTasks)
+			break;
+
+		queue->proc(queue->param, task);
+	}
+}
+
+class WorkerPool {
+public:
+	WorkerPool() : _queue(nullptr), _busy(false), _quit(false) {
+		_start = g_system->createSemaphore();
+		_done = g_system->createSemaphore();
+	}
+
+	~WorkerPool() {
+		stop();
+		delete _start;
+		delete _done;
+	}
+
+	/**
+	 * Run the queue on the calling thread and on up to numWorkers workers.
+	 * Returns false without running anything if the pool is busy.
+	 */
+	bool run(TaskQueue &queue, uint numWorkers) {
+		if (!_start || !_done)
+			return false;
+
+		{
+			StackLock lock(_mutex);
+			if (_busy)
+				return false;
+			_busy = true;
+		}
+
+		// If the backend fails to create a thread, the remaining ones
+		// simply pick up more tasks
+		while (_workers.size() < numWorkers) {
+			ThreadInternal *worker = g_system->createThread(workerProc, this);
+			if (!worker)
+				break;
+			_workers.push_back(worker);
+		}
+		numWorkers = MIN<uint>(numWorkers, _workers.size());
+
+		_queue = &queue;
+		for (uint i = 0; i < numWorkers; i++)
+			_start->post();
+
+		runTaskQueue(&queue);
+
+		for (uint i = 0; i < numWorkers; i++)
+			_done->wait();
+		_queue = nullptr;
+
+		StackLock lock(_mutex);
+		_busy = false;
+		return true;
+	}
+
+	void stop() {
+		StackLock lock(_mutex);
+		assert(!_busy);
+
+		_quit = true;
+		for (uint i = 0; i < _workers.size(); i++)
+			_start->post();
+		for (uint i = 0; i < _workers.size(); i++) {
+			_workers[i]->wait();
+			delete _workers[i];
+		}
+		_workers.clear();
+		_quit = false;
+	}
+
+private:
+	static void workerProc(void *param) {
+		WorkerPool *pool = (WorkerPool *)param;
+
+		for (;;) {
+			pool->_start->wait();
+			if (pool->_quit)
+				break;
+
+			runTaskQueue(pool->_queue);
+			pool->_done->post();
+		}
+	}
+
+	Array<ThreadInternal *> _workers;
+	SemaphoreInternal *_start;
+	SemaphoreInternal *_done;
+	TaskQueue *_queue;
+	Mutex _mutex;
+	bool _busy;
+	bool _quit;
+};
+
+// Created on first use, as it needs the backend, and deleted by
+// shutdownThreads()
+WorkerPool *g_workerPool = nullptr;
+
+Mutex &getWorkerPoolMutex() {
+	static Mutex *mutex = new Mutex();
+	return *mutex;
+}
+
+WorkerPool *getWorkerPool() {
+	StackLock lock(getWorkerPoolMutex());
+	if (!g_workerPool)
+		g_workerPool = new WorkerPool();
+	return g_workerPool;
+}
+
+} // End of anonymous namespace
+
+uint getMaxThreads() {
+	return MAX<uint>(g_system->getCpuCount(), 1);
+}
+
+void runTasks(TaskProc proc, void *param, uint numTasks, uint maxThreads) {
+	if (maxThreads == 0)
+		maxThreads = getMaxThreads();
+
+	uint numThreads = MIN(maxThreads, numTasks);
+	if (numThreads > 1) {
+		TaskQueue queue;
+		queue.proc = proc;
+		queue.param = param;
+		queue.numTasks = numTasks;
+		queue.nextTask = 0;
+
+		// The calling thread works on the queue as well, so one worker
+		// less is needed
+		if (getWorkerPool()->run(queue, numThreads - 1))
+			return;
+	}
+
+	for (uint i = 0; i < numTasks; i++)
+		proc(param, i);
+}
+
+void shutdownThreads() {
+	StackLock lock(getWorkerPoolMutex());
+	delete g_workerPool;
+	g_workerPool = nullptr;
+}
+
+} // End of namespace Common
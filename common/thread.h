@@ -0,0 +1,98 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_thread Threads
+ * @ingroup common
+ *
+ * @brief API for spreading work across backend threads.
+ *
+ * Threads are an optional backend feature. Code using them must always
+ * be able to do the same work on the calling thread, which is what
+ * runTasks() does when OSystem::createThread() is not supported.
+ * @{
+ */
+
+class ThreadInternal {
+public:
+	virtual ~ThreadInternal() {}
+
+	/** Block until the thread procedure has returned. */
+	virtual void wait() = 0;
+};
+
+class SemaphoreInternal {
+public:
+	virtual ~SemaphoreInternal() {}
+
+	/** Block until the count is above 0, then decrement it. */
+	virtual void wait() = 0;
+
+	/** Increment the count, waking up one of the waiting threads. */
+	virtual void post() = 0;
+};
+
+/** Type definition of a task run by runTasks(). */
+typedef void (*TaskProc)(void *param, uint task);
+
+/**
+ * Return the number of threads runTasks() uses by default, which is
+ * 1 if the backend does not support threads.
+ */
+uint getMaxThreads();
+
+/**
+ * Run @p proc for every task in [0, numTasks) and return once all of them
+ * are done. The tasks are spread across up to @p maxThreads threads, the
+ * calling one included, so they must not depend on each other.
+ *
+ * The other threads are workers which are created the first time they are
+ * needed, and then wait for more tasks until shutdownThreads() is called.
+ * While they are busy, e.g. when a task calls runTasks() again, the tasks
+ * are run on the calling thread.
+ *
+ * @param proc       The procedure to run for each task.
+ * @param param      User data passed to @p proc.
+ * @param numTasks   The number of tasks to run.
+ * @param maxThreads The maximum number of threads to use, or 0 to use
+ *                   getMaxThreads().
+ */
+void runTasks(TaskProc proc, void *param, uint numTasks, uint maxThreads = 0);
+
+/**
+ * Stop the worker threads used by runTasks(). This must be called before
+ * the backend is destroyed.
+ */
+void shutdownThreads();
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -69,6 +69,19 @@ public:
 	 * of this callback will be running anymore.
 	 */
 	virtual void removeTimerProc(TimerProc proc) = 0;
+
+	/**
+	 * Mark the given timer callback as slow, so that it does not delay the
+	 * other timers.
+	 *
+	 * Depending on the backend, such a callback may be run on a thread of its
+	 * own, and it must then not install or remove timers itself. Backends
+	 * without support for this run it like any other timer.
+	 *
+	 * @param proc   Installed timer callback.
+	 * @param heavy  Whether the callback is slow.
+	 */
+	virtual void setHeavyTimerProc(TimerProc proc, bool heavy) {}
 };
 
 /** @} */
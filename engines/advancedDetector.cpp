@@ -28,8 +28,10 @@
 #include "common/md5.h"
 #include "common/config-manager.h"
 #include "common/punycode.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/thread.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
 #include "common/compression/clickteam.h"
@@ -407,6 +409,10 @@ Common::Error AdvancedMetaEngineDetectionBase::identifyGame(DetectedGame &game,
 
 	// Detection is done, no need to keep archives in memory anymore
 	ADCacheMan.clearArchives();
+	ADCacheMan.clearDirectories();
+
+	debugC(2, kDebugGlobalDetection, "MD5 cache: %u hits, %u misses", ADCacheMan.getPersistentHits(), ADCacheMan.getPersistentMisses());
+	ADCacheMan.flushPersistentCache(true);
 
 	if (!agdDesc.desc)
 		return Common::kNoGameDataFoundError;
@@ -442,7 +448,7 @@ void AdvancedMetaEngineDetectionBase::composeFileHashMap(FileMap &allFiles, cons
 				continue;
 
 			Common::FSList files;
-			if (!file->getChildren(files, Common::FSNode::kListAll))
+			if (!ADCacheMan.getChildren(*file, files))
 				continue;
 
 			composeFileHashMap(allFiles, files, depth - 1, tstr);
@@ -468,6 +474,169 @@ namespace Common {
 	DECLARE_SINGLETON(AdvancedDetectorCacheManager);
 }
 
+#define MD5CACHE_FILENAME "md5cache.dat"
+#define MD5CACHE_VERSION 1
+
+// Entries not used during this many sessions are dropped
+#define MD5CACHE_MAX_AGE 64
+
+// Minimum time between two writes of the cache which are not forced
+#define MD5CACHE_FLUSH_INTERVAL 10000
+
+bool AdvancedDetectorCacheManager::isPersistentCacheEnabled() const {
+	// Detection from the command line runs before the backend is set up,
+	// so there is no savefile manager to store the cache with yet.
+	if (!g_system->getSavefileManager())
+		return false;
+
+	return ConfMan.hasKey("md5_cache") ? ConfMan.getBool("md5_cache") : true;
+}
+
+void AdvancedDetectorCacheManager::loadPersistentCache() {
+	persistentLoaded = true;
+
+	Common::ScopedPtr<Common::InSaveFile> file(g_system->getSavefileManager()->openForLoading(MD5CACHE_FILENAME));
+	if (!file)
+		return;
+
+	if (file->readUint32BE() != MKTAG('M', 'D', '5', 'C') || file->readUint32LE() != MD5CACHE_VERSION) {
+		debugC(2, kDebugGlobalDetection, "Discarding MD5 cache of unknown version");
+		return;
+	}
+
+	persistentSession = file->readUint32LE() + 1;
+	uint32 count = file->readUint32LE();
+
+	for (uint32 i = 0; i < count; i++) {
+		Common::String key = file->readString();
+		PersistentEntry entry;
+		entry.fileSize = file->readSint64LE();
+		entry.modificationTime = file->readSint64LE();
+		entry.props.size = file->readSint64LE();
+		entry.props.md5prop = (MD5Properties)file->readUint32LE();
+		entry.props.md5 = file->readString();
+		entry.lastUsed = file->readUint32LE();
+
+		if (file->err() || file->eos()) {
+			warning("Truncated MD5 cache, ignoring the rest of it");
+			break;
+		}
+
+		if (persistentSession - entry.lastUsed <= MD5CACHE_MAX_AGE)
+			persistentHashMap.setVal(key, entry);
+		else
+			persistentDirty = true;
+	}
+
+	debugC(2, kDebugGlobalDetection, "Loaded %u entries from the MD5 cache", persistentHashMap.size());
+}
+
+bool AdvancedDetectorCacheManager::getPersistentMD5(const Common::String &key, int64 fileSize, int64 modificationTime, FileProperties &fileProps) {
+	Common::StackLock lock(mutex);
+
+	if (!persistentLoaded)
+		loadPersistentCache();
+
+	PersistentHashMap::iterator entry = persistentHashMap.find(key);
+	if (entry == persistentHashMap.end() || entry->_value.fileSize != fileSize || entry->_value.modificationTime != modificationTime) {
+		persistentMisses++;
+		return false;
+	}
+
+	persistentHits++;
+	fileProps = entry->_value.props;
+	if (entry->_value.lastUsed != persistentSession) {
+		entry->_value.lastUsed = persistentSession;
+		persistentDirty = true;
+	}
+	return true;
+}
+
+void AdvancedDetectorCacheManager::setPersistentMD5(const Common::String &key, int64 fileSize, int64 modificationTime, const FileProperties &fileProps) {
+	Common::StackLock lock(mutex);
+
+	if (!persistentLoaded)
+		loadPersistentCache();
+
+	PersistentEntry entry;
+	entry.fileSize = fileSize;
+	entry.modificationTime = modificationTime;
+	entry.props = fileProps;
+	entry.lastUsed = persistentSession;
+	persistentHashMap.setVal(key, entry);
+	persistentDirty = true;
+}
+
+void AdvancedDetectorCacheManager::flushPersistentCache(bool force) {
+	if (!persistentDirty)
+		return;
+
+	uint32 time = g_system->getMillis();
+	if (!force && time - lastPersistentFlush < MD5CACHE_FLUSH_INTERVAL)
+		return;
+
+	Common::ScopedPtr<Common::OutSaveFile> file(g_system->getSavefileManager()->openForSaving(MD5CACHE_FILENAME));
+	if (!file) {
+		warning("Could not write the MD5 cache");
+		return;
+	}
+
+	file->writeUint32BE(MKTAG('M', 'D', '5', 'C'));
+	file->writeUint32LE(MD5CACHE_VERSION);
+	file->writeUint32LE(persistentSession);
+	file->writeUint32LE(persistentHashMap.size());
+
+	for (PersistentHashMap::const_iterator i = persistentHashMap.begin(); i != persistentHashMap.end(); ++i) {
+		file->writeString(i->_key);
+		file->writeByte(0);
+		file->writeSint64LE(i->_value.fileSize);
+		file->writeSint64LE(i->_value.modificationTime);
+		file->writeSint64LE(i->_value.props.size);
+		file->writeUint32LE(i->_value.props.md5prop);
+		file->writeString(i->_value.props.md5);
+		file->writeByte(0);
+		file->writeUint32LE(i->_value.lastUsed);
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("Could not write the MD5 cache");
+
+	persistentDirty = false;
+	lastPersistentFlush = time;
+}
+
+/**
+ * Find the file on disk which contains the data of @p fname, and build the
+ * key of its persistent MD5 cache entry.
+ *
+ * @return false if the file can not be cached persistently.
+ */
+static bool getPersistentCacheKey(uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname,
+								  Common::String &key, int64 &fileSize, int64 &modificationTime) {
+	// Mac forks can be spread over several files, e.g. AppleDouble ones,
+	// so their modification can not be checked with a single file.
+	if (md5prop & (kMD5MacResFork | kMD5MacDataFork))
+		return false;
+
+	Common::Path diskName = fname;
+	if (md5prop & kMD5Archive) {
+		// Archive members are checked by the archive
+		Common::StringTokenizer tok(fname.toString(), ":");
+		tok.nextToken();
+		diskName = Common::Path(tok.nextToken());
+	}
+
+	AdvancedMetaEngineBase::FileMap::const_iterator file = allFiles.find(diskName);
+	if (file == allFiles.end() || !file->_value.getFileStats(fileSize, modificationTime))
+		return false;
+
+	key = Common::String::format("%s:%s:%s:%u", md5PropToCachePrefix(md5prop).c_str(),
+	                             file->_value.getPath().toString(Common::Path::kNativeSeparator).c_str(),
+	                             fname.toString('/').c_str(), md5Bytes);
+	return true;
+}
+
 
 static MD5Properties gameFileToMD5Props(const ADGameFileDescription *fileEntry, uint32 gameFlags) {
 	MD5Properties ret = kMD5Head;
@@ -532,12 +701,17 @@ Common::String md5PropToGameFile(MD5Properties flags) {
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps);
 
-bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+static Common::String getMD5CacheKey(uint md5Bytes, MD5Properties md5prop, const Common::Path &fname) {
 	Common::String hashname = md5PropToCachePrefix(md5prop);
 		hashname += ':';
 		hashname += fname.toString('/');
 		hashname += ':';
-		hashname += Common::String::format("%d", _md5Bytes);
+		hashname += Common::String::format("%d", md5Bytes);
+	return hashname;
+}
+
+static bool getCachedFileProperties(uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) {
+	Common::String hashname = getMD5CacheKey(md5Bytes, md5prop, fname);
 
 	if (ADCacheMan.containsMD5(hashname)) {
 		fileProps.md5 = ADCacheMan.getMD5(hashname);
@@ -545,16 +719,129 @@ bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles,
 		return true;
 	}
 
-	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
+	Common::String persistentKey;
+	int64 fileSize, modificationTime;
+	if (ADCacheMan.isPersistentCacheEnabled() &&
+			getPersistentCacheKey(md5Bytes, allFiles, md5prop, fname, persistentKey, fileSize, modificationTime)) {
+		if (ADCacheMan.getPersistentMD5(persistentKey, fileSize, modificationTime, fileProps)) {
+			ADCacheMan.setMD5(hashname, fileProps.md5);
+			ADCacheMan.setSize(hashname, fileProps.size);
+			return true;
+		}
+	}
+
+	bool res = getFilePropertiesIntern(md5Bytes, allFiles, md5prop, fname, fileProps);
 
 	if (res) {
 		ADCacheMan.setMD5(hashname, fileProps.md5);
 		ADCacheMan.setSize(hashname, fileProps.size);
+
+		if (!persistentKey.empty())
+			ADCacheMan.setPersistentMD5(persistentKey, fileSize, modificationTime, fileProps);
 	}
 
 	return res;
 }
 
+bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+	return getCachedFileProperties(_md5Bytes, allFiles, md5prop, fname, fileProps);
+}
+
+void AdvancedMetaEngineDetectionBase::queueDetectionReads(const Common::FSList &fslist) {
+	if (fslist.empty())
+		return;
+
+	preprocessDescriptions();
+
+	FileMap allFiles;
+	composeFileHashMap(allFiles, fslist, (_maxScanDepth == 0 ? 1 : _maxScanDepth));
+
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			MD5Properties md5prop = gameFileToMD5Props(fileDesc, g->flags);
+
+			// Archives are shared by all engines, and Mac forks may be
+			// spread over several files, so those are read by detectGames()
+			if (md5prop & (kMD5Archive | kMD5MacMask))
+				continue;
+
+			Common::Path fname(fileDesc->fileName);
+			if (allFiles.contains(fname))
+				ADCacheMan.queueRead(getMD5CacheKey(_md5Bytes, md5prop, fname), _md5Bytes, allFiles, md5prop, fname);
+		}
+	}
+}
+
+bool AdvancedDetectorCacheManager::getChildren(const Common::FSNode &dir, Common::FSList &files) {
+	DirectoryHashMap::const_iterator entry = directoryHashMap.find(dir.getPath());
+	if (entry != directoryHashMap.end()) {
+		files = entry->_value;
+		return true;
+	}
+
+	if (!dir.getChildren(files, Common::FSNode::kListAll))
+		return false;
+
+	directoryHashMap.setVal(dir.getPath(), files);
+	return true;
+}
+
+void AdvancedDetectorCacheManager::queueRead(const Common::String &hashname, uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname) {
+	if (containsMD5(hashname))
+		return;
+
+	const Common::FSNode &node = allFiles[fname];
+	Common::String path = node.getPath().toString(Common::Path::kNativeSeparator);
+
+	uint index;
+	if (readQueueIndex.tryGetVal(path, index)) {
+		for (const QueuedRead &read : readQueue[index]) {
+			if (read.hashname == hashname)
+				return;
+		}
+	} else {
+		index = readQueue.size();
+		readQueue.resize(index + 1);
+		readQueueIndex.setVal(path, index);
+	}
+
+	QueuedRead read;
+	read.hashname = hashname;
+	read.md5Bytes = md5Bytes;
+	read.md5prop = md5prop;
+	read.fname = fname;
+	read.files.setVal(fname, node);
+	readQueue[index].push_back(read);
+}
+
+void AdvancedDetectorCacheManager::runQueuedReadsTask(void *param, uint task) {
+	const QueuedReadList &reads = ((AdvancedDetectorCacheManager *)param)->readQueue[task];
+
+	for (const QueuedRead &read : reads) {
+		FileProperties fileProps;
+		getCachedFileProperties(read.md5Bytes, read.files, read.md5prop, read.fname, fileProps);
+	}
+}
+
+void AdvancedDetectorCacheManager::runQueuedReads(uint maxThreads) {
+	if (readQueue.empty())
+		return;
+
+	debugC(3, kDebugGlobalDetection, "Reading %u queued files", readQueue.size());
+
+	// Load the persistent cache here, as the savefile manager must not be
+	// used by the worker threads
+	if (!persistentLoaded && isPersistentCacheEnabled())
+		loadPersistentCache();
+
+	Common::runTasks(&runQueuedReadsTask, this, readQueue.size(), maxThreads);
+
+	readQueue.clear();
+	readQueueIndex.clear(true);
+}
+
 bool AdvancedMetaEngineBase::getFilePropertiesExtern(uint md5Bytes, const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
 	return getFilePropertiesIntern(md5Bytes, allFiles, md5prop, fname, fileProps);
 }
@@ -26,6 +26,7 @@
 #include "engines/engine.h"
 
 #include "common/hash-str.h"
+#include "common/mutex.h"
 
 #include "common/gui_options.h" // Keep it here, so detection tables can refer to them
 
@@ -508,6 +509,13 @@ public:
 	 */
 	DetectedGames detectGames(const Common::FSList &fslist, uint32 skipADFlags, bool skipIncomplete) override;
 
+	/**
+	 * Queue the plain files of the detection entries which are present in
+	 * @p fslist in the MD5 cache. Files in archives and Mac forks are left to
+	 * detectGames().
+	 */
+	void queueDetectionReads(const Common::FSList &fslist) override;
+
 	uint getMD5Bytes() const override final { return _md5Bytes; }
 
 	int getGameVariantCount() const override final {
@@ -726,26 +734,37 @@ private:
 
 /**
  * Singleton Cache Storage for Computed MD5s and Open Archives
+ *
+ * Besides the MD5s computed during the current detection, the MD5s of files
+ * on disk are kept in a persistent cache, so detecting unchanged files again
+ * does not have to read them. Its entries are keyed on the full path of the
+ * file and the MD5 properties, and are only used as long as the size and the
+ * modification time of the file stay the same.
  */
 class AdvancedDetectorCacheManager : public Common::Singleton<AdvancedDetectorCacheManager> {
 public:
 	void setMD5(const Common::String &fname, const Common::String &md5) {
+		Common::StackLock lock(mutex);
 		md5HashMap.setVal(fname, md5);
 	}
 
-	const Common::String &getMD5(const Common::String &fname) const {
+	Common::String getMD5(const Common::String &fname) const {
+		Common::StackLock lock(mutex);
 		return md5HashMap.getVal(fname);
 	}
 
 	void setSize(const Common::String &fname, int64 size) {
+		Common::StackLock lock(mutex);
 		sizeHashMap.setVal(fname, size);
 	}
 
 	int64 getSize(const Common::String &fname) const {
+		Common::StackLock lock(mutex);
 		return sizeHashMap.getVal(fname);
 	}
 
 	bool containsMD5(const Common::String &fname) const {
+		Common::StackLock lock(mutex);
 		return (md5HashMap.contains(fname) && sizeHashMap.contains(fname));
 	}
 
@@ -766,10 +785,61 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	/**
+	 * List the contents of a subdirectory which is part of the detection.
+	 * The listing is only done once per detection run, however many
+	 * engines look into the directory.
+	 */
+	bool getChildren(const Common::FSNode &dir, Common::FSList &files);
+
+	/**
+	 * Queue a file whose MD5 is going to be needed by the detection, so it
+	 * can be computed by runQueuedReads() along with the other ones.
+	 *
+	 * @param hashname  Key of the MD5 in the cache.
+	 * @param allFiles  Map containing the node of @p fname.
+	 */
+	void queueRead(const Common::String &hashname, uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname);
+
+	/**
+	 * Compute the MD5s of all queued files, spread over up to @p maxThreads
+	 * threads (0 for as many as there are CPUs). All MD5s of a file are
+	 * computed by the same thread, as file nodes must not be shared between
+	 * threads.
+	 */
+	void runQueuedReads(uint maxThreads);
+
+	AdvancedDetectorCacheManager() : persistentLoaded(false), persistentDirty(false), persistentSession(0), lastPersistentFlush(0) {
 		clear();
 	}
 
+	~AdvancedDetectorCacheManager() {
+		flushPersistentCache(true);
+		clearArchives();
+	}
+
+	/** Return whether the persistent MD5 cache is enabled in the configuration. */
+	bool isPersistentCacheEnabled() const;
+
+	/**
+	 * Look up the properties of a file in the persistent cache. Entries are
+	 * ignored if the file does not have the given size and modification time
+	 * anymore.
+	 */
+	bool getPersistentMD5(const Common::String &key, int64 fileSize, int64 modificationTime, FileProperties &fileProps);
+
+	void setPersistentMD5(const Common::String &key, int64 fileSize, int64 modificationTime, const FileProperties &fileProps);
+
+	/**
+	 * Write the persistent cache to disk if it changed. Unless @p force is
+	 * set, this is skipped if it was written only a few seconds ago, so mass
+	 * detection does not rewrite it after every directory.
+	 */
+	void flushPersistentCache(bool force = false);
+
+	uint getPersistentHits() const { return persistentHits; }
+	uint getPersistentMisses() const { return persistentMisses; }
+
 	void clearArchives() {
 		for (auto &entry : archiveHashMap) {
 			delete entry._value;
@@ -777,10 +847,18 @@ public:
 		archiveHashMap.clear(true);
 	}
 
+	void clearDirectories() {
+		directoryHashMap.clear(true);
+	}
+
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
 		clearArchives();
+		clearDirectories();
+		readQueue.clear();
+		readQueueIndex.clear(true);
+		persistentHits = persistentMisses = 0;
 	}
 
 private:
@@ -789,9 +867,49 @@ private:
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	typedef Common::HashMap<Common::Path, Common::Archive *, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> ArchiveHashMap;
+	typedef Common::HashMap<Common::Path, Common::FSList, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> DirectoryHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+	DirectoryHashMap directoryHashMap;
+
+	struct QueuedRead {
+		Common::String hashname;
+		uint md5Bytes;
+		MD5Properties md5prop;
+		Common::Path fname;
+		AdvancedMetaEngineBase::FileMap files;	///< The files needed to read @c fname
+	};
+
+	// Queued reads, grouped by the file on disk they read
+	typedef Common::Array<QueuedRead> QueuedReadList;
+	Common::Array<QueuedReadList> readQueue;
+	Common::HashMap<Common::String, uint> readQueueIndex;
+
+	static void runQueuedReadsTask(void *param, uint task);
+
+	// Protects the MD5 maps and the persistent cache, which are used by
+	// the threads of runQueuedReads()
+	mutable Common::Mutex mutex;
+
+	struct PersistentEntry {
+		int64 fileSize;
+		int64 modificationTime;
+		FileProperties props;
+		uint32 lastUsed;	///< Session in which the entry was used last
+	};
+
+	// Keyed on native paths, so they are compared case sensitively
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentHashMap;
+	PersistentHashMap persistentHashMap;
+	bool persistentLoaded;
+	bool persistentDirty;
+	uint32 persistentSession;
+	uint32 lastPersistentFlush;
+	uint persistentHits;
+	uint persistentMisses;
+
+	void loadPersistentCache();
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
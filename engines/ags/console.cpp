@@ -35,6 +35,7 @@ AGSConsole::AGSConsole(AGSEngine *vm) : GUI::Debugger(), _vm(vm), _logOutputTarg
 	registerCmd("ags_set_script_dump", WRAP_METHOD(AGSConsole, Cmd_SetScriptDump));
 	registerCmd("ags_sprite_info",   WRAP_METHOD(AGSConsole, Cmd_getSpriteInfo));
 	registerCmd("ags_sprite_dump",  WRAP_METHOD(AGSConsole, Cmd_dumpSprite));
+	registerCmd("ags_sprite_cache",  WRAP_METHOD(AGSConsole, Cmd_spriteCacheStats));
 
 	_logOutputTarget = new LogOutputTarget();
 	_agsDebuggerOutput = _GP(DbgMgr).RegisterOutput("ScummVMLog", _logOutputTarget, AGS3::AGS::Shared::kDbgMsg_None);
@@ -207,6 +208,20 @@ bool AGSConsole::Cmd_getSpriteInfo(int argc, const char **argv) {
 	return true;
 }
 
+bool AGSConsole::Cmd_spriteCacheStats(int argc, const char **argv) {
+	if (argc != 1) {
+		debugPrintf("Usage: %s\n", argv[0]);
+		return true;
+	}
+
+	const AGS3::AGS::Shared::SpriteCache::PrefetchStats &stats = _GP(spriteset).GetPrefetchStats();
+	debugPrintf("Cache: %u KB of %u KB, %u KB locked\n", (uint)(_GP(spriteset).GetCacheSize() / 1024),
+		(uint)(_GP(spriteset).GetMaxCacheSize() / 1024), (uint)(_GP(spriteset).GetLockedSize() / 1024));
+	debugPrintf("Prefetched: %u queued, %u used, %u wasted\n", stats.Queued, stats.Used, stats.Wasted);
+	debugPrintf("Stall time avoided: %u ms, waited: %u ms\n", stats.SavedMs, stats.WaitedMs);
+	return true;
+}
+
 bool AGSConsole::Cmd_dumpSprite(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Usage: %s SpriteNumber\n", argv[0]);
@@ -51,6 +51,7 @@
 #include "ags/engine/ac/walk_behind.h"
 #include "ags/engine/ac/dynobj/script_object.h"
 #include "ags/engine/ac/dynobj/script_hotspot.h"
+#include "ags/shared/gui/gui_button.h"
 #include "ags/shared/gui/gui_main.h"
 #include "ags/engine/script/cc_instance.h"
 #include "ags/engine/debugging/debug_log.h"
@@ -398,6 +399,35 @@ static void reset_temp_room() {
 	_GP(troom) = RoomStatus();
 }
 
+// Asks the sprite cache to decode the sprites which the new room is going
+// to show first: its objects, the characters standing in it, and the GUIs.
+static void prefetch_room_sprites(int newnum) {
+	std::vector<sprkey_t> sprites;
+	for (const auto &obj : _GP(thisroom).Objects)
+		sprites.push_back(obj.Sprite);
+	for (int i = 0; i < _GP(game).numcharacters; ++i) {
+		const CharacterInfo &chi = _GP(game).chars[i];
+		if (chi.room != newnum || chi.view < 0 || (size_t)chi.view >= _GP(views).size())
+			continue;
+		const ViewStruct &view = _GP(views)[chi.view];
+		if (chi.loop >= view.numLoops)
+			continue;
+		const ViewLoopNew &loop = view.loops[chi.loop];
+		for (int f = 0; f < loop.numFrames; ++f)
+			sprites.push_back(loop.frames[f].pic);
+	}
+	for (const auto &gui : _GP(guis)) {
+		if (gui.IsDisplayed())
+			sprites.push_back(gui.BgImage);
+	}
+	for (const auto &btn : _GP(guibuts)) {
+		if (btn.ParentId >= 0 && (size_t)btn.ParentId < _GP(guis).size() &&
+			_GP(guis)[btn.ParentId].IsDisplayed())
+			sprites.push_back(btn.Image);
+	}
+	_GP(spriteset).PrefetchSprites(sprites);
+}
+
 // forchar = playerchar on NewRoom, or NULL if restore saved game
 void load_new_room(int newnum, CharacterInfo *forchar) {
 
@@ -427,6 +457,7 @@ void load_new_room(int newnum, CharacterInfo *forchar) {
 	_G(our_eip) = 200;
 	_GP(thisroom).GameID = NO_GAME_ID_IN_ROOM_FILE;
 	load_room(room_filename, &_GP(thisroom), _GP(game).IsLegacyHiRes(), _GP(game).SpriteInfos);
+	prefetch_room_sprites(newnum);
 
 	if ((_GP(thisroom).GameID != NO_GAME_ID_IN_ROOM_FILE) &&
 	        (_GP(thisroom).GameID != _GP(game).uniqueid)) {
@@ -20,6 +20,7 @@
  */
 
 #include "common/debug-channels.h"
+#include "common/std/vector.h"
 #include "ags/shared/ac/common.h"
 #include "ags/engine/ac/dynobj/cc_dynamic_array.h"
 #include "ags/engine/ac/dynobj/managed_object_pool.h"
@@ -259,6 +260,8 @@ ccInstance::ccInstance() {
 	numimports = 0;
 	resolved_imports = nullptr;
 	code_fixups         = nullptr;
+	code_ops            = nullptr;
+	code_args           = nullptr;
 
 	memset(callStackLineNumber, 0, sizeof(callStackLineNumber));
 	memset(callStackAddr, 0, sizeof(callStackAddr));
@@ -409,6 +412,67 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
 	return cc_has_error();
 }
 
+bool ccInstance::ReadOperation(const ccInstance *codeInst, int32_t at_pc, ScriptOperation &op) {
+	op.Instruction.Code         = codeInst->code[at_pc];
+	op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+	op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+
+	if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS) {
+		cc_error("invalid instruction %d found in code stream", op.Instruction.Code);
+		return false;
+	}
+
+	op.ArgCount = (*g_commands)[op.Instruction.Code].ArgCount;
+	if (at_pc + op.ArgCount >= codeInst->codesize) {
+		cc_error("unexpected end of code data (%d; %d)", at_pc + op.ArgCount, codeInst->codesize);
+		return false;
+	}
+
+	int pc_at = at_pc + 1;
+	for (int i = 0; i < op.ArgCount; ++i, ++pc_at) {
+		char fixup = codeInst->code_fixups[pc_at];
+		if (fixup > 0) {
+			// could be relative pointer or import address
+			switch (fixup) {
+			case FIXUP_GLOBALDATA: {
+				ScriptVariable *gl_var = (ScriptVariable *)codeInst->code[pc_at];
+				op.Args[i].SetGlobalVar(&gl_var->RValue);
+			}
+			break;
+			case FIXUP_FUNCTION:
+				// originally commented -- CHECKME: could this be used in very old versions of AGS?
+				//      code[fixup] += (long)&code[0];
+				// This is a program counter value, presumably will be used as SCMD_CALL argument
+				op.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
+				break;
+			case FIXUP_STRING:
+				op.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
+				break;
+			case FIXUP_IMPORT: {
+				const ScriptImport *import = _GP(simp).getByIndex(static_cast<uint32_t>(codeInst->code[pc_at]));
+				if (import) {
+					op.Args[i] = import->Value;
+				} else {
+					cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
+					return false;
+				}
+			}
+			break;
+			case FIXUP_STACK:
+				op.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
+				break;
+			default:
+				cc_error("internal fixup type error: %d", fixup);
+				return false;
+			}
+		} else {
+			// should be a numeric literal (int32 or float)
+			op.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
+		}
+	}
+	return true;
+}
+
 // Macros to maintain the call stack
 #define PUSH_CALL_STACK \
 	if (callStackSize >= MAX_CALL_STACK) { \
@@ -429,6 +493,24 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
 	line_number = callStackLineNumber[callStackSize];\
 	_G(currentline) = line_number
 
+// With GCC and Clang, the interpreter jumps to the code of each instruction
+// through a table of label addresses rather than through the switch, which
+// saves the range check. There is still a single jump at the head of the
+// loop, which every instruction returns to with a break.
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER)
+#define AGS_SCRIPT_LABEL_DISPATCH
+#define SCRIPT_OP(code) case code: op_##code
+#define SCRIPT_OP_ADDR(code) &&op_##code
+#define SCRIPT_OP_DEFAULT default: op_invalid
+#define SCRIPT_OP_INVALID_ADDR &&op_invalid
+// Label addresses and computed gotos are GNU extensions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#else
+#define SCRIPT_OP(code) case code
+#define SCRIPT_OP_DEFAULT default
+#endif
+
 #define MAXNEST 50  // number of recursive function calls allowed
 int ccInstance::Run(int32_t curpc) {
 	pc = curpc;
@@ -450,11 +532,44 @@ int ccInstance::Run(int32_t curpc) {
 	bool write_debug_dump = ccGetOption(SCOPT_DEBUGRUN) ||
 		(gDebugLevel > 0 && DebugMan.isDebugChannelEnabled(::AGS::kDebugScript));
 	ScriptOperation codeOp;
+	bool args_are_literals = false;
 	FunctionCallStack func_callstack;
 	int loopIterationCheckDisabled = 0;
 	unsigned loopIterations = 0u;      // any loop iterations (needed for timeout test)
 	unsigned loopCheckIterations = 0u; // loop iterations accumulated only if check is enabled
 
+#ifdef AGS_SCRIPT_LABEL_DISPATCH
+	// Jump straight to the code of each instruction, indexed by instruction code
+	static const void *const dispatch_table[CC_NUM_SCCMDS] = {
+		SCRIPT_OP_INVALID_ADDR, SCRIPT_OP_ADDR(SCMD_ADD), SCRIPT_OP_ADDR(SCMD_SUB),
+		SCRIPT_OP_ADDR(SCMD_REGTOREG), SCRIPT_OP_ADDR(SCMD_WRITELIT), SCRIPT_OP_ADDR(SCMD_RET),
+		SCRIPT_OP_ADDR(SCMD_LITTOREG), SCRIPT_OP_ADDR(SCMD_MEMREAD), SCRIPT_OP_ADDR(SCMD_MEMWRITE),
+		SCRIPT_OP_ADDR(SCMD_MULREG), SCRIPT_OP_ADDR(SCMD_DIVREG), SCRIPT_OP_ADDR(SCMD_ADDREG),
+		SCRIPT_OP_ADDR(SCMD_SUBREG), SCRIPT_OP_ADDR(SCMD_BITAND), SCRIPT_OP_ADDR(SCMD_BITOR),
+		SCRIPT_OP_ADDR(SCMD_ISEQUAL), SCRIPT_OP_ADDR(SCMD_NOTEQUAL), SCRIPT_OP_ADDR(SCMD_GREATER),
+		SCRIPT_OP_ADDR(SCMD_LESSTHAN), SCRIPT_OP_ADDR(SCMD_GTE), SCRIPT_OP_ADDR(SCMD_LTE),
+		SCRIPT_OP_ADDR(SCMD_AND), SCRIPT_OP_ADDR(SCMD_OR), SCRIPT_OP_ADDR(SCMD_CALL),
+		SCRIPT_OP_ADDR(SCMD_MEMREADB), SCRIPT_OP_ADDR(SCMD_MEMREADW), SCRIPT_OP_ADDR(SCMD_MEMWRITEB),
+		SCRIPT_OP_ADDR(SCMD_MEMWRITEW), SCRIPT_OP_ADDR(SCMD_JZ), SCRIPT_OP_ADDR(SCMD_PUSHREG),
+		SCRIPT_OP_ADDR(SCMD_POPREG), SCRIPT_OP_ADDR(SCMD_JMP), SCRIPT_OP_ADDR(SCMD_MUL),
+		SCRIPT_OP_ADDR(SCMD_CALLEXT), SCRIPT_OP_ADDR(SCMD_PUSHREAL), SCRIPT_OP_ADDR(SCMD_SUBREALSTACK),
+		SCRIPT_OP_ADDR(SCMD_LINENUM), SCRIPT_OP_ADDR(SCMD_CALLAS), SCRIPT_OP_ADDR(SCMD_THISBASE),
+		SCRIPT_OP_ADDR(SCMD_NUMFUNCARGS), SCRIPT_OP_ADDR(SCMD_MODREG), SCRIPT_OP_ADDR(SCMD_XORREG),
+		SCRIPT_OP_ADDR(SCMD_NOTREG), SCRIPT_OP_ADDR(SCMD_SHIFTLEFT), SCRIPT_OP_ADDR(SCMD_SHIFTRIGHT),
+		SCRIPT_OP_ADDR(SCMD_CALLOBJ), SCRIPT_OP_ADDR(SCMD_CHECKBOUNDS), SCRIPT_OP_ADDR(SCMD_MEMWRITEPTR),
+		SCRIPT_OP_ADDR(SCMD_MEMREADPTR), SCRIPT_OP_ADDR(SCMD_MEMZEROPTR),
+		SCRIPT_OP_ADDR(SCMD_MEMINITPTR), SCRIPT_OP_ADDR(SCMD_LOADSPOFFS), SCRIPT_OP_ADDR(SCMD_CHECKNULL),
+		SCRIPT_OP_ADDR(SCMD_FADD), SCRIPT_OP_ADDR(SCMD_FSUB), SCRIPT_OP_ADDR(SCMD_FMULREG),
+		SCRIPT_OP_ADDR(SCMD_FDIVREG), SCRIPT_OP_ADDR(SCMD_FADDREG), SCRIPT_OP_ADDR(SCMD_FSUBREG),
+		SCRIPT_OP_ADDR(SCMD_FGREATER), SCRIPT_OP_ADDR(SCMD_FLESSTHAN), SCRIPT_OP_ADDR(SCMD_FGTE),
+		SCRIPT_OP_ADDR(SCMD_FLTE), SCRIPT_OP_ADDR(SCMD_ZEROMEMORY), SCRIPT_OP_ADDR(SCMD_CREATESTRING),
+		SCRIPT_OP_ADDR(SCMD_STRINGSEQUAL), SCRIPT_OP_ADDR(SCMD_STRINGSNOTEQ),
+		SCRIPT_OP_ADDR(SCMD_CHECKNULLREG), SCRIPT_OP_ADDR(SCMD_LOOPCHECKOFF),
+		SCRIPT_OP_ADDR(SCMD_MEMZEROPTRND), SCRIPT_OP_ADDR(SCMD_JNZ), SCRIPT_OP_ADDR(SCMD_DYNAMICBOUNDS),
+		SCRIPT_OP_ADDR(SCMD_NEWARRAY), SCRIPT_OP_ADDR(SCMD_NEWUSEROBJECT)
+	};
+#endif
+
 	const auto timeout = std::chrono::milliseconds(_G(timeoutCheckMs));
 	// NOTE: removed timeout_abort check for now: was working *logically* wrong;
 	//const auto timeout_abort = std::chrono::milliseconds(_G(timeoutAbortMs));
@@ -464,92 +579,46 @@ int ccInstance::Run(int32_t curpc) {
 		if (_G(abort_engine))
 			return -1;
 
-		/*
-		if (!codeInst->ReadOperation(codeOp, pc))
-		{
-		    return -1;
-		}
-		*/
-		/* ReadOperation */
-		//=====================================================================
-		codeOp.Instruction.Code         = codeInst->code[pc];
-		codeOp.Instruction.InstanceId   = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-		codeOp.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-		if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS) {
-			cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-			return -1;
-		}
-
-		codeOp.ArgCount = (*g_commands)[codeOp.Instruction.Code].ArgCount;
-		if (pc + codeOp.ArgCount >= codeInst->codesize) {
-			cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-			return -1;
-		}
-
-		int pc_at = pc + 1;
-		for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at) {
-			char fixup = codeInst->code_fixups[pc_at];
-			if (fixup > 0) {
-				// could be relative pointer or import address
-				/*
-				if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
-				{
-				    return -1;
-				}
-				*/
-				/* FixupArgument */
-				//=====================================================================
-				switch (fixup) {
-				case FIXUP_GLOBALDATA: {
-					ScriptVariable *gl_var = (ScriptVariable *)codeInst->code[pc_at];
-					codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-				}
-				break;
-				case FIXUP_FUNCTION:
-					// originally commented -- CHECKME: could this be used in very old versions of AGS?
-					//      code[fixup] += (long)&code[0];
-					// This is a program counter value, presumably will be used as SCMD_CALL argument
-					codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
-					break;
-				case FIXUP_STRING:
-					codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
-					break;
-				case FIXUP_IMPORT: {
-					const ScriptImport *import = _GP(simp).getByIndex(static_cast<uint32_t>(codeInst->code[pc_at]));
-					if (import) {
-						codeOp.Args[i] = import->Value;
-					} else {
-						cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
-						return -1;
-					}
-				}
-				break;
-				case FIXUP_STACK:
-					codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-					break;
-				default:
-					cc_error("internal fixup type error: %d", fixup);
-					return -1;
-				}
-				/* End FixupArgument */
-				//=====================================================================
+		// Most instructions were decoded when the script was loaded, and only
+		// their literal arguments are to be read, or their arguments were
+		// resolved then
+		const ScriptCodeOp *decoded = codeInst->code_ops ? &codeInst->code_ops[pc] : nullptr;
+		int reg_index1, reg_index2;
+		if (decoded && (decoded->Flags & (kScCodeOpDecoded | kScCodeOpFixups)) == kScCodeOpDecoded) {
+			codeOp.Instruction.Code = decoded->Code;
+			codeOp.Instruction.InstanceId = decoded->InstanceId;
+			codeOp.ArgCount = decoded->ArgCount;
+			if (decoded->Flags & kScCodeOpResolved) {
+				const RuntimeScriptValue *args = &codeInst->code_args[decoded->ArgIndex];
+				for (int i = 0; i < codeOp.ArgCount; ++i)
+					codeOp.Args[i] = args[i];
+				args_are_literals = false;
 			} else {
-				// should be a numeric literal (int32 or float)
-				codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
+				if (!args_are_literals) {
+					for (int i = 0; i < MAX_SCMD_ARGS; ++i)
+						codeOp.Args[i].SetInt32(0);
+					args_are_literals = true;
+				}
+				const intptr_t *args = &codeInst->code[pc + 1];
+				for (int i = 0; i < codeOp.ArgCount; ++i)
+					codeOp.Args[i].IValue = (int32_t)args[i];
 			}
+			reg_index1 = decoded->Reg[0];
+			reg_index2 = decoded->Reg[1];
+		} else {
+			if (!ReadOperation(codeInst, pc, codeOp))
+				return -1;
+			args_are_literals = false;
+			reg_index1 = codeOp.Args[0].IValue >= 0 && codeOp.Args[0].IValue < CC_NUM_REGISTERS ? codeOp.Args[0].IValue : 0;
+			reg_index2 = codeOp.Args[1].IValue >= 0 && codeOp.Args[1].IValue < CC_NUM_REGISTERS ? codeOp.Args[1].IValue : 0;
 		}
-		/* End ReadOperation */
-		//=====================================================================
 
 		// save the arguments for quick access
-		RuntimeScriptValue &arg1 = codeOp.Args[0];
-		RuntimeScriptValue &arg2 = codeOp.Args[1];
-		RuntimeScriptValue &arg3 = codeOp.Args[2];
-		RuntimeScriptValue &reg1 =
-		    registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
-		RuntimeScriptValue &reg2 =
-		    registers[arg2.IValue >= 0 && arg2.IValue < CC_NUM_REGISTERS ? arg2.IValue : 0];
+		const RuntimeScriptValue &arg1 = codeOp.Args[0];
+		const RuntimeScriptValue &arg2 = codeOp.Args[1];
+		const RuntimeScriptValue &arg3 = codeOp.Args[2];
+		RuntimeScriptValue &reg1 = registers[reg_index1];
+		RuntimeScriptValue &reg2 = registers[reg_index2];
 
 		const char *direct_ptr1;
 		const char *direct_ptr2;
@@ -558,14 +627,17 @@ int ccInstance::Run(int32_t curpc) {
 			DumpInstruction(codeOp);
 		}
 
+#ifdef AGS_SCRIPT_LABEL_DISPATCH
+		goto *dispatch_table[codeOp.Instruction.Code];
+#endif
 		switch (codeOp.Instruction.Code) {
-		case SCMD_LINENUM:
+		SCRIPT_OP(SCMD_LINENUM):
 			line_number = arg1.IValue;
 			_G(currentline) = arg1.IValue;
 			if (_G(new_line_hook))
 				_G(new_line_hook)(this, _G(currentline));
 			break;
-		case SCMD_ADD:
+		SCRIPT_OP(SCMD_ADD):
 			// If the register is SREG_SP, we are allocating new variable on the stack
 			if (arg1.IValue == SREG_SP) {
 				// Only allocate new data if current stack entry is invalid;
@@ -584,7 +656,7 @@ int ccInstance::Run(int32_t curpc) {
 				reg1.IValue += arg2.IValue;
 			}
 			break;
-		case SCMD_SUB:
+		SCRIPT_OP(SCMD_SUB):
 			if (reg1.Type == kScValStackPtr) {
 				// If this is SREG_SP, this is stack pop, which frees local variables;
 				// Other than SREG_SP this may be AGS 2.x method to offset stack in SREG_MAR;
@@ -604,10 +676,10 @@ int ccInstance::Run(int32_t curpc) {
 				reg1.IValue -= arg2.IValue;
 			}
 			break;
-		case SCMD_REGTOREG:
+		SCRIPT_OP(SCMD_REGTOREG):
 			reg2 = reg1;
 			break;
-		case SCMD_WRITELIT:
+		SCRIPT_OP(SCMD_WRITELIT):
 			// Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
 			//
 			// NOTE: since it reads directly from arg2 (which originally was
@@ -630,7 +702,7 @@ int ccInstance::Run(int32_t curpc) {
 				break;
 			}
 			break;
-		case SCMD_RET: {
+		SCRIPT_OP(SCMD_RET): {
 			if (loopIterationCheckDisabled > 0)
 				loopIterationCheckDisabled--;
 
@@ -645,18 +717,18 @@ int ccInstance::Run(int32_t curpc) {
 			POP_CALL_STACK;
 			continue; // continue so that the PC doesn't get overwritten
 		}
-		case SCMD_LITTOREG:
+		SCRIPT_OP(SCMD_LITTOREG):
 			reg1 = arg2;
 			break;
-		case SCMD_MEMREAD:
+		SCRIPT_OP(SCMD_MEMREAD):
 			// Take the data address from reg[MAR] and copy int32_t to reg[arg1]
 			reg1 = registers[SREG_MAR].ReadValue();
 			break;
-		case SCMD_MEMWRITE:
+		SCRIPT_OP(SCMD_MEMWRITE):
 			// Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
 			registers[SREG_MAR].WriteValue(reg1);
 			break;
-		case SCMD_LOADSPOFFS:
+		SCRIPT_OP(SCMD_LOADSPOFFS):
 			registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
 			if (cc_has_error()) {
 				return -1;
@@ -664,68 +736,68 @@ int ccInstance::Run(int32_t curpc) {
 			break;
 
 		// 64 bit: Force 32 bit math
-		case SCMD_MULREG:
+		SCRIPT_OP(SCMD_MULREG):
 			reg1.SetInt32(reg1.IValue * reg2.IValue);
 			break;
-		case SCMD_DIVREG:
+		SCRIPT_OP(SCMD_DIVREG):
 			if (reg2.IValue == 0) {
 				cc_error("!Integer divide by zero");
 				return -1;
 			}
 			reg1.SetInt32(reg1.IValue / reg2.IValue);
 			break;
-		case SCMD_ADDREG:
+		SCRIPT_OP(SCMD_ADDREG):
 			// This may be pointer arithmetics, in which case IValue stores offset from base pointer
 			reg1.IValue += reg2.IValue;
 			break;
-		case SCMD_SUBREG:
+		SCRIPT_OP(SCMD_SUBREG):
 			// This may be pointer arithmetics, in which case IValue stores offset from base pointer
 			reg1.IValue -= reg2.IValue;
 			break;
-		case SCMD_BITAND:
+		SCRIPT_OP(SCMD_BITAND):
 			reg1.SetInt32(reg1.IValue & reg2.IValue);
 			break;
-		case SCMD_BITOR:
+		SCRIPT_OP(SCMD_BITOR):
 			reg1.SetInt32(reg1.IValue | reg2.IValue);
 			break;
-		case SCMD_ISEQUAL:
+		SCRIPT_OP(SCMD_ISEQUAL):
 			reg1.SetInt32AsBool(reg1 == reg2);
 			break;
-		case SCMD_NOTEQUAL:
+		SCRIPT_OP(SCMD_NOTEQUAL):
 			reg1.SetInt32AsBool(reg1 != reg2);
 			break;
-		case SCMD_GREATER:
+		SCRIPT_OP(SCMD_GREATER):
 			reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
 			break;
-		case SCMD_LESSTHAN:
+		SCRIPT_OP(SCMD_LESSTHAN):
 			reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
 			break;
-		case SCMD_GTE:
+		SCRIPT_OP(SCMD_GTE):
 			reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
 			break;
-		case SCMD_LTE:
+		SCRIPT_OP(SCMD_LTE):
 			reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
 			break;
-		case SCMD_AND:
+		SCRIPT_OP(SCMD_AND):
 			reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
 			break;
-		case SCMD_OR:
+		SCRIPT_OP(SCMD_OR):
 			reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
 			break;
-		case SCMD_XORREG:
+		SCRIPT_OP(SCMD_XORREG):
 			reg1.SetInt32(reg1.IValue ^ reg2.IValue);
 			break;
-		case SCMD_MODREG:
+		SCRIPT_OP(SCMD_MODREG):
 			if (reg2.IValue == 0) {
 				cc_error("!Integer divide by zero");
 				return -1;
 			}
 			reg1.SetInt32(reg1.IValue % reg2.IValue);
 			break;
-		case SCMD_NOTREG:
+		SCRIPT_OP(SCMD_NOTREG):
 			reg1 = !(reg1);
 			break;
-		case SCMD_CALL:
+		SCRIPT_OP(SCMD_CALL):
 			// Call another function within same script, just save PC
 			// and continue from there
 			if (curnest >= MAXNEST - 1) {
@@ -754,40 +826,40 @@ int ccInstance::Run(int32_t curpc) {
 			thisbase[curnest] = 0;
 			funcstart[curnest] = pc;
 			continue; // continue so that the PC doesn't get overwritten
-		case SCMD_MEMREADB:
+		SCRIPT_OP(SCMD_MEMREADB):
 			// Take the data address from reg[MAR] and copy byte to reg[arg1]
 			reg1.SetUInt8(registers[SREG_MAR].ReadByte());
 			break;
-		case SCMD_MEMREADW:
+		SCRIPT_OP(SCMD_MEMREADW):
 			// Take the data address from reg[MAR] and copy int16_t to reg[arg1]
 			reg1.SetInt16(registers[SREG_MAR].ReadInt16());
 			break;
-		case SCMD_MEMWRITEB:
+		SCRIPT_OP(SCMD_MEMWRITEB):
 			// Take the data address from reg[MAR] and copy there byte from reg[arg1]
 			registers[SREG_MAR].WriteByte(reg1.IValue);
 			break;
-		case SCMD_MEMWRITEW:
+		SCRIPT_OP(SCMD_MEMWRITEW):
 			// Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
 			registers[SREG_MAR].WriteInt16(reg1.IValue);
 			break;
-		case SCMD_JZ:
+		SCRIPT_OP(SCMD_JZ):
 			if (registers[SREG_AX].IsNull())
 				pc += arg1.IValue;
 			break;
-		case SCMD_JNZ:
+		SCRIPT_OP(SCMD_JNZ):
 			if (!registers[SREG_AX].IsNull())
 				pc += arg1.IValue;
 			break;
-		case SCMD_PUSHREG:
+		SCRIPT_OP(SCMD_PUSHREG):
 			// Push reg[arg1] value to the stack
 			ASSERT_STACK_SPACE_AVAILABLE(1);
 			PushValueToStack(reg1);
 			break;
-		case SCMD_POPREG:
+		SCRIPT_OP(SCMD_POPREG):
 			ASSERT_STACK_SIZE(1);
 			reg1 = PopValueFromStack();
 			break;
-		case SCMD_JMP:
+		SCRIPT_OP(SCMD_JMP):
 			pc += arg1.IValue;
 
 			// Make sure it's not stuck in a While loop
@@ -810,17 +882,17 @@ int ccInstance::Run(int32_t curpc) {
 				}
 			}
 			break;
-		case SCMD_MUL:
+		SCRIPT_OP(SCMD_MUL):
 			reg1.IValue *= arg2.IValue;
 			break;
-		case SCMD_CHECKBOUNDS:
+		SCRIPT_OP(SCMD_CHECKBOUNDS):
 			if ((reg1.IValue < 0) ||
 			        (reg1.IValue >= arg2.IValue)) {
 				cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg2.IValue - 1);
 				return -1;
 			}
 			break;
-		case SCMD_DYNAMICBOUNDS: {
+		SCRIPT_OP(SCMD_DYNAMICBOUNDS): {
 			// TODO: test reg[MAR] type here;
 			// That might be dynamic object, but also a non-managed dynamic array, "allocated"
 			// on global or local memspace (buffer)
@@ -841,7 +913,7 @@ int ccInstance::Run(int32_t curpc) {
 
 		// 64 bit: Handles are always 32 bit values. They are not C pointer.
 
-		case SCMD_MEMREADPTR: {
+		SCRIPT_OP(SCMD_MEMREADPTR): {
 			cc_clear_error();
 
 			int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -859,7 +931,7 @@ int ccInstance::Run(int32_t curpc) {
 				return -1;
 			break;
 		}
-		case SCMD_MEMWRITEPTR: {
+		SCRIPT_OP(SCMD_MEMWRITEPTR): {
 
 			int32_t handle = registers[SREG_MAR].ReadInt32();
 			const char *address = nullptr;
@@ -890,7 +962,7 @@ int ccInstance::Run(int32_t curpc) {
 			}
 			break;
 		}
-		case SCMD_MEMINITPTR: {
+		SCRIPT_OP(SCMD_MEMINITPTR): {
 			const char *address = nullptr;
 
 			if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager()) {
@@ -916,13 +988,13 @@ int ccInstance::Run(int32_t curpc) {
 			registers[SREG_MAR].WriteInt32(newHandle);
 			break;
 		}
-		case SCMD_MEMZEROPTR: {
+		SCRIPT_OP(SCMD_MEMZEROPTR): {
 			int32_t handle = registers[SREG_MAR].ReadInt32();
 			ccReleaseObjectReference(handle);
 			registers[SREG_MAR].WriteInt32(0);
 			break;
 		}
-		case SCMD_MEMZEROPTRND: {
+		SCRIPT_OP(SCMD_MEMZEROPTRND): {
 			int32_t handle = registers[SREG_MAR].ReadInt32();
 
 			// don't do the Dispose check for the object being returned -- this is
@@ -936,22 +1008,22 @@ int ccInstance::Run(int32_t curpc) {
 			registers[SREG_MAR].WriteInt32(0);
 			break;
 		}
-		case SCMD_CHECKNULL:
+		SCRIPT_OP(SCMD_CHECKNULL):
 			if (registers[SREG_MAR].IsNull()) {
 				cc_error("!Null pointer referenced");
 				return -1;
 			}
 			break;
-		case SCMD_CHECKNULLREG:
+		SCRIPT_OP(SCMD_CHECKNULLREG):
 			if (reg1.IsNull()) {
 				cc_error("!Null string referenced");
 				return -1;
 			}
 			break;
-		case SCMD_NUMFUNCARGS:
+		SCRIPT_OP(SCMD_NUMFUNCARGS):
 			num_args_to_func = arg1.IValue;
 			break;
-		case SCMD_CALLAS: {
+		SCRIPT_OP(SCMD_CALLAS): {
 			PUSH_CALL_STACK;
 
 			// Call to a function in another script
@@ -1009,7 +1081,7 @@ int ccInstance::Run(int32_t curpc) {
 			POP_CALL_STACK;
 			break;
 		}
-		case SCMD_CALLEXT: {
+		SCRIPT_OP(SCMD_CALLEXT): {
 			// Call to a real 'C' code function
 			was_just_callas = -1;
 			if (num_args_to_func < 0) {
@@ -1075,10 +1147,10 @@ int ccInstance::Run(int32_t curpc) {
 			num_args_to_func = -1;
 			break;
 		}
-		case SCMD_PUSHREAL:
+		SCRIPT_OP(SCMD_PUSHREAL):
 			PushToFuncCallStack(func_callstack, reg1);
 			break;
-		case SCMD_SUBREALSTACK:
+		SCRIPT_OP(SCMD_SUBREALSTACK):
 			PopFromFuncCallStack(func_callstack, arg1.IValue);
 			if (was_just_callas >= 0) {
 				ASSERT_STACK_SIZE(arg1.IValue);
@@ -1086,7 +1158,7 @@ int ccInstance::Run(int32_t curpc) {
 				was_just_callas = -1;
 			}
 			break;
-		case SCMD_CALLOBJ:
+		SCRIPT_OP(SCMD_CALLOBJ):
 			// set the OP register
 			if (reg1.IsNull()) {
 				cc_error("!Null pointer referenced");
@@ -1119,16 +1191,16 @@ int ccInstance::Run(int32_t curpc) {
 			}
 			next_call_needs_object = 1;
 			break;
-		case SCMD_SHIFTLEFT:
+		SCRIPT_OP(SCMD_SHIFTLEFT):
 			reg1.SetInt32(reg1.IValue << reg2.IValue);
 			break;
-		case SCMD_SHIFTRIGHT:
+		SCRIPT_OP(SCMD_SHIFTRIGHT):
 			reg1.SetInt32(reg1.IValue >> reg2.IValue);
 			break;
-		case SCMD_THISBASE:
+		SCRIPT_OP(SCMD_THISBASE):
 			thisbase[curnest] = arg1.IValue;
 			break;
-		case SCMD_NEWARRAY: {
+		SCRIPT_OP(SCMD_NEWARRAY): {
 			int numElements = reg1.IValue;
 			if (numElements < 1) {
 				cc_error("invalid size for dynamic array; requested: %d, range: 1..%d", numElements, INT32_MAX);
@@ -1138,7 +1210,7 @@ int ccInstance::Run(int32_t curpc) {
 			reg1.SetDynamicObject(ref.second, &_GP(globalDynamicArray));
 			break;
 		}
-		case SCMD_NEWUSEROBJECT: {
+		SCRIPT_OP(SCMD_NEWUSEROBJECT): {
 			const int32_t size = arg2.IValue;
 			if (size < 0) {
 				cc_error("Invalid size for user object; requested: %d (or %d), range: 0..%d", (uint32_t)size, size, INT_MAX);
@@ -1148,41 +1220,41 @@ int ccInstance::Run(int32_t curpc) {
 			reg1.SetDynamicObject(suo, suo);
 			break;
 		}
-		case SCMD_FADD:
+		SCRIPT_OP(SCMD_FADD):
 			reg1.SetFloat(reg1.FValue + arg2.IValue); // arg2 was used as int here originally
 			break;
-		case SCMD_FSUB:
+		SCRIPT_OP(SCMD_FSUB):
 			reg1.SetFloat(reg1.FValue - arg2.IValue); // arg2 was used as int here originally
 			break;
-		case SCMD_FMULREG:
+		SCRIPT_OP(SCMD_FMULREG):
 			reg1.SetFloat(reg1.FValue * reg2.FValue);
 			break;
-		case SCMD_FDIVREG:
+		SCRIPT_OP(SCMD_FDIVREG):
 			if (reg2.FValue == 0.0) {
 				cc_error("!Floating point divide by zero");
 				return -1;
 			}
 			reg1.SetFloat(reg1.FValue / reg2.FValue);
 			break;
-		case SCMD_FADDREG:
+		SCRIPT_OP(SCMD_FADDREG):
 			reg1.SetFloat(reg1.FValue + reg2.FValue);
 			break;
-		case SCMD_FSUBREG:
+		SCRIPT_OP(SCMD_FSUBREG):
 			reg1.SetFloat(reg1.FValue - reg2.FValue);
 			break;
-		case SCMD_FGREATER:
+		SCRIPT_OP(SCMD_FGREATER):
 			reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
 			break;
-		case SCMD_FLESSTHAN:
+		SCRIPT_OP(SCMD_FLESSTHAN):
 			reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
 			break;
-		case SCMD_FGTE:
+		SCRIPT_OP(SCMD_FGTE):
 			reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
 			break;
-		case SCMD_FLTE:
+		SCRIPT_OP(SCMD_FLTE):
 			reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
 			break;
-		case SCMD_ZEROMEMORY:
+		SCRIPT_OP(SCMD_ZEROMEMORY):
 			// Check if we are zeroing at stack tail
 			if (registers[SREG_MAR] == registers[SREG_SP]) {
 				// creating a local variable -- check the stack to ensure no mem overrun
@@ -1204,7 +1276,7 @@ int ccInstance::Run(int32_t curpc) {
 				return -1;
 			}
 			break;
-		case SCMD_CREATESTRING:
+		SCRIPT_OP(SCMD_CREATESTRING):
 			if (_G(stringClassImpl) == nullptr) {
 				cc_error("No string class implementation set, but opcode was used");
 				return -1;
@@ -1214,7 +1286,7 @@ int ccInstance::Run(int32_t curpc) {
 			    _G(stringClassImpl)->CreateString(direct_ptr1).second,
 			    &_GP(myScriptStringImpl));
 			break;
-		case SCMD_STRINGSEQUAL:
+		SCRIPT_OP(SCMD_STRINGSEQUAL):
 			if ((reg1.IsNull()) || (reg2.IsNull())) {
 				cc_error("!Null pointer referenced");
 				return -1;
@@ -1224,7 +1296,7 @@ int ccInstance::Run(int32_t curpc) {
 			reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) == 0);
 
 			break;
-		case SCMD_STRINGSNOTEQ:
+		SCRIPT_OP(SCMD_STRINGSNOTEQ):
 			if ((reg1.IsNull()) || (reg2.IsNull())) {
 				cc_error("!Null pointer referenced");
 				return -1;
@@ -1233,11 +1305,11 @@ int ccInstance::Run(int32_t curpc) {
 			direct_ptr2 = (const char *)reg2.GetDirectPtr();
 			reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) != 0);
 			break;
-		case SCMD_LOOPCHECKOFF:
+		SCRIPT_OP(SCMD_LOOPCHECKOFF):
 			if (loopIterationCheckDisabled == 0)
 				loopIterationCheckDisabled++;
 			break;
-		default:
+		SCRIPT_OP_DEFAULT:
 			cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
 			return -1;
 		}
@@ -1247,6 +1319,10 @@ int ccInstance::Run(int32_t curpc) {
 	return 0;
 }
 
+#ifdef AGS_SCRIPT_LABEL_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
 String ccInstance::GetCallStack(int maxLines) const {
 	String buffer = String::FromFormat("in \"%s\", line %d\n", runningInst->instanceof->GetSectionName(pc), line_number);
 
@@ -1431,6 +1507,8 @@ bool ccInstance::_Create(PScript scri, ccInstance *joined) {
 	if (joined) {
 		resolved_imports = joined->resolved_imports;
 		code_fixups = joined->code_fixups;
+		code_ops = joined->code_ops;
+		code_args = joined->code_args;
 	} else {
 		if (!CreateGlobalVars(scri.get())) {
 			return false;
@@ -1513,9 +1591,13 @@ void ccInstance::Free() {
 	if ((flags & INSTF_SHAREDATA) == 0) {
 		delete[] resolved_imports;
 		delete[] code_fixups;
+		delete[] code_ops;
+		delete[] code_args;
 	}
 	resolved_imports = nullptr;
 	code_fixups = nullptr;
+	code_ops = nullptr;
+	code_args = nullptr;
 }
 
 bool ccInstance::ResolveScriptImports(const ccScript *scri) {
@@ -1726,9 +1808,86 @@ bool ccInstance::ResolveImportFixups(const ccScript *scri) {
 		if (import->InstancePtr != nullptr && (code[fixup + 1] & INSTANCE_ID_REMOVEMASK) == SCMD_CALLEXT)
 			code[fixup + 1] = SCMD_CALLAS | (import->InstancePtr->loadedInstanceId << INSTANCE_ID_SHIFT);
 	}
+
+	DecodeCode();
 	return true;
 }
 
+void ccInstance::DecodeCode() {
+	delete[] code_ops;
+	delete[] code_args;
+	code_ops = new ScriptCodeOp[codesize]();
+	code_args = nullptr;
+	std::vector<RuntimeScriptValue> args;
+
+	// Decode the instructions in sequence; if an invalid one is found, the
+	// rest of the code is left to ReadOperation, which reports the error
+	// only if it is executed.
+	int32_t at_pc = 0;
+	while (at_pc < codesize) {
+		const int32_t instruction = code[at_pc];
+		const int32_t op_code = instruction & INSTANCE_ID_REMOVEMASK;
+		if (op_code < 0 || op_code >= CC_NUM_SCCMDS)
+			break;
+		const int arg_count = (*g_commands)[op_code].ArgCount;
+		if (at_pc + arg_count >= codesize)
+			break;
+
+		ScriptCodeOp &op = code_ops[at_pc];
+		op.Code = op_code;
+		op.InstanceId = (instruction >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+		op.ArgCount = arg_count;
+		op.Flags = kScCodeOpDecoded;
+
+		// Global data, strings and functions do not depend on the execution
+		// state, unlike imports and the stack
+		RuntimeScriptValue op_args[MAX_SCMD_ARGS];
+		for (int i = 0; i < arg_count; ++i) {
+			const int32_t pc_at = at_pc + 1 + i;
+			switch (code_fixups[pc_at]) {
+			case 0:
+				op_args[i].SetInt32((int32_t)code[pc_at]);
+				break;
+			case FIXUP_GLOBALDATA:
+				op_args[i].SetGlobalVar(&((ScriptVariable *)code[pc_at])->RValue);
+				op.Flags |= kScCodeOpResolved;
+				break;
+			case FIXUP_FUNCTION:
+				op_args[i].SetInt32((int32_t)code[pc_at]);
+				op.Flags |= kScCodeOpResolved;
+				break;
+			case FIXUP_STRING:
+				op_args[i].SetStringLiteral(&strings[0] + code[pc_at]);
+				op.Flags |= kScCodeOpResolved;
+				break;
+			default:
+				op.Flags |= kScCodeOpFixups;
+				break;
+			}
+		}
+
+		if (op.Flags & kScCodeOpFixups) {
+			op.Flags &= ~kScCodeOpResolved;
+		} else if (op.Flags & kScCodeOpResolved) {
+			op.ArgIndex = args.size();
+			for (int i = 0; i < arg_count; ++i)
+				args.push_back(op_args[i]);
+		}
+
+		for (int i = 0; i < 2; ++i) {
+			const int32_t reg = i < arg_count ? op_args[i].IValue : 0;
+			op.Reg[i] = reg >= 0 && reg < CC_NUM_REGISTERS ? reg : 0;
+		}
+		at_pc += arg_count + 1;
+	}
+
+	if (!args.empty()) {
+		code_args = new RuntimeScriptValue[args.size()];
+		for (uint i = 0; i < args.size(); ++i)
+			code_args[i] = args[i];
+	}
+}
+
 /*
 bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
 {
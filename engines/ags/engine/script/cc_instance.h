@@ -69,6 +69,25 @@ struct ScriptOperation {
 	int                 ArgCount;
 };
 
+// Flags of a ScriptCodeOp
+enum ScriptCodeOpFlags {
+	kScCodeOpDecoded  = 0x01, // the op starts a valid instruction
+	kScCodeOpFixups   = 0x02, // some of the arguments need run-time fixups
+	kScCodeOpResolved = 0x04  // the arguments were resolved at load time
+};
+
+// An instruction of the byte-code, decoded once all the fixups that do not
+// depend on the execution state have been resolved. There is one per code
+// element, the ones which do not start an instruction are left empty.
+struct ScriptCodeOp {
+	uint8_t Code;        // instruction code, without the instance id
+	uint8_t InstanceId;
+	uint8_t ArgCount;
+	uint8_t Flags;
+	uint8_t Reg[2];      // registers referenced by the first two arguments
+	uint32_t ArgIndex;   // index of the resolved arguments in code_args
+};
+
 struct ScriptVariable {
 	ScriptVariable() {
 		ScAddress = -1; // address = 0 is valid one, -1 means undefined
@@ -139,6 +158,11 @@ public:
 	int  numimports;
 
 	char *code_fixups;
+	// Decoded byte-code, see ScriptCodeOp
+	ScriptCodeOp *code_ops;
+	// Arguments of the instructions with global data, string and function
+	// fixups, resolved when the code is decoded
+	RuntimeScriptValue *code_args;
 
 	// returns the currently executing instance, or NULL if none
 	static ccInstance *GetCurrentInstance(void);
@@ -183,6 +207,9 @@ public:
 	// Using resolved_imports[], resolve the IMPORT fixups
 	// Also change CALLEXT op-codes to CALLAS when they pertain to a script instance
 	bool    ResolveImportFixups(const ccScript *scri);
+	// Decode the byte-code into code_ops; this is done by ResolveImportFixups,
+	// once the code does not change anymore
+	void    DecodeCode();
 
 private:
 	bool    _Create(PScript scri, ccInstance *joined);
@@ -194,6 +221,9 @@ private:
 	ScriptVariable *FindGlobalVar(int32_t var_addr);
 	bool    CreateRuntimeCodeFixups(const ccScript *scri);
 	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
+	// Read an instruction which was not decoded, or has arguments that need
+	// run-time fixups
+	bool    ReadOperation(const ccInstance *codeInst, int32_t at_pc, ScriptOperation &op);
 
 	// Begin executing script starting from the given bytecode index
 	int     Run(int32_t curpc);
@@ -26,6 +26,7 @@
 //=============================================================================
 
 #include "common/system.h"
+#include "common/thread.h"
 #include "ags/shared/core/platform.h"
 #include "ags/shared/util/stream.h"
 #include "common/std/algorithm.h"
@@ -91,7 +92,9 @@ void SpriteCache::SetMaxCacheSize(size_t size) {
 }
 
 void SpriteCache::Reset() {
+	StopPrefetch();
 	_file.Close();
+	_prefetchFile.Close();
 	// TODO: find out if it's safe to simply always delete _spriteData.Image with array element
 	for (size_t i = 0; i < _spriteData.size(); ++i) {
 		if (_spriteData[i].Image) {
@@ -100,7 +103,8 @@ void SpriteCache::Reset() {
 		}
 	}
 	_spriteData.clear();
-	_mru.clear();
+	_mruHead = _mruTail = -1;
+	_mruCount = 0;
 	_cacheSize = 0;
 	_lockedSize = 0;
 }
@@ -149,6 +153,7 @@ void SpriteCache::RemoveSprite(sprkey_t index, bool freeMemory) {
 
 	if (freeMemory)
 		delete _spriteData[index].Image;
+	MruRemove(index);
 	InitNullSpriteParams(index);
 	SprCacheLog("RemoveSprite: %d", index);
 }
@@ -169,6 +174,7 @@ sprkey_t SpriteCache::GetFreeIndex() {
 	for (size_t i = MIN_SPRITE_INDEX; i < _spriteData.size(); ++i) {
 		// slot empty
 		if (!DoesSpriteExist(i)) {
+			MruRemove(i);
 			_sprInfos[i] = SpriteInfo();
 			_spriteData[i] = SpriteData();
 			return i;
@@ -210,19 +216,49 @@ Bitmap *SpriteCache::operator [] (sprkey_t index) {
 	if (_spriteData[index].IsExternalSprite() || _spriteData[index].IsLocked())
 		return _spriteData[index].Image;
 
-	if (_spriteData[index].Image) {
-		// Move to the beginning of the MRU list
-		_mru.splice(_mru.begin(), _mru, _spriteData[index].MruIt);
-	} else {
-		// Sprite exists in file but is not in mem, load it
+	// Sprite exists in file but is not in mem, load it
+	if (!_spriteData[index].Image)
 		LoadSprite(index);
-		_spriteData[index].MruIt = _mru.insert(_mru.begin(), index);
-	}
+	// Move to the beginning of the MRU list
+	MruPushFront(index);
 	return _spriteData[index].Image;
 }
 
+void SpriteCache::MruPushFront(sprkey_t index) {
+	if (_mruHead == index)
+		return;
+	MruRemove(index);
+	SpriteData &spr = _spriteData[index];
+	spr.MruPrev = -1;
+	spr.MruNext = _mruHead;
+	spr.InMru = true;
+	if (_mruHead >= 0)
+		_spriteData[_mruHead].MruPrev = index;
+	else
+		_mruTail = index;
+	_mruHead = index;
+	_mruCount++;
+}
+
+void SpriteCache::MruRemove(sprkey_t index) {
+	SpriteData &spr = _spriteData[index];
+	if (!spr.InMru)
+		return;
+	if (spr.MruPrev >= 0)
+		_spriteData[spr.MruPrev].MruNext = spr.MruNext;
+	else
+		_mruHead = spr.MruNext;
+	if (spr.MruNext >= 0)
+		_spriteData[spr.MruNext].MruPrev = spr.MruPrev;
+	else
+		_mruTail = spr.MruPrev;
+	spr.MruPrev = spr.MruNext = -1;
+	spr.InMru = false;
+	_mruCount--;
+}
+
 void SpriteCache::FreeMem(size_t space) {
-	for (int tries = 0; (_mru.size() > 0) && (_cacheSize >= (_maxCacheSize - space)); ++tries) {
+	for (int tries = 0; (_mruCount > 0) && (_cacheSize >= (_maxCacheSize - space)); ++tries) {
 		DisposeOldest();
 		if (tries > 1000) { // ???
 			Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: STUCK IN FREE_UP_MEM; RESETTING CACHE");
@@ -232,11 +268,10 @@ void SpriteCache::FreeMem(size_t space) {
 }
 
 void SpriteCache::DisposeOldest() {
-	assert(_mru.size() > 0);
-	if (_mru.size() == 0)
+	assert(_mruCount > 0);
+	if (_mruCount == 0)
 		return;
-	auto it = std::prev(_mru.end());
-	const auto sprnum = *it;
+	const sprkey_t sprnum = _mruTail;
 	// Safety check: must be a sprite from resources
 	// TODO: compare with latest upstream
 	// Commented out the assertion, since it triggers for sprites that are in the list but remapped to the placeholder (sprite 0)
@@ -247,29 +282,25 @@ void SpriteCache::DisposeOldest() {
 	if (!_spriteData[sprnum].IsAssetSprite()) {
 		if (!(_spriteData[sprnum].Flags & SPRCACHEFLAG_REMAPPED))
 			Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SpriteCache::DisposeOldest: in MRU list sprite %d is external or does not exist", sprnum);
-		_mru.erase(it);
-		// std::list::erase() invalidates iterators to the erased item.
-		// But our implementation does not.
-		_spriteData[sprnum].MruIt._node = nullptr;
+		MruRemove(sprnum);
 		return;
 	}
 	// Delete the image, unless is locked
 	// NOTE: locked sprites may still occur in MRU list
 	if (!_spriteData[sprnum].IsLocked()) {
 		_cacheSize -= _spriteData[sprnum].Size;
-		delete _spriteData[*it].Image;
+		delete _spriteData[sprnum].Image;
 		_spriteData[sprnum].Image = nullptr;
 		SprCacheLog("DisposeOldest: disposed %d, size now %d KB", sprnum, _cacheSize / 1024);
 	}
 	// Remove from the mru list
-	_mru.erase(it);
-	// std::list::erase() invalidates iterators to the erased item.
-	// But our implementation does not.
-	_spriteData[sprnum].MruIt._node = nullptr;
+	MruRemove(sprnum);
 }
 
 void SpriteCache::DisposeAll() {
 	for (size_t i = 0; i < _spriteData.size(); ++i) {
+		_spriteData[i].MruPrev = _spriteData[i].MruNext = -1;
+		_spriteData[i].InMru = false;
 		if (!_spriteData[i].IsLocked() && // not locked
 			_spriteData[i].IsAssetSprite()) // sprite from game resource
 		{
@@ -278,7 +309,8 @@ void SpriteCache::DisposeAll() {
 		}
 	}
 	_cacheSize = _lockedSize;
-	_mru.clear();
+	_mruHead = _mruTail = -1;
+	_mruCount = 0;
 }
 
 void SpriteCache::Precache(sprkey_t index) {
@@ -294,10 +326,7 @@ void SpriteCache::Precache(sprkey_t index) {
 	} else if (!_spriteData[index].IsLocked()) {
 		sprSize = _spriteData[index].Size;
 		// Remove locked sprite from the MRU list
-		_mru.erase(_spriteData[index].MruIt);
-		// std::list::erase() invalidates iterators to the erased item.
-		// But our implementation does not.
-		_spriteData[index].MruIt._node = nullptr;
+		MruRemove(index);
 	}
 
 	// make sure locked sprites can't fill the cache
@@ -317,8 +346,10 @@ size_t SpriteCache::LoadSprite(sprkey_t index) {
 		return 0;
 
 	sprkey_t load_index = GetDataIndex(index);
-	Bitmap *image;
-	HError err = _file.LoadSprite(load_index, image);
+	HError err = HError::None();
+	Bitmap *image = TakePrefetchedSprite(index, load_index);
+	if (!image)
+		err = _file.LoadSprite(load_index, image);
 	if (!image) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
 			"LoadSprite: failed to load sprite %d:\n%s\n - remapping to sprite 0.", index,
@@ -386,12 +417,17 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
 	HError err = _file.OpenFile(filename, sprindex_filename, metrics);
 	if (!err)
 		return err;
+	// The prefetch thread reads through its own stream; if that could not
+	// be opened, sprites are simply loaded on demand
+	if (!_prefetchFile.OpenCopy(_file, filename))
+		_prefetchFile.Close();
 
 	// Initialize sprite infos
 	size_t newsize = metrics.size();
 	_sprInfos.resize(newsize);
 	_spriteData.resize(newsize);
-	_mru.clear();
+	_mruHead = _mruTail = -1;
+	_mruCount = 0;
 	for (size_t i = 0; i < metrics.size(); ++i) {
 		if (!metrics[i].IsNull()) {
 			// Existing sprite
@@ -407,7 +443,152 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
 }
 
 void SpriteCache::DetachFile() {
+	StopPrefetch();
 	_file.Close();
+	_prefetchFile.Close();
+}
+
+void SpriteCache::PrefetchSprites(const std::vector<sprkey_t> &indexes) {
+	StopPrefetch();
+	if (!_prefetchFile.IsValid())
+		return;
+
+	// Only queue the sprites which would have to be loaded from the file,
+	// and no more of them than would fit into half of the cache
+	size_t total = 0;
+	for (sprkey_t index : indexes) {
+		if (index <= 0 || (size_t)index >= _spriteData.size())
+			continue;
+		const SpriteData &spr = _spriteData[index];
+		if (!spr.IsAssetSprite() || spr.Image || spr.IsLocked() || (spr.Flags & SPRCACHEFLAG_REMAPPED))
+			continue;
+		bool queued = false;
+		for (const PrefetchJob &job : _prefetchJobs) {
+			if (job.Index == index) {
+				queued = true;
+				break;
+			}
+		}
+		if (queued)
+			continue;
+		const size_t size = _sprInfos[index].Width * _sprInfos[index].Height * 4;
+		if (total + size > _maxCacheSize / 2)
+			break;
+		total += size;
+
+		PrefetchJob job;
+		job.Index = index;
+		job.DataIndex = GetDataIndex(index);
+		_prefetchJobs.push_back(job);
+	}
+	if (_prefetchJobs.empty())
+		return;
+
+	_prefetchDone = g_system->createSemaphore();
+	if (_prefetchDone)
+		_prefetchThread = g_system->createThread(PrefetchThreadProc, this);
+	if (!_prefetchThread) {
+		delete _prefetchDone;
+		_prefetchDone = nullptr;
+		_prefetchJobs.clear();
+		return;
+	}
+	_prefetchStats.Queued += _prefetchJobs.size();
+	SprCacheLog("PrefetchSprites: queued %zu sprites", _prefetchJobs.size());
+}
+
+void SpriteCache::StopPrefetch() {
+	if (_prefetchThread) {
+		{
+			Common::StackLock lock(_prefetchMutex);
+			_prefetchCancel = true;
+		}
+		_prefetchThread->wait();
+		delete _prefetchThread;
+		_prefetchThread = nullptr;
+		delete _prefetchDone;
+		_prefetchDone = nullptr;
+	}
+
+	for (PrefetchJob &job : _prefetchJobs) {
+		if (job.Done && !job.Taken) {
+			delete job.Image;
+			_prefetchStats.Wasted++;
+		}
+	}
+	_prefetchJobs.clear();
+	_prefetchNext = 0;
+	_prefetchCancel = false;
+}
+
+Bitmap *SpriteCache::TakePrefetchedSprite(sprkey_t index, sprkey_t load_index) {
+	size_t i = 0;
+	for (; i < _prefetchJobs.size(); ++i) {
+		if (_prefetchJobs[i].Index == index && _prefetchJobs[i].DataIndex == load_index)
+			break;
+	}
+	if (i == _prefetchJobs.size())
+		return nullptr;
+
+	PrefetchJob &job = _prefetchJobs[i];
+	uint32_t waitStart = 0;
+	for (;;) {
+		{
+			Common::StackLock lock(_prefetchMutex);
+			if (job.Taken)
+				return nullptr;
+			if (job.Done) {
+				const uint32_t waited = waitStart ? g_system->getMillis() - waitStart : 0;
+				Bitmap *image = job.Image;
+				job.Image = nullptr;
+				job.Taken = true;
+				_prefetchStats.Used++;
+				_prefetchStats.SavedMs += job.LoadTime > waited ? job.LoadTime - waited : 0;
+				_prefetchStats.WaitedMs += waited;
+				return image;
+			}
+			if (i >= _prefetchNext) {
+				// Not started yet, the thread will skip it
+				job.Taken = true;
+				return nullptr;
+			}
+			_prefetchWaiting = true;
+		}
+		// The sprite is being decoded right now, it won't take long
+		if (!waitStart)
+			waitStart = g_system->getMillis();
+		_prefetchDone->wait();
+	}
+}
+
+void SpriteCache::PrefetchThreadProc(void *param) {
+	SpriteCache *cache = (SpriteCache *)param;
+	std::vector<PrefetchJob> &jobs = cache->_prefetchJobs;
+	for (;;) {
+		size_t i;
+		{
+			Common::StackLock lock(cache->_prefetchMutex);
+			while (cache->_prefetchNext < jobs.size() && jobs[cache->_prefetchNext].Taken)
+				cache->_prefetchNext++;
+			if (cache->_prefetchCancel || cache->_prefetchNext >= jobs.size())
+				return;
+			i = cache->_prefetchNext++;
+		}
+
+		const uint32_t start = g_system->getMillis();
+		Bitmap *image = nullptr;
+		cache->_prefetchFile.LoadSprite(jobs[i].DataIndex, image);
+		const uint32_t loadTime = g_system->getMillis() - start;
+
+		Common::StackLock lock(cache->_prefetchMutex);
+		jobs[i].Image = image;
+		jobs[i].LoadTime = loadTime;
+		jobs[i].Done = true;
+		if (cache->_prefetchWaiting) {
+			cache->_prefetchWaiting = false;
+			cache->_prefetchDone->post();
+		}
+	}
 }
 
 } // namespace Shared
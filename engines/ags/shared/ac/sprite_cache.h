@@ -24,7 +24,8 @@
 //
 // SpriteFile handles sprite serialization and streaming.
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
-// and does MRU (most-recent-use) caching.
+// and does MRU (most-recent-use) caching. Sprites which are going to be
+// needed soon may be decoded ahead of time by a background thread.
 //
 // TODO: store sprite data in a specialized container type that is optimized
 // for having most keys allocated in large continious sequences by default.
@@ -41,14 +42,19 @@
 #ifndef AGS_SHARED_AC_SPRITE_CACHE_H
 #define AGS_SHARED_AC_SPRITE_CACHE_H
 
+#include "common/mutex.h"
 #include "common/std/memory.h"
 #include "common/std/vector.h"
-#include "common/std/list.h"
 #include "ags/shared/ac/sprite_file.h"
 #include "ags/shared/core/platform.h"
 #include "ags/shared/util/error.h"
 #include "ags/shared/util/geometry.h"
 
+namespace Common {
+class ThreadInternal;
+class SemaphoreInternal;
+}
+
 namespace AGS3 {
 
 namespace AGS {
@@ -147,12 +153,39 @@ public:
 	// Loads (if it's not in cache yet) and returns bitmap by the sprite index
 	Shared::Bitmap *operator[](sprkey_t index);
 
+	// Starts decoding the given sprites on a background thread, so they are
+	// ready when they are asked for; sprites queued before are dropped.
+	// Does nothing if the backend does not support threads.
+	void        PrefetchSprites(const std::vector<sprkey_t> &indexes);
+	// Stops the background thread and frees the sprites it decoded
+	void        StopPrefetch();
+
+	// Telemetry of the sprite prefetching
+	struct PrefetchStats {
+		uint32_t Queued = 0;   // sprites given to the background thread
+		uint32_t Used = 0;     // prefetched sprites which were asked for
+		uint32_t Wasted = 0;   // prefetched sprites which were never asked for
+		uint32_t SavedMs = 0;  // loading time the game did not have to wait for
+		uint32_t WaitedMs = 0; // time spent waiting for the background thread
+	};
+	const PrefetchStats &GetPrefetchStats() const {
+		return _prefetchStats;
+	}
+
 private:
 	// Load sprite from game resource
 	size_t      LoadSprite(sprkey_t index);
 	// Gets the index of a sprite which data is used for the given slot;
 	// in case of remapped sprite this will return the one given sprite is remapped to
 	sprkey_t    GetDataIndex(sprkey_t index);
+	// Takes the bitmap of the sprite from the background thread, if it was
+	// queued there; waits for it if it is being decoded right now
+	Shared::Bitmap *TakePrefetchedSprite(sprkey_t index, sprkey_t load_index);
+	static void PrefetchThreadProc(void *param);
+	// Puts the sprite at the beginning of the MRU list
+	void        MruPushFront(sprkey_t index);
+	// Removes the sprite from the MRU list, if it is in it
+	void        MruRemove(sprkey_t index);
 	// Delete the oldest (least recently used) image in cache
 	void        DisposeOldest();
 	// Keep disposing oldest elements until cache has at least the given free space
@@ -165,8 +198,10 @@ private:
 		// TODO: investigate if we may safely use unique_ptr here
 		// (some of these bitmaps may be assigned from outside of the cache)
 		Shared::Bitmap *Image = nullptr; // actual bitmap
-		// MRU list reference
-		std::list<sprkey_t>::iterator MruIt;
+		// MRU list links, -1 at the ends of the list
+		sprkey_t MruPrev = -1;
+		sprkey_t MruNext = -1;
+		bool InMru = false;
 
 		// Tells if there actually is a registered sprite in this slot
 		bool DoesSpriteExist() const;
@@ -191,8 +226,34 @@ private:
 
 	// MRU list: the way to track which sprites were used recently.
 	// When clearing up space for new sprites, cache first deletes the sprites
-	// that were last time used long ago.
-	std::list<sprkey_t> _mru;
+	// that were last time used long ago. The list is linked through the
+	// sprite slots, so touching a sprite does not allocate.
+	sprkey_t _mruHead = -1;
+	sprkey_t _mruTail = -1;
+	size_t _mruCount = 0;
+
+	// A sprite decoded by the background thread
+	struct PrefetchJob {
+		sprkey_t Index = 0;
+		sprkey_t DataIndex = 0;
+		Shared::Bitmap *Image = nullptr;
+		uint32_t LoadTime = 0;
+		bool Done = false;
+		bool Taken = false;
+	};
+
+	// Second stream on the sprite file, only used by the background thread
+	SpriteFile _prefetchFile;
+	std::vector<PrefetchJob> _prefetchJobs;
+	size_t _prefetchNext = 0;
+	bool _prefetchCancel = false;
+	bool _prefetchWaiting = false;
+	// Protects the jobs, which are shared with the background thread
+	Common::Mutex _prefetchMutex;
+	Common::ThreadInternal *_prefetchThread = nullptr;
+	// Posted when a sprite is done while the cache waits for it
+	Common::SemaphoreInternal *_prefetchDone = nullptr;
+	PrefetchStats _prefetchStats;
 
 	// Initialize the empty sprite slot
 	void        InitNullSpriteParams(sprkey_t index);
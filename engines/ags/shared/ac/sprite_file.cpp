@@ -229,6 +229,20 @@ HError SpriteFile::OpenFile(const String &filename, const String &sprindex_filen
 	return RebuildSpriteIndex(_stream.get(), topmost, metrics);
 }
 
+HError SpriteFile::OpenCopy(const SpriteFile &other, const String &filename) {
+	Close();
+
+	_stream.reset(_GP(AssetMgr)->OpenAsset(filename));
+	if (_stream == nullptr)
+		return new Error(String::FromFormat("Failed to open spriteset file '%s'.", filename.GetCStr()));
+
+	_spriteData = other._spriteData;
+	_version = other._version;
+	_storeFlags = other._storeFlags;
+	_compress = other._compress;
+	return HError::None();
+}
+
 void SpriteFile::Close() {
 	_stream.reset();
 	_spriteData.clear();
@@ -133,8 +133,15 @@ public:
 	// Loads sprite reference information and inits sprite stream
 	HError      OpenFile(const String &filename, const String &sprindex_filename,
 		std::vector<Size> &metrics);
+	// Opens another stream on the file opened by the given SpriteFile, so
+	// that both can read sprites at the same time
+	HError      OpenCopy(const SpriteFile &other, const String &filename);
 	// Closes stream; no reading will be possible unless opened again
 	void        Close();
+	// Tells if the file is open for reading
+	bool        IsValid() const {
+		return _stream != nullptr;
+	}
 
 	int         GetStoreFlags() const;
 	// Tells if bitmaps in the file are compressed
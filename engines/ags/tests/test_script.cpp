@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include "common/debug.h"
+#include "common/std/chrono.h"
+#include "common/textconsole.h"
+#include "ags/shared/core/platform.h"
+#include "ags/shared/script/cc_common.h"
+#include "ags/shared/script/cc_internal.h"
+#include "ags/shared/script/cc_script.h"
+#include "ags/engine/script/cc_instance.h"
+
+namespace AGS3 {
+
+// Builds a script with a single exported function "loop", which runs a loop
+// of register arithmetic and a jump the given number of times, and returns
+// the value it computed.
+static PScript CreateLoopScript(int32_t iterations) {
+	const int32_t code[] = {
+		SCMD_LOOPCHECKOFF,
+		SCMD_LITTOREG, SREG_AX, iterations,
+		SCMD_LITTOREG, SREG_BX, 0,
+		// loop:
+		SCMD_ADD, SREG_BX, 3,
+		SCMD_REGTOREG, SREG_AX, SREG_CX,
+		SCMD_BITAND, SREG_CX, SREG_BX,
+		SCMD_SUB, SREG_AX, 1,
+		SCMD_JNZ, -14,
+		SCMD_REGTOREG, SREG_BX, SREG_AX,
+		SCMD_RET
+	};
+
+	PScript script(new ccScript());
+	script->codesize = ARRAYSIZE(code);
+	script->code = (int32_t *)malloc(sizeof(code));
+	memcpy(script->code, code, sizeof(code));
+	script->imports = (char **)malloc(sizeof(char *));
+	script->numexports = 1;
+	script->exports = (char **)malloc(sizeof(char *));
+	script->exports[0] = scumm_strdup("loop");
+	script->export_addr = (int32_t *)malloc(sizeof(int32_t));
+	script->export_addr[0] = EXPORT_FUNCTION << 24;
+	return script;
+}
+
+// Runs the script and returns the time it took in milliseconds
+static uint32 RunLoopScript(ccInstance *inst, bool decoded, int32_t iterations) {
+	ScriptCodeOp *code_ops = inst->code_ops;
+	if (!decoded)
+		inst->code_ops = nullptr;
+
+	uint32 start = std::chrono::high_resolution_clock::now();
+	if (inst->CallScriptFunction("loop", 0, nullptr) != 0)
+		error("Script failed: %s", cc_get_error().ErrorString.GetCStr());
+	uint32 end = std::chrono::high_resolution_clock::now();
+	inst->code_ops = code_ops;
+
+	assert(inst->returnValue == 3 * iterations);
+	return end - start;
+}
+
+void Test_Script() {
+#ifdef SLOW_TESTS
+	const int32_t iterations = 10000000;
+#else
+	const int32_t iterations = 100000;
+#endif
+	PScript script = CreateLoopScript(iterations);
+	ccInstance *inst = ccInstance::CreateFromScript(script);
+	if (!inst || !inst->ResolveScriptImports(script.get()) || !inst->ResolveImportFixups(script.get()))
+		error("Script could not be loaded: %s", cc_get_error().ErrorString.GetCStr());
+	assert(inst->code_ops);
+
+	// Each iteration runs 5 instructions
+	const uint64 instructions = (uint64)iterations * 5 + 5;
+	for (int decoded = 0; decoded < 2; decoded++) {
+		uint32 time = MAX<uint32>(RunLoopScript(inst, decoded, iterations), 1);
+		debug("Script interpreter, %s: %u ms, %f million instructions per second\n",
+		      decoded ? "pre-decoded code" : "decoding at run time",
+		      time, (double)instructions / time / 1000.0);
+	}
+
+	delete inst;
+}
+
+} // namespace AGS3
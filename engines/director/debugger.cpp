@@ -769,12 +769,12 @@ bool Debugger::cmdBpEntity(int argc, const char **argv) {
 		}
 		bp.entity = g_lingo->_theEntities[entityName]->entity;
 		if (!fieldName.empty()) {
-			Common::String target = Common::String::format("%d%s", bp.entity, fieldName.c_str());
-			if (!g_lingo->_theEntityFields.contains(target)) {
+			TheEntityField *field = g_lingo->findTheEntityField(bp.entity, fieldName);
+			if (!field) {
 				debugPrintf("Field %s not found for entity %s.\n", fieldName.c_str(), entityName.c_str());
 				return true;
 			}
-			bp.field = g_lingo->_theEntityFields[target]->field;
+			bp.field = field->field;
 		}
 
 		if (argc == 3) {
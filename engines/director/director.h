@@ -88,6 +88,7 @@ enum {
 	kDebugImGui,
 	kDebugPaused,
 	kDebugPauseOnLoad,
+	kDebugBenchmark,
 };
 
 enum {
@@ -45,6 +45,7 @@
 #include "common/endian.h"
 
 #include "director/director.h"
+#include "director/cast.h"
 #include "director/movie.h"
 #include "director/lingo/lingo.h"
 #include "director/lingo/lingo-ast.h"
@@ -119,6 +120,38 @@ LingoCompiler::LingoCompiler() {
 	_refMode = false;
 
 	_hadError = false;
+
+	_compileCacheEnabled = true;
+	_compileCacheHits = _compileCacheMisses = 0;
+	_compileCacheSize = 0;
+	_cacheable = false;
+}
+
+LingoCompiler::~LingoCompiler() {
+	clearCompileCache();
+}
+
+// Total size of the sources the compile cache may hold
+#define COMPILE_CACHE_BUDGET (16 * 1024 * 1024)
+
+void LingoCompiler::clearCompileCache() {
+	for (auto &it : _compileCache)
+		it._value.context->decRefCount();
+
+	_compileCache.clear();
+	_compileCacheSize = 0;
+}
+
+Common::String LingoCompiler::getCompileCacheKey(const Common::U32String &code, LingoArchive *archive, ScriptType type, CastMemberID id, const Common::String &scriptName, uint32 preprocFlags) {
+	// The preprocessor and the patcher depend on the movie, the cast and
+	// the script, and the parser on the Director version
+	Movie *movie = g_director->getCurrentMovie();
+	Common::String key = Common::String::format("%s\n%s\n%d %d %d %x %d %d\n%s\n",
+		g_director->getCurrentPath().c_str(), archive->cast->getMacName().c_str(),
+		type, id.member, id.castLib, preprocFlags, g_director->getVersion(),
+		movie ? movie->_allowOutdatedLingo : false, scriptName.c_str());
+
+	return key + code.encode(Common::kUtf8);
 }
 
 ScriptContext *LingoCompiler::compileAnonymous(const Common::U32String &code, uint32 preprocFlags) {
@@ -129,6 +162,36 @@ ScriptContext *LingoCompiler::compileAnonymous(const Common::U32String &code, ui
 }
 
 ScriptContext *LingoCompiler::compileLingo(const Common::U32String &code, LingoArchive *archive, ScriptType type, CastMemberID id, const Common::String &scriptName, bool anonymous, uint32 preprocFlags) {
+	// Factories register themselves in the archive, and the debugger
+	// window needs the AST, so these are always compiled
+	Common::String cacheKey;
+	_cacheable = _compileCacheEnabled && archive && !anonymous && !debugChannelSet(-1, kDebugImGui);
+	if (_cacheable) {
+		cacheKey = getCompileCacheKey(code, archive, type, id, scriptName, preprocFlags);
+
+		if (_compileCache.contains(cacheKey)) {
+			const CachedScript &cached = _compileCache[cacheKey];
+			ScriptContext *sc = new ScriptContext(*cached.context, false);
+
+			for (uint i = 0; i < cached.globals.size(); i++) {
+				if (!g_lingo->_globalvars.contains(cached.globals[i]))
+					g_lingo->_globalvars[cached.globals[i]] = Datum();
+			}
+			for (auto &it : sc->_functionHandlers) {
+				if (!archive->functionHandlers.contains(it._key)) {
+					archive->functionHandlers[it._key] = it._value;
+				}
+			}
+
+			debugC(1, kDebugCompile, "Reusing compiled script for type %s with id %d", scriptType2str(type), id.member);
+			_compileCacheHits++;
+			_hadError = false;
+			return sc;
+		}
+		_compileCacheMisses++;
+	}
+	_globalNames.clear();
+
 	_assemblyArchive = archive;
 	_assemblyAST = nullptr;
 	_assemblyId = id.member;
@@ -259,6 +322,19 @@ ScriptContext *LingoCompiler::compileLingo(const Common::U32String &code, LingoA
 	_methodVars = nullptr;
 	_currentAssembly = nullptr;
 
+	if (_cacheable && !_hadError) {
+		if (_compileCacheSize + cacheKey.size() > COMPILE_CACHE_BUDGET)
+			clearCompileCache();
+
+		// The copy shares the byte-code of the handlers with the original,
+		// but has its own properties
+		CachedScript &cached = _compileCache[cacheKey];
+		cached.context = new ScriptContext(*mainContext, false);
+		cached.context->incRefCount();
+		cached.globals = _globalNames;
+		_compileCacheSize += cacheKey.size();
+	}
+
 	if (debugChannelSet(-1, kDebugImGui)) {
 		_assemblyContext->_assemblyAST = _assemblyAST;
 	} else {
@@ -409,11 +485,13 @@ void LingoCompiler::registerMethodVar(const Common::String &name, VarType type)
 		} else if (type == kVarGlobal) {
 			if (!g_lingo->_globalvars.contains(name))
 				g_lingo->_globalvars[name] = Datum();
+			_globalNames.push_back(name);
 		}
 	}
 }
 
 void LingoCompiler::registerFactory(Common::String &name) {
+	_cacheable = false;
 	_assemblyContext->setName(name);
 	_assemblyContext->setFactory(true);
 	g_lingo->_globalvars[name] = _assemblyContext;
@@ -656,13 +734,13 @@ bool LingoCompiler::visitPutBeforeNode(PutBeforeNode *node) {
 /* SetNode */
 
 int LingoCompiler::getTheFieldID(int entity, const Common::String &field, bool silent) {
-	Common::String fieldKey = Common::String::format("%d%s", entity, field.c_str());
-	if (!g_lingo->_theEntityFields.contains(fieldKey)) {
+	TheEntityField *theField = g_lingo->findTheEntityField(entity, field);
+	if (!theField) {
 		if (!silent)
 			warning("BUILDBOT: LingoCompiler::getTheFieldId: Unhandled the field %s of %s", field.c_str(), g_lingo->entity2str(entity));
 		return -1;
 	}
-	return g_lingo->_theEntityFields[fieldKey]->field;
+	return theField->field;
 }
 
 bool LingoCompiler::visitSetNode(SetNode *node) {
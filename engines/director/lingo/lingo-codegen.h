@@ -30,7 +30,7 @@ namespace Director {
 class LingoCompiler : NodeVisitor {
 public:
 	LingoCompiler();
-	virtual ~LingoCompiler() {}
+	virtual ~LingoCompiler();
 
 	ScriptContext *compileAnonymous(const Common::U32String &code, uint32 preprocFlags = 0);
 	ScriptContext *compileLingo(const Common::U32String &code, LingoArchive *archive, ScriptType type, CastMemberID id, const Common::String &scriptName, bool anonyomous = false, uint32 preprocFlags = kLPPNone);
@@ -71,6 +71,28 @@ public:
 
 	bool _hadError;
 
+	// Scripts compiled for an archive are kept, keyed by everything their
+	// code depends on, and compiling the same script again for the same
+	// movie hands out a copy instead of parsing it again.
+	bool _compileCacheEnabled;
+	uint32 _compileCacheHits;
+	uint32 _compileCacheMisses;
+
+	void clearCompileCache();
+
+private:
+	struct CachedScript {
+		ScriptContext *context;
+		Common::StringArray globals;
+	};
+
+	Common::String getCompileCacheKey(const Common::U32String &code, LingoArchive *archive, ScriptType type, CastMemberID id, const Common::String &scriptName, uint32 preprocFlags);
+
+	Common::HashMap<Common::String, CachedScript> _compileCache;
+	uint32 _compileCacheSize;
+	bool _cacheable;				// No factory was compiled
+	Common::StringArray _globalNames;	// Globals registered while compiling
+
 public:
 	virtual bool visitScriptNode(ScriptNode *node);
 	virtual bool visitFactoryNode(FactoryNode *node);
@@ -438,7 +438,10 @@ ScriptContext::ScriptContext(Common::String name, ScriptType type, int id)
 	_objType = kScriptObj;
 }
 
-ScriptContext::ScriptContext(const ScriptContext &sc) : Object<ScriptContext>(sc) {
+ScriptContext::ScriptContext(const ScriptContext &sc, bool inherit) : Object<ScriptContext>(sc) {
+	if (!inherit)
+		_inheritanceLevel = sc._inheritanceLevel;
+
 	_scriptType = sc._scriptType;
 	_functionNames = sc._functionNames;
 	for (auto &it : sc._functionHandlers) {
@@ -450,6 +453,7 @@ ScriptContext::ScriptContext(const ScriptContext &sc) : Object<ScriptContext>(sc
 		_eventHandlers[it._key].ctx = this;
 	}
 	_constants = sc._constants;
+	_methodNames = sc._methodNames;
 	_properties = sc._properties;
 	_propertyNames = sc._propertyNames;
 
@@ -689,14 +693,14 @@ Common::String Window::asString() {
 }
 
 bool Window::hasProp(const Common::String &propName) {
-	Common::String fieldName = Common::String::format("%d%s", kTheWindow, propName.c_str());
-	return g_lingo->_theEntityFields.contains(fieldName) && hasField(g_lingo->_theEntityFields[fieldName]->field);
+	TheEntityField *field = g_lingo->findTheEntityField(kTheWindow, propName);
+	return field && hasField(field->field);
 }
 
 Datum Window::getProp(const Common::String &propName) {
-	Common::String fieldName = Common::String::format("%d%s", kTheWindow, propName.c_str());
-	if (g_lingo->_theEntityFields.contains(fieldName)) {
-		return getField(g_lingo->_theEntityFields[fieldName]->field);
+	TheEntityField *field = g_lingo->findTheEntityField(kTheWindow, propName);
+	if (field) {
+		return getField(field->field);
 	}
 
 	warning("Window::getProp: unknown property '%s'", propName.c_str());
@@ -704,9 +708,9 @@ Datum Window::getProp(const Common::String &propName) {
 }
 
 bool Window::setProp(const Common::String &propName, const Datum &value, bool force) {
-	Common::String fieldName = Common::String::format("%d%s", kTheWindow, propName.c_str());
-	if (g_lingo->_theEntityFields.contains(fieldName)) {
-		return setField(g_lingo->_theEntityFields[fieldName]->field, value);
+	TheEntityField *field = g_lingo->findTheEntityField(kTheWindow, propName);
+	if (field) {
+		return setField(field->field, value);
 	}
 
 	warning("Window::setProp: unknown property '%s'", propName.c_str());
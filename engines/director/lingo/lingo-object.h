@@ -230,7 +230,9 @@ private:
 
 public:
 	ScriptContext(Common::String name, ScriptType type = kNoneScript, int id = 0);
-	ScriptContext(const ScriptContext &sc);
+	// A copy which does not inherit from @p sc is the same script, such as
+	// a context reused from the compile cache, rather than a child object
+	ScriptContext(const ScriptContext &sc, bool inherit = true);
 	~ScriptContext() override;
 
 	bool isFactory() const { return _objType == kFactoryObj; };
@@ -325,16 +325,17 @@ void Lingo::initTheEntities() {
 
 	TheEntityField *f = fields;
 	_fieldNames.resize(kTheMaxTheFieldType);
+	_theEntityFields.resize(kTheMaxTheEntityType);
 
 	while (f->entity != kTheNOEntity) {
 		if (f->version <= _vm->getVersion()) {
-			_theEntityFields[Common::String::format("%d%s", f->entity, f->name)] = f;
+			_theEntityFields[f->entity][f->name] = f;
 
 			_fieldNames[f->field] = f->name;
 		}
 
 		// Store all fields for kTheObject
-		_theEntityFields[Common::String::format("%d%s", _objectEntityId, f->name)] = f;
+		_theEntityFields[_objectEntityId][f->name] = f;
 
 		f++;
 	}
@@ -343,6 +344,7 @@ void Lingo::initTheEntities() {
 void Lingo::cleanUpTheEntities() {
 	_entityNames.clear();
 	_fieldNames.clear();
+	_theEntityFields.clear();
 }
 
 const char *Lingo::entity2str(int id) {
@@ -366,6 +368,17 @@ const char *Lingo::field2str(int id) {
 	return (const char *)buf;
 }
 
+TheEntityField *Lingo::findTheEntityField(int entity, const Common::String &field) {
+	if (entity < 0 || entity >= (int)_theEntityFields.size())
+		return nullptr;
+
+	TheEntityFieldHash::const_iterator it = _theEntityFields[entity].find(field);
+	if (it == _theEntityFields[entity].end())
+		return nullptr;
+
+	return it->_value;
+}
+
 #define getTheEntitySTUB(entity) \
 	warning("Lingo::getTheEntity(): Unprocessed getting entity %s", entity2str(entity));
 
@@ -2037,11 +2050,11 @@ void Lingo::getObjectProp(Datum &obj, Common::String &propName) {
 			// No matching cast member. Many of the fields are accessible
 			// to indicate the cast member is empty, however the
 			// rest will throw a Lingo error.
-			Common::String key = Common::String::format("%d%s", kTheCast, propName.c_str());
+			TheEntityField *field = findTheEntityField(kTheCast, propName);
 			bool emptyAllowed = false;
-			if (_theEntityFields.contains(key)) {
+			if (field) {
 				emptyAllowed = true;
-				switch (_theEntityFields[key]->field) {
+				switch (field->field) {
 				case kTheCastType:
 				case kTheType:
 					d = Datum("empty");
@@ -463,6 +463,7 @@ public:
 	void cleanUpTheEntities();
 	const char *entity2str(int id);
 	const char *field2str(int id);
+	TheEntityField *findTheEntityField(int entity, const Common::String &field);
 
 	// global kTheEntity
 	Datum _actorList;
@@ -509,7 +510,7 @@ public:
 	bool _caughtError;
 
 	TheEntityHash _theEntities;
-	TheEntityFieldHash _theEntityFields;
+	Common::Array<TheEntityFieldHash> _theEntityFields;	// Fields by name, for each entity
 
 	int _objectEntityId;
 
@@ -19,6 +19,8 @@
  *
  */
 
+#include "common/algorithm.h"
+#include "common/archive.h"
 #include "common/config-manager.h"
 #include "common/system.h"
 #include "common/compression/deflate.h"
@@ -35,9 +37,13 @@
 
 #include "director/director.h"
 #include "director/archive.h"
+#include "director/cast.h"
 #include "director/movie.h"
 #include "director/picture.h"
 #include "director/window.h"
+#include "director/lingo/lingo.h"
+#include "director/lingo/lingo-codegen.h"
+#include "director/lingo/lingo-the.h"
 
 #include "image/pict.h"
 
@@ -165,6 +171,94 @@ void Window::testFonts() {
 	delete fontFile;
 }
 
+void Window::benchmarkLingo() {
+	Common::ArchiveMemberList fsList;
+	SearchMan.listMatchingMembers(fsList, "*.lingo");
+	Common::Array<Common::Path> fileList;
+	for (auto &it : fsList)
+		fileList.push_back(it->getPathInArchive());
+
+	Common::sort(fileList.begin(), fileList.end());
+
+	Common::Array<Common::U32String> scripts;
+	for (uint i = 0; i < fileList.size(); i++) {
+		Common::SeekableReadStream *const stream = SearchMan.createReadStreamForMember(fileList[i]);
+		if (!stream)
+			continue;
+
+		uint size = stream->size();
+		char *script = (char *)calloc(size + 1, 1);
+		stream->read(script, size);
+		scripts.push_back(Common::U32String(script, Common::kMacRoman));
+
+		free(script);
+		delete stream;
+	}
+
+	// Compile all test scripts without the compile cache, then with a cold
+	// and with a warm one
+	LingoCompiler *compiler = g_lingo->_compiler;
+	Cast *cast = _currentMovie->getMainLingoArch()->cast;
+	const char *compileModes[] = { "no cache", "cold cache", "warm cache" };
+	const int passes = 10;
+
+	for (int mode = 0; mode < ARRAYSIZE(compileModes); mode++) {
+		compiler->_compileCacheEnabled = (mode != 0);
+		if (mode == 1)
+			compiler->clearCompileCache();
+		compiler->_compileCacheHits = compiler->_compileCacheMisses = 0;
+
+		const int modePasses = (mode == 1) ? 1 : passes;
+		uint32 start = g_system->getMillis();
+		for (int pass = 0; pass < modePasses; pass++) {
+			LingoArchive *archive = new LingoArchive(cast);
+			for (uint i = 0; i < scripts.size(); i++)
+				archive->addCode(scripts[i], kTestScript, i + 1);
+			delete archive;
+		}
+		uint32 time = g_system->getMillis() - start;
+
+		debug("Lingo compilation, %s: %u scripts in %u ms per pass, %u cache hits, %u misses", compileModes[mode],
+			scripts.size(), time / modePasses, compiler->_compileCacheHits, compiler->_compileCacheMisses);
+	}
+
+	// Look up cast member properties by a key built from the entity and
+	// the property name in a single table, and in the table of the entity
+	const char *propNames[] = { "name", "width", "height", "rect", "castType", "fileName", "number", "loaded", "regPoint", "scriptText" };
+	Common::StringArray props;
+	for (int i = 0; i < ARRAYSIZE(propNames); i++)
+		props.push_back(propNames[i]);
+
+	TheEntityFieldHash keyedFields;
+	for (uint entity = 0; entity < g_lingo->_theEntityFields.size(); entity++) {
+		for (auto &it : g_lingo->_theEntityFields[entity])
+			keyedFields[Common::String::format("%d%s", entity, it._key.c_str())] = it._value;
+	}
+
+	const char *lookupModes[] = { "entity and name keys", "entity tables" };
+	const int lookups = 1000000;
+
+	for (int mode = 0; mode < ARRAYSIZE(lookupModes); mode++) {
+		int found = 0;
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < lookups; i++) {
+			const Common::String &propName = props[i % props.size()];
+			if (mode == 0) {
+				Common::String key = Common::String::format("%d%s", kTheCast, propName.c_str());
+				if (keyedFields.contains(key) && keyedFields[key]->field != kTheNOField)
+					found++;
+			} else {
+				TheEntityField *field = g_lingo->findTheEntityField(kTheCast, propName);
+				if (field && field->field != kTheNOField)
+					found++;
+			}
+		}
+		uint32 time = g_system->getMillis() - start;
+
+		debug("Lingo property lookups, %s: %d lookups in %u ms, %d found", lookupModes[mode], lookups, time, found);
+	}
+}
+
 //////////////////////
 // Movie iteration
 //////////////////////
@@ -338,6 +432,9 @@ void Window::runTests() {
 		testFonts();
 	}
 
+	if (debugChannelSet(-1, kDebugBenchmark))
+		benchmarkLingo();
+
 	g_lingo->runTests();
 }
 
@@ -174,6 +174,7 @@ public:
 	Common::HashMap<Common::String, Movie *> *scanMovies(const Common::Path &folder);
 	void testFontScaling();
 	void testFonts();
+	void benchmarkLingo();
 	void enqueueAllMovies();
 	MovieReference getNextMovieFromQueue();
 	void runTests();
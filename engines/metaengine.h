@@ -158,6 +158,17 @@ public:
 	 */
 	virtual DetectedGames detectGames(const Common::FSList &fslist, uint32 skipADFlags = 0, bool skipIncomplete = false) = 0;
 
+	/**
+	 * Queue the files which detectGames() is going to read from the given
+	 * list of files in the detection cache. The cache then reads the files
+	 * queued by all engines at once, using several threads, before
+	 * detectGames() is called.
+	 *
+	 * This is only an optimization: detectGames() must return the same
+	 * results whether this was called or not.
+	 */
+	virtual void queueDetectionReads(const Common::FSList &fslist) {}
+
 	/** Returns the number of bytes used for MD5-based detection, or 0 if not supported. */
 	virtual uint getMD5Bytes() const = 0;
 
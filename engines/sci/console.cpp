@@ -117,6 +117,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -233,6 +234,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("script_stats",		WRAP_METHOD(Console, cmdScriptStats));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -357,6 +359,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" resource_cache - Shows statistics of the resource cache\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -447,6 +450,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" script_stats - Shows how often each SCI operation was executed, and statistics of the selector cache\n");
 	debugPrintf(" script_objects / scro - Shows all objects inside a specified script\n");
 	debugPrintf(" script_strings / scrs - Shows all strings inside a specified script\n");
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
@@ -1134,6 +1138,37 @@ bool Console::cmdAllocList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		resMan->resetCacheStats();
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows statistics of the resource cache\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const ResourceManager::CacheStats &stats = resMan->getCacheStats();
+	debugPrintf("Cache: %d of %d KiB in use, %d KiB locked\n", resMan->getCacheMemory() / 1024, resMan->getCacheSize() / 1024, resMan->getLockedMemory() / 1024);
+	debugPrintf("Hits: %u, misses: %u, evictions: %u, prefetched: %u\n", stats.hits, stats.misses, stats.evictions, stats.prefetches);
+	if (stats.hits + stats.misses)
+		debugPrintf("Hit rate: %u%%\n", stats.hits * 100 / (stats.hits + stats.misses));
+
+	debugPrintf("Pinned types:");
+	bool pinned = false;
+	for (int i = 0; i < kResourceTypeInvalid; ++i) {
+		if (resMan->isPinnedType((ResourceType)i)) {
+			debugPrintf(" %s", getResourceTypeName((ResourceType)i));
+			pinned = true;
+		}
+	}
+	debugPrintf(pinned ? "\n" : " none\n");
+
+	return true;
+}
+
 bool Console::cmdDissectScript(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Examines a script\n");
@@ -3440,6 +3475,55 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+struct OpcodeCountGreater {
+	OpcodeCountGreater(const uint32 *counts) : _counts(counts) {}
+	bool operator()(uint a, uint b) const { return _counts[a] > _counts[b]; }
+
+	const uint32 *_counts;
+};
+
+bool Console::cmdScriptStats(int argc, const char **argv) {
+	EngineState *s = _engine->_gamestate;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		memset(s->_opcodeCounts, 0, sizeof(s->_opcodeCounts));
+		s->_sendCache.resetStats();
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows how often each SCI operation was executed, and statistics of the selector cache\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	const uint32 hits = s->_sendCache.getHits();
+	const uint32 misses = s->_sendCache.getMisses();
+	debugPrintf("Send selector cache hits: %u, misses: %u\n", hits, misses);
+	if (hits + misses)
+		debugPrintf("Hit rate: %u%%\n", (uint32)((uint64)hits * 100 / (hits + misses)));
+
+	// List the operations, most frequent first
+	Common::Array<uint> opcodes;
+	uint64 total = 0;
+	for (uint i = 0; i < ARRAYSIZE(s->_opcodeCounts); i++) {
+		if (s->_opcodeCounts[i]) {
+			opcodes.push_back(i);
+			total += s->_opcodeCounts[i];
+		}
+	}
+	Common::sort(opcodes.begin(), opcodes.end(), OpcodeCountGreater(s->_opcodeCounts));
+
+	for (uint i = 0; i < opcodes.size(); i++) {
+		const uint32 count = s->_opcodeCounts[opcodes[i]];
+#ifndef REDUCE_MEMORY_USAGE
+		debugPrintf("%02x %-8s %10u %6.2f%%\n", opcodes[i], opcodeNames[opcodes[i]], count, count * 100.0 / total);
+#else
+		debugPrintf("%02x %10u %6.2f%%\n", opcodes[i], count, count * 100.0 / total);
+#endif
+	}
+
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("Shows all objects inside a specified script.\n");
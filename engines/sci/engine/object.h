@@ -279,6 +279,12 @@ public:
 	uint16 getMethodCount() const { return _methodCount; }
 	reg_t getPos() const { return _pos; }
 
+	/**
+	 * @returns The raw object data within the owner script, which an object
+	 * shares with its clones.
+	 */
+	const SciSpan<const byte> &getBaseObject() const { return _baseObj; }
+
 	void saveLoadWithSerializer(Common::Serializer &ser) override;
 
 	void cloneFromObject(const Object *obj) {
@@ -34,6 +34,8 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
 	_heap.push_back(0);
 
+	_scriptGeneration = 1;
+
 	_clonesSegId = 0;
 	_listsSegId = 0;
 	_nodesSegId = 0;
@@ -65,6 +67,7 @@ void SegManager::resetSegMan() {
 
 	// And reinitialize
 	_heap.push_back(0);
+	_scriptGeneration++;
 
 	_clonesSegId = 0;
 	_listsSegId = 0;
@@ -165,6 +168,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_scriptGeneration++;
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -1105,6 +1109,7 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 #ifdef ENABLE_SCI32
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
+	_scriptGeneration++;
 
 	return segmentId;
 }
@@ -1124,6 +1129,8 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (scr->getLockers() > 0)
 		return;
 
+	_scriptGeneration++;
+
 	// Free all classtable references to this script
 	for (uint i = 0; i < classTableSize(); i++)
 		if (getClass(i).reg.getSegment() == segmentId)
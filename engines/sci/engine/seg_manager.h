@@ -123,6 +123,13 @@ public:
 	 */
 	void uninstantiateScript(int script_nr);
 
+	/**
+	 * Returns a counter which changes whenever scripts are loaded or unloaded.
+	 * Lookups cached from script objects are only valid as long as it stays
+	 * the same.
+	 */
+	uint32 getScriptGeneration() const { return _scriptGeneration; }
+
 private:
 	void uninstantiateScriptSci0(int script_nr);
 
@@ -465,6 +472,7 @@ private:
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
 	Common::HashMap<int, SegmentId> _scriptSegMap;
+	uint32 _scriptGeneration; ///< See getScriptGeneration()
 
 	ResourceManager *_resMan;
 	ScriptPatcher *_scriptPatcher;
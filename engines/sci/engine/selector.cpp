@@ -367,4 +367,64 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 //	return _lookupSelector_function(segMan, obj, selectorId, fptr);
 }
 
+SendCache::SendCache() {
+	clear();
+	resetStats();
+}
+
+void SendCache::clear() {
+	for (uint i = 0; i < kSlotCount; i++)
+		_slots[i].generation = 0;
+}
+
+SelectorType SendCache::lookup(SegManager *segMan, reg_t callSite, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
+	const Object *obj = segMan->getObject(obj_location);
+	if (!obj || !obj->getBaseObject().data())
+		return lookupSelector(segMan, obj_location, selectorId, varp, fptr);
+
+	if (getSciVersion() == SCI_VERSION_0_EARLY)
+		selectorId &= ~1;
+
+	// The result of a lookup only depends on the object definition, which
+	// holds the methods of the object and of its clones, on whether it is
+	// a class, which decides where its variables are defined, and on its
+	// superclass
+	const byte *baseObj = obj->getBaseObject().data();
+	const reg_t superClass = obj->getSuperClassSelector();
+	const bool isClass = obj->isClass();
+	const uint32 generation = segMan->getScriptGeneration();
+
+	Slot &slot = _slots[(callSite.getOffset() ^ (callSite.getSegment() << 5) ^ (selectorId * 0x9e5)) & (kSlotCount - 1)];
+	if (slot.generation == generation && slot.baseObj == baseObj && slot.selector == selectorId &&
+		slot.superClass == superClass && slot.isClass == isClass) {
+		_hits++;
+	} else {
+		_misses++;
+		ObjVarRef ref;
+		reg_t funcp;
+		const SelectorType type = lookupSelector(segMan, obj_location, selectorId, &ref, &funcp);
+		if (type == kSelectorNone)
+			return kSelectorNone;
+
+		slot.generation = generation;
+		slot.baseObj = baseObj;
+		slot.superClass = superClass;
+		slot.isClass = isClass;
+		slot.selector = selectorId;
+		slot.type = type;
+		slot.varIndex = type == kSelectorVariable ? ref.varindex : -1;
+		slot.funcp = type == kSelectorMethod ? funcp : NULL_REG;
+	}
+
+	if (slot.type == kSelectorVariable) {
+		if (varp) {
+			varp->obj = obj_location;
+			varp->varindex = slot.varIndex;
+		}
+	} else if (fptr) {
+		*fptr = slot.funcp;
+	}
+	return slot.type;
+}
+
 } // End of namespace Sci
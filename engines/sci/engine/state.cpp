@@ -119,6 +119,9 @@ void EngineState::reset(bool isRestoring) {
 
 	scriptStepCounter = 0;
 	scriptGCInterval = GC_INTERVAL;
+	memset(_opcodeCounts, 0, sizeof(_opcodeCounts));
+	_sendCache.clear();
+	_sendCache.resetStats();
 }
 
 void EngineState::speedThrottler(uint32 neededSleep) {
@@ -172,6 +172,8 @@ struct EngineState : public Common::Serializable {
 
 	int scriptStepCounter; // Counts the number of steps executed
 	int scriptGCInterval; // Number of steps in between gcs
+	uint32 _opcodeCounts[128]; ///< Number of times each opcode was executed, see the script_stats console command
+	SendCache _sendCache; ///< Selector lookup cache of the send operations
 
 	uint16 currentRoomNumber() const;
 	void setRoomNumber(uint16 roomNumber);
@@ -169,6 +169,11 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 		if (type == VAR_TEMP && value.getSegment() == kUninitializedSegment)
 			value.setSegment(0);
 
+		// Scripts set the number of the next room a few cycles before it
+		// is started, so its resources can be loaded while the game waits
+		if (type == VAR_GLOBAL && index == kGlobalVarNewRoomNo && value != s->variables[type][index])
+			g_sci->getResMan()->prefetchRoom(value.getOffset());
+
 		s->variables[type][index] = value;
 
 		g_sci->_guestAdditions->writeVarHook(type, index, value);
@@ -232,7 +237,7 @@ static void _exec_varselectors(EngineState *s) {
 }
 
 
-ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPtr sp, int framesize, StackPtr argp) {
+ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPtr sp, int framesize, StackPtr argp, reg_t callSite) {
 	// send_obj and work_obj are equal for anything but 'super'
 	// Returns a pointer to the TOS exec_stack element
 	assert(s);
@@ -258,7 +263,7 @@ ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj, StackPt
 		g_sci->_guestAdditions->sendSelectorHook(send_obj, selector, argp);
 #endif
 
-		SelectorType selectorType = lookupSelector(s->_segMan, send_obj, selector, &varp, &funcp);
+		SelectorType selectorType = s->_sendCache.lookup(s->_segMan, callSite, send_obj, selector, &varp, &funcp);
 		if (selectorType == kSelectorNone)
 			error("Send to invalid selector 0x%x (%s) of object at %04x:%04x", 0xffff & selector, g_sci->getKernel()->getSelectorName(0xffff & selector).c_str(), PRINT_REG(send_obj));
 
@@ -624,6 +629,7 @@ void run_vm(EngineState *s) {
 		byte extOpcode;
 		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
 		const byte opcode = extOpcode >> 1;
+		++s->_opcodeCounts[opcode];
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
 #ifdef ABORT_ON_INFINITE_LOOP
@@ -964,7 +970,8 @@ void run_vm(EngineState *s) {
 
 			s->xs->sp[1].incOffset(s->r_rest);
 			xs_new = send_selector(s, s->r_acc, s->r_acc, s_temp,
-									(int)(opparams[0] >> 1) + (uint16)s->r_rest, s->xs->sp);
+									(int)(opparams[0] >> 1) + (uint16)s->r_rest, s->xs->sp,
+									s->xs->addr.pc);
 
 			if (xs_new && xs_new != s->xs)
 				s->_executionStackPosChanged = true;
@@ -1011,7 +1018,7 @@ void run_vm(EngineState *s) {
 			s->xs->sp[1].incOffset(s->r_rest);
 			xs_new = send_selector(s, s->xs->objp, s->xs->objp,
 									s_temp, (int)(opparams[0] >> 1) + (uint16)s->r_rest,
-									s->xs->sp);
+									s->xs->sp, s->xs->addr.pc);
 
 			if (xs_new && xs_new != s->xs)
 				s->_executionStackPosChanged = true;
@@ -1040,7 +1047,7 @@ void run_vm(EngineState *s) {
 				s->xs->sp[1].incOffset(s->r_rest);
 				xs_new = send_selector(s, r_temp, s->xs->objp, s_temp,
 										(int)(opparams[1] >> 1) + (uint16)s->r_rest,
-										s->xs->sp);
+										s->xs->sp, s->xs->addr.pc);
 
 				if (xs_new && xs_new != s->xs)
 					s->_executionStackPosChanged = true;
@@ -360,10 +360,12 @@ ExecStack *execute_method(EngineState *s, uint16 script, uint16 pubfunct,
  * 						[selector_number][argument_counter] and then
  * 						"argument_counter" word entries with the
  * 						parameter values.
+ * @param[in] callSite	Address of the send operation, used to pick the
+ * 						slots of the selector lookup cache
  * @return				A pointer to the new execution stack TOS entry
  */
 ExecStack *send_selector(EngineState *s, reg_t send_obj, reg_t work_obj,
-	StackPtr sp, int framesize, StackPtr argp);
+	StackPtr sp, int framesize, StackPtr argp, reg_t callSite = NULL_REG);
 
 
 /**
@@ -397,6 +399,55 @@ void run_vm(EngineState *s);
 SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
 		ObjVarRef *varp, reg_t *fptr);
 
+/**
+ * Inline cache for the selector lookups of send operations.
+ *
+ * Each call site and selector gets a slot, which remembers the result of the
+ * last lookup together with the object definition and superclass it was made
+ * for. As long as the same kind of object is sent the same selector from the
+ * same place, its class chain is not walked again. Slots are invalidated when
+ * scripts are loaded or unloaded, see SegManager::getScriptGeneration().
+ */
+class SendCache {
+public:
+	SendCache();
+
+	/**
+	 * Looks up a selector like lookupSelector(), through the cache.
+	 * @param[in] callSite		Address of the send operation, which only
+	 * 							selects the slot to use
+	 */
+	SelectorType lookup(SegManager *segMan, reg_t callSite, reg_t obj, Selector selectorId,
+		ObjVarRef *varp, reg_t *fptr);
+
+	/** Invalidates all slots. */
+	void clear();
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	void resetStats() { _hits = _misses = 0; }
+
+private:
+	enum {
+		kSlotCount = 1024
+	};
+
+	struct Slot {
+		uint32 generation; ///< Script generation of the lookup, 0 if unused
+		const byte *baseObj;
+		reg_t superClass;
+		bool isClass;
+		Selector selector;
+		SelectorType type;
+		int varIndex;
+		reg_t funcp;
+	};
+
+	Slot _slots[kSlotCount];
+	uint32 _hits;
+	uint32 _misses;
+};
+
 /**
  * Read a PMachine instruction from a memory buffer and return its length.
  *
@@ -207,6 +207,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_loadCost = 0;
+	_cachePriority = 0;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -419,7 +421,11 @@ void ResourceManager::disposeVolumeFileStream(Common::SeekableReadStream *fileSt
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	// Sources which decompress the resource set a higher cost
+	res->_loadCost = 0;
 	res->_source->loadResource(this, res);
+	if (!res->_loadCost)
+		res->_loadCost = res->size();
 	if (_patcher) {
 		_patcher->applyPatch(*res);
 	};
@@ -1006,6 +1012,10 @@ void ResourceManager::init() {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
 	_LRU.clear();
+	_cacheClock = 0;
+	_pinnedTypes = 0;
+	_prefetchQueue.clear();
+	resetCacheStats();
 	_resMap.clear();
 	_audioMapSCI1 = nullptr;
 #ifdef ENABLE_SCI32
@@ -1079,6 +1089,14 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	if (ConfMan.hasKey("resource_cache_size") && ConfMan.getInt("resource_cache_size") > 0)
+		_maxMemoryLRU = ConfMan.getInt("resource_cache_size") * 1024;
+
+	// Views, pics and scripts are needed again and again while a room is
+	// running, so they can be kept in memory at the expense of the rest
+	if (ConfMan.hasKey("resource_cache_pin") && ConfMan.getBool("resource_cache_pin"))
+		_pinnedTypes = (1ULL << kResourceTypeView) | (1ULL << kResourceTypePic) | (1ULL << kResourceTypeScript) | (1ULL << kResourceTypeHeap);
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1137,6 +1155,8 @@ void ResourceManager::addToLRU(Resource *res) {
 	}
 	_LRU.push_front(res);
 	_memoryLRU += res->size();
+	// Resources which are expensive to load for their size stay longer
+	res->_cachePriority = _cacheClock + res->_loadCost * 16 / MAX<uint32>(res->size(), 1);
 #ifdef SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
 	      res->_id.toString().c_str(), res->size,
@@ -1148,13 +1168,84 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
 		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
-		removeFromLRU(goner);
-		goner->unalloc();
+
+		// Evict the resource with the lowest priority, where the priority
+		// is the cost of loading the resource again per byte it occupies,
+		// on top of the priority of the last evicted resource
+		// (GreedyDual-Size). Resources which are not used anymore thus age
+		// out, while cheap ones go first. Ties are broken by least recent
+		// use, and pinned types only go when nothing else is left.
+		Common::List<Resource *>::iterator goner = _LRU.end();
+		for (Common::List<Resource *>::iterator it = _LRU.begin(); it != _LRU.end(); ++it) {
+			if (goner == _LRU.end()) {
+				goner = it;
+				continue;
+			}
+
+			bool pinned = isPinnedType((*it)->getType());
+			bool gonerPinned = isPinnedType((*goner)->getType());
+			if (pinned != gonerPinned) {
+				if (!pinned)
+					goner = it;
+			} else if ((*it)->_cachePriority <= (*goner)->_cachePriority) {
+				goner = it;
+			}
+		}
+
+		Resource *res = *goner;
+		_cacheClock = MAX(_cacheClock, res->_cachePriority);
+		removeFromLRU(res);
+		res->unalloc();
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
-		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
+		debug("resMan-debug: LRU: Freeing %s (%d bytes)", res->_id.toString().c_str(), res->size);
 #endif
 	}
+
+	// Rebase the priorities long before they could overflow
+	if (_cacheClock >= 0x80000000) {
+		for (Common::List<Resource *>::iterator it = _LRU.begin(); it != _LRU.end(); ++it)
+			(*it)->_cachePriority -= MIN((*it)->_cachePriority, _cacheClock);
+		_cacheClock = 0;
+	}
+}
+
+void ResourceManager::resetCacheStats() {
+	_cacheStats.hits = 0;
+	_cacheStats.misses = 0;
+	_cacheStats.evictions = 0;
+	_cacheStats.prefetches = 0;
+}
+
+void ResourceManager::prefetchRoom(uint16 roomNumber) {
+	static const ResourceType types[] = { kResourceTypeScript, kResourceTypeHeap, kResourceTypePic };
+
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		Resource *res = testResource(ResourceId(types[i], roomNumber));
+		if (res && res->_status == kResStatusNoMalloc)
+			_prefetchQueue.push_back(res->_id);
+	}
+}
+
+bool ResourceManager::prefetchResource() {
+	while (!_prefetchQueue.empty()) {
+		Resource *res = testResource(_prefetchQueue.front());
+		_prefetchQueue.pop_front();
+
+		// The game may have loaded it in the meantime
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		loadResource(res);
+		if (res->_status == kResStatusAllocated) {
+			addToLRU(res);
+			freeOldResources();
+			_cacheStats.prefetches++;
+		}
+		return true;
+	}
+
+	return false;
 }
 
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
@@ -1193,9 +1284,14 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return nullptr;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	} else {
+		_cacheStats.hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -2354,6 +2450,23 @@ int Resource::readResourceInfo(ResVersion volVersion, Common::SeekableReadStream
 	return (compression == kCompUnknown) ? SCI_ERROR_UNKNOWN_COMPRESSION : SCI_ERROR_NONE;
 }
 
+// Rough cost of unpacking a byte with each compression method, relative to
+// reading a byte from disk
+static uint32 getDecompressionCost(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return 0;
+	case kCompHuffman:
+		return 8;
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		// These are also reordered after unpacking
+		return 6;
+	default:
+		return 4;
+	}
+}
+
 int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file) {
 	int errorNum;
 	uint32 szPacked = 0;
@@ -2399,6 +2512,8 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 	if (errorNum) {
 		unalloc();
 	} else {
+		_loadCost = szPacked + _size * getDecompressionCost(compression);
+
 		// At least Lighthouse puts sound effects in RESSCI.00n/RESSCI.PAT
 		// instead of using a RESOURCE.SFX
 		if (getType() == kResourceTypeAudio) {
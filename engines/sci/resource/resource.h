@@ -309,6 +309,8 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	uint32 _loadCost; /**< Bytes read to load the resource, plus a weight for decompressing it */
+	uint32 _cachePriority; /**< Priority in the resource cache, see ResourceManager::freeOldResources() */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -394,6 +396,33 @@ public:
 	 */
 	Resource *testResource(const ResourceId &id) const;
 
+	/** Statistics of the resource cache, shown by the debugger. */
+	struct CacheStats {
+		uint32 hits;		///< Resources found in memory
+		uint32 misses;		///< Resources which had to be loaded
+		uint32 evictions;	///< Resources freed to make room for others
+		uint32 prefetches;	///< Resources loaded ahead of time
+	};
+
+	const CacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats();
+	int getCacheMemory() const { return _memoryLRU; }
+	int getCacheSize() const { return _maxMemoryLRU; }
+	int getLockedMemory() const { return _memoryLocked; }
+	bool isPinnedType(ResourceType type) const { return (_pinnedTypes & (1ULL << type)) != 0; }
+
+	/**
+	 * Queues the script, heap and pic resources of a room to be loaded while
+	 * the game is idle, before the room is started.
+	 */
+	void prefetchRoom(uint16 roomNumber);
+
+	/**
+	 * Loads the next resource queued by prefetchRoom().
+	 * @return false if there was nothing to load
+	 */
+	bool prefetchResource();
+
 	/**
 	 * Returns a list of all resources of the specified type.
 	 * @param type		The resource type to look for
@@ -494,6 +523,10 @@ protected:
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
 	int _maxMemoryLRU;
+	uint32 _cacheClock;	///< Priority of the last resource evicted from the cache
+	uint64 _pinnedTypes;	///< Bitmask of resource types which are evicted last
+	CacheStats _cacheStats;
+	Common::List<ResourceId> _prefetchQueue;
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	typedef Common::List<ResourceSource *> SourcesList;
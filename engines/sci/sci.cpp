@@ -1012,7 +1012,9 @@ void SciEngine::sleep(uint32 msecs) {
 #endif
 		uint32 time = _system->getMillis();
 		if (time + 10 < wakeUpTime) {
-			_system->delayMillis(10);
+			// Use the time to load the resources of the next room, if any
+			if (!_resMan->prefetchResource())
+				_system->delayMillis(10);
 		} else {
 			if (time < wakeUpTime)
 				_system->delayMillis(wakeUpTime - time);
@@ -80,6 +80,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 	registerCmd("matrix",    WRAP_METHOD(ScummDebugger, Cmd_PrintBoxMatrix));
 	registerCmd("camera",    WRAP_METHOD(ScummDebugger, Cmd_Camera));
 	registerCmd("room",      WRAP_METHOD(ScummDebugger, Cmd_Room));
+	registerCmd("bgbench",   WRAP_METHOD(ScummDebugger, Cmd_BgBench));
 	registerCmd("objects",   WRAP_METHOD(ScummDebugger, Cmd_PrintObjects));
 	registerCmd("object",    WRAP_METHOD(ScummDebugger, Cmd_Object));
 	registerCmd("script",    WRAP_METHOD(ScummDebugger, Cmd_Script));
@@ -379,6 +380,53 @@ bool ScummDebugger::Cmd_Room(int argc, const char **argv) {
 	}
 }
 
+bool ScummDebugger::Cmd_BgBench(int argc, const char **argv) {
+	int iterations = (argc > 1) ? atoi(argv[1]) : 100;
+	if (iterations <= 0) {
+		debugPrintf("Usage: bgbench [<iterations>]\n");
+		return true;
+	}
+
+	if (_vm->_game.heversion >= 71) {
+		debugPrintf("Room backgrounds are not drawn strip by strip in this game\n");
+		return true;
+	}
+
+	if (!_vm->_roomResource) {
+		debugPrintf("No room is loaded\n");
+		return true;
+	}
+
+	Gdi *gdi = _vm->_gdi;
+	const bool cacheEnabled = gdi->_stripCacheEnabled;
+	const int numStrips = gdi->_numStrips;
+	const uint32 strips = (uint32)iterations * numStrips;
+
+	debugPrintf("Redrawing the %d visible strips of room %d [%d] %d times\n", numStrips, _vm->_currentRoom, _vm->_roomResource, iterations);
+
+	for (int cached = 0; cached < 2; cached++) {
+		gdi->_stripCacheEnabled = cached;
+		gdi->flushStripCache();
+		gdi->_stripCacheHits = gdi->_stripCacheMisses = 0;
+
+		const uint32 start = g_system->getMillis();
+		for (int i = 0; i < iterations; i++)
+			_vm->redrawBGStrip(0, numStrips);
+		const uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		debugPrintf("%s: %u ms, %u strips per second", cached ? "Strip cache" : "Decoding", time, (uint32)((uint64)strips * 1000 / time));
+		if (cached)
+			debugPrintf(", %u hits, %u misses", gdi->_stripCacheHits, gdi->_stripCacheMisses);
+		debugPrintf("\n");
+	}
+
+	gdi->_stripCacheEnabled = cacheEnabled;
+
+	// The objects drawn over the background have to be drawn again
+	_vm->_fullRedraw = true;
+	return true;
+}
+
 bool ScummDebugger::Cmd_LoadGame(int argc, const char **argv) {
 	if (argc > 1) {
 		int slot = atoi(argv[1]);
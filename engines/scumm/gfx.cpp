@@ -216,6 +216,16 @@ Gdi::Gdi(ScummEngine *vm) : _vm(vm) {
 	_zbufferDisabled = false;
 	_objectMode = false;
 	_distaff = false;
+
+	_stripCache.image = nullptr;
+	_stripCache.height = 0;
+	_stripCache.numZBuffer = 0;
+	_stripCache.paletteMod = 0;
+	_stripCache.paletteHash = 0;
+	_stripCache.stripSize = 0;
+	_stripCacheEnabled = true;
+	_stripCacheHits = 0;
+	_stripCacheMisses = 0;
 }
 
 Gdi::~Gdi() {
@@ -285,6 +295,7 @@ void Gdi::init() {
 }
 
 void Gdi::roomChanged(byte *roomptr) {
+	flushStripCache();
 }
 
 void GdiNES::roomChanged(byte *roomptr) {
@@ -1172,7 +1183,7 @@ void ScummEngine::redrawBGStrip(int start, int num) {
 	else
 		room = getResourceAddress(rtRoom, _roomResource);
 
-	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, 0);
+	_gdi->drawBitmap(room + _IM00_offs, &_virtscr[kMainVirtScreen], s, 0, _roomWidth, _virtscr[kMainVirtScreen].h, s, num, Gdi::dbRoomImage);
 }
 
 void ScummEngine::restoreBackground(Common::Rect rect, byte backColor) {
@@ -2301,6 +2312,47 @@ int Gdi::getZPlanes(const byte *ptr, const byte *zplane_list[9], bool bmapImage)
 	return numzbuf;
 }
 
+void Gdi::flushStripCache() {
+	_stripCache.image = nullptr;
+	_stripCache.data.clear();
+	_stripCache.valid.clear();
+}
+
+/**
+ * Check whether the strips drawBitmap() is about to draw can go through the
+ * strip cache, which is only the case for the full height of the room image
+ * on the main virtual screen. The cache is flushed if the image or anything
+ * the decoded pixels depend on changed since it was filled.
+ */
+bool Gdi::prepareStripCache(const byte *ptr, const VirtScreen *vs, const int y, const int height, int numzbuf, byte flag) {
+	if (!_stripCacheEnabled || !(flag & dbRoomImage) || !canCacheStrips())
+		return false;
+	if (vs->number != kMainVirtScreen || y != 0 || height != vs->h || vs->format.bytesPerPixel != 1)
+		return false;
+
+	uint32 paletteHash = 0;
+	for (int i = 0; i < 256; i++)
+		paletteHash = paletteHash * 31 + _vm->_roomPalette[i];
+
+	if (_stripCache.image != ptr || _stripCache.height != height || _stripCache.numZBuffer != numzbuf ||
+		_stripCache.paletteMod != _paletteMod || _stripCache.paletteHash != paletteHash) {
+		const int numStrips = MAX(_vm->_roomWidth, (int)vs->w) / 8;
+
+		_stripCache.image = ptr;
+		_stripCache.height = height;
+		_stripCache.numZBuffer = numzbuf;
+		_stripCache.paletteMod = _paletteMod;
+		_stripCache.paletteHash = paletteHash;
+		// 8 pixels per line, and one byte per line for each z-plane but the first
+		_stripCache.stripSize = (8 + MAX(numzbuf - 1, 0)) * height;
+		_stripCache.data.resize(numStrips * _stripCache.stripSize);
+		_stripCache.valid.clear();
+		_stripCache.valid.resize(numStrips);
+	}
+
+	return true;
+}
+
 /**
  * Draw a bitmap onto a virtual screen. This is main drawing method for room backgrounds
  * and objects, used throughout all SCUMM versions.
@@ -2345,6 +2397,8 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 	_objectMode = (flag & dbObjectMode) == dbObjectMode;
 	prepareDrawBitmap(ptr, vs, x, y, width, height, stripnr, numstrip);
 
+	const bool useStripCache = prepareStripCache(ptr, vs, y, height, numzbuf, flag);
+
 	sx = x - vs->xstart / 8;
 	if (sx < 0) {
 		numstrip -= -sx;
@@ -2377,11 +2431,53 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 		else
 			dstPtr = (byte *)vs->getBasePtr(x * 8, y);
 
-		transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+		byte *cachePtr = nullptr;
+		bool cacheHit = false;
+		if (useStripCache && stripnr >= 0 && stripnr < (int)_stripCache.valid.size()) {
+			cachePtr = &_stripCache.data[stripnr * _stripCache.stripSize];
+			cacheHit = _stripCache.valid[stripnr];
+		}
 
-		// COMI and HE games only uses flag value
-		if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
-			transpStrip = true;
+		if (cacheHit) {
+			_stripCacheHits++;
+			for (int h = 0; h < height; h++, cachePtr += 8)
+				memcpy(dstPtr + h * vs->pitch, cachePtr, 8);
+			for (int i = 1; i < numzbuf; i++) {
+				if (!zplane_list[i])
+					continue;
+				byte *mask_ptr = getMaskBuffer(x, y, i);
+				for (int h = 0; h < height; h++)
+					mask_ptr[h * _numStrips] = *cachePtr++;
+			}
+		} else {
+			if (cachePtr)
+				_stripCacheMisses++;
+
+			transpStrip = drawStrip(dstPtr, vs, x, y, width, height, stripnr, smap_ptr);
+
+			// Strips with transparent pixels depend on what was drawn before them
+			if (transpStrip)
+				cachePtr = nullptr;
+
+			// COMI and HE games only uses flag value
+			if (_vm->_game.version == 8 || _vm->_game.heversion >= 60)
+				transpStrip = true;
+
+			decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
+
+			if (cachePtr) {
+				_stripCache.valid[stripnr] = true;
+				for (int h = 0; h < height; h++, cachePtr += 8)
+					memcpy(cachePtr, dstPtr + h * vs->pitch, 8);
+				for (int i = 1; i < numzbuf; i++) {
+					if (!zplane_list[i])
+						continue;
+					const byte *mask_ptr = getMaskBuffer(x, y, i);
+					for (int h = 0; h < height; h++)
+						*cachePtr++ = mask_ptr[h * _numStrips];
+				}
+			}
+		}
 
 		if (vs->hasTwoBuffers) {
 			byte *frontBuf = (byte *)vs->getBasePtr(x * 8, y);
@@ -2391,8 +2487,6 @@ void Gdi::drawBitmap(const byte *ptr, VirtScreen *vs, int x, const int y, const
 				clear8Col(frontBuf, vs->pitch, height, vs->format.bytesPerPixel);
 		}
 
-		decodeMask(x, y, width, height, stripnr, numzbuf, zplane_list, transpStrip, flag);
-
 #if 0
 		// HACK: blit mask(s) onto normal screen. Useful to debug masking
 		for (int i = 0; i < numzbuf; i++) {
@@ -4005,6 +4099,24 @@ void Gdi::drawStripEGA(byte *dst, int dstPitch, const byte *src, int height) con
 		}                            \
 	} while (0)
 
+#define NEXT_COLOR do {                         \
+		FILL_BITS(1);                           \
+		if (READ_BIT) {                         \
+			FILL_BITS(1);                       \
+			if (READ_BIT) {                     \
+				FILL_BITS(3);                   \
+				color += delta_color[data & 7]; \
+				shift -= 3;                     \
+				data >>= 3;                     \
+			} else {                            \
+				FILL_BITS(_decomp_shr);         \
+				color = data & _decomp_mask;    \
+				shift -= _decomp_shr;           \
+				data >>= _decomp_shr;           \
+			}                                   \
+		}                                       \
+	} while (0)
+
 // NOTE: drawStripHE is actually very similar to drawStripComplex
 void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int height, const bool transpCheck) const {
 	static const int delta_color[] = { -4, -3, -2, -1, 1, 2, 3, 4 };
@@ -4017,6 +4129,27 @@ void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int h
 	src += 3;
 	shift = 24;
 
+	// Opaque strips on 8-bit screens are decoded a line at a time, and
+	// each line is stored at once instead of through writeRoomColor()
+	if (!transpCheck && width == 8 && _vm->_bytesPerPixel == 1) {
+		const byte *palette = _roomPalette;
+		const byte paletteMod = _paletteMod;
+		byte line[8];
+
+		while (1) {
+			for (int i = 0; i < 7; i++) {
+				line[i] = palette[(color + paletteMod) & 0xFF];
+				NEXT_COLOR;
+			}
+			line[7] = palette[(color + paletteMod) & 0xFF];
+			memcpy(dst, line, 8);
+			dst += dstPitch;
+			if (--height == 0)
+				return;
+			NEXT_COLOR;
+		}
+	}
+
 	int x = width;
 	while (1) {
 		if (!transpCheck || color != _transparentColor)
@@ -4030,24 +4163,11 @@ void Gdi::drawStripHE(byte *dst, int dstPitch, const byte *src, int width, int h
 			if (height == 0)
 				return;
 		}
-		FILL_BITS(1);
-		if (READ_BIT) {
-			FILL_BITS(1);
-			if (READ_BIT) {
-				FILL_BITS(3);
-				color += delta_color[data & 7];
-				shift -= 3;
-				data >>= 3;
-			} else {
-				FILL_BITS(_decomp_shr);
-				color = data & _decomp_mask;
-				shift -= _decomp_shr;
-				data >>= _decomp_shr;
-			}
-		}
+		NEXT_COLOR;
 	}
 }
 
+#undef NEXT_COLOR
 #undef READ_BIT
 #undef FILL_BITS
 
@@ -4106,6 +4226,21 @@ void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height,
 	byte lineBuffer[8];
 	memset(lineBuffer, 0, 8);
 
+	// Opaque strips on 8-bit screens are stored a line at a time
+	if (!transpCheck && _vm->_bytesPerPixel == 1) {
+		const byte *palette = _roomPalette;
+		const byte paletteMod = _paletteMod;
+
+		while (height--) {
+			majMin.decodeLine(lineBuffer, 8, 1);
+			for (byte i = 0; i < 8; i++)
+				lineBuffer[i] = palette[(lineBuffer[i] + paletteMod) & 0xFF];
+			memcpy(dst, lineBuffer, 8);
+			dst += dstPitch;
+		}
+		return;
+	}
+
 	while (height--) {
 		majMin.decodeLine(lineBuffer, 8, 1);
 		for (byte i = 0; i < 8; i ++) {
@@ -4118,6 +4253,22 @@ void Gdi::drawStripComplex(byte *dst, int dstPitch, const byte *src, int height,
 	}
 }
 
+#define NEXT_COLOR do {                  \
+		if (!READ_BIT) {                 \
+		} else if (!READ_BIT) {          \
+			FILL_BITS;                   \
+			color = bits & _decomp_mask; \
+			bits >>= _decomp_shr;        \
+			cl -= _decomp_shr;           \
+			inc = -1;                    \
+		} else if (!READ_BIT) {          \
+			color += inc;                \
+		} else {                         \
+			inc = -inc;                  \
+			color += inc;                \
+		}                                \
+	} while (0)
+
 void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height, const bool transpCheck) const {
 	byte color = *src++;
 	uint bits = *src++;
@@ -4125,6 +4276,25 @@ void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height,
 	byte bit;
 	int8 inc = -1;
 
+	// Opaque strips on 8-bit screens are decoded a line at a time, and
+	// each line is stored at once instead of through writeRoomColor()
+	if (!transpCheck && _vm->_bytesPerPixel == 1) {
+		const byte *palette = _roomPalette;
+		const byte paletteMod = _paletteMod;
+		byte line[8];
+
+		do {
+			for (int x = 0; x < 8; x++) {
+				FILL_BITS;
+				line[x] = palette[(color + paletteMod) & 0xFF];
+				NEXT_COLOR;
+			}
+			memcpy(dst, line, 8);
+			dst += dstPitch;
+		} while (--height);
+		return;
+	}
+
 	do {
 		int x = 8;
 		do {
@@ -4132,19 +4302,7 @@ void Gdi::drawStripBasicH(byte *dst, int dstPitch, const byte *src, int height,
 			if (!transpCheck || color != _transparentColor)
 				writeRoomColor(dst, color);
 			dst += _vm->_bytesPerPixel;
-			if (!READ_BIT) {
-			} else if (!READ_BIT) {
-				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
-				inc = -1;
-			} else if (!READ_BIT) {
-				color += inc;
-			} else {
-				inc = -inc;
-				color += inc;
-			}
+			NEXT_COLOR;
 		} while (--x);
 		dst += dstPitch - 8 * _vm->_bytesPerPixel;
 	} while (--height);
@@ -4157,6 +4315,23 @@ void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height,
 	byte bit;
 	int8 inc = -1;
 
+	// The pixels of a vertical strip can't be stored a line at a time, but
+	// opaque strips on 8-bit screens can still skip writeRoomColor()
+	if (!transpCheck && _vm->_bytesPerPixel == 1) {
+		const byte *palette = _roomPalette;
+		const byte paletteMod = _paletteMod;
+
+		for (int x = 0; x < 8; x++, dst++) {
+			byte *column = dst;
+			for (int h = 0; h < height; h++, column += dstPitch) {
+				FILL_BITS;
+				*column = palette[(color + paletteMod) & 0xFF];
+				NEXT_COLOR;
+			}
+		}
+		return;
+	}
+
 	int x = 8;
 	do {
 		int h = height;
@@ -4165,24 +4340,13 @@ void Gdi::drawStripBasicV(byte *dst, int dstPitch, const byte *src, int height,
 			if (!transpCheck || color != _transparentColor)
 				writeRoomColor(dst, color);
 			dst += dstPitch;
-			if (!READ_BIT) {
-			} else if (!READ_BIT) {
-				FILL_BITS;
-				color = bits & _decomp_mask;
-				bits >>= _decomp_shr;
-				cl -= _decomp_shr;
-				inc = -1;
-			} else if (!READ_BIT) {
-				color += inc;
-			} else {
-				inc = -inc;
-				color += inc;
-			}
+			NEXT_COLOR;
 		} while (--h);
 		dst -= _vertStripNextInc;
 	} while (--x);
 }
 
+#undef NEXT_COLOR
 #undef READ_BIT
 #undef FILL_BITS
 
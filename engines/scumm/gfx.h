@@ -22,6 +22,7 @@
 #ifndef SCUMM_GFX_H
 #define SCUMM_GFX_H
 
+#include "common/array.h"
 #include "common/system.h"
 #include "common/list.h"
 
@@ -304,6 +305,22 @@ protected:
 	/** Flag which is true when an object is being rendered, false otherwise. */
 	bool _objectMode;
 
+	/**
+	 * Decoded strips of the current room image. Redrawing the background,
+	 * e.g. while scrolling, copies the pixels and the z-plane masks of a
+	 * strip from here instead of decoding it again.
+	 */
+	struct StripCache {
+		const byte *image;
+		int height;
+		int numZBuffer;
+		byte paletteMod;
+		uint32 paletteHash;
+		int stripSize;
+		Common::Array<byte> data;
+		Common::Array<bool> valid;
+	} _stripCache;
+
 public:
 	/** Flag which is true when loading objects or titles for distaff, in PCEngine version of Loom. */
 	bool _distaff;
@@ -351,6 +368,10 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip);
 
+	/** Whether the strips decoded by drawBitmap() only depend on the room image and the palette. */
+	virtual bool canCacheStrips() const { return true; }
+	bool prepareStripCache(const byte *ptr, const VirtScreen *vs, const int y, const int height, int numzbuf, byte flag);
+
 public:
 	Gdi(ScummEngine *vm);
 	virtual ~Gdi();
@@ -377,10 +398,17 @@ public:
 
 	void resetBackground(int top, int bottom, int strip);
 
+	void flushStripCache();
+
+	bool _stripCacheEnabled;
+	uint32 _stripCacheHits;
+	uint32 _stripCacheMisses;
+
 	enum DrawBitmapFlags {
 		dbAllowMaskOr   = 1 << 0,
 		dbDrawMaskOnAll = 1 << 1,
-		dbObjectMode    = 2 << 2
+		dbObjectMode    = 2 << 2,
+		dbRoomImage     = 1 << 4
 	};
 };
 
@@ -398,6 +426,8 @@ protected:
 	void prepareDrawBitmap(const byte *ptr, VirtScreen *vs,
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip) override;
+
+	bool canCacheStrips() const override { return !_tmskPtr; }
 public:
 	GdiHE(ScummEngine *vm);
 };
@@ -431,6 +461,8 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip) override;
 
+	bool canCacheStrips() const override { return false; }
+
 public:
 	GdiNES(ScummEngine *vm);
 
@@ -474,6 +506,8 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip) override;
 
+	bool canCacheStrips() const override { return false; }
+
 public:
 	GdiPCEngine(ScummEngine *vm);
 	~GdiPCEngine() override;
@@ -513,6 +547,8 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip) override;
 
+	bool canCacheStrips() const override { return false; }
+
 public:
 	GdiV1(ScummEngine *vm);
 
@@ -542,6 +578,8 @@ protected:
 					const int x, const int y, const int width, const int height,
 	                int stripnr, int numstrip) override;
 
+	bool canCacheStrips() const override { return false; }
+
 public:
 	GdiV2(ScummEngine *vm);
 	~GdiV2() override;
@@ -33,13 +33,17 @@
 #include "engines/wintermute/math/math_util.h"
 #include "engines/wintermute/base/base_game.h"
 #include "engines/wintermute/base/base_sprite.h"
+#include "engines/wintermute/base/font/base_font.h"
 #include "engines/util.h"
 
+#include "common/algorithm.h"
 #include "common/system.h"
 #include "common/queue.h"
 #include "common/config-manager.h"
 
 #define DIRTY_RECT_LIMIT 800
+// Size of the cells of the grid the tickets are sorted into
+#define TICKET_GRID_CELL 64
 
 namespace Wintermute {
 
@@ -58,6 +62,9 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 	_borderLeft = _borderRight = _borderTop = _borderBottom = 0;
 	_ratioX = _ratioY = 1.0f;
 	_dirtyRect = nullptr;
+	_gridColumns = _gridRows = 0;
+	_frameStats.ticketsReused = _frameStats.ticketsRedrawn = _frameStats.pixelsBlitted = 0;
+	_lastFrameStats = _frameStats;
 	_disableDirtyRects = false;
 	if (ConfMan.hasKey("dirty_rects")) {
 		_disableDirtyRects = !ConfMan.getBool("dirty_rects");
@@ -68,12 +75,7 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 
 //////////////////////////////////////////////////////////////////////////
 BaseRenderOSystem::~BaseRenderOSystem() {
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
-	}
+	clearTickets();
 
 	delete _dirtyRect;
 
@@ -136,6 +138,10 @@ bool BaseRenderOSystem::initRenderer(int width, int height, bool windowed) {
 	_blankSurface->fillRect(Common::Rect(0, 0, _blankSurface->h, _blankSurface->w), _blankSurface->format.ARGBToColor(255, 0, 0, 0));
 	_active = true;
 
+	_gridColumns = (_renderSurface->w + TICKET_GRID_CELL - 1) / TICKET_GRID_CELL;
+	_gridRows = (_renderSurface->h + TICKET_GRID_CELL - 1) / TICKET_GRID_CELL;
+	_ticketGrid.resize(_gridColumns * _gridRows);
+
 	_clearColor = _renderSurface->format.ARGBToColor(255, 0, 0, 0);
 
 	return STATUS_OK;
@@ -160,6 +166,7 @@ bool BaseRenderOSystem::flip() {
 		_skipThisFrame = false;
 		delete _dirtyRect;
 		_dirtyRect = nullptr;
+		_dirtyRects.clear();
 		g_system->updateScreen();
 		_needsFlip = false;
 
@@ -171,6 +178,9 @@ bool BaseRenderOSystem::flip() {
 		}
 
 		addDirtyRect(_renderRect);
+
+		_lastFrameStats = _frameStats;
+		_frameStats.ticketsReused = _frameStats.ticketsRedrawn = _frameStats.pixelsBlitted = 0;
 		return true;
 	}
 	if (!_disableDirtyRects) {
@@ -180,9 +190,7 @@ bool BaseRenderOSystem::flip() {
 		RenderQueueIterator it = _renderQueue.begin();
 		while (it != _renderQueue.end()) {
 			if ((*it)->_wantsDraw == false) {
-				RenderTicket *ticket = *it;
-				it = _renderQueue.erase(it);
-				delete ticket;
+				it = eraseTicket(it);
 			} else {
 				(*it)->_wantsDraw = false;
 				++it;
@@ -201,10 +209,14 @@ bool BaseRenderOSystem::flip() {
 		//  g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
 		delete _dirtyRect;
 		_dirtyRect = nullptr;
+		_dirtyRects.clear();
 		_needsFlip = false;
 	}
 	_lastFrameIter = _renderQueue.end();
 
+	_lastFrameStats = _frameStats;
+	_frameStats.ticketsReused = _frameStats.ticketsRedrawn = _frameStats.pixelsBlitted = 0;
+
 	g_system->updateScreen();
 
 	return STATUS_OK;
@@ -302,25 +314,31 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 
 	if (owner) { // Fade-tickets are owner-less
 		RenderTicket compare(owner, nullptr, srcRect, dstRect, transform);
-		RenderQueueIterator it = _lastFrameIter;
-		++it;
-		// Avoid calling end() and operator* every time, when potentially going through
-		// LOTS of tickets.
-		RenderQueueIterator endIterator = _renderQueue.end();
-		RenderTicket *compareTicket = nullptr;
-		for (; it != endIterator; ++it) {
-			compareTicket = *it;
-			if (*(compareTicket) == compare && compareTicket->_isValid) {
-				if (_disableDirtyRects) {
-					drawFromSurface(compareTicket);
-				} else {
-					drawFromQueuedTicket(it);
-				}
-				return;
+		RenderTicket *cachedTicket = findCachedTicket(compare);
+		if (cachedTicket) {
+			// Unclaimed tickets all come after the last one drawn, and
+			// usually right after it
+			RenderQueueIterator it = _lastFrameIter;
+			++it;
+			// Avoid calling end() every time, when potentially going through
+			// LOTS of tickets.
+			RenderQueueIterator endIterator = _renderQueue.end();
+			while (it != endIterator && *it != cachedTicket)
+				++it;
+			assert(it != endIterator);
+
+			_frameStats.ticketsReused++;
+			if (_disableDirtyRects) {
+				drawFromSurface(cachedTicket);
+			} else {
+				drawFromQueuedTicket(it);
 			}
+			return;
 		}
 	}
 	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+	if (owner)
+		_ticketCache[ticket->getHash()].push_back(ticket);
 	if (!_disableDirtyRects) {
 		drawFromTicket(ticket);
 	} else {
@@ -330,6 +348,58 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 	}
 }
 
+RenderTicket *BaseRenderOSystem::findCachedTicket(const RenderTicket &compare) {
+	Common::HashMap<uint32, Common::Array<RenderTicket *> >::iterator bucket = _ticketCache.find(compare.getHash());
+	if (bucket == _ticketCache.end())
+		return nullptr;
+
+	// Tickets which want to be drawn were already claimed in this frame
+	Common::Array<RenderTicket *> &tickets = bucket->_value;
+	for (uint i = 0; i < tickets.size(); i++) {
+		if (!tickets[i]->_wantsDraw && tickets[i]->_isValid && *tickets[i] == compare)
+			return tickets[i];
+	}
+	return nullptr;
+}
+
+void BaseRenderOSystem::removeCachedTicket(RenderTicket *ticket) {
+	if (!ticket->_owner)
+		return;
+
+	Common::HashMap<uint32, Common::Array<RenderTicket *> >::iterator bucket = _ticketCache.find(ticket->getHash());
+	if (bucket == _ticketCache.end())
+		return;
+
+	Common::Array<RenderTicket *> &tickets = bucket->_value;
+	for (uint i = 0; i < tickets.size(); i++) {
+		if (tickets[i] == ticket) {
+			tickets.remove_at(i);
+			break;
+		}
+	}
+	if (tickets.empty())
+		_ticketCache.erase(bucket);
+}
+
+BaseRenderOSystem::RenderQueueIterator BaseRenderOSystem::eraseTicket(const RenderQueueIterator &ticket) {
+	RenderTicket *renderTicket = *ticket;
+	removeCachedTicket(renderTicket);
+	RenderQueueIterator next = _renderQueue.erase(ticket);
+	delete renderTicket;
+	return next;
+}
+
+void BaseRenderOSystem::clearTickets() {
+	RenderQueueIterator it = _renderQueue.begin();
+	while (it != _renderQueue.end()) {
+		RenderTicket *ticket = *it;
+		it = _renderQueue.erase(it);
+		delete ticket;
+	}
+	_ticketCache.clear();
+	_gridTickets.clear();
+}
+
 void BaseRenderOSystem::invalidateTicket(RenderTicket *renderTicket) {
 	addDirtyRect(renderTicket->_dstRect);
 	renderTicket->_isValid = false;
@@ -388,57 +458,103 @@ void BaseRenderOSystem::addDirtyRect(const Common::Rect &rect) {
 		_dirtyRect->extend(rect);
 	}
 	_dirtyRect->clip(_renderRect);
-}
 
-void BaseRenderOSystem::drawTickets() {
-	RenderQueueIterator it = _renderQueue.begin();
-	// Clean out the old tickets
-	// Note: We draw invalid tickets too, otherwise we wouldn't be honoring
-	// the draw request they obviously made BEFORE becoming invalid, either way
-	// we have a copy of their data, so their invalidness won't affect us.
-	while (it != _renderQueue.end()) {
-		if ((*it)->_wantsDraw == false) {
-			RenderTicket *ticket = *it;
-			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
+	Common::Rect dirty(rect);
+	dirty.clip(_renderRect);
+	if (dirty.isEmpty())
+		return;
+
+	// Merge the rect with the ones it overlaps, so nothing is drawn twice
+	uint i = 0;
+	while (i < _dirtyRects.size()) {
+		if (_dirtyRects[i].intersects(dirty)) {
+			dirty.extend(_dirtyRects[i]);
+			_dirtyRects[i] = _dirtyRects.back();
+			_dirtyRects.pop_back();
+			i = 0;
 		} else {
-			++it;
+			i++;
 		}
 	}
-	if (!_dirtyRect || _dirtyRect->width() == 0 || _dirtyRect->height() == 0) {
-		it = _renderQueue.begin();
-		while (it != _renderQueue.end()) {
-			RenderTicket *ticket = *it;
-			ticket->_wantsDraw = false;
-			++it;
+	_dirtyRects.push_back(dirty);
+
+	// Too many small rects cost more than they save
+	if (_dirtyRects.size() > DIRTY_RECT_LIMIT) {
+		_dirtyRects.resize(1);
+		_dirtyRects[0] = *_dirtyRect;
+	}
+}
+
+void BaseRenderOSystem::buildTicketGrid() {
+	for (uint i = 0; i < _ticketGrid.size(); i++)
+		_ticketGrid[i].resize(0);
+	_gridTickets.resize(0);
+
+	const Common::Rect screen(_renderSurface->w, _renderSurface->h);
+	for (RenderQueueIterator it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
+		RenderTicket *ticket = *it;
+		const uint32 index = _gridTickets.size();
+		_gridTickets.push_back(ticket);
+
+		Common::Rect area(ticket->_dstRect);
+		area.clip(screen);
+		if (area.isEmpty())
+			continue;
+
+		for (int y = area.top / TICKET_GRID_CELL; y <= (area.bottom - 1) / TICKET_GRID_CELL; y++) {
+			for (int x = area.left / TICKET_GRID_CELL; x <= (area.right - 1) / TICKET_GRID_CELL; x++)
+				_ticketGrid[y * _gridColumns + x].push_back(index);
 		}
-		return;
 	}
 
-	it = _renderQueue.begin();
-	_lastFrameIter = _renderQueue.end();
+	_gridStamps.resize(_gridTickets.size());
+	for (uint i = 0; i < _gridStamps.size(); i++)
+		_gridStamps[i] = 0;
+}
+
+void BaseRenderOSystem::drawDirtyRect(const Common::Rect &rect, uint32 stamp) {
 	// A special case: If the screen has one giant OPAQUE rect to be drawn, then we skip filling
 	// the background color. Typical use-case: Fullscreen FMVs.
 	// Caveat: The FPS-counter will invalidate this.
-	if (it != _lastFrameIter && _renderQueue.front() == _renderQueue.back() && (*it)->_transform._alphaDisable == true) {
+	if (_gridTickets.size() == 1 && _gridTickets[0]->_transform._alphaDisable == true) {
 		// If our single opaque rect fills the dirty rect, we can skip filling.
-		if (*_dirtyRect != (*it)->_dstRect) {
+		if (!_gridTickets[0]->_dstRect.contains(rect)) {
 			// Apply the clear-color to the dirty rect.
-			_renderSurface->fillRect(*_dirtyRect, _clearColor);
+			_renderSurface->fillRect(rect, _clearColor);
 		}
 		// Otherwise Do NOT fill.
 	} else {
 		// Apply the clear-color to the dirty rect.
-		_renderSurface->fillRect(*_dirtyRect, _clearColor);
+		_renderSurface->fillRect(rect, _clearColor);
 	}
-	for (; it != _renderQueue.end(); ++it) {
-		RenderTicket *ticket = *it;
-		if (ticket->_dstRect.intersects(*_dirtyRect)) {
+
+	// Collect the tickets of the cells the rect covers, once each
+	_gridCandidates.resize(0);
+	const Common::Rect screen(_renderSurface->w, _renderSurface->h);
+	Common::Rect area(rect);
+	area.clip(screen);
+	if (!area.isEmpty()) {
+		for (int y = area.top / TICKET_GRID_CELL; y <= (area.bottom - 1) / TICKET_GRID_CELL; y++) {
+			for (int x = area.left / TICKET_GRID_CELL; x <= (area.right - 1) / TICKET_GRID_CELL; x++) {
+				const Common::Array<uint32> &cell = _ticketGrid[y * _gridColumns + x];
+				for (uint i = 0; i < cell.size(); i++) {
+					if (_gridStamps[cell[i]] != stamp) {
+						_gridStamps[cell[i]] = stamp;
+						_gridCandidates.push_back(cell[i]);
+					}
+				}
+			}
+		}
+	}
+	Common::sort(_gridCandidates.begin(), _gridCandidates.end());
+
+	for (uint i = 0; i < _gridCandidates.size(); i++) {
+		RenderTicket *ticket = _gridTickets[_gridCandidates[i]];
+		if (ticket->_dstRect.intersects(rect)) {
 			// dstClip is the area we want redrawn.
 			Common::Rect dstClip(ticket->_dstRect);
 			// reduce it to the dirty rect
-			dstClip.clip(*_dirtyRect);
+			dstClip.clip(rect);
 			// we need to keep track of the position to redraw the dirty rect
 			Common::Rect pos(dstClip);
 			int16 offsetX = ticket->_dstRect.left;
@@ -448,20 +564,57 @@ void BaseRenderOSystem::drawTickets() {
 
 			drawFromSurface(ticket, &pos, &dstClip);
 			_needsFlip = true;
+
+			_frameStats.ticketsRedrawn++;
+			_frameStats.pixelsBlitted += pos.width() * pos.height();
+		}
+	}
+
+	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(rect.left, rect.top), _renderSurface->pitch, rect.left, rect.top, rect.width(), rect.height());
+}
+
+void BaseRenderOSystem::drawTickets() {
+	RenderQueueIterator it = _renderQueue.begin();
+	// Clean out the old tickets
+	// Note: We draw invalid tickets too, otherwise we wouldn't be honoring
+	// the draw request they obviously made BEFORE becoming invalid, either way
+	// we have a copy of their data, so their invalidness won't affect us.
+	while (it != _renderQueue.end()) {
+		if ((*it)->_wantsDraw == false) {
+			addDirtyRect((*it)->_dstRect);
+			it = eraseTicket(it);
+		} else {
+			++it;
 		}
-		// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
-		ticket->_wantsDraw = false;
 	}
-	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(_dirtyRect->left, _dirtyRect->top), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
+	if (!_dirtyRect || _dirtyRect->width() == 0 || _dirtyRect->height() == 0 || _dirtyRects.empty()) {
+		it = _renderQueue.begin();
+		while (it != _renderQueue.end()) {
+			RenderTicket *ticket = *it;
+			ticket->_wantsDraw = false;
+			++it;
+		}
+		return;
+	}
+
+	_lastFrameIter = _renderQueue.end();
+
+	// Only the tickets in the cells a dirty rect covers are looked at
+	buildTicketGrid();
+	for (uint i = 0; i < _dirtyRects.size(); i++)
+		drawDirtyRect(_dirtyRects[i], i + 1);
+
+	// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
+	for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it)
+		(*it)->_wantsDraw = false;
+	_gridTickets.resize(0);
 
 	it = _renderQueue.begin();
 	// Clean out the old tickets
 	while (it != _renderQueue.end()) {
 		if ((*it)->_isValid == false) {
-			RenderTicket *ticket = *it;
 			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
+			it = eraseTicket(it);
 		} else {
 			++it;
 		}
@@ -523,6 +676,17 @@ Common::String BaseRenderOSystem::getName() const {
 	return "ScummVM-OSystem-renderer";
 }
 
+//////////////////////////////////////////////////////////////////////////
+bool BaseRenderOSystem::displayDebugInfo() {
+	char str[100];
+	Common::sprintf_s(str, "Tickets: %d reused, %d redrawn", _lastFrameStats.ticketsReused, _lastFrameStats.ticketsRedrawn);
+	_gameRef->getSystemFont()->drawText((byte *)str, 0, 30, getWidth(), TAL_RIGHT);
+
+	Common::sprintf_s(str, "Blitted: %d pixels", _lastFrameStats.pixelsBlitted);
+	_gameRef->getSystemFont()->drawText((byte *)str, 0, 50, getWidth(), TAL_RIGHT);
+	return STATUS_OK;
+}
+
 //////////////////////////////////////////////////////////////////////////
 bool BaseRenderOSystem::setViewport(int left, int top, int right, int bottom) {
 	Common::Rect rect;
@@ -582,12 +746,7 @@ void BaseRenderOSystem::endSaveLoad() {
 	BaseRenderer::endSaveLoad();
 
 	// Clear the scale-buffered tickets as we just loaded.
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
-	}
+	clearTickets();
 	// HACK: After a save the buffer will be drawn before the scripts get to update it,
 	// so just skip this single frame.
 	_skipThisFrame = true;
@@ -30,6 +30,8 @@
 
 #include "engines/wintermute/base/gfx/base_renderer.h"
 
+#include "common/array.h"
+#include "common/hashmap.h"
 #include "common/rect.h"
 #include "common/list.h"
 
@@ -65,7 +67,20 @@ public:
 
 	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
 
+	/**
+	 * Counters of the work done to draw a frame.
+	 */
+	struct FrameStats {
+		uint32 ticketsReused;  // Tickets matched with a ticket of the previous frame
+		uint32 ticketsRedrawn; // Tickets drawn to the render surface
+		uint32 pixelsBlitted;  // Pixels of the tickets drawn
+	};
+
+	/** Get the counters of the last frame drawn. */
+	const FrameStats &getFrameStats() const { return _lastFrameStats; }
+
 	Common::String getName() const override;
+	bool displayDebugInfo() override;
 
 	bool initRenderer(int width, int height, bool windowed) override;
 	bool flip() override;
@@ -126,13 +141,49 @@ private:
 	 * Traverse the tickets that are dirty, and draw them
 	 */
 	void drawTickets();
+	/**
+	 * Remove a ticket from the queue and the ticket cache, and delete it.
+	 * @return iterator pointing to the ticket after it.
+	 */
+	RenderQueueIterator eraseTicket(const RenderQueueIterator &ticket);
+	void clearTickets();
+	/**
+	 * Find an unclaimed ticket of the previous frame equal to a ticket.
+	 */
+	RenderTicket *findCachedTicket(const RenderTicket &compare);
+	void removeCachedTicket(RenderTicket *ticket);
+	/**
+	 * Sort the tickets in the queue into the cells of the screen they cover.
+	 */
+	void buildTicketGrid();
+	/**
+	 * Draw the tickets intersecting a dirty rect, in queue order.
+	 */
+	void drawDirtyRect(const Common::Rect &rect, uint32 stamp);
 	// Non-dirty-rects:
 	void drawFromSurface(RenderTicket *ticket);
 	// Dirty-rects:
 	void drawFromSurface(RenderTicket *ticket, Common::Rect *dstRect, Common::Rect *clipRect);
 	Common::Rect *_dirtyRect;
+	// The dirty areas, which do not overlap. _dirtyRect is their bounding box.
+	Common::Array<Common::Rect> _dirtyRects;
 	Common::List<RenderTicket *> _renderQueue;
 
+	// The tickets with an owner in the queue, by their hash
+	Common::HashMap<uint32, Common::Array<RenderTicket *> > _ticketCache;
+
+	// The tickets in queue order, and the indices of the ones which cover
+	// each cell of the screen
+	Common::Array<RenderTicket *> _gridTickets;
+	Common::Array<uint32> _gridStamps;
+	Common::Array<Common::Array<uint32> > _ticketGrid;
+	Common::Array<uint32> _gridCandidates;
+	int _gridColumns;
+	int _gridRows;
+
+	FrameStats _frameStats;
+	FrameStats _lastFrameStats;
+
 	bool _needsFlip;
 	RenderQueueIterator _lastFrameIter;
 	Common::Rect _renderRect;
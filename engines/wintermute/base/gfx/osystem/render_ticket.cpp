@@ -96,6 +96,31 @@ bool RenderTicket::operator==(const RenderTicket &t) const {
 	return true;
 }
 
+static inline uint32 packPair(int a, int b) {
+	return (uint32)(uint16)a | ((uint32)(uint16)b << 16);
+}
+
+uint32 RenderTicket::getHash() const {
+	const uint32 values[] = {
+		(uint32)(uintptr)_owner,
+		packPair(_dstRect.left, _dstRect.top),
+		packPair(_dstRect.right, _dstRect.bottom),
+		packPair(_srcRect.left, _srcRect.top),
+		packPair(_srcRect.right, _srcRect.bottom),
+		packPair(_transform._zoom.x, _transform._zoom.y),
+		packPair(_transform._offset.x, _transform._offset.y),
+		(uint32)_transform._angle,
+		(uint32)_transform._flip | ((uint32)_transform._alphaDisable << 8) | ((uint32)_transform._blendMode << 16),
+		_transform._rgbaMod,
+		packPair(_transform._numTimesX, _transform._numTimesY)
+	};
+
+	uint32 hash = 0;
+	for (int i = 0; i < ARRAYSIZE(values); i++)
+		hash = hash * 33 + values[i];
+	return hash;
+}
+
 // Replacement for SDL2's SDL_RenderCopy
 void RenderTicket::drawToSurface(Graphics::Surface *_targetSurface) const {
 	Graphics::ManagedSurface src;
@@ -68,6 +68,11 @@ public:
 
 	BaseSurfaceOSystem *_owner;
 	bool operator==(const RenderTicket &a) const;
+	/**
+	 * Get a hash of the fields compared by operator==, so equal tickets
+	 * have equal hashes.
+	 */
+	uint32 getHash() const;
 	const Common::Rect *getSrcRect() const { return &_srcRect; }
 private:
 	Graphics::Surface *_surface;
@@ -91,6 +91,15 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 	return bbox;
 }
 
+// The string caches are keyed by code points, 8-bit strings use the byte
+// values like the per character code paths do.
+Common::U32String toCacheString(const Common::String &str) {
+	Common::U32String result;
+	for (uint i = 0; i < str.size(); ++i)
+		result += (Common::u32char_type_t)(byte)str[i];
+	return result;
+}
+
 template<class StringType>
 int getStringWidthImpl(const Font &font, const StringType &str) {
 	int space = 0;
@@ -452,10 +461,18 @@ Common::Rect Font::getBoundingBox(const Common::U32String &input, int x, int y,
 }
 
 int Font::getStringWidth(const Common::String &str) const {
+	int width;
+	if (hasStringCache() && getCachedStringWidth(toCacheString(str), width))
+		return width;
+
 	return getStringWidthImpl(*this, str);
 }
 
 int Font::getStringWidth(const Common::U32String &str) const {
+	int width;
+	if (getCachedStringWidth(str, width))
+		return width;
+
 	return getStringWidthImpl(*this, str);
 }
 
@@ -469,16 +486,30 @@ void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color)
 
 void Font::drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::String renderStr = useEllipsis ? handleEllipsis(*this, str, w) : str;
+
+	Common::Rect bbox;
+	if (hasStringCache() && drawCachedString(dst, toCacheString(renderStr), x, y, w, color, align, deltax, nullptr, bbox))
+		return;
+
 	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
 }
 
 void Font::drawString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::U32String renderStr = useEllipsis ? handleEllipsis(*this, str, w) : str;
+
+	Common::Rect bbox;
+	if (drawCachedString(dst, renderStr, x, y, w, color, align, deltax, nullptr, bbox))
+		return;
+
 	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
 }
 
 void Font::drawString(ManagedSurface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::String renderStr = useEllipsis ? handleEllipsis(*this, str, w) : str;
+
+	if (hasStringCache() && drawCachedManagedString(dst, toCacheString(renderStr), x, y, w, color, align, deltax))
+		return;
+
 	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
 
 	if (w != 0) {
@@ -488,6 +519,10 @@ void Font::drawString(ManagedSurface *dst, const Common::String &str, int x, int
 
 void Font::drawString(ManagedSurface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::U32String renderStr = useEllipsis ? handleEllipsis(*this, str, w) : str;
+
+	if (drawCachedManagedString(dst, renderStr, x, y, w, color, align, deltax))
+		return;
+
 	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
 
 	if (w != 0) {
@@ -495,6 +530,21 @@ void Font::drawString(ManagedSurface *dst, const Common::U32String &str, int x,
 	}
 }
 
+bool Font::drawCachedManagedString(ManagedSurface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	Common::Rect bbox;
+	bool drawn;
+	if (dst->hasTransparentColor()) {
+		uint32 transColor = dst->getTransparentColor();
+		drawn = drawCachedString(dst->surfacePtr(), str, x, y, w, color, align, deltax, &transColor, bbox);
+	} else {
+		drawn = drawCachedString(dst->surfacePtr(), str, x, y, w, color, align, deltax, nullptr, bbox);
+	}
+
+	if (drawn && !bbox.isEmpty())
+		dst->addDirtyRect(bbox);
+	return drawn;
+}
+
 int Font::wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines, int initWidth, uint32 mode) const {
 	Common::Array<bool> dummyLineContinuation;
 	return wordWrapTextImpl(*this, str, maxWidth, lines, dummyLineContinuation, initWidth, mode);
@@ -249,6 +249,32 @@ public:
 	/** @overload */
 	int getStringWidth(const Common::U32String &str) const;
 
+	/**
+	 * Whether the font implements the whole string fast paths below. The
+	 * string helpers skip converting 8-bit strings when this is false.
+	 */
+	virtual bool hasStringCache() const { return false; }
+
+	/**
+	 * Look up the width of a whole string, e.g. from a cache of previously
+	 * measured strings. Returns false when the generic per character
+	 * measuring has to be used.
+	 */
+	virtual bool getCachedStringWidth(const Common::U32String &str, int &width) const { return false; }
+
+	/**
+	 * Draw a whole string in one go. This takes the same parameters as
+	 * drawString, after ellipsis handling, and has to produce exactly the
+	 * same pixels as drawing the string character by character. Returns
+	 * false when the string has to be drawn character by character instead.
+	 *
+	 * @param transparentColor  The transparent color of the destination or
+	 *                          nullptr if it has none.
+	 * @param bbox              Set to the area covered by the drawn characters.
+	 */
+	virtual bool drawCachedString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax,
+	                              const uint32 *transparentColor, Common::Rect &bbox) const { return false; }
+
 	/**
 	 * Word-wrap a text (that can contain newline characters) so that
 	 * no text line is wider than @p maxWidth pixels.
@@ -299,6 +325,8 @@ public:
 	 */
 	void scaleSingleGlyph(Surface *scaleSurface, int *grayScaleMap, int grayScaleMapSize, int width, int height, int xOffset, int yOffset, int grayLevel, int chr, int srcheight, int srcwidth, float scale) const;
 
+private:
+	bool drawCachedManagedString(ManagedSurface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
 };
 /** @} */
 } // End of namespace Graphics
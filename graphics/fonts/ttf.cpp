@@ -38,7 +38,9 @@
 #include "common/stream.h"
 #include "common/memstream.h"
 #include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/ptr.h"
+#include "common/algorithm.h"
 #include "common/compression/unzip.h"
 
 #include <ft2build.h>
@@ -153,6 +155,15 @@ unsigned long TTFLibrary::readCallback(FT_Stream stream, unsigned long offset, u
 	return ttfFile->read(buffer, count);
 }
 
+enum {
+	kAtlasPageSize = 256,
+	kDefaultGlyphCacheSize = 1024 * 1024,
+	kMaxCachedKerningPairs = 4096,
+	kMaxCachedStrings = 256,
+	kMaxCachedStringLength = 256,
+	kMaxStringCacheSize = 512 * 1024
+};
+
 class TTFFont : public Font {
 public:
 	TTFFont();
@@ -177,6 +188,14 @@ public:
 	void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const override;
 	void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const override;
 
+	bool hasStringCache() const override { return true; }
+	bool getCachedStringWidth(const Common::U32String &str, int &width) const override;
+	bool drawCachedString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax,
+	                      const uint32 *transparentColor, Common::Rect &bbox) const override;
+
+	void getCacheStats(TTFCacheStats &stats) const;
+	void setGlyphCacheSize(uint32 bytes);
+
 private:
 	bool _initialized;
 	FT_StreamRec_ _stream;
@@ -188,19 +207,78 @@ private:
 	int _width, _height;
 	int _ascent, _descent;
 
+	struct AtlasPage;
+
 	struct Glyph {
-		Surface image;
 		int xOffset, yOffset;
 		int advance;
+		int width, height;
 		FT_UInt slot;
+
+		// Where the bitmap lives in the glyph atlas. The page is null when
+		// the glyph is empty or when its page has been evicted.
+		AtlasPage *page;
+		int atlasX, atlasY;
+	};
+
+	/**
+	 * Glyph bitmaps are packed into shared pages, row by row. When the atlas
+	 * grows over its budget the least recently used page is dropped as a
+	 * whole, and its glyphs are rendered again the next time they are drawn.
+	 */
+	struct AtlasPage {
+		Surface image;
+		int shelfX, shelfY, shelfHeight;
+		uint32 lastUse;
+		Common::Array<Glyph *> glyphs;
 	};
 
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
+	bool rasterizeGlyph(Glyph &glyph) const;
+	const uint8 *getGlyphBitmap(Glyph &glyph, int &pitch) const;
+	uint8 *allocateAtlasSpace(Glyph &glyph) const;
+	void evictAtlasPage() const;
 	typedef Common::HashMap<uint32, Glyph> GlyphCache;
 	mutable GlyphCache _glyphs;
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	typedef Common::Array<AtlasPage *> AtlasPageList;
+	mutable AtlasPageList _atlas;
+	int _atlasPageSize;
+	uint32 _atlasBudget;
+	mutable uint32 _atlasBytes;
+	mutable uint32 _atlasClock;
+	mutable uint32 _glyphRenders;
+	mutable uint32 _atlasEvictions;
+
+	// Kerning offsets, keyed by the glyph slots of both characters
+	typedef Common::HashMap<uint32, int> KerningCache;
+	mutable KerningCache _kerning;
+
+	/**
+	 * Layout of a measured or drawn string. When the glyph boxes do not
+	 * overlap, the coverage of the whole string is merged into one bitmap
+	 * which is then blended in one go.
+	 */
+	struct StringLayout {
+		int width;
+		Common::Rect bbox;      // Union of the glyph boxes, relative to the pen start
+		int minRight, maxRight; // Range of the glyph box right edges, for the clipping in Font::drawString
+		bool batchable;
+		Surface bitmap;         // Created on the first draw
+		uint32 lastUse;
+	};
+
+	StringLayout *getStringLayout(const Common::U32String &str) const;
+	void evictStringLayout() const;
+	typedef Common::HashMap<Common::U32String, StringLayout *> StringCache;
+	mutable StringCache _strings;
+	mutable uint32 _stringBytes;
+	mutable uint32 _stringClock;
+	mutable uint32 _stringHits;
+	mutable uint32 _stringMisses;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -221,7 +299,9 @@ TTFFont::TTFFont()
 	: _initialized(false), _stream(), _face(), _ttfFile(0), _width(0), _height(0), _ascent(0),
 	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
 	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false),
-	  _disposeAfterUse(DisposeAfterUse::NO) {
+	  _disposeAfterUse(DisposeAfterUse::NO), _atlasPageSize(kAtlasPageSize), _atlasBudget(kDefaultGlyphCacheSize),
+	  _atlasBytes(0), _atlasClock(0), _glyphRenders(0), _atlasEvictions(0), _stringBytes(0), _stringClock(0),
+	  _stringHits(0), _stringMisses(0) {
 }
 
 TTFFont::~TTFFont() {
@@ -232,11 +312,18 @@ TTFFont::~TTFFont() {
 			delete _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	for (AtlasPageList::iterator i = _atlas.begin(); i != _atlas.end(); ++i) {
+		(*i)->image.free();
+		delete *i;
+	}
+
+	for (StringCache::iterator i = _strings.begin(); i != _strings.end(); ++i) {
+		i->_value->bitmap.free();
+		delete i->_value;
+	}
 }
 
 
@@ -342,6 +429,9 @@ bool TTFFont::load(Common::SeekableReadStream *ttfFile, DisposeAfterUse::Flag di
 	}
 #endif
 
+	// Make the atlas pages large enough to hold a few glyphs of big fonts
+	_atlasPageSize = MAX<int>(kAtlasPageSize, Common::nextHigher2((uint)MAX(_width, _height) * 2));
+
 	// Apply a matrix transform for all loaded glyphs
 	if (_fakeItalic) {
 		// This matrix is taken from Wine source code
@@ -578,9 +668,26 @@ int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!leftGlyph || !rightGlyph)
 		return 0;
 
+	// TrueType fonts have at most 65535 glyphs, so both slots fit in the key
+	const bool cacheable = (leftGlyph <= 0xFFFF && rightGlyph <= 0xFFFF);
+	const uint32 key = (leftGlyph << 16) | rightGlyph;
+	if (cacheable) {
+		KerningCache::const_iterator kerningEntry = _kerning.find(key);
+		if (kerningEntry != _kerning.end())
+			return kerningEntry->_value;
+	}
+
 	FT_Vector kerningVector;
 	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	const int offset = (kerningVector.x / 64);
+
+	if (cacheable) {
+		if (_kerning.size() >= kMaxCachedKerningPairs)
+			_kerning.clear();
+		_kerning[key] = offset;
+	}
+
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
@@ -589,10 +696,8 @@ Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
 	if (glyphEntry == _glyphs.end()) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		const Glyph &glyph = glyphEntry->_value;
+		return Common::Rect(glyph.xOffset, glyph.yOffset, glyph.xOffset + glyph.width, glyph.yOffset + glyph.height);
 	}
 }
 
@@ -643,47 +748,15 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 	}
 }
 
-} // End of anonymous namespace
-
-void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	drawChar(dst, chr, x, y, color, nullptr);
-}
-
-void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const {
-	if (dst->hasTransparentColor()) {
-		uint32 transColor = dst->getTransparentColor();
-		drawChar(dst->surfacePtr(), chr, x, y, color, &transColor);
-	} else {
-		drawChar(dst->surfacePtr(), chr, x, y, color, nullptr);
-	}
-
-	Common::Rect charBox = getBoundingBox(chr);
-	charBox.translate(x, y);
-	dst->addDirtyRect(charBox);
-}
-
-void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
-		const uint32 *transparentColor) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
-		return;
-
-	const Glyph &glyph = glyphEntry->_value;
-
-	x += glyph.xOffset;
-	y += glyph.yOffset;
-
+// Draws an 8-bit coverage bitmap at the given position, clipped to the
+// destination surface.
+static void drawCoverage(Surface *dst, const uint8 *srcPos, const int srcPitch, int x, int y, int w, int h,
+		uint32 color, const uint32 *transparentColor) {
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
-
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
-
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
 		srcPos -= x;
@@ -698,7 +771,7 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * srcPitch;
 		h += y;
 		y = 0;
 	}
@@ -727,15 +800,299 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += srcPitch;
 		}
 	} else if (dst->format.bytesPerPixel == 1) {
-		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format, transparentColor);
+	}
+}
+
+} // End of anonymous namespace
+
+void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
+	drawChar(dst, chr, x, y, color, nullptr);
+}
+
+void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const {
+	if (dst->hasTransparentColor()) {
+		uint32 transColor = dst->getTransparentColor();
+		drawChar(dst->surfacePtr(), chr, x, y, color, &transColor);
+	} else {
+		drawChar(dst->surfacePtr(), chr, x, y, color, nullptr);
 	}
+
+	Common::Rect charBox = getBoundingBox(chr);
+	charBox.translate(x, y);
+	dst->addDirtyRect(charBox);
+}
+
+void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
+		const uint32 *transparentColor) const {
+	assureCached(chr);
+	GlyphCache::iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry == _glyphs.end())
+		return;
+
+	Glyph &glyph = glyphEntry->_value;
+
+	int srcPitch;
+	const uint8 *srcPos = getGlyphBitmap(glyph, srcPitch);
+	if (!srcPos)
+		return;
+
+	drawCoverage(dst, srcPos, srcPitch, x + glyph.xOffset, y + glyph.yOffset, glyph.width, glyph.height, color, transparentColor);
+}
+
+bool TTFFont::getCachedStringWidth(const Common::U32String &str, int &width) const {
+	const StringLayout *layout = getStringLayout(str);
+	if (!layout)
+		return false;
+
+	width = layout->width;
+	return true;
+}
+
+bool TTFFont::drawCachedString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax,
+                               const uint32 *transparentColor, Common::Rect &bbox) const {
+	StringLayout *layout = getStringLayout(str);
+	if (!layout || !layout->batchable)
+		return false;
+
+	// Same placement as in drawStringImpl. Strings which would be clipped
+	// there glyph by glyph are left to it.
+	const int leftX = x, rightX = x + w + 1;
+
+	if (align == kTextAlignCenter)
+		x = x + (w - layout->width)/2;
+	else if (align == kTextAlignRight)
+		x = x + w - layout->width;
+	x += deltax;
+
+	if (x + layout->maxRight > rightX || x + layout->minRight < leftX)
+		return false;
+
+	bbox = Common::Rect();
+	if (layout->bbox.isEmpty())
+		return true;
+
+	if (!layout->bitmap.getPixels()) {
+		layout->bitmap.create(layout->bbox.width(), layout->bbox.height(), PixelFormat::createFormatCLUT8());
+		_stringBytes += layout->bitmap.pitch * layout->bitmap.h;
+
+		int penX = 0;
+		uint32 last = 0;
+		for (Common::U32String::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
+			const uint32 cur = *i;
+			penX += getKerningOffset(last, cur);
+			last = cur;
+
+			GlyphCache::iterator glyphEntry = _glyphs.find(cur);
+			if (glyphEntry != _glyphs.end()) {
+				Glyph &glyph = glyphEntry->_value;
+
+				int srcPitch;
+				const uint8 *src = getGlyphBitmap(glyph, srcPitch);
+				if (src) {
+					uint8 *dstPos = (uint8 *)layout->bitmap.getBasePtr(penX + glyph.xOffset - layout->bbox.left, glyph.yOffset - layout->bbox.top);
+					for (int cy = 0; cy < glyph.height; ++cy) {
+						memcpy(dstPos, src, glyph.width);
+						dstPos += layout->bitmap.pitch;
+						src += srcPitch;
+					}
+				}
+			}
+
+			penX += getCharWidth(cur);
+		}
+
+		while (_stringBytes > kMaxStringCacheSize && _strings.size() > 1)
+			evictStringLayout();
+	}
+
+	drawCoverage(dst, (const uint8 *)layout->bitmap.getPixels(), layout->bitmap.pitch, x + layout->bbox.left, y + layout->bbox.top,
+	             layout->bitmap.w, layout->bitmap.h, color, transparentColor);
+
+	bbox = layout->bbox;
+	bbox.translate(x, y);
+	return true;
+}
+
+TTFFont::StringLayout *TTFFont::getStringLayout(const Common::U32String &str) const {
+	if (str.size() > kMaxCachedStringLength)
+		return nullptr;
+
+	StringCache::iterator entry = _strings.find(str);
+	if (entry != _strings.end()) {
+		++_stringHits;
+		entry->_value->lastUse = ++_stringClock;
+		return entry->_value;
+	}
+
+	++_stringMisses;
+	if (_strings.size() >= kMaxCachedStrings)
+		evictStringLayout();
+
+	StringLayout *layout = new StringLayout();
+	layout->width = 0;
+	layout->minRight = layout->maxRight = 0;
+	layout->batchable = true;
+	layout->lastUse = ++_stringClock;
+
+	// This follows the pen movement of drawStringImpl
+	int x = 0;
+	int coveredRight = 0;
+	uint32 last = 0;
+	for (Common::U32String::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
+		const uint32 cur = *i;
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		Common::Rect charBox = getBoundingBox(cur);
+		charBox.translate(x, 0);
+
+		if (i == str.begin()) {
+			layout->minRight = layout->maxRight = charBox.right;
+		} else {
+			layout->minRight = MIN<int>(layout->minRight, charBox.right);
+			layout->maxRight = MAX<int>(layout->maxRight, charBox.right);
+		}
+
+		if (!charBox.isEmpty()) {
+			if (layout->bbox.isEmpty()) {
+				layout->bbox = charBox;
+			} else {
+				// Overlapping glyphs are blended onto each other, which
+				// one merged bitmap can not reproduce.
+				if (charBox.left < coveredRight)
+					layout->batchable = false;
+				layout->bbox.extend(charBox);
+			}
+			coveredRight = MAX<int>(coveredRight, charBox.right);
+		}
+
+		x += getCharWidth(cur);
+	}
+	layout->width = x;
+
+	_strings[str] = layout;
+	return layout;
+}
+
+void TTFFont::evictStringLayout() const {
+	StringCache::iterator oldest = _strings.end();
+	for (StringCache::iterator i = _strings.begin(); i != _strings.end(); ++i) {
+		if (oldest == _strings.end() || i->_value->lastUse < oldest->_value->lastUse)
+			oldest = i;
+	}
+
+	if (oldest == _strings.end())
+		return;
+
+	StringLayout *layout = oldest->_value;
+	_stringBytes -= layout->bitmap.pitch * layout->bitmap.h;
+	layout->bitmap.free();
+	delete layout;
+	_strings.erase(oldest);
+}
+
+const uint8 *TTFFont::getGlyphBitmap(Glyph &glyph, int &pitch) const {
+	if (glyph.width <= 0 || glyph.height <= 0)
+		return nullptr;
+
+	if (!glyph.page && !rasterizeGlyph(glyph))
+		return nullptr;
+
+	glyph.page->lastUse = ++_atlasClock;
+	pitch = glyph.page->image.pitch;
+	return (const uint8 *)glyph.page->image.getBasePtr(glyph.atlasX, glyph.atlasY);
+}
+
+uint8 *TTFFont::allocateAtlasSpace(Glyph &glyph) const {
+	AtlasPage *page = _atlas.empty() ? nullptr : _atlas.back();
+
+	if (page) {
+		// Start a new shelf when the current one is full
+		if (page->shelfX + glyph.width > page->image.w) {
+			page->shelfY += page->shelfHeight;
+			page->shelfX = 0;
+			page->shelfHeight = 0;
+		}
+
+		if (page->shelfX + glyph.width > page->image.w || page->shelfY + glyph.height > page->image.h)
+			page = nullptr;
+	}
+
+	if (!page) {
+		// Glyphs which don't fit into a standard page get one of their own
+		const int w = MAX<int>(_atlasPageSize, glyph.width);
+		const int h = MAX<int>(_atlasPageSize, glyph.height);
+
+		while (!_atlas.empty() && _atlasBytes + w * h > _atlasBudget)
+			evictAtlasPage();
+
+		page = new AtlasPage();
+		page->image.create(w, h, PixelFormat::createFormatCLUT8());
+		page->shelfX = page->shelfY = page->shelfHeight = 0;
+		page->lastUse = 0;
+		_atlasBytes += page->image.pitch * page->image.h;
+		_atlas.push_back(page);
+	}
+
+	glyph.page = page;
+	glyph.atlasX = page->shelfX;
+	glyph.atlasY = page->shelfY;
+
+	page->shelfX += glyph.width;
+	page->shelfHeight = MAX<int>(page->shelfHeight, glyph.height);
+	page->lastUse = ++_atlasClock;
+	page->glyphs.push_back(&glyph);
+
+	return (uint8 *)page->image.getBasePtr(glyph.atlasX, glyph.atlasY);
+}
+
+void TTFFont::evictAtlasPage() const {
+	AtlasPageList::iterator oldest = _atlas.end();
+	for (AtlasPageList::iterator i = _atlas.begin(); i != _atlas.end(); ++i) {
+		if (oldest == _atlas.end() || (*i)->lastUse < (*oldest)->lastUse)
+			oldest = i;
+	}
+
+	if (oldest == _atlas.end())
+		return;
+
+	AtlasPage *page = *oldest;
+	for (Common::Array<Glyph *>::iterator i = page->glyphs.begin(); i != page->glyphs.end(); ++i)
+		(*i)->page = nullptr;
+
+	_atlasBytes -= page->image.pitch * page->image.h;
+	page->image.free();
+	delete page;
+	_atlas.erase(oldest);
+	++_atlasEvictions;
+}
+
+void TTFFont::getCacheStats(TTFCacheStats &stats) const {
+	stats.glyphs = _glyphs.size();
+	stats.atlasPages = _atlas.size();
+	stats.atlasBytes = _atlasBytes;
+	stats.atlasBudget = _atlasBudget;
+	stats.glyphRenders = _glyphRenders;
+	stats.atlasEvictions = _atlasEvictions;
+	stats.strings = _strings.size();
+	stats.stringBytes = _stringBytes;
+	stats.stringHits = _stringHits;
+	stats.stringMisses = _stringMisses;
+}
+
+void TTFFont::setGlyphCacheSize(uint32 bytes) {
+	_atlasBudget = bytes;
+
+	while (_atlas.size() > 1 && _atlasBytes > _atlasBudget)
+		evictAtlasPage();
 }
 
 bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
@@ -744,11 +1101,16 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		return false;
 
 	glyph.slot = slot;
+	glyph.page = nullptr;
+
+	return rasterizeGlyph(glyph);
+}
 
+bool TTFFont::rasterizeGlyph(Glyph &glyph) const {
 	// We use the light target and render mode to improve the looks of the
 	// glyphs. It is most noticeable in FreeSansBold.ttf, where otherwise the
 	// 't' glyph looks like it is cut off on the right side.
-	if (FT_Load_Glyph(_face, slot, _loadFlags))
+	if (FT_Load_Glyph(_face, glyph.slot, _loadFlags))
 		return false;
 
 	if (FT_Render_Glyph(_face->glyph, _renderMode))
@@ -757,6 +1119,8 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	if (_face->glyph->format != FT_GLYPH_FORMAT_BITMAP)
 		return false;
 
+	++_glyphRenders;
+
 	glyph.xOffset = _face->glyph->bitmap_left;
 	glyph.yOffset = _ascent - _face->glyph->bitmap_top;
 
@@ -802,51 +1166,57 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
+	if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO && bitmap->pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::rasterizeGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
+#if FAKE_BOLD == 1
+		if (_fakeBold) {
+			FT_Bitmap_Done(_face->glyph->library, &ownBitmap);
+		}
+#endif
+		return false;
+	}
 
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	glyph.width = bitmap->width;
+	glyph.height = bitmap->rows;
 
-	const uint8 *src = bitmap->buffer;
-	int srcPitch = bitmap->pitch;
-	if (srcPitch < 0) {
-		src += (bitmap->rows - 1) * srcPitch;
-		srcPitch = -srcPitch;
-	}
+	if (glyph.width > 0 && glyph.height > 0) {
+		const uint8 *src = bitmap->buffer;
+		int srcPitch = bitmap->pitch;
+		if (srcPitch < 0) {
+			src += (bitmap->rows - 1) * srcPitch;
+			srcPitch = -srcPitch;
+		}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
+		uint8 *dst = allocateAtlasSpace(glyph);
+		const int dstPitch = glyph.page->image.pitch;
 
-	switch (bitmap->pixel_mode) {
-	case FT_PIXEL_MODE_MONO:
-		for (int y = 0; y < (int)bitmap->rows; ++y) {
-			const uint8 *curSrc = src;
-			uint8 mask = 0;
+		switch (bitmap->pixel_mode) {
+		case FT_PIXEL_MODE_MONO:
+			for (int y = 0; y < (int)bitmap->rows; ++y) {
+				const uint8 *curSrc = src;
+				uint8 mask = 0;
 
-			for (int x = 0; x < (int)bitmap->width; ++x) {
-				if ((x % 8) == 0)
-					mask = *curSrc++;
+				for (int x = 0; x < (int)bitmap->width; ++x) {
+					if ((x % 8) == 0)
+						mask = *curSrc++;
 
-				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = (mask & 0x80) ? 255 : 0;
+					mask <<= 1;
+				}
 
-				mask <<= 1;
-				++dst;
+				dst += dstPitch;
+				src += srcPitch;
 			}
+			break;
 
-			src += srcPitch;
-		}
-		break;
-
-	case FT_PIXEL_MODE_GRAY:
-		for (int y = 0; y < (int)bitmap->rows; ++y) {
-			memcpy(dst, src, bitmap->width);
-			dst += glyph.image.pitch;
-			src += srcPitch;
+		default:
+			for (int y = 0; y < (int)bitmap->rows; ++y) {
+				memcpy(dst, src, bitmap->width);
+				dst += dstPitch;
+				src += srcPitch;
+			}
+			break;
 		}
-		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 #if FAKE_BOLD == 1
@@ -863,9 +1233,9 @@ void TTFFont::assureCached(uint32 chr) const {
 		return;
 	}
 
-	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
+	// The atlas refers to the glyph, so it has to be cached in place
+	if (!cacheGlyph(_glyphs[chr], chr)) {
+		_glyphs.erase(chr);
 	}
 }
 
@@ -1085,6 +1455,21 @@ Font *findTTFace(const Common::Array<Common::Path> &files, const Common::U32Stri
 	return font;
 }
 
+bool getTTFCacheStats(const Font *font, TTFCacheStats &stats) {
+	const TTFFont *ttfFont = dynamic_cast<const TTFFont *>(font);
+	if (!ttfFont)
+		return false;
+
+	ttfFont->getCacheStats(stats);
+	return true;
+}
+
+void setTTFGlyphCacheSize(Font *font, uint32 bytes) {
+	TTFFont *ttfFont = dynamic_cast<TTFFont *>(font);
+	if (ttfFont)
+		ttfFont->setGlyphCacheSize(bytes);
+}
+
 } // End of namespace Graphics
 
 namespace Common {
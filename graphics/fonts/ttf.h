@@ -142,6 +142,37 @@ Font *loadTTFFontFromArchive(const Common::String &filename, int size, TTFSizeMo
  */
 Font *findTTFace(const Common::Array<Common::Path> &files, const Common::U32String &faceName, bool bold, bool italic, int size, uint xdpi = 0, uint ydpi = 0,TTFRenderMode renderMode = kTTFRenderModeLight, const uint32 *mapping = 0);
 
+/**
+ * Statistics of the glyph atlas and string layout cache of a TTF font.
+ */
+struct TTFCacheStats {
+	uint32 glyphs;         ///< Number of glyphs with known metrics.
+	uint32 atlasPages;     ///< Number of allocated atlas pages.
+	uint32 atlasBytes;     ///< Memory used by the atlas pages.
+	uint32 atlasBudget;    ///< Memory budget of the atlas.
+	uint32 glyphRenders;   ///< Number of glyphs rendered by FreeType, including re-renders after evictions.
+	uint32 atlasEvictions; ///< Number of atlas pages dropped to stay within the budget.
+	uint32 strings;        ///< Number of cached string layouts.
+	uint32 stringBytes;    ///< Memory used by the merged string bitmaps.
+	uint32 stringHits;     ///< Number of string lookups served by the cache.
+	uint32 stringMisses;   ///< Number of string lookups which had to lay out the string.
+};
+
+/**
+ * Query the cache statistics of a font loaded by the functions above.
+ *
+ * @return false in case the font is not a TTF font.
+ */
+bool getTTFCacheStats(const Font *font, TTFCacheStats &stats);
+
+/**
+ * Set the memory budget for the glyph atlas of a font loaded by the functions
+ * above. When the atlas grows larger, the least recently used glyphs are
+ * dropped and rendered again on demand. The atlas always keeps at least one
+ * page, whatever the budget.
+ */
+void setTTFGlyphCacheSize(Font *font, uint32 bytes);
+
 void shutdownTTF();
 
 } // End of namespace Graphics
@@ -73,6 +73,7 @@ void Context::reset() {
 	packedPixelsSupported = false;
 	packedDepthStencilSupported = false;
 	unpackSubImageSupported = false;
+	pixelBufferObjectSupported = false;
 	OESDepth24 = false;
 	textureEdgeClampSupported = false;
 	textureBorderClampSupported = false;
@@ -175,6 +176,8 @@ void Context::initialize(ContextType contextType) {
 
 	bool EXTFramebufferMultisample = false;
 	bool EXTFramebufferBlit = false;
+	bool ARBPixelBufferObject = false;
+	bool ARBMapBufferRange = false;
 
 	Common::StringTokenizer tokenizer(extString, " ");
 	while (!tokenizer.empty()) {
@@ -196,6 +199,10 @@ void Context::initialize(ContextType contextType) {
 			EXTFramebufferMultisample = true;
 		} else if (token == "GL_EXT_framebuffer_blit") {
 			EXTFramebufferBlit = true;
+		} else if (token == "GL_ARB_pixel_buffer_object") {
+			ARBPixelBufferObject = true;
+		} else if (token == "GL_ARB_map_buffer_range") {
+			ARBMapBufferRange = true;
 		} else if (token == "GL_OES_depth24") {
 			OESDepth24 = true;
 		} else if (token == "GL_SGIS_texture_edge_clamp") {
@@ -282,6 +289,9 @@ void Context::initialize(ContextType contextType) {
 		if (isGLVersionOrHigher(1, 4)) {
 			textureMirrorRepeatSupported = true;
 		}
+		// OpenGL 2.1 adds pixel buffer objects and OpenGL 3.0 adds mapping buffer ranges
+		pixelBufferObjectSupported = (isGLVersionOrHigher(2, 1) || ARBPixelBufferObject) &&
+		                             (isGLVersionOrHigher(3, 0) || ARBMapBufferRange);
 		debug(5, "OpenGL: GL context initialized");
 	} else {
 		warning("OpenGL: Unknown context initialized");
@@ -307,6 +317,7 @@ void Context::initialize(ContextType contextType) {
 	debug(5, "OpenGL: Packed pixels support: %d", packedPixelsSupported);
 	debug(5, "OpenGL: Packed depth stencil support: %d", packedDepthStencilSupported);
 	debug(5, "OpenGL: Unpack subimage support: %d", unpackSubImageSupported);
+	debug(5, "OpenGL: Pixel buffer object support: %d", pixelBufferObjectSupported);
 	debug(5, "OpenGL: OpenGL ES depth 24 support: %d", OESDepth24);
 	debug(5, "OpenGL: Texture edge clamping support: %d", textureEdgeClampSupported);
 	debug(5, "OpenGL: Texture border clamping support: %d", textureBorderClampSupported);
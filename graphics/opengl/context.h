@@ -105,6 +105,9 @@ public:
 	/** Whether specifying a pitch when uploading to textures is available or not */
 	bool unpackSubImageSupported;
 
+	/** Whether uploading textures through mapped pixel buffer objects is available or not */
+	bool pixelBufferObjectSupported;
+
 	/** Whether depth component 24 is supported or not */
 	bool OESDepth24;
 
@@ -306,7 +306,7 @@ uint16 convertTo16Bit(const typename ColorMask::PixelType p) {
 
 
 template<typename ColorMask>
-int16 *EdgeScaler::chooseGreyscale(typename ColorMask::PixelType *pixels) {
+int16 *EdgeScaler::chooseGreyscale(PixelState &state, typename ColorMask::PixelType *pixels) {
 	int i, j;
 	int32 scores[3];
 
@@ -323,14 +323,14 @@ int16 *EdgeScaler::chooseGreyscale(typename ColorMask::PixelType *pixels) {
 		grey_ptr = _greyscaleTable[i];
 
 		/* fill the 9 pixel window with greyscale values */
-		bptr = _bplanes[i];
+		bptr = state.bplanes[i];
 		pptr = pixels;
 		for (j = 9; j; --j)
 			*bptr++ = grey_ptr[convertTo16Bit<ColorMask>(*pptr++)];
-		bptr = _bplanes[i];
+		bptr = state.bplanes[i];
 
 		center = grey_ptr[convertTo16Bit<ColorMask>(pixels[4])];
-		diff_ptr = _greyscaleDiffs[i];
+		diff_ptr = state.greyscaleDiffs[i];
 
 		/* calculate the delta from center pixel */
 		diff_ptr[0] = bptr[0] - center;
@@ -356,29 +356,29 @@ int16 *EdgeScaler::chooseGreyscale(typename ColorMask::PixelType *pixels) {
 	if (scores[1] >= scores[0] && scores[1] >= scores[2]) {
 		if (!scores[1]) return NULL;
 
-		_chosenGreyscale = _greyscaleTable[1];
-		_bptr = _bplanes[1];
-		return _greyscaleDiffs[1];
+		state.chosenGreyscale = _greyscaleTable[1];
+		state.bptr = state.bplanes[1];
+		return state.greyscaleDiffs[1];
 	}
 
 	if (scores[0] >= scores[1] && scores[0] >= scores[2]) {
 		if (!scores[0]) return NULL;
 
-		_chosenGreyscale = _greyscaleTable[0];
-		_bptr = _bplanes[0];
-		return _greyscaleDiffs[0];
+		state.chosenGreyscale = _greyscaleTable[0];
+		state.bptr = state.bplanes[0];
+		return state.greyscaleDiffs[0];
 	}
 
 	if (!scores[2]) return NULL;
 
-	_chosenGreyscale = _greyscaleTable[2];
-	_bptr = _bplanes[2];
-	return _greyscaleDiffs[2];
+	state.chosenGreyscale = _greyscaleTable[2];
+	state.bptr = state.bplanes[2];
+	return state.greyscaleDiffs[2];
 }
 
 
 template<typename ColorMask>
-int32 EdgeScaler::calcPixelDiffNosqrt(typename ColorMask::PixelType pixel1, typename ColorMask::PixelType pixel2) {
+int32 EdgeScaler::calcPixelDiffNosqrt(PixelState &state, typename ColorMask::PixelType pixel1, typename ColorMask::PixelType pixel2) {
 	pixel1 = convertTo16Bit<ColorMask>(pixel1);
 	pixel2 = convertTo16Bit<ColorMask>(pixel2);
 
@@ -405,11 +405,11 @@ int32 EdgeScaler::calcPixelDiffNosqrt(typename ColorMask::PixelType pixel1, type
 	int16 diff;
 	int r_shift, g_shift, b_shift;
 
-	if (_chosenGreyscale == _greyscaleTable[1]) {
+	if (state.chosenGreyscale == _greyscaleTable[1]) {
 		r_shift = 1;
 		g_shift = 2;
 		b_shift = 0;
-	} else if (_chosenGreyscale == _greyscaleTable[0]) {
+	} else if (state.chosenGreyscale == _greyscaleTable[0]) {
 		r_shift = 2;
 		g_shift = 1;
 		b_shift = 0;
@@ -446,12 +446,12 @@ int32 EdgeScaler::calcPixelDiffNosqrt(typename ColorMask::PixelType pixel1, type
 #endif
 
 #if 0   /* use the greyscale directly */
-	return labs(_chosenGreyscale[pixel1] - _chosenGreyscale[pixel2]);
+	return labs(state.chosenGreyscale[pixel1] - state.chosenGreyscale[pixel2]);
 #endif
 }
 
 
-int EdgeScaler::findPrincipleAxis(int16 *diffs, int16 *bplane,
+int EdgeScaler::findPrincipleAxis(PixelState &state, int16 *diffs, int16 *bplane,
 								  int8 *sim,
 								  int32 *return_angle) {
 	struct xy_point {
@@ -502,11 +502,11 @@ int EdgeScaler::findPrincipleAxis(int16 *diffs, int16 *bplane,
 	/* calculate yes/no similarity matrix to center pixel */
 	/* store the number of similar pixels */
 	cutoff = ((int16)1 << (GREY_SHIFT - 3));
-	for (i = 0, _simSum = 0; i < 8; i++)
-		_simSum += (sim[i] = (diffs[i] < cutoff));
+	for (i = 0, state.simSum = 0; i < 8; i++)
+		state.simSum += (sim[i] = (diffs[i] < cutoff));
 
 	/* don't reverse pattern for off-center knights and sharp corners */
-	if (_simSum >= 3 && _simSum <= 5) {
+	if (state.simSum >= 3 && state.simSum <= 5) {
 		/* |. */ /* '- */
 		if (sim[1] && sim[4] && sim[5] && !sim[3] && !sim[6] &&
 		        (!sim[0] ^ !sim[7]))
@@ -528,7 +528,7 @@ int EdgeScaler::findPrincipleAxis(int16 *diffs, int16 *bplane,
 			reverse_flag = 0;
 
 		/* 90 degree corners */
-		else if (_simSum == 3) {
+		else if (state.simSum == 3) {
 			if ((sim[0] && sim[1] && sim[3]) ||
 			        (sim[1] && sim[2] && sim[4]) ||
 			        (sim[3] && sim[5] && sim[6]) ||
@@ -539,11 +539,11 @@ int EdgeScaler::findPrincipleAxis(int16 *diffs, int16 *bplane,
 
 	/* redo similarity array, less stringent for later checks */
 	cutoff = ((int16)1 << (GREY_SHIFT - 1));
-	for (i = 0, _simSum = 0; i < 8; i++)
-		_simSum += (sim[i] = (diffs[i] < cutoff));
+	for (i = 0, state.simSum = 0; i < 8; i++)
+		state.simSum += (sim[i] = (diffs[i] < cutoff));
 
 	/* center pixel is different from all the others, not an edge */
-	if (_simSum == 0) return '0';
+	if (state.simSum == 0) return '0';
 
 	/* reverse the difference array, so most similar is closest to 1 */
 	if (reverse_flag) {
@@ -676,7 +676,7 @@ int EdgeScaler::findPrincipleAxis(int16 *diffs, int16 *bplane,
 
 
 template<typename Pixel>
-int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_flag) {
+int EdgeScaler::checkArrows(PixelState &state, int best_dir, Pixel *pixels, int8 *sim, int half_flag) {
 	Pixel center = pixels[4];
 
 	if (center == pixels[0] && center == pixels[2] &&
@@ -745,7 +745,7 @@ int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_fla
 		        sim[1] == sim[3] &&
 		        sim[3] == sim[6] &&
 		        ((sim[2] && sim[7]) ||
-		         (half_flag && _simSum == 2 && sim[4] &&
+		         (half_flag && state.simSum == 2 && sim[4] &&
 		          (sim[2] || sim[7])))) /* < */
 			return 1;
 		break;
@@ -754,7 +754,7 @@ int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_fla
 		        sim[1] == sim[4] &&
 		        sim[4] == sim[6] &&
 		        ((sim[0] && sim[5]) ||
-		         (half_flag && _simSum == 2 && sim[3] &&
+		         (half_flag && state.simSum == 2 && sim[3] &&
 		          (sim[0] || sim[5])))) /* > */
 			return 1;
 		break;
@@ -763,7 +763,7 @@ int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_fla
 		        sim[1] == sim[3] &&
 		        sim[3] == sim[4] &&
 		        ((sim[5] && sim[7]) ||
-		         (half_flag && _simSum == 2 && sim[6] &&
+		         (half_flag && state.simSum == 2 && sim[6] &&
 		          (sim[5] || sim[7])))) /* ^ */
 			return 1;
 		break;
@@ -772,7 +772,7 @@ int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_fla
 		        sim[3] == sim[6] &&
 		        sim[4] == sim[6] &&
 		        ((sim[0] && sim[2]) ||
-		         (half_flag && _simSum == 2 && sim[1] &&
+		         (half_flag && state.simSum == 2 && sim[1] &&
 		          (sim[0] || sim[2])))) /* v */
 			return 1;
 		break;
@@ -783,7 +783,7 @@ int EdgeScaler::checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_fla
 
 
 template<typename Pixel>
-int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
+int EdgeScaler::refineDirection(PixelState &state, char edge_type, Pixel *pixels, int16 *bptr,
 								int8 *sim, double angle) {
 	int32 sums_dir[9] = { 0 };
 	int32 sum;
@@ -919,7 +919,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		if (n > 1) return 6;    /* | */
 
 		if (best_dir >= 5)
-			ok_arrow_flag = checkArrows<Pixel>(best_dir, pixels, sim, 1);
+			ok_arrow_flag = checkArrows<Pixel>(state, best_dir, pixels, sim, 1);
 
 		switch (best_dir) {
 		case 1:
@@ -1073,7 +1073,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		if (n > 1) return 0;    /* - */
 
 		if (best_dir >= 5)
-			ok_arrow_flag = checkArrows<Pixel>(best_dir, pixels, sim, 1);
+			ok_arrow_flag = checkArrows<Pixel>(state, best_dir, pixels, sim, 1);
 
 		switch (best_dir) {
 		case 1:
@@ -1115,7 +1115,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 	case '\\':
 
 		/* CHECK -- handle noisy half-diags */
-		if (_simSum == 1) {
+		if (state.simSum == 1) {
 			if (pixels[1] == pixels[3] && pixels[3] == pixels[5] &&
 			        pixels[5] == pixels[7]) {
 				if (pixels[2] != pixels[1] && pixels[6] != pixels[1]) {
@@ -1268,7 +1268,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		}
 
 		/* CHECK -- handle zig-zags */
-		if (_simSum == 3) {
+		if (state.simSum == 3) {
 			if ((best_dir == 0 || best_dir == 1) &&
 			        sim[0] && sim[1] && sim[4])
 				return 1;               /* '- */
@@ -1300,7 +1300,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 					return 17;      /* .\ */
 			}
 
-			if (_simSum == 3 && sim[0] && sim[7] &&
+			if (state.simSum == 3 && sim[0] && sim[7] &&
 			        pixels[1] == pixels[3] && pixels[3] == pixels[5] &&
 			        pixels[5] == pixels[7]) {
 				if (sim[2])
@@ -1309,7 +1309,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 					return 17;      /* .\ */
 			}
 
-			if (_simSum == 3 && sim[2] && sim[5]) {
+			if (state.simSum == 3 && sim[2] && sim[5]) {
 				if (sim[0])
 					return 18;      /* '/ */
 				if (sim[7])
@@ -1318,7 +1318,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		}
 
 		if (best_dir >= 5)
-			ok_arrow_flag = checkArrows<Pixel>(best_dir, pixels, sim, 0);
+			ok_arrow_flag = checkArrows<Pixel>(state, best_dir, pixels, sim, 0);
 
 		switch (best_dir) {
 		case 1:
@@ -1360,7 +1360,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 	case '/':
 
 		/* CHECK -- handle noisy half-diags */
-		if (_simSum == 1) {
+		if (state.simSum == 1) {
 			if (pixels[1] == pixels[3] && pixels[3] == pixels[5] &&
 			        pixels[5] == pixels[7]) {
 				if (pixels[0] != pixels[1] && pixels[8] != pixels[1]) {
@@ -1519,7 +1519,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		}
 
 		/* CHECK -- handle zig-zags */
-		if (_simSum == 3) {
+		if (state.simSum == 3) {
 			if ((best_dir == 0 || best_dir == 1) &&
 			        sim[2] && sim[4] && sim[6])
 				return 7;               /* |' */
@@ -1551,7 +1551,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 					return 19;      /* /. */
 			}
 
-			if (_simSum == 3 && sim[2] && sim[5] &&
+			if (state.simSum == 3 && sim[2] && sim[5] &&
 			        pixels[1] == pixels[3] && pixels[3] == pixels[5] &&
 			        pixels[5] == pixels[7]) {
 				if (sim[0])
@@ -1560,7 +1560,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 					return 19;      /* /. */
 			}
 
-			if (_simSum == 3 && sim[0] && sim[7]) {
+			if (state.simSum == 3 && sim[0] && sim[7]) {
 				if (sim[2])
 					return 16;      /* \' */
 				if (sim[5])
@@ -1569,7 +1569,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 		}
 
 		if (best_dir >= 5)
-			ok_arrow_flag = checkArrows<Pixel>(best_dir, pixels, sim, 0);
+			ok_arrow_flag = checkArrows<Pixel>(state, best_dir, pixels, sim, 0);
 
 		switch (best_dir) {
 		case 1:
@@ -1624,7 +1624,7 @@ int EdgeScaler::refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
 
 
 template<typename Pixel>
-int EdgeScaler::fixKnights(int sub_type, Pixel *pixels, int8 *sim) {
+int EdgeScaler::fixKnights(PixelState &state, int sub_type, Pixel *pixels, int8 *sim) {
 	Pixel center = pixels[4];
 	int dir = sub_type;
 	int n = 0;
@@ -1642,56 +1642,56 @@ int EdgeScaler::fixKnights(int sub_type, Pixel *pixels, int8 *sim) {
 	switch (sub_type) {
 	case 1:     /* '- */
 		if (sim[0] && sim[4] &&
-		        !(_simSum == 3 && sim[5] &&
+		        !(state.simSum == 3 && sim[5] &&
 		          pixels[0] == pixels[4] && pixels[6] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 2:     /* -. */
 		if (sim[3] && sim[7] &&
-		        !(_simSum == 3 && sim[2] &&
+		        !(state.simSum == 3 && sim[2] &&
 		          pixels[2] == pixels[4] && pixels[8] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 4:     /* '| */
 		if (sim[0] && sim[6] &&
-		        !(_simSum == 3 && sim[2] &&
+		        !(state.simSum == 3 && sim[2] &&
 		          pixels[0] == pixels[4] && pixels[2] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 5:     /* |. */
 		if (sim[1] && sim[7] &&
-		        !(_simSum == 3 && sim[5] &&
+		        !(state.simSum == 3 && sim[5] &&
 		          pixels[6] == pixels[4] && pixels[8] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 7:     /* |' */
 		if (sim[2] && sim[6] &&
-		        !(_simSum == 3 && sim[0] &&
+		        !(state.simSum == 3 && sim[0] &&
 		          pixels[0] == pixels[4] && pixels[2] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 8:     /* .| */
 		if (sim[1] && sim[5] &&
-		        !(_simSum == 3 && sim[7] &&
+		        !(state.simSum == 3 && sim[7] &&
 		          pixels[6] == pixels[4] && pixels[8] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 10:    /* -' */
 		if (sim[2] && sim[3] &&
-		        !(_simSum == 3 && sim[7] &&
+		        !(state.simSum == 3 && sim[7] &&
 		          pixels[2] == pixels[4] && pixels[8] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
 
 	case 11:    /* .- */
 		if (sim[4] && sim[5] &&
-		        !(_simSum == 3 && sim[0] &&
+		        !(state.simSum == 3 && sim[0] &&
 		          pixels[0] == pixels[4] && pixels[6] == pixels[4]))
 			ok_orig_flag = 1;
 		break;
@@ -1771,7 +1771,7 @@ int EdgeScaler::fixKnights(int sub_type, Pixel *pixels, int8 *sim) {
 #define greenMask   0x07E0
 
 template<typename ColorMask>
-void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
+void EdgeScaler::antiAliasGridClean3x(PixelState &state, uint8 *dptr, int dstPitch,
 		typename ColorMask::PixelType *pixels, int sub_type, int16 *bptr) {
 	typedef typename ColorMask::PixelType Pixel;
 
@@ -1789,7 +1789,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[6] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -1799,9 +1799,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[6] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1809,7 +1809,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[6] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[8]);
 			if (diff1 <= diff2)
@@ -1823,7 +1823,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -1833,9 +1833,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1843,7 +1843,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[2] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[0]);
 			if (diff1 <= diff2)
@@ -1860,9 +1860,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 16) {
 			tmp[2] = interpolate_1_1_1(pixels[1], pixels[5], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1873,9 +1873,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 17) {
 			tmp[6] = interpolate_1_1_1(pixels[3], pixels[7], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[6] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1891,7 +1891,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -1901,9 +1901,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1911,7 +1911,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[2] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[8]);
 			if (diff1 <= diff2)
@@ -1925,7 +1925,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[6] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -1935,9 +1935,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[6] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1945,7 +1945,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[6] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[0]);
 			if (diff1 <= diff2)
@@ -1959,7 +1959,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -1969,9 +1969,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -1979,7 +1979,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[0] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[6]);
 			if (diff1 <= diff2)
@@ -1993,7 +1993,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[8] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2003,9 +2003,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[8] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2013,7 +2013,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[8] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[2]);
 			if (diff1 <= diff2)
@@ -2030,9 +2030,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 18) {
 			tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2043,9 +2043,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 19) {
 			tmp[8] = interpolate_1_1_1(pixels[5], pixels[7], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[8] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2061,7 +2061,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[8] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2071,9 +2071,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[8] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2081,7 +2081,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[8] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[6]);
 			if (diff1 <= diff2)
@@ -2095,7 +2095,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2105,9 +2105,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2115,7 +2115,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			else
 				tmp[0] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[2]);
 			if (diff1 <= diff2)
@@ -2129,7 +2129,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -2139,9 +2139,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2151,7 +2151,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[6] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2161,9 +2161,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[6] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2179,7 +2179,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2189,9 +2189,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2201,7 +2201,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[8] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2211,9 +2211,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[8] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2229,7 +2229,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -2239,9 +2239,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2251,7 +2251,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[2] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2261,9 +2261,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2279,7 +2279,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 			tmp[i] = center;
 
 		tmp[6] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[6])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2289,9 +2289,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[6], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[6], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[6] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2301,7 +2301,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[8] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[8])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2311,9 +2311,9 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[8], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[8], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[8] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2372,7 +2372,7 @@ void EdgeScaler::antiAliasGridClean3x(uint8 *dptr, int dstPitch,
 
 
 template<typename ColorMask>
-void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
+void EdgeScaler::antiAliasGrid2x(PixelState &state, uint8 *dptr, int dstPitch,
 									typename ColorMask::PixelType *pixels, int sub_type, int16 *bptr,
 									int8 *sim,
 									int interpolate_2x) {
@@ -2390,7 +2390,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[3] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2400,9 +2400,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2410,7 +2410,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[2] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[8]);
 			if (diff1 <= diff2) {
@@ -2423,7 +2423,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[2] = interpolate_1_1(tmp[2], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
 						tmp[2] = center;
 				}
 			}
@@ -2435,7 +2435,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[2] = tmp[3] = center;
 
 		tmp[1] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2445,9 +2445,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[1] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2455,7 +2455,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[1] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[0]);
 			if (diff1 <= diff2) {
@@ -2468,7 +2468,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[1] = interpolate_1_1(tmp[1], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
 						tmp[1] = center;
 				}
 			}
@@ -2483,9 +2483,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 16) {
 			tmp[1] = interpolate_1_1_1(pixels[1], pixels[5], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[1] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2500,17 +2500,17 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			 * mouse pointer in Sam&Max.  Half-diags can be too thin in 2x
 			 * nearest-neighbor, so detect them and don't anti-alias them.
 			 */
-			else if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])] ||
-			         (_simSum == 1 && (sim[0] || sim[7]) &&
+			else if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])] ||
+			         (state.simSum == 1 && (sim[0] || sim[7]) &&
 			          pixels[1] == pixels[3] && pixels[5] == pixels[7]))
 				tmp[1] = center;
 		}
 
 		if (sub_type != 17) {
 			tmp[2] = interpolate_1_1_1(pixels[3], pixels[7], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2525,8 +2525,8 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			 * mouse pointer in Sam&Max.  Half-diags can be too thin in 2x
 			 * nearest-neighbor, so detect them and don't anti-alias them.
 			 */
-			else if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])] ||
-			         (_simSum == 1 && (sim[0] || sim[7]) &&
+			else if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])] ||
+			         (state.simSum == 1 && (sim[0] || sim[7]) &&
 			          pixels[1] == pixels[3] && pixels[5] == pixels[7]))
 				tmp[2] = center;
 		}
@@ -2537,7 +2537,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[2] = tmp[3] = center;
 
 		tmp[1] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2547,9 +2547,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[1] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2557,7 +2557,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[1] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[8]);
 			if (diff1 <= diff2) {
@@ -2570,7 +2570,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[1] = interpolate_1_1(tmp[1], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
 						tmp[1] = center;
 				}
 			}
@@ -2582,7 +2582,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[3] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -2592,9 +2592,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2602,7 +2602,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[2] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[0]);
 			if (diff1 <= diff2) {
@@ -2615,7 +2615,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[2] = interpolate_1_1(tmp[2], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
 						tmp[2] = center;
 				}
 			}
@@ -2627,7 +2627,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -2637,9 +2637,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2647,7 +2647,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[0] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[6]);
 			if (diff1 <= diff2) {
@@ -2660,7 +2660,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[0] = interpolate_1_1(tmp[0], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
 						tmp[0] = center;
 				}
 			}
@@ -2672,7 +2672,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = center;
 
 		tmp[3] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2682,9 +2682,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[3] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2692,7 +2692,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[3] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[2]);
 			if (diff1 <= diff2) {
@@ -2705,7 +2705,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[3] = interpolate_1_1(tmp[3], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
 						tmp[3] = center;
 				}
 			}
@@ -2720,9 +2720,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 
 		if (sub_type != 18) {
 			tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2737,17 +2737,17 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			 * mouse pointer in Sam&Max.  Half-diags can be too thin in 2x
 			 * nearest-neighbor, so detect them and don't anti-alias them.
 			 */
-			else if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])] ||
-			         (_simSum == 1 && (sim[2] || sim[5]) &&
+			else if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])] ||
+			         (state.simSum == 1 && (sim[2] || sim[5]) &&
 			          pixels[1] == pixels[5] && pixels[3] == pixels[7]))
 				tmp[0] = center;
 		}
 
 		if (sub_type != 19) {
 			tmp[3] = interpolate_1_1_1(pixels[5], pixels[7], center);
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[3] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2762,8 +2762,8 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			 * mouse pointer in Sam&Max.  Half-diags can be too thin in 2x
 			 * nearest-neighbor, so detect them and don't anti-alias them.
 			 */
-			else if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])] ||
-			         (_simSum == 1 && (sim[2] || sim[5]) &&
+			else if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])] ||
+			         (state.simSum == 1 && (sim[2] || sim[5]) &&
 			          pixels[1] == pixels[5] && pixels[3] == pixels[7]))
 				tmp[3] = center;
 		}
@@ -2774,7 +2774,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = center;
 
 		tmp[3] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2784,9 +2784,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[3] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2794,7 +2794,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[3] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[6]);
 			if (diff1 <= diff2) {
@@ -2807,7 +2807,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[3] = interpolate_1_1(tmp[3], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
 						tmp[3] = center;
 				}
 			}
@@ -2819,7 +2819,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_KNIGHTS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2829,9 +2829,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2839,7 +2839,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 			else
 				tmp[0] = pixels[4];
 
-			tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+			tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 			diff1 = labs(bptr[4] - tmp_grey);
 			diff2 = labs(bptr[4] - bptr[2]);
 			if (diff1 <= diff2) {
@@ -2852,7 +2852,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				if (interpolate_2x) {
 					tmp[0] = interpolate_1_1(tmp[0], center);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
 						tmp[0] = center;
 				}
 			}
@@ -2864,7 +2864,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -2874,9 +2874,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2885,12 +2885,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[0] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[4] && sim[2]) {
+			if (state.simSum == 2 && sim[4] && sim[2]) {
 				if (interpolate_2x) {
 					tmp[0] = interpolate_1_1(center, tmp[0]);
 					tmp[2] = interpolate_2_1(center, tmp[0]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
 						tmp[0] = center;
 				}
 
@@ -2904,7 +2904,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[2] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -2914,9 +2914,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2925,12 +2925,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[2] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[4] && sim[7]) {
+			if (state.simSum == 2 && sim[4] && sim[7]) {
 				if (interpolate_2x) {
 					tmp[2] = interpolate_1_1(center, tmp[2]);
 					tmp[0] = interpolate_2_1(center, tmp[2]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
 						tmp[2] = center;
 				}
 
@@ -2949,7 +2949,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[1] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -2959,9 +2959,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[1] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -2970,12 +2970,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[1] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[3] && sim[0]) {
+			if (state.simSum == 2 && sim[3] && sim[0]) {
 				if (interpolate_2x) {
 					tmp[1] = interpolate_1_1(center, tmp[1]);
 					tmp[3] = interpolate_2_1(center, tmp[1]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
 						tmp[1] = center;
 				}
 
@@ -2989,7 +2989,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[3] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -2999,9 +2999,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[3] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -3010,12 +3010,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[3] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[3] && sim[5]) {
+			if (state.simSum == 2 && sim[3] && sim[5]) {
 				if (interpolate_2x) {
 					tmp[3] = interpolate_1_1(center, tmp[3]);
 					tmp[1] = interpolate_2_1(center, tmp[3]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
 						tmp[3] = center;
 				}
 
@@ -3034,7 +3034,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[0] = interpolate_1_1_1(pixels[1], pixels[3], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[1]);
 		diff2 = labs(bptr[4] - bptr[3]);
@@ -3044,9 +3044,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[3]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[0], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[3]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[0], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[0] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -3055,12 +3055,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[0] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[6] && sim[5]) {
+			if (state.simSum == 2 && sim[6] && sim[5]) {
 				if (interpolate_2x) {
 					tmp[0] = interpolate_1_1(center, tmp[0]);
 					tmp[1] = interpolate_2_1(center, tmp[0]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[0])])
 						tmp[0] = center;
 				}
 
@@ -3074,7 +3074,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[1] = interpolate_1_1_1(pixels[1], pixels[5], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[5]);
 		diff2 = labs(bptr[4] - bptr[1]);
@@ -3084,9 +3084,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[1]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[5]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[1], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[1]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[5]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[1], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[1] = pixels[1];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -3095,12 +3095,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[1] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[6] && sim[7]) {
+			if (state.simSum == 2 && sim[6] && sim[7]) {
 				if (interpolate_2x) {
 					tmp[1] = interpolate_1_1(center, tmp[1]);
 					tmp[0] = interpolate_2_1(center, tmp[1]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[1])])
 						tmp[1] = center;
 				}
 
@@ -3119,7 +3119,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		tmp[0] = tmp[1] = tmp[2] = tmp[3] = center;
 
 		tmp[2] = interpolate_1_1_1(pixels[3], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[3]);
 		diff2 = labs(bptr[4] - bptr[7]);
@@ -3129,9 +3129,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[3]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[2], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[3]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[2], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[2] = pixels[3];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -3140,12 +3140,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[2] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[1] && sim[0]) {
+			if (state.simSum == 2 && sim[1] && sim[0]) {
 				if (interpolate_2x) {
 					tmp[2] = interpolate_1_1(center, tmp[2]);
 					tmp[3] = interpolate_2_1(center, tmp[2]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[2])])
 						tmp[2] = center;
 				}
 
@@ -3159,7 +3159,7 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		}
 
 		tmp[3] = interpolate_1_1_1(pixels[5], pixels[7], center);
-		tmp_grey = _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
+		tmp_grey = state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])];
 #if PARANOID_ARROWS
 		diff1 = labs(bptr[4] - bptr[7]);
 		diff2 = labs(bptr[4] - bptr[5]);
@@ -3169,9 +3169,9 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 		else    /* choose nearest pixel */
 #endif
 		{
-			diff1 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[5]);
-			diff2 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[7]);
-			diff3 = calcPixelDiffNosqrt<ColorMask>(tmp[3], pixels[4]);
+			diff1 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[5]);
+			diff2 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[7]);
+			diff3 = calcPixelDiffNosqrt<ColorMask>(state, tmp[3], pixels[4]);
 			if (diff1 <= diff2 && diff1 <= diff3)
 				tmp[3] = pixels[5];
 			else if (diff2 <= diff1 && diff2 <= diff3)
@@ -3180,12 +3180,12 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 				tmp[3] = pixels[4];
 
 			/* check for half-arrow */
-			if (_simSum == 2 && sim[1] && sim[2]) {
+			if (state.simSum == 2 && sim[1] && sim[2]) {
 				if (interpolate_2x) {
 					tmp[3] = interpolate_1_1(center, tmp[3]);
 					tmp[2] = interpolate_2_1(center, tmp[3]);
 				} else {
-					if (bptr[4] > _chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
+					if (bptr[4] > state.chosenGreyscale[convertTo16Bit<ColorMask>(tmp[3])])
 						tmp[3] = center;
 				}
 
@@ -3328,6 +3328,7 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 	int sub_type;
 	int32 angle;
 	int16 *diffs;
+	PixelState state;
 	int dstPitch3 = dstPitch * 3;
 	int bufferPitch3 = bufferPitch * 3;
 
@@ -3366,25 +3367,25 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 				}
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
+			diffs = chooseGreyscale<ColorMask>(state, pixels);
 
 			/* block of solid color */
 			if (!diffs) {
-				antiAliasGridClean3x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+				antiAliasGridClean3x<ColorMask>(state, (uint8 *) dptr16, dstPitch, pixels,
 				                                    0, NULL);
 				continue;
 			}
 
-			bplane = _bptr;
+			bplane = state.bptr;
 
-			edge_type = findPrincipleAxis(diffs, bplane,
+			edge_type = findPrincipleAxis(state, diffs, bplane,
 			                              sim, &angle);
-			sub_type = refineDirection<Pixel>(edge_type, pixels, bplane,
+			sub_type = refineDirection<Pixel>(state, edge_type, pixels, bplane,
 			                           sim, angle);
 			if (sub_type >= 0)
-				sub_type = fixKnights<Pixel>(sub_type, pixels, sim);
+				sub_type = fixKnights<Pixel>(state, sub_type, pixels, sim);
 
-			antiAliasGridClean3x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+			antiAliasGridClean3x<ColorMask>(state, (uint8 *) dptr16, dstPitch, pixels,
 			                                    sub_type, bplane);
 		}
 	}
@@ -3413,6 +3414,7 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 	int sub_type;
 	int32 angle;
 	int16 *diffs;
+	PixelState state;
 	int dstPitch2 = dstPitch << 1;
 	int bufferPitch2 = bufferPitch * 2;
 
@@ -3451,25 +3453,25 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 				}
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
+			diffs = chooseGreyscale<ColorMask>(state, pixels);
 
 			/* block of solid color */
 			if (!diffs) {
-				antiAliasGrid2x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+				antiAliasGrid2x<ColorMask>(state, (uint8 *) dptr16, dstPitch, pixels,
 				                              0, NULL, NULL, 0);
 				continue;
 			}
 
-			bplane = _bptr;
+			bplane = state.bptr;
 
-			edge_type = findPrincipleAxis(diffs, bplane,
+			edge_type = findPrincipleAxis(state, diffs, bplane,
 			                              sim, &angle);
-			sub_type = refineDirection<Pixel>(edge_type, pixels, bplane,
+			sub_type = refineDirection<Pixel>(state, edge_type, pixels, bplane,
 			                           sim, angle);
 			if (sub_type >= 0)
-				sub_type = fixKnights<Pixel>(sub_type, pixels, sim);
+				sub_type = fixKnights<Pixel>(state, sub_type, pixels, sim);
 
-			antiAliasGrid2x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
+			antiAliasGrid2x<ColorMask>(state, (uint8 *) dptr16, dstPitch, pixels,
 			                              sub_type, bplane, sim,
 			                              interpolate_2x);
 		}
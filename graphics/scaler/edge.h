@@ -39,6 +39,18 @@ protected:
 
 private:
 
+	/**
+	 * The edge detection state of the pixel being scaled. It is kept by
+	 * each pass, so that several bands can be scaled at the same time.
+	 */
+	struct PixelState {
+		int16 *chosenGreyscale;      ///< pointer to chosen greyscale table
+		int16 *bptr;                 ///< too awkward to pass variables
+		int8 simSum;                 ///< sum of similarity matrix
+		int16 greyscaleDiffs[3][8];
+		int16 bplanes[3][9];
+	};
+
 	/**
 	 * Choose greyscale bitplane to use, return diff array.  Exit early and
 	 * return NULL for a block of solid color (all diffs zero).
@@ -64,7 +76,7 @@ private:
 	 * bitplanes.  The increase in image quality is well worth the speed hit.
 	 */
 	template<typename ColorMask>
-	int16 *chooseGreyscale(typename ColorMask::PixelType *pixels);
+	int16 *chooseGreyscale(PixelState &state, typename ColorMask::PixelType *pixels);
 
 	/**
 	 * Calculate the distance between pixels in RGB space.  Greyscale isn't
@@ -73,7 +85,7 @@ private:
 	 * useful results.
 	 */
 	template<typename ColorMask>
-	int32 calcPixelDiffNosqrt(typename ColorMask::PixelType pixel1, typename ColorMask::PixelType pixel2);
+	int32 calcPixelDiffNosqrt(PixelState &state, typename ColorMask::PixelType pixel1, typename ColorMask::PixelType pixel2);
 
 	/**
 	 * Create vectors of all delta grey values from center pixel, with magnitudes
@@ -88,7 +100,7 @@ private:
 	 * Don't replace any of the double math with integer-based approximations,
 	 * since everything I have tried has lead to slight mis-detection errors.
 	 */
-	int findPrincipleAxis(int16 *diffs, int16 *bplane,
+	int findPrincipleAxis(PixelState &state, int16 *diffs, int16 *bplane,
 		int8 *sim,
 		int32 *return_angle);
 
@@ -96,7 +108,7 @@ private:
 	 * Check for mis-detected arrow patterns.  Return 1 (good), 0 (bad).
 	 */
 	template<typename Pixel>
-	int checkArrows(int best_dir, Pixel *pixels, int8 *sim, int half_flag);
+	int checkArrows(PixelState &state, int best_dir, Pixel *pixels, int8 *sim, int half_flag);
 
 	/**
 	 * Take original direction, refine it by testing different pixel difference
@@ -106,14 +118,14 @@ private:
 	 * refinement algorithms.
 	 */
 	template<typename Pixel>
-	int refineDirection(char edge_type, Pixel *pixels, int16 *bptr,
+	int refineDirection(PixelState &state, char edge_type, Pixel *pixels, int16 *bptr,
 		int8 *sim, double angle);
 
 	/**
 	 * "Chess Knight" patterns can be mis-detected, fix easy cases.
 	 */
 	template<typename Pixel>
-	int fixKnights(int sub_type, Pixel *pixels, int8 *sim);
+	int fixKnights(PixelState &state, int sub_type, Pixel *pixels, int8 *sim);
 
 	/**
 	 * Initialize various lookup tables
@@ -125,7 +137,7 @@ private:
 	 * Fill pixel grid with or without interpolation, using the detected edge
 	 */
 	template<typename ColorMask>
-	void antiAliasGrid2x(uint8 *dptr, int dstPitch,
+	void antiAliasGrid2x(PixelState &state, uint8 *dptr, int dstPitch,
 		typename ColorMask::PixelType *pixels, int sub_type, int16 *bptr,
 		int8 *sim,
 		int interpolate_2x);
@@ -134,7 +146,7 @@ private:
 	 * Fill pixel grid without interpolation, using the detected edge
 	 */
 	template<typename ColorMask>
-	void antiAliasGridClean3x(uint8 *dptr, int dstPitch,
+	void antiAliasGridClean3x(PixelState &state, uint8 *dptr, int dstPitch,
 		typename ColorMask::PixelType *pixels, int sub_type, int16 *bptr);
 
 	/**
@@ -162,11 +174,6 @@ private:
 
 	int16 _rgbTable[65536][3];       ///< table lookup for RGB
 	int16 _greyscaleTable[3][65536]; ///< greyscale tables
-	int16 *_chosenGreyscale;               ///< pointer to chosen greyscale table
-	int16 *_bptr;                          ///< too awkward to pass variables
-	int8 _simSum;                          ///< sum of similarity matrix
-	int16 _greyscaleDiffs[3][8];
-	int16 _bplanes[3][9];
 };
 
 
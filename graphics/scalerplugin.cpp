@@ -20,6 +20,8 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/thread.h"
+
 namespace {
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
@@ -52,9 +54,42 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 		} else {
 			Normal1x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 		}
-	} else {
+		return;
+	}
+
+	// Scalers only read the rows around a band, and write the rows of the
+	// band, so the bands can be scaled independently.
+	const uint numThreads = _threadCount ? _threadCount : Common::getMaxThreads();
+	const uint numBands = MIN<uint>(numThreads * 2, height / kMinBandHeight);
+	if (numThreads <= 1 || numBands <= 1 || width * height < kMinThreadedPixels) {
 		scaleIntern(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+	} else {
+		ScaleJob job;
+		job.scaler = this;
+		job.srcPtr = srcPtr;
+		job.srcPitch = srcPitch;
+		job.dstPtr = dstPtr;
+		job.dstPitch = dstPitch;
+		job.width = width;
+		job.height = height;
+		job.x = x;
+		job.y = y;
+		job.numBands = numBands;
+		Common::runTasks(scaleBand, &job, numBands, numThreads);
 	}
+
+	finishScale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+}
+
+void Scaler::scaleBand(void *param, uint task) {
+	const ScaleJob *job = (const ScaleJob *)param;
+
+	// Spread the rows evenly, so that no band is shorter than kMinBandHeight
+	const int top = task * job->height / job->numBands;
+	const int bottom = (task + 1) * job->height / job->numBands;
+	job->scaler->scaleIntern(job->srcPtr + top * job->srcPitch, job->srcPitch,
+	                         job->dstPtr + top * job->scaler->_factor * job->dstPitch, job->dstPitch,
+	                         job->width, bottom - top, job->x, job->y + top);
 }
 
 SourceScaler::SourceScaler(const Graphics::PixelFormat &format) : Scaler(format), _width(0), _height(0), _oldSrc(NULL), _enable(false) {
@@ -111,6 +146,16 @@ void SourceScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 	            _oldSrc + offset, srcPitch,
 	            width, height,
 	            (uint8 *)_bufferedOutput.getBasePtr(x * _factor, y * _factor), _bufferedOutput.pitch);
+}
+
+void SourceScaler::finishScale(const uint8 *srcPtr, uint32 srcPitch, const uint8 *dstPtr,
+						 uint32 dstPitch, int width, int height, int x, int y) {
+	if (!_enable)
+		return;
+
+	// The bands read the old source around them, so it can only be updated
+	// once all of them are done.
+	int offset = (_padding + x) * _format.bytesPerPixel + (_padding + y) * srcPitch;
 
 	// Update the destination buffer
 	byte *buffer = (byte *)_bufferedOutput.getBasePtr(x * _factor, y * _factor);
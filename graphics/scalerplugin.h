@@ -27,7 +27,7 @@
 
 class Scaler {
 public:
-	Scaler(const Graphics::PixelFormat &format) : _format(format) {}
+	Scaler(const Graphics::PixelFormat &format) : _format(format), _threadCount(1) {}
 	virtual ~Scaler() {}
 
 	/**
@@ -72,6 +72,24 @@ public:
 		return oldFactor;
 	}
 
+	/**
+	 * Set the number of threads used for large rects.
+	 *
+	 * Rects of at least kMinThreadedPixels source pixels are split into
+	 * horizontal bands, which are scaled by up to this many threads. 0 uses
+	 * Common::getMaxThreads(), and 1, the default, scales everything on the
+	 * calling thread.
+	 */
+	void setThreadCount(uint count) { _threadCount = count; }
+
+	uint getThreadCount() const { return _threadCount; }
+
+	/** The number of source pixels from which a rect is scaled by several threads. */
+	static const int kMinThreadedPixels = 320 * 100;
+
+	/** The minimum number of source rows in a band. */
+	static const int kMinBandHeight = 16;
+
 	/**
 	 * Set the source to be used when scaling and copying to the old buffer.
 	 *
@@ -101,8 +119,34 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) = 0;
 
+	/**
+	 * Called once the whole rect has been scaled. When the rect is split
+	 * into bands, scaleIntern() is called for each of them, possibly from
+	 * several threads at once, and this is called afterwards on the
+	 * calling thread.
+	 *
+	 * @see scale
+	 */
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, const uint8 *dstPtr,
+	                         uint32 dstPitch, int width, int height, int x, int y) {}
+
 	uint _factor;
 	Graphics::PixelFormat _format;
+
+private:
+	struct ScaleJob {
+		Scaler *scaler;
+		const uint8 *srcPtr;
+		uint32 srcPitch;
+		uint8 *dstPtr;
+		uint32 dstPitch;
+		int width, height, x, y;
+		uint numBands;
+	};
+
+	static void scaleBand(void *param, uint task);
+
+	uint _threadCount;
 };
 
 /**
@@ -127,12 +171,18 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) final;
 
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, const uint8 *dstPtr,
+	                         uint32 dstPitch, int width, int height, int x, int y) final;
+
 	/**
 	 * Scalers must implement this function. It will be called by oldSrcScale.
 	 * If by comparing the src and oldsrc images it is discovered that no change
 	 * is necessary, do not write a pixel.
 	 *
 	 * If oldSrcPtr is NULL, do not read from it. Scale every pixel.
+	 *
+	 * Large rects are split into bands, which may be scaled at the same time
+	 * by several threads, so this must not modify any member state.
 	 */
 	virtual void internScale(const uint8 *srcPtr, uint32 srcPitch,
 	                         uint8 *dstPtr, uint32 dstPitch,
@@ -27,6 +27,8 @@
 
 #include "common/singleton.h"
 #include "common/array.h"
+#include "common/config-manager.h"
+#include "common/thread.h"
 
 #include "graphics/tinygl/tinygl.h"
 #include "graphics/tinygl/zgl.h"
@@ -358,12 +360,40 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
 
+	// Tiled rasterization is opt-in, 0 uses one thread per CPU
+	int rasterThreads = ConfMan.hasKey("tinygl_threads") ? ConfMan.getInt("tinygl_threads") : 1;
+	initRasterContexts(rasterThreads > 0 ? rasterThreads : Common::getMaxThreads());
+
 	TinyGL::Internal::tglBlitResetScissorRect();
 }
 
+void GLContext::initRasterContexts(uint numThreads) {
+	if (numThreads <= 1)
+		return;
+
+	for (uint i = 0; i < numThreads; i++) {
+		// Value-initialize, so anything not synced before execution is zero
+		GLContext *worker = new GLContext();
+		worker->fb = new FrameBuffer(fb);
+		worker->vertex = nullptr;
+		worker->vertex_max = 0;
+		_rasterContexts.push_back(worker);
+	}
+}
+
+void GLContext::deinitRasterContexts() {
+	for (uint i = 0; i < _rasterContexts.size(); i++) {
+		gl_free(_rasterContexts[i]->vertex);
+		delete _rasterContexts[i]->fb;
+		delete _rasterContexts[i];
+	}
+	_rasterContexts.clear();
+}
+
 void GLContext::deinit() {
 	disposeDrawCallLists();
 	disposeResources();
+	deinitRasterContexts();
 
 	specbuf_cleanup();
 	for (int i = 0; i < 3; i++)
@@ -55,16 +55,49 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 
 	_currentTexture = nullptr;
 
+	_enableScissor = false;
+	_parent = nullptr;
+}
+
+FrameBuffer::FrameBuffer(FrameBuffer *parent) {
+	_parent = parent;
+	syncWithParent();
+
+	_offscreenBuffer.pbuf = nullptr;
+	_offscreenBuffer.zbuf = nullptr;
+
+	_currentTexture = nullptr;
+
 	_enableScissor = false;
 }
 
 FrameBuffer::~FrameBuffer() {
+	// The buffers of a child frame buffer belong to its parent
+	if (_parent)
+		return;
+
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
 		gl_free(_sbuf);
 }
 
+void FrameBuffer::syncWithParent() {
+	assert(_parent);
+	_pbufWidth = _parent->_pbufWidth;
+	_pbufHeight = _parent->_pbufHeight;
+	_pbufFormat = _parent->_pbufFormat;
+	_pbufBpp = _parent->_pbufBpp;
+	_pbufPitch = _parent->_pbufPitch;
+
+	_pbuf = _parent->_pbuf;
+	_zbuf = _parent->_zbuf;
+	_sbuf = _parent->_sbuf;
+
+	_textureSize = _parent->_textureSize;
+	_textureSizeMask = _parent->_textureSizeMask;
+}
+
 Buffer *FrameBuffer::genOffscreenBuffer() {
 	Buffer *buf = (Buffer *)gl_malloc(sizeof(Buffer));
 	buf->pbuf = (byte *)gl_zalloc(_pbufHeight * _pbufPitch);
@@ -105,8 +105,14 @@ struct ZBufferPoint {
 
 struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
+	// Creates a frame buffer drawing into the buffers of another one, with its own
+	// rasterization state. Used by the worker threads of the tiled rasterizer.
+	explicit FrameBuffer(FrameBuffer *parent);
 	~FrameBuffer();
 
+	// Picks up the current buffers of the parent frame buffer.
+	void syncWithParent();
+
 	Graphics::PixelFormat getPixelFormat() {
 		return _pbufFormat;
 	}
@@ -754,6 +760,7 @@ private:
 	template <bool kInterpRGB, bool kInterpZ, bool kDepthWrite, bool kEnableScissor>
 	void drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2);
 
+	FrameBuffer *_parent;
 	Buffer _offscreenBuffer;
 	byte *_pbuf;
 	int _pbufWidth;
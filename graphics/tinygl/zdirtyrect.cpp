@@ -24,6 +24,7 @@
 #include "graphics/tinygl/gl.h"
 
 #include "common/debug.h"
+#include "common/thread.h"
 
 namespace TinyGL {
 
@@ -192,12 +193,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (canExecuteDrawCallsTiled()) {
+			Common::Array<Common::Rect> regions;
 			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+				regions.push_back((*itRect).rectangle);
+			}
+			executeDrawCallsTiled(regions);
+		} else {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -239,9 +248,16 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 
 	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
 
-	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
-		delete *it;
+	if (canExecuteDrawCallsTiled()) {
+		executeDrawCallsTiled(Common::Array<Common::Rect>(1, dirtyAreas.back()));
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			delete *it;
+		}
+	} else {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			(*it)->execute(true);
+			delete *it;
+		}
 	}
 
 	_drawCallsQueue.clear();
@@ -251,6 +267,100 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+// Scan lines per tile are chosen so there are a few tiles per worker, to even
+// out the load, but not fewer than this.
+static const int kMinTileHeight = 16;
+
+struct TiledDrawCalls {
+	GLContext *context;
+	const Common::Array<Common::Rect> *tiles;
+	Common::List<DrawCall *>::const_iterator begin, end;
+};
+
+static void executeTiles(void *param, uint worker) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	const TiledDrawCalls *job = (const TiledDrawCalls *)param;
+	const uint numWorkers = job->context->_rasterContexts.size();
+	GLContext *c = job->context->_rasterContexts[worker];
+
+	// Tiles don't overlap, so each one can be drawn independently as long as
+	// its draw calls are executed in order.
+	for (uint i = worker; i < job->tiles->size(); i += numWorkers) {
+		const Common::Rect &tile = (*job->tiles)[i];
+		for (DrawCallIterator it = job->begin; it != job->end; ++it) {
+			if (tile.intersects((*it)->getDirtyRegion())) {
+				(*it)->executeTile(c, tile);
+			}
+		}
+	}
+}
+
+bool GLContext::canExecuteDrawCallsTiled() const {
+	// Selection and the profiling counters write to shared state
+	return !_rasterContexts.empty() && render_mode != TGL_SELECT && !_profilingEnabled;
+}
+
+void GLContext::executeDrawCallsTiled(const Common::Array<Common::Rect> &regions) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	const uint numWorkers = _rasterContexts.size();
+	for (uint i = 0; i < numWorkers; i++) {
+		GLContext *worker = _rasterContexts[i];
+		worker->fb->syncWithParent();
+		// Rasterization state not captured by the draw calls
+		worker->render_mode = render_mode;
+		worker->current_cull_face = current_cull_face;
+		worker->vertex_n = vertex_n;
+		worker->_textureSize = _textureSize;
+	}
+
+	// Split the regions into horizontal tiles on a common grid. Since the
+	// rasterizer skips scan lines outside of the scissor rectangle, this
+	// costs little more than drawing the regions at once.
+	const int tileHeight = MAX<int>(kMinTileHeight, fb->getPixelBufferHeight() / (numWorkers * 4));
+	Common::Array<Common::Rect> tiles;
+	for (uint i = 0; i < regions.size(); i++) {
+		const Common::Rect &region = regions[i];
+		for (int top = region.top; top < region.bottom; ) {
+			int bottom = MIN<int>((top / tileHeight + 1) * tileHeight, region.bottom);
+			tiles.push_back(Common::Rect(region.left, top, region.right, bottom));
+			top = bottom;
+		}
+	}
+
+	TiledDrawCalls job;
+	job.context = this;
+	job.tiles = &tiles;
+
+	DrawCallIterator it = _drawCallsQueue.begin();
+	while (it != _drawCallsQueue.end()) {
+		job.begin = it;
+		while (it != _drawCallsQueue.end() && (*it)->canExecuteTile()) {
+			++it;
+		}
+		job.end = it;
+
+		if (job.begin != job.end) {
+			Common::runTasks(executeTiles, &job, numWorkers, numWorkers);
+		}
+
+		// Blits go through the global context, so they are executed here in
+		// between the batches the workers take care of.
+		for ( ; it != _drawCallsQueue.end() && !(*it)->canExecuteTile(); ++it) {
+			if (!_enableDirtyRectangles) {
+				(*it)->execute(true);
+				continue;
+			}
+			for (uint i = 0; i < regions.size(); i++) {
+				if (regions[i].intersects((*it)->getDirtyRegion())) {
+					(*it)->execute(regions[i], true);
+				}
+			}
+		}
+	}
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
@@ -293,8 +403,8 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	_state = captureState(c);
+	if (c->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -337,14 +447,44 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
 	c->vertex = _vertex;
+	draw(c);
+
+	c->vertex = prevVertex;
+	c->vertex_cnt = prevVertexCount;
+
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void RasterizationDrawCall::executeTile(GLContext *c, const Common::Rect &clippingRectangle) const {
+	// Clipping and quads temporarily change the edge flags of the vertices,
+	// so every worker draws from its own copy of them.
+	if (c->vertex_max < _vertexCount) {
+		gl_free(c->vertex);
+		c->vertex = (GLVertex *)gl_malloc(_vertexCount * sizeof(GLVertex));
+		c->vertex_max = _vertexCount;
+	}
+	memcpy(c->vertex, _vertex, sizeof(GLVertex) * _vertexCount);
+
+	applyState(c, _state);
+	c->fb->setScissorRectangle(clippingRectangle);
+	draw(c);
+	c->fb->resetScissorRectangle();
+}
+
+// Draws the primitives from the vertices at c->vertex with the state of c.
+void RasterizationDrawCall::draw(GLContext *c) const {
+	GLVertex *vertex = c->vertex;
+
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
@@ -424,17 +564,11 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		error("glBegin: type %x not handled", c->begin_type);
 	}
 
-	c->vertex = prevVertex;
-	c->vertex_cnt = prevVertexCount;
-
-	if (restoreState) {
-		applyState(backupState);
-	}
+	c->vertex = vertex;
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) const {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -485,8 +619,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -576,7 +709,7 @@ BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transf
 	tglIncBlitImageRef(image);
 	_blitState = captureState();
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	if (gl_get_context()->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -693,7 +826,7 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		_dirtyRegion = c->renderRect;
 	}
 }
@@ -711,6 +844,12 @@ void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool re
 	                   _clearStencilBuffer, _stencilValue);
 }
 
+void ClearBufferDrawCall::executeTile(GLContext *c, const Common::Rect &clippingRectangle) const {
+	c->fb->clearRegion(clippingRectangle.left, clippingRectangle.top, clippingRectangle.width(), clippingRectangle.height(),
+	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
+	                   _clearStencilBuffer, _stencilValue);
+}
+
 bool ClearBufferDrawCall::operator==(const ClearBufferDrawCall &other) const {
 	return
 		_clearZBuffer == other._clearZBuffer &&
@@ -467,6 +467,10 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Tiled rasterization: one context per worker thread, each drawing
+	// into fb through a child frame buffer
+	Common::Array<GLContext *> _rasterContexts;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
 
@@ -524,6 +528,14 @@ public:
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
 
+	void initRasterContexts(uint numThreads);
+	void deinitRasterContexts();
+	bool canExecuteDrawCallsTiled() const;
+	void executeDrawCallsTiled(const Common::Array<Common::Rect> &regions);
+	bool needsDirtyRegions() const {
+		return _enableDirtyRectangles || !_rasterContexts.empty();
+	}
+
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
 	GLSpecBuf *specbuf_get_buffer(const int shininess_i, const float shininess);
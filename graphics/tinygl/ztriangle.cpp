@@ -229,6 +229,9 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		p2 = tp;
 	}
 
+	if (kEnableScissor && (p2->y < _clipRectangle.top || p0->y >= _clipRectangle.bottom))
+		return;
+
 	// we compute dXdx and dXdy for all interpolated values
 
 	fdx1 = (float)(p1->x - p0->x);
@@ -445,8 +448,16 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			// Scan lines outside of the scissor rectangle would be rejected pixel by
+			// pixel, so only step the edges for them. This keeps drawing a triangle
+			// in horizontal tiles about as cheap as drawing it at once.
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
+
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && y < _clipRectangle.top) {
+				// Nothing to draw
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
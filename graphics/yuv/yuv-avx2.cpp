@@ -0,0 +1,157 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <immintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+// Same as sse2_channel, for sixteen pixels
+template<bool fullScale>
+static FORCEINLINE __m256i avx2_channel(__m256i y, __m256i c, __m256i offset, __m128i loss) {
+	__m256i v = _mm256_add_epi16(y, _mm256_sub_epi16(c, offset));
+	if (fullScale) {
+		v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+	} else {
+		v = _mm256_min_epi16(_mm256_max_epi16(v, _mm256_set1_epi16(16)), _mm256_set1_epi16(235));
+		v = _mm256_mullo_epi16(_mm256_sub_epi16(v, _mm256_set1_epi16(16)), _mm256_set1_epi16(255));
+		v = _mm256_srli_epi16(_mm256_mulhi_epu16(v, _mm256_set1_epi16((short)38305)), 7);
+	}
+	return _mm256_srl_epi16(v, loss);
+}
+
+// Unpacking works per 128-bit lane, so the eight chroma values are first
+// spread over both lanes before they are doubled up.
+static FORCEINLINE __m256i avx2_loadChroma(const int16 *src, bool halfChroma) {
+	if (halfChroma) {
+		const __m256i c = _mm256_permute4x64_epi64(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)), _MM_SHUFFLE(1, 1, 0, 0));
+		return _mm256_unpacklo_epi16(c, c);
+	} else {
+		return _mm256_loadu_si256((const __m256i *)src);
+	}
+}
+
+static FORCEINLINE __m256i avx2_pack32(__m128i r, __m128i g, __m128i b, __m128i a, const __m128i *shifts) {
+	return _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(r), shifts[0]), _mm256_sll_epi32(_mm256_cvtepu16_epi32(g), shifts[1])),
+	                       _mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(b), shifts[2]), _mm256_sll_epi32(_mm256_cvtepu16_epi32(a), shifts[3])));
+}
+
+// Converts sixteen pixels at a time, and returns the number of pixels done
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha, bool fullScale>
+static int rowAVX2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	const __m256i rOffset = _mm256_set1_epi16(params.rOffset);
+	const __m256i gOffset = _mm256_set1_epi16(params.gOffset);
+	const __m256i bOffset = _mm256_set1_epi16(params.bOffset);
+	const __m128i rLoss = _mm_cvtsi32_si128(params.rLoss);
+	const __m128i gLoss = _mm_cvtsi32_si128(params.gLoss);
+	const __m128i bLoss = _mm_cvtsi32_si128(params.bLoss);
+	const __m128i aLoss = _mm_cvtsi32_si128(params.aLoss);
+	const __m128i shifts[4] = {
+		_mm_cvtsi32_si128(params.rShift), _mm_cvtsi32_si128(params.gShift),
+		_mm_cvtsi32_si128(params.bShift), _mm_cvtsi32_si128(params.aShift)
+	};
+
+	// Without an alpha plane, the alpha bits are always set
+	const __m256i aMask16 = _mm256_set1_epi16((short)params.aMask);
+	const __m256i aMask8 = _mm256_set1_epi16((short)(params.aMask >> params.aShift));
+
+	const int16 *cr_r  = chroma;
+	const int16 *crb_g = chroma + YUVToRGBKernel::kChunkSize;
+	const int16 *cb_b  = chroma + YUVToRGBKernel::kChunkSize * 2;
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const int c = halfChroma ? (x >> 1) : x;
+
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + x)));
+		const __m256i r = avx2_channel<fullScale>(y, avx2_loadChroma(cr_r + c, halfChroma), rOffset, rLoss);
+		const __m256i g = avx2_channel<fullScale>(y, avx2_loadChroma(crb_g + c, halfChroma), gOffset, gLoss);
+		const __m256i b = avx2_channel<fullScale>(y, avx2_loadChroma(cb_b + c, halfChroma), bOffset, bLoss);
+
+		__m256i a;
+		if (hasAlpha)
+			a = _mm256_srl_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(aSrc + x))), aLoss);
+		else
+			a = aMask8;
+
+		if (bytesPerPixel == 2) {
+			__m256i out = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi16(r, shifts[0]), _mm256_sll_epi16(g, shifts[1])), _mm256_sll_epi16(b, shifts[2]));
+			out = _mm256_or_si256(out, hasAlpha ? _mm256_sll_epi16(a, shifts[3]) : aMask16);
+			_mm256_storeu_si256((__m256i *)(dst + x * 2), out);
+		} else {
+			_mm256_storeu_si256((__m256i *)(dst + x * 4),
+			                    avx2_pack32(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b), _mm256_castsi256_si128(a), shifts));
+			_mm256_storeu_si256((__m256i *)(dst + x * 4 + 32),
+			                    avx2_pack32(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1), _mm256_extracti128_si256(a, 1), shifts));
+		}
+	}
+
+	return x;
+}
+
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha>
+static int rowAVX2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	if (params.fullScale)
+		return rowAVX2T<bytesPerPixel, halfChroma, hasAlpha, true>(dst, ySrc, aSrc, chroma, width, params);
+	else
+		return rowAVX2T<bytesPerPixel, halfChroma, hasAlpha, false>(dst, ySrc, aSrc, chroma, width, params);
+}
+
+template<int bytesPerPixel>
+static int rowAVX2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	if (halfChroma) {
+		if (aSrc)
+			return rowAVX2T<bytesPerPixel, true, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowAVX2T<bytesPerPixel, true, false>(dst, ySrc, aSrc, chroma, width, params);
+	} else {
+		if (aSrc)
+			return rowAVX2T<bytesPerPixel, false, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowAVX2T<bytesPerPixel, false, false>(dst, ySrc, aSrc, chroma, width, params);
+	}
+}
+
+void YUVToRGBKernel::rowAVX2(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	int done;
+	if (params.bytesPerPixel == 2)
+		done = rowAVX2T<2>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+	else
+		done = rowAVX2T<4>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+
+	if (done < width)
+		rowGeneric(dst + done * params.bytesPerPixel, ySrc + done, aSrc ? aSrc + done : nullptr,
+		           chroma + (halfChroma ? (done >> 1) : done), width - done, halfChroma, params);
+}
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
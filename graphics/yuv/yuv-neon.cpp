@@ -0,0 +1,171 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Graphics {
+
+// Same as sse2_channel, for eight pixels
+template<bool fullScale>
+static FORCEINLINE uint16x8_t neon_channel(int16x8_t y, int16x8_t c, int16x8_t offset, int16x8_t loss) {
+	int16x8_t v = vaddq_s16(y, vsubq_s16(c, offset));
+	uint16x8_t u;
+	if (fullScale) {
+		u = vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(v, vdupq_n_s16(0)), vdupq_n_s16(255)));
+	} else {
+		v = vminq_s16(vmaxq_s16(v, vdupq_n_s16(16)), vdupq_n_s16(235));
+		u = vmulq_u16(vreinterpretq_u16_s16(vsubq_s16(v, vdupq_n_s16(16))), vdupq_n_u16(255));
+		const uint32x4_t lo = vmull_u16(vget_low_u16(u), vdup_n_u16(38305));
+		const uint32x4_t hi = vmull_u16(vget_high_u16(u), vdup_n_u16(38305));
+		u = vshrq_n_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)), 7);
+	}
+	return vshlq_u16(u, loss);
+}
+
+static FORCEINLINE int16x8_t neon_loadChroma(const int16 *src, bool halfChroma) {
+	if (halfChroma) {
+		const int16x4_t c = vld1_s16(src);
+		const int16x4x2_t z = vzip_s16(c, c);
+		return vcombine_s16(z.val[0], z.val[1]);
+	} else {
+		return vld1q_s16(src);
+	}
+}
+
+static FORCEINLINE uint32x4_t neon_pack32(uint16x4_t r, uint16x4_t g, uint16x4_t b, uint16x4_t a, const int32x4_t *shifts) {
+	return vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(r), shifts[0]), vshlq_u32(vmovl_u16(g), shifts[1])),
+	                 vorrq_u32(vshlq_u32(vmovl_u16(b), shifts[2]), vshlq_u32(vmovl_u16(a), shifts[3])));
+}
+
+// Converts eight pixels at a time, and returns the number of pixels done
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha, bool fullScale>
+static int rowNEONT(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	const int16x8_t rOffset = vdupq_n_s16(params.rOffset);
+	const int16x8_t gOffset = vdupq_n_s16(params.gOffset);
+	const int16x8_t bOffset = vdupq_n_s16(params.bOffset);
+
+	// Shifting by a negative count shifts to the right
+	const int16x8_t rLoss = vdupq_n_s16(-params.rLoss);
+	const int16x8_t gLoss = vdupq_n_s16(-params.gLoss);
+	const int16x8_t bLoss = vdupq_n_s16(-params.bLoss);
+	const int16x8_t aLoss = vdupq_n_s16(-params.aLoss);
+	const int16x8_t shifts16[4] = {
+		vdupq_n_s16(params.rShift), vdupq_n_s16(params.gShift),
+		vdupq_n_s16(params.bShift), vdupq_n_s16(params.aShift)
+	};
+	const int32x4_t shifts32[4] = {
+		vdupq_n_s32(params.rShift), vdupq_n_s32(params.gShift),
+		vdupq_n_s32(params.bShift), vdupq_n_s32(params.aShift)
+	};
+
+	// Without an alpha plane, the alpha bits are always set
+	const uint16x8_t aMask16 = vdupq_n_u16((uint16)params.aMask);
+	const uint16x8_t aMask8 = vdupq_n_u16((uint16)(params.aMask >> params.aShift));
+
+	const int16 *cr_r  = chroma;
+	const int16 *crb_g = chroma + YUVToRGBKernel::kChunkSize;
+	const int16 *cb_b  = chroma + YUVToRGBKernel::kChunkSize * 2;
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const int c = halfChroma ? (x >> 1) : x;
+
+		const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ySrc + x)));
+		const uint16x8_t r = neon_channel<fullScale>(y, neon_loadChroma(cr_r + c, halfChroma), rOffset, rLoss);
+		const uint16x8_t g = neon_channel<fullScale>(y, neon_loadChroma(crb_g + c, halfChroma), gOffset, gLoss);
+		const uint16x8_t b = neon_channel<fullScale>(y, neon_loadChroma(cb_b + c, halfChroma), bOffset, bLoss);
+
+		uint16x8_t a;
+		if (hasAlpha)
+			a = vshlq_u16(vmovl_u8(vld1_u8(aSrc + x)), aLoss);
+		else
+			a = aMask8;
+
+		if (bytesPerPixel == 2) {
+			uint16x8_t out = vorrq_u16(vorrq_u16(vshlq_u16(r, shifts16[0]), vshlq_u16(g, shifts16[1])), vshlq_u16(b, shifts16[2]));
+			out = vorrq_u16(out, hasAlpha ? vshlq_u16(a, shifts16[3]) : aMask16);
+			vst1q_u16((uint16 *)(dst + x * 2), out);
+		} else {
+			vst1q_u32((uint32 *)(dst + x * 4), neon_pack32(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), vget_low_u16(a), shifts32));
+			vst1q_u32((uint32 *)(dst + x * 4 + 16), neon_pack32(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b), vget_high_u16(a), shifts32));
+		}
+	}
+
+	return x;
+}
+
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha>
+static int rowNEONT(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	if (params.fullScale)
+		return rowNEONT<bytesPerPixel, halfChroma, hasAlpha, true>(dst, ySrc, aSrc, chroma, width, params);
+	else
+		return rowNEONT<bytesPerPixel, halfChroma, hasAlpha, false>(dst, ySrc, aSrc, chroma, width, params);
+}
+
+template<int bytesPerPixel>
+static int rowNEONT(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	if (halfChroma) {
+		if (aSrc)
+			return rowNEONT<bytesPerPixel, true, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowNEONT<bytesPerPixel, true, false>(dst, ySrc, aSrc, chroma, width, params);
+	} else {
+		if (aSrc)
+			return rowNEONT<bytesPerPixel, false, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowNEONT<bytesPerPixel, false, false>(dst, ySrc, aSrc, chroma, width, params);
+	}
+}
+
+void YUVToRGBKernel::rowNEON(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	int done;
+	if (params.bytesPerPixel == 2)
+		done = rowNEONT<2>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+	else
+		done = rowNEONT<4>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+
+	if (done < width)
+		rowGeneric(dst + done * params.bytesPerPixel, ySrc + done, aSrc ? aSrc + done : nullptr,
+		           chroma + (halfChroma ? (done >> 1) : done), width - done, halfChroma, params);
+}
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
@@ -0,0 +1,184 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Graphics {
+
+// Computes the value of one channel for eight pixels, like the clip table
+// lookup in the generic code path. In the ITU range, the values are scaled
+// with (x - 16) * 255 / 219, where the division is done as a multiplication
+// by 38305 / 2^23, which is exact for all inputs.
+template<bool fullScale>
+static FORCEINLINE __m128i sse2_channel(__m128i y, __m128i c, __m128i offset, __m128i loss) {
+	__m128i v = _mm_add_epi16(y, _mm_sub_epi16(c, offset));
+	if (fullScale) {
+		v = _mm_min_epi16(_mm_max_epi16(v, _mm_setzero_si128()), _mm_set1_epi16(255));
+	} else {
+		v = _mm_min_epi16(_mm_max_epi16(v, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+		v = _mm_mullo_epi16(_mm_sub_epi16(v, _mm_set1_epi16(16)), _mm_set1_epi16(255));
+		v = _mm_srli_epi16(_mm_mulhi_epu16(v, _mm_set1_epi16((short)38305)), 7);
+	}
+	return _mm_srl_epi16(v, loss);
+}
+
+static FORCEINLINE void sse2_loadChroma(const int16 *src, bool halfChroma, __m128i &lo, __m128i &hi) {
+	if (halfChroma) {
+		const __m128i c = _mm_loadu_si128((const __m128i *)src);
+		lo = _mm_unpacklo_epi16(c, c);
+		hi = _mm_unpackhi_epi16(c, c);
+	} else {
+		lo = _mm_loadu_si128((const __m128i *)src);
+		hi = _mm_loadu_si128((const __m128i *)(src + 8));
+	}
+}
+
+static FORCEINLINE void sse2_store32(byte *dst, __m128i r, __m128i g, __m128i b, __m128i a, const __m128i *shifts) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), shifts[0]), _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), shifts[1])),
+	                                _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), shifts[2]), _mm_sll_epi32(_mm_unpacklo_epi16(a, zero), shifts[3])));
+	const __m128i hi = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), shifts[0]), _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), shifts[1])),
+	                                _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), shifts[2]), _mm_sll_epi32(_mm_unpackhi_epi16(a, zero), shifts[3])));
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 16), hi);
+}
+
+// Converts sixteen pixels at a time, and returns the number of pixels done
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha, bool fullScale>
+static int rowSSE2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rOffset = _mm_set1_epi16(params.rOffset);
+	const __m128i gOffset = _mm_set1_epi16(params.gOffset);
+	const __m128i bOffset = _mm_set1_epi16(params.bOffset);
+	const __m128i rLoss = _mm_cvtsi32_si128(params.rLoss);
+	const __m128i gLoss = _mm_cvtsi32_si128(params.gLoss);
+	const __m128i bLoss = _mm_cvtsi32_si128(params.bLoss);
+	const __m128i aLoss = _mm_cvtsi32_si128(params.aLoss);
+	const __m128i shifts[4] = {
+		_mm_cvtsi32_si128(params.rShift), _mm_cvtsi32_si128(params.gShift),
+		_mm_cvtsi32_si128(params.bShift), _mm_cvtsi32_si128(params.aShift)
+	};
+
+	// Without an alpha plane, the alpha bits are always set
+	const __m128i aMask16 = _mm_set1_epi16((short)params.aMask);
+	const __m128i aMask8 = _mm_set1_epi16((short)(params.aMask >> params.aShift));
+
+	const int16 *cr_r  = chroma;
+	const int16 *crb_g = chroma + YUVToRGBKernel::kChunkSize;
+	const int16 *cb_b  = chroma + YUVToRGBKernel::kChunkSize * 2;
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const int c = halfChroma ? (x >> 1) : x;
+
+		const __m128i y = _mm_loadu_si128((const __m128i *)(ySrc + x));
+		const __m128i yLo = _mm_unpacklo_epi8(y, zero);
+		const __m128i yHi = _mm_unpackhi_epi8(y, zero);
+
+		__m128i cLo, cHi;
+		sse2_loadChroma(cr_r + c, halfChroma, cLo, cHi);
+		const __m128i rLo = sse2_channel<fullScale>(yLo, cLo, rOffset, rLoss);
+		const __m128i rHi = sse2_channel<fullScale>(yHi, cHi, rOffset, rLoss);
+		sse2_loadChroma(crb_g + c, halfChroma, cLo, cHi);
+		const __m128i gLo = sse2_channel<fullScale>(yLo, cLo, gOffset, gLoss);
+		const __m128i gHi = sse2_channel<fullScale>(yHi, cHi, gOffset, gLoss);
+		sse2_loadChroma(cb_b + c, halfChroma, cLo, cHi);
+		const __m128i bLo = sse2_channel<fullScale>(yLo, cLo, bOffset, bLoss);
+		const __m128i bHi = sse2_channel<fullScale>(yHi, cHi, bOffset, bLoss);
+
+		__m128i aLo, aHi;
+		if (hasAlpha) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)(aSrc + x));
+			aLo = _mm_srl_epi16(_mm_unpacklo_epi8(a, zero), aLoss);
+			aHi = _mm_srl_epi16(_mm_unpackhi_epi8(a, zero), aLoss);
+		} else {
+			aLo = aHi = aMask8;
+		}
+
+		if (bytesPerPixel == 2) {
+			__m128i lo = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(rLo, shifts[0]), _mm_sll_epi16(gLo, shifts[1])), _mm_sll_epi16(bLo, shifts[2]));
+			__m128i hi = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(rHi, shifts[0]), _mm_sll_epi16(gHi, shifts[1])), _mm_sll_epi16(bHi, shifts[2]));
+			lo = _mm_or_si128(lo, hasAlpha ? _mm_sll_epi16(aLo, shifts[3]) : aMask16);
+			hi = _mm_or_si128(hi, hasAlpha ? _mm_sll_epi16(aHi, shifts[3]) : aMask16);
+			_mm_storeu_si128((__m128i *)(dst + x * 2), lo);
+			_mm_storeu_si128((__m128i *)(dst + x * 2 + 16), hi);
+		} else {
+			sse2_store32(dst + x * 4, rLo, gLo, bLo, aLo, shifts);
+			sse2_store32(dst + x * 4 + 32, rHi, gHi, bHi, aHi, shifts);
+		}
+	}
+
+	return x;
+}
+
+template<int bytesPerPixel, bool halfChroma, bool hasAlpha>
+static int rowSSE2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	if (params.fullScale)
+		return rowSSE2T<bytesPerPixel, halfChroma, hasAlpha, true>(dst, ySrc, aSrc, chroma, width, params);
+	else
+		return rowSSE2T<bytesPerPixel, halfChroma, hasAlpha, false>(dst, ySrc, aSrc, chroma, width, params);
+}
+
+template<int bytesPerPixel>
+static int rowSSE2T(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	if (halfChroma) {
+		if (aSrc)
+			return rowSSE2T<bytesPerPixel, true, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowSSE2T<bytesPerPixel, true, false>(dst, ySrc, aSrc, chroma, width, params);
+	} else {
+		if (aSrc)
+			return rowSSE2T<bytesPerPixel, false, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			return rowSSE2T<bytesPerPixel, false, false>(dst, ySrc, aSrc, chroma, width, params);
+	}
+}
+
+void YUVToRGBKernel::rowSSE2(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	int done;
+	if (params.bytesPerPixel == 2)
+		done = rowSSE2T<2>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+	else
+		done = rowSSE2T<4>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+
+	if (done < width)
+		rowGeneric(dst + done * params.bytesPerPixel, ySrc + done, aSrc ? aSrc + done : nullptr,
+		           chroma + (halfChroma ? (done >> 1) : done), width - done, halfChroma, params);
+}
+
+} // End of namespace Graphics
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
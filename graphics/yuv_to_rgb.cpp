@@ -82,6 +82,9 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/system.h"
+#include "common/thread.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
@@ -100,9 +103,15 @@ public:
 	const int16 *getColorTable() const { return _colorTab; }
 	const byte *getClipTable() const { return _clipTable; }
 
+	/** Offsets of the red, green and blue entries in the clip table, which are also included in the color table */
+	int getROffset() const { return _rOffset; }
+	int getGOffset() const { return _gOffset; }
+	int getBOffset() const { return _bOffset; }
+
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
+	int _rOffset, _gOffset, _bOffset;
 	int16 _colorTab[4 * 256]; // 2048 bytes
 	byte _clipTable[3 * 768];
 };
@@ -118,6 +127,10 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	uint b_offset = (format.bLoss == format.gLoss) ? g_offset :
 	                (format.bLoss == format.rLoss) ? r_offset : g_offset + 768;
 
+	_rOffset = r_offset + 256;
+	_gOffset = g_offset + 256;
+	_bOffset = b_offset + 256;
+
 	byte *r_2_pix_alloc = &_clipTable[r_offset];
 	byte *g_2_pix_alloc = &_clipTable[g_offset];
 	byte *b_2_pix_alloc = &_clipTable[b_offset];
@@ -183,6 +196,7 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_threadCount = 1;
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
@@ -198,160 +212,227 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
-#define PUT_PIXEL(s, d) \
-	L = &clipTable[(s)]; \
-	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | a_mask)
+YUVToRGBKernel::RowFunc YUVToRGBKernel::rowFunc = nullptr;
+
+void YUVToRGBKernel::selectFuncs() {
+	rowFunc = rowGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+		rowFunc = rowNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+		rowFunc = rowSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+		rowFunc = rowAVX2;
+#endif
+}
 
-template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = lookup->getColorTable();
-	const int16 *Cr_g_tab = Cr_r_tab + 256;
-	const int16 *Cb_g_tab = Cr_g_tab + 256;
-	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const byte *clipTable = lookup->getClipTable();
-
-	const byte r_shift = lookup->getFormat().rShift;
-	const byte g_shift = lookup->getFormat().gShift;
-	const byte b_shift = lookup->getFormat().bShift;
-	const PixelInt a_mask = (0xFF >> lookup->getFormat().aLoss) << lookup->getFormat().aShift;
-
-	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
-			const byte *L;
-
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXEL(*ySrc, dstPtr);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
+template<typename PixelInt, bool halfChroma, bool hasAlpha>
+static void convertRowGeneric(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, const YUVToRGBRowParams &params) {
+	const int16 *cr_r  = chroma;
+	const int16 *crb_g = chroma + YUVToRGBKernel::kChunkSize;
+	const int16 *cb_b  = chroma + YUVToRGBKernel::kChunkSize * 2;
+	const byte *clipTable = params.clipTable;
+	PixelInt *out = (PixelInt *)dst;
 
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch - yWidth;
-		uSrc += uvPitch - yWidth;
-		vSrc += uvPitch - yWidth;
+	for (int x = 0; x < width; x++) {
+		const int c = halfChroma ? (x >> 1) : x;
+		const byte *L = &clipTable[ySrc[x]];
+		const PixelInt a = hasAlpha ? (PixelInt)((aSrc[x] >> params.aLoss) << params.aShift) : (PixelInt)params.aMask;
+
+		out[x] = ((PixelInt)L[cr_r[c]] << params.rShift) | ((PixelInt)L[crb_g[c]] << params.gShift) | ((PixelInt)L[cb_b[c]] << params.bShift) | a;
 	}
 }
 
-void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
+template<typename PixelInt>
+static void convertRowGeneric(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	if (halfChroma) {
+		if (aSrc)
+			convertRowGeneric<PixelInt, true, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			convertRowGeneric<PixelInt, true, false>(dst, ySrc, aSrc, chroma, width, params);
+	} else {
+		if (aSrc)
+			convertRowGeneric<PixelInt, false, true>(dst, ySrc, aSrc, chroma, width, params);
+		else
+			convertRowGeneric<PixelInt, false, false>(dst, ySrc, aSrc, chroma, width, params);
+	}
+}
+
+void YUVToRGBKernel::rowGeneric(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+	if (params.bytesPerPixel == 2)
+		convertRowGeneric<uint16>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+	else
+		convertRowGeneric<uint32>(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+}
+
+struct YUVToRGBManager::ConvertJob {
+	const YUVToRGBLookup *lookup;
+	YUVToRGBRowParams params;
+	ChromaLayout layout;
+
+	byte *dst;
+	int dstPitch;
+
+	const byte *ySrc, *uSrc, *vSrc, *aSrc;
+	int yWidth, yHeight, yPitch, uvPitch;
 
+	int bandHeight;
+};
+
+void YUVToRGBManager::convert(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, ChromaLayout layout, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const Graphics::PixelFormat &format = lookup->getFormat();
+
+	ConvertJob job;
+	job.lookup = lookup;
+	job.layout = layout;
+	job.dst = (byte *)dst->getPixels();
+	job.dstPitch = dst->pitch;
+	job.ySrc = ySrc;
+	job.uSrc = uSrc;
+	job.vSrc = vSrc;
+	job.aSrc = aSrc;
+	job.yWidth = yWidth;
+	job.yHeight = yHeight;
+	job.yPitch = yPitch;
+	job.uvPitch = uvPitch;
+
+	YUVToRGBRowParams &params = job.params;
+	params.clipTable = lookup->getClipTable();
+	params.rOffset = lookup->getROffset();
+	params.gOffset = lookup->getGOffset();
+	params.bOffset = lookup->getBOffset();
+	params.fullScale = (scale == kScaleFull);
+	params.bytesPerPixel = format.bytesPerPixel;
+	params.rShift = format.rShift;
+	params.gShift = format.gShift;
+	params.bShift = format.bShift;
+	params.aShift = format.aShift;
+	params.rLoss = format.rLoss;
+	params.gLoss = format.gLoss;
+	params.bLoss = format.bLoss;
+	params.aLoss = format.aLoss;
+	params.aMask = (0xFF >> format.aLoss) << format.aShift;
+
+	const uint numThreads = _threadCount ? _threadCount : Common::getMaxThreads();
+	if (numThreads <= 1 || yWidth * yHeight < kMinThreadedPixels) {
+		convertRows(job, 0, yHeight);
+		return;
+	}
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	// Bands start on a multiple of 4 rows, so that they never split the
+	// rows sharing their chroma values.
+	job.bandHeight = MAX(16, ((yHeight / (int)(numThreads * 2)) + 3) & ~3);
+	const uint numBands = (yHeight + job.bandHeight - 1) / job.bandHeight;
+	Common::runTasks(convertBand, &job, numBands, numThreads);
 }
 
-template<typename PixelInt>
-void convertYUV422ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfWidth = yWidth >> 1;
+void YUVToRGBManager::convertBand(void *param, uint task) {
+	const ConvertJob *job = (const ConvertJob *)param;
+
+	const int y = task * job->bandHeight;
+	convertRows(*job, y, MIN(job->bandHeight, job->yHeight - y));
+}
+
+#define READ_QUAD(ptr, prefix) \
+	byte prefix##A = ptr[index]; \
+	byte prefix##B = ptr[index + 1]; \
+	byte prefix##C = ptr[index + uvPitch]; \
+	byte prefix##D = ptr[index + uvPitch + 1]
+
+#define DO_INTERPOLATION(out) \
+	out = (out##A * (4 - xDiff) * (4 - yDiff) + out##B * xDiff * (4 - yDiff) + \
+			out##C * yDiff * (4 - xDiff) + out##D * xDiff * yDiff) >> 4
 
+void YUVToRGBManager::convertRows(const ConvertJob &job, int y, int rows) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = lookup->getColorTable();
+	const int16 *Cr_r_tab = job.lookup->getColorTable();
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const byte *clipTable = lookup->getClipTable();
-
-	const byte r_shift = lookup->getFormat().rShift;
-	const byte g_shift = lookup->getFormat().gShift;
-	const byte b_shift = lookup->getFormat().bShift;
-	const PixelInt a_mask = (0xFF >> lookup->getFormat().aLoss) << lookup->getFormat().aShift;
-
-	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
-			const byte *L;
-
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXEL(*ySrc, dstPtr);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-			PUT_PIXEL(*ySrc, dstPtr);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
 
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch  - yWidth;
-		uSrc += uvPitch - halfWidth;
-		vSrc += uvPitch - halfWidth;
+	// The chroma contribution of a chunk of pixels, which is looked up once
+	// and then converted by the row kernel
+	int16 chroma[3 * YUVToRGBKernel::kChunkSize];
+	int16 *cr_r  = chroma;
+	int16 *crb_g = chroma + YUVToRGBKernel::kChunkSize;
+	int16 *cb_b  = chroma + YUVToRGBKernel::kChunkSize * 2;
+
+	const int uvPitch = job.uvPitch;
+	const bool halfChroma = (job.layout == kChroma422 || job.layout == kChroma420);
+	const int rowsPerChroma = (job.layout == kChroma420) ? 2 : 1;
+	const int chunkPixels = halfChroma ? YUVToRGBKernel::kChunkSize * 2 : YUVToRGBKernel::kChunkSize;
+	const int bytesPerPixel = job.params.bytesPerPixel;
+
+	for (int row = y; row < y + rows; row += rowsPerChroma) {
+		for (int x = 0; x < job.yWidth; x += chunkPixels) {
+			const int width = MIN(chunkPixels, job.yWidth - x);
+
+			if (job.layout == kChroma410) {
+				// Perform bilinear interpolation on the chroma values
+				// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
+				const int yDiff = row & 3;
+				for (int i = 0; i < width; i++) {
+					const int xDiff = (x + i) & 3;
+					const int index = (row >> 2) * uvPitch + ((x + i) >> 2);
+
+					byte u, v;
+					READ_QUAD(job.uSrc, u);
+					READ_QUAD(job.vSrc, v);
+					DO_INTERPOLATION(u);
+					DO_INTERPOLATION(v);
+
+					cr_r[i]  = Cr_r_tab[v];
+					crb_g[i] = Cr_g_tab[v] + Cb_g_tab[u];
+					cb_b[i]  = Cb_b_tab[u];
+				}
+			} else {
+				const int chromaRow = (job.layout == kChroma420) ? (row >> 1) : row;
+				const int chromaX = halfChroma ? (x >> 1) : x;
+				const int count = halfChroma ? ((width + 1) >> 1) : width;
+				const byte *uSrc = job.uSrc + chromaRow * uvPitch + chromaX;
+				const byte *vSrc = job.vSrc + chromaRow * uvPitch + chromaX;
+
+				for (int i = 0; i < count; i++) {
+					cr_r[i]  = Cr_r_tab[vSrc[i]];
+					crb_g[i] = Cr_g_tab[vSrc[i]] + Cb_g_tab[uSrc[i]];
+					cb_b[i]  = Cb_b_tab[uSrc[i]];
+				}
+			}
+
+			for (int i = 0; i < rowsPerChroma; i++) {
+				const int offset = (row + i) * job.yPitch + x;
+				YUVToRGBKernel::convertRow(job.dst + (row + i) * job.dstPitch + x * bytesPerPixel, job.ySrc + offset,
+				                           job.aSrc ? job.aSrc + offset : nullptr, chroma, width, halfChroma, job.params);
+			}
+		}
 	}
 }
 
-void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+#undef READ_QUAD
+#undef DO_INTERPOLATION
+
+void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
-	assert((yWidth & 1) == 0);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV422ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV422ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	convert(dst, scale, kChroma444, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
 }
 
-template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
-	int halfWidth = yWidth >> 1;
-
-	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = lookup->getColorTable();
-	const int16 *Cr_g_tab = Cr_r_tab + 256;
-	const int16 *Cb_g_tab = Cr_g_tab + 256;
-	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const byte *clipTable = lookup->getClipTable();
-
-	const byte r_shift = lookup->getFormat().rShift;
-	const byte g_shift = lookup->getFormat().gShift;
-	const byte b_shift = lookup->getFormat().bShift;
-	const PixelInt a_mask = (0xFF >> lookup->getFormat().aLoss) << lookup->getFormat().aShift;
-
-	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
-			const byte *L;
-
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-			PUT_PIXEL(*ySrc, dstPtr);
-			PUT_PIXEL(*(ySrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			dstPtr += sizeof(PixelInt);
-		}
+void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+	assert((yWidth & 1) == 0);
 
-		dstPtr += dstPitch;
-		ySrc += (yPitch << 1) - yWidth;
-		uSrc += uvPitch - halfWidth;
-		vSrc += uvPitch - halfWidth;
-	}
+	convert(dst, scale, kChroma422, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
 }
 
 void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
@@ -362,65 +443,7 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
-#define PUT_PIXELA(s, a, d) \
-	L = &clipTable[(s)]; \
-	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | ((a >> a_loss) << a_shift))
-
-template<typename PixelInt>
-void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
-	int halfWidth = yWidth >> 1;
-
-	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = lookup->getColorTable();
-	const int16 *Cr_g_tab = Cr_r_tab + 256;
-	const int16 *Cb_g_tab = Cr_g_tab + 256;
-	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const byte *clipTable = lookup->getClipTable();
-
-	const byte r_shift = lookup->getFormat().rShift;
-	const byte g_shift = lookup->getFormat().gShift;
-	const byte b_shift = lookup->getFormat().bShift;
-	const byte a_shift = lookup->getFormat().aShift;
-	const byte a_loss = lookup->getFormat().aLoss;
-
-	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
-			const byte *L;
-
-			int16 cr_r  = Cr_r_tab[*vSrc];
-			int16 crb_g = Cr_g_tab[*vSrc] + Cb_g_tab[*uSrc];
-			int16 cb_b  = Cb_b_tab[*uSrc];
-			++uSrc;
-			++vSrc;
-
-			PUT_PIXELA(*ySrc, *aSrc, dstPtr);
-			PUT_PIXELA(*(ySrc + yPitch), *(aSrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			aSrc++;
-			dstPtr += sizeof(PixelInt);
-			PUT_PIXELA(*ySrc, *aSrc, dstPtr);
-			PUT_PIXELA(*(ySrc + yPitch), *(aSrc + yPitch), dstPtr + dstPitch);
-			ySrc++;
-			aSrc++;
-			dstPtr += sizeof(PixelInt);
-		}
-
-		dstPtr += dstPitch;
-		ySrc += (yPitch << 1) - yWidth;
-		aSrc += (yPitch << 1) - yWidth;
-		uSrc += uvPitch - halfWidth;
-		vSrc += uvPitch - halfWidth;
-	}
+	convert(dst, scale, kChroma420, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
 }
 
 void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
@@ -431,88 +454,9 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUVA420ToRGBA<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUVA420ToRGBA<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
-#define READ_QUAD(ptr, prefix) \
-	byte prefix##A = ptr[index]; \
-	byte prefix##B = ptr[index + 1]; \
-	byte prefix##C = ptr[index + uvPitch]; \
-	byte prefix##D = ptr[index + uvPitch + 1]
-
-#define DO_INTERPOLATION(out) \
-	out = (out##A * (4 - xDiff) * (4 - yDiff) + out##B * xDiff * (4 - yDiff) + \
-			out##C * yDiff * (4 - xDiff) + out##D * xDiff * yDiff) >> 4
-
-#define DO_YUV410_PIXEL() \
-	DO_INTERPOLATION(u); \
-	DO_INTERPOLATION(v); \
-	\
-	cr_r  = Cr_r_tab[v]; \
-	crb_g = Cr_g_tab[v] + Cb_g_tab[u]; \
-	cb_b  = Cb_b_tab[u]; \
-	\
-	PUT_PIXEL(*ySrc, dstPtr); \
-	dstPtr += sizeof(PixelInt); \
-	\
-	ySrc++; \
-	xDiff++
-
-template<typename PixelInt>
-void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = lookup->getColorTable();
-	const int16 *Cr_g_tab = Cr_r_tab + 256;
-	const int16 *Cb_g_tab = Cr_g_tab + 256;
-	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const byte *clipTable = lookup->getClipTable();
-
-	const byte r_shift = lookup->getFormat().rShift;
-	const byte g_shift = lookup->getFormat().gShift;
-	const byte b_shift = lookup->getFormat().bShift;
-	const PixelInt a_mask = (0xFF >> lookup->getFormat().aLoss) << lookup->getFormat().aShift;
-
-	int quarterWidth = yWidth >> 2;
-
-	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
-			// Perform bilinear interpolation on the chroma values
-			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
-			// Feel free to optimize further
-			int targetY = y >> 2;
-			int xDiff = 0;
-			int yDiff = y & 3;
-			int index = targetY * uvPitch + x;
-
-			// Declare some variables for the following macros
-			byte u, v;
-			int16 cr_r, crb_g, cb_b;
-			const byte *L;
-
-			READ_QUAD(uSrc, u);
-			READ_QUAD(vSrc, v);
-
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-		}
-
-		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
-		ySrc += yPitch - yWidth;
-	}
+	convert(dst, scale, kChroma420, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
-#undef READ_QUAD
-#undef DO_INTERPOLATION
-#undef DO_YUV410_PIXEL
-
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
@@ -521,13 +465,7 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	convert(dst, scale, kChroma410, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
@@ -41,10 +41,70 @@
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
+class YUVToRGBTestSuite;
+
 namespace Graphics {
 
 class YUVToRGBLookup;
 
+/** The parameters of a conversion, which are the same for every row. */
+struct YUVToRGBRowParams {
+	const byte *clipTable; ///< The clip table of the YUVToRGBLookup
+	int rOffset;           ///< Offset of the red entries in the clip table, which is also included in the red chroma values
+	int gOffset;           ///< Offset of the green entries in the clip table, which is also included in the green chroma values
+	int bOffset;           ///< Offset of the blue entries in the clip table, which is also included in the blue chroma values
+	bool fullScale;        ///< Is the luminance in the range [0, 255] instead of [16, 235]?
+	byte bytesPerPixel;
+	byte rShift, gShift, bShift, aShift;
+	byte rLoss, gLoss, bLoss, aLoss;
+	uint32 aMask;          ///< Alpha bits to set, if there is no alpha plane
+};
+
+/**
+ * The kernels converting a row of pixels, once the chroma contribution of
+ * each pixel has been looked up.
+ *
+ * The chroma values are stored as three arrays of kChunkSize entries, for
+ * the red, green and blue contributions. Every implementation produces
+ * exactly the same pixels as the lookup tables.
+ */
+class YUVToRGBKernel {
+public:
+	/** The maximum number of chroma values passed to a kernel at once. */
+	static const int kChunkSize = 512;
+
+	/**
+	 * Convert @p width pixels. With @p halfChroma set, each chroma value is
+	 * used for two neighbouring pixels. If @p aSrc is not null, it holds
+	 * the alpha value of every pixel.
+	 */
+	static void convertRow(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params) {
+		if (!rowFunc)
+			selectFuncs();
+		rowFunc(dst, ySrc, aSrc, chroma, width, halfChroma, params);
+	}
+
+private:
+	typedef void (*RowFunc)(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params);
+
+#ifdef SCUMMVM_NEON
+	static void rowNEON(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void rowSSE2(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void rowAVX2(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params);
+#endif
+	static void rowGeneric(byte *dst, const byte *ySrc, const byte *aSrc, const int16 *chroma, int width, bool halfChroma, const YUVToRGBRowParams &params);
+
+	static void selectFuncs();
+
+	static RowFunc rowFunc;
+
+	friend class ::YUVToRGBTestSuite;
+};
+
 class YUVToRGBManager : public Common::Singleton<YUVToRGBManager> {
 public:
 	/** The scale of the luminance values */
@@ -135,6 +195,18 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Set the number of threads used for large images.
+	 *
+	 * Images of at least kMinThreadedPixels pixels have their rows split
+	 * across this many threads. 0 uses Common::getMaxThreads(), and 1, the
+	 * default, converts everything on the calling thread.
+	 */
+	void setThreadCount(uint count) { _threadCount = count; }
+
+	/** The number of pixels from which an image is converted by several threads. */
+	static const int kMinThreadedPixels = 1280 * 720;
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -142,7 +214,21 @@ private:
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale);
 
+	enum ChromaLayout {
+		kChroma444,
+		kChroma422,
+		kChroma420,
+		kChroma410
+	};
+
+	struct ConvertJob;
+
+	void convert(Graphics::Surface *dst, LuminanceScale scale, ChromaLayout layout, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+	static void convertRows(const ConvertJob &job, int y, int rows);
+	static void convertBand(void *param, uint task);
+
 	YUVToRGBLookup *_lookup;
+	uint _threadCount;
 };
  /** @} */
 } // End of namespace Graphics
@@ -0,0 +1,375 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gui/ThemeCache.h"
+
+#include "graphics/VectorRenderer.h"
+
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/util.h"
+
+namespace GUI {
+
+enum {
+	kThemeCacheTag = MKTAG('S', 'T', 'H', 'C'),
+	// Increase this when the recorded calls or the DrawStep structure change
+	kThemeCacheVersion = 1
+};
+
+static void writeCacheString(Common::WriteStream &stream, const Common::String &str) {
+	stream.writeString(str);
+	stream.writeByte(0);
+}
+
+ThemeCache::ThemeCache() : _calls(DisposeAfterUse::YES), _callCount(0) {
+}
+
+ThemeCache::~ThemeCache() {
+	clearBitmaps();
+}
+
+void ThemeCache::clearBitmaps() {
+	for (uint i = 0; i < _bitmaps.size(); ++i) {
+		if (_bitmaps[i].surface) {
+			_bitmaps[i].surface->free();
+			delete _bitmaps[i].surface;
+		}
+	}
+	_bitmaps.clear();
+}
+
+void ThemeCache::startCall(Call call) {
+	_calls.writeByte(call);
+	_callCount++;
+}
+
+/**********************************************************
+ * Recording
+ *********************************************************/
+void ThemeCache::recordDrawData(const Common::String &data, bool cached) {
+	startCall(kCallDrawData);
+	writeCacheString(_calls, data);
+	_calls.writeByte(cached);
+}
+
+void ThemeCache::recordDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &function, const Common::String &bitmap) {
+	startCall(kCallDrawStep);
+	writeCacheString(_calls, drawDataId);
+	writeDrawStep(_calls, step, function, bitmap);
+}
+
+void ThemeCache::recordTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV) {
+	startCall(kCallTextData);
+	writeCacheString(_calls, drawDataId);
+	_calls.writeSint32BE(textId);
+	_calls.writeSint32BE(colorId);
+	_calls.writeSint32BE(alignH);
+	_calls.writeSint32BE(alignV);
+}
+
+void ThemeCache::recordFont(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	startCall(kCallFont);
+	_calls.writeSint32BE(textId);
+	writeCacheString(_calls, language);
+	writeCacheString(_calls, file);
+	writeCacheString(_calls, scalableFile);
+	_calls.writeSint32BE(pointsize);
+}
+
+void ThemeCache::recordFontNames(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize) {
+	startCall(kCallFontNames);
+	_calls.writeSint32BE(textId);
+	writeCacheString(_calls, language);
+	writeCacheString(_calls, file);
+	writeCacheString(_calls, scalableFile);
+	_calls.writeSint32BE(pointsize);
+}
+
+void ThemeCache::recordTextColor(TextColor colorId, int r, int g, int b) {
+	startCall(kCallTextColor);
+	_calls.writeSint32BE(colorId);
+	_calls.writeSint32BE(r);
+	_calls.writeSint32BE(g);
+	_calls.writeSint32BE(b);
+}
+
+void ThemeCache::recordBitmap(const Common::String &filename, const Common::String &scalablefile, int width, int height) {
+	startCall(kCallBitmap);
+	writeCacheString(_calls, filename);
+	writeCacheString(_calls, scalablefile);
+	_calls.writeSint32BE(width);
+	_calls.writeSint32BE(height);
+
+	_bitmapNames.push_back(filename);
+}
+
+void ThemeCache::recordCursor(const Common::String &filename, int hotspotX, int hotspotY) {
+	startCall(kCallCursor);
+	writeCacheString(_calls, filename);
+	_calls.writeSint32BE(hotspotX);
+	_calls.writeSint32BE(hotspotY);
+}
+
+void ThemeCache::recordVar(const Common::String &name, int val) {
+	startCall(kCallVar);
+	writeCacheString(_calls, name);
+	_calls.writeSint32BE(val);
+}
+
+void ThemeCache::recordDialog(const Common::String &name, const Common::String &overlays, int16 maxWidth, int16 maxHeight, int inset) {
+	startCall(kCallDialog);
+	writeCacheString(_calls, name);
+	writeCacheString(_calls, overlays);
+	_calls.writeSint16BE(maxWidth);
+	_calls.writeSint16BE(maxHeight);
+	_calls.writeSint32BE(inset);
+}
+
+void ThemeCache::recordLayout(ThemeLayout::LayoutType type, int spacing, ThemeLayout::ItemAlign itemAlign) {
+	startCall(kCallLayout);
+	_calls.writeSint32BE(type);
+	_calls.writeSint32BE(spacing);
+	_calls.writeSint32BE(itemAlign);
+}
+
+void ThemeCache::recordWidget(const Common::String &name, const Common::String &type, int w, int h, Graphics::TextAlign align, bool useRTL) {
+	startCall(kCallWidget);
+	writeCacheString(_calls, name);
+	writeCacheString(_calls, type);
+	_calls.writeSint32BE(w);
+	_calls.writeSint32BE(h);
+	_calls.writeSint32BE(align);
+	_calls.writeByte(useRTL);
+}
+
+void ThemeCache::recordImportedLayout(const Common::String &name) {
+	startCall(kCallImportedLayout);
+	writeCacheString(_calls, name);
+}
+
+void ThemeCache::recordSpace(int size) {
+	startCall(kCallSpace);
+	_calls.writeSint32BE(size);
+}
+
+void ThemeCache::recordPadding(int16 l, int16 r, int16 t, int16 b) {
+	startCall(kCallPadding);
+	_calls.writeSint16BE(l);
+	_calls.writeSint16BE(r);
+	_calls.writeSint16BE(t);
+	_calls.writeSint16BE(b);
+}
+
+void ThemeCache::recordCloseLayout() {
+	startCall(kCallCloseLayout);
+}
+
+void ThemeCache::recordCloseDialog() {
+	startCall(kCallCloseDialog);
+}
+
+/**********************************************************
+ * Serialization
+ *********************************************************/
+static void writeColor(Common::WriteStream &stream, const Graphics::DrawStep::Color &color) {
+	stream.writeByte(color.r);
+	stream.writeByte(color.g);
+	stream.writeByte(color.b);
+	stream.writeByte(color.set);
+}
+
+static void writeRect(Common::WriteStream &stream, const Common::Rect &r) {
+	stream.writeSint16BE(r.left);
+	stream.writeSint16BE(r.top);
+	stream.writeSint16BE(r.right);
+	stream.writeSint16BE(r.bottom);
+}
+
+void ThemeCache::writeDrawStep(Common::WriteStream &stream, const Graphics::DrawStep &step, const Common::String &function, const Common::String &bitmap) {
+	// The drawing function and the bitmap are stored by name, since the
+	// pointers differ between runs
+	writeCacheString(stream, function);
+	writeCacheString(stream, bitmap);
+	stream.writeByte(step.alphaType);
+
+	writeColor(stream, step.fgColor);
+	writeColor(stream, step.bgColor);
+	writeColor(stream, step.gradColor1);
+	writeColor(stream, step.gradColor2);
+	writeColor(stream, step.bevelColor);
+
+	stream.writeByte(step.autoWidth);
+	stream.writeByte(step.autoHeight);
+	stream.writeSint16BE(step.x);
+	stream.writeSint16BE(step.y);
+	stream.writeSint16BE(step.w);
+	stream.writeSint16BE(step.h);
+	writeRect(stream, step.padding);
+	writeRect(stream, step.clip);
+	stream.writeByte(step.xAlign);
+	stream.writeByte(step.yAlign);
+
+	stream.writeByte(step.shadow);
+	stream.writeByte(step.stroke);
+	stream.writeByte(step.factor);
+	stream.writeByte(step.radius);
+	stream.writeByte(step.bevel);
+	stream.writeByte(step.fillMode);
+	stream.writeByte(step.shadowFillMode);
+	stream.writeUint32BE(step.extraData);
+	stream.writeUint32BE(step.scale);
+	stream.writeUint32BE(step.shadowIntensity);
+	stream.writeByte(step.autoscale);
+}
+
+void ThemeCache::writeSurface(Common::WriteStream &stream, const Graphics::ManagedSurface *surface) {
+	// Paletted bitmaps are not kept by the theme engine, and empty ones are
+	// not worth caching. Both are loaded again by replaying the call.
+	if (!surface || !surface->getPixels() || surface->format.bytesPerPixel == 1) {
+		stream.writeByte(0);
+		return;
+	}
+
+	const Graphics::PixelFormat &format = surface->format;
+	stream.writeByte(1);
+	stream.writeUint16BE(surface->w);
+	stream.writeUint16BE(surface->h);
+	stream.writeByte(format.bytesPerPixel);
+	stream.writeByte(format.rLoss);
+	stream.writeByte(format.gLoss);
+	stream.writeByte(format.bLoss);
+	stream.writeByte(format.aLoss);
+	stream.writeByte(format.rShift);
+	stream.writeByte(format.gShift);
+	stream.writeByte(format.bShift);
+	stream.writeByte(format.aShift);
+	stream.writeByte(surface->hasTransparentColor());
+	stream.writeUint32BE(surface->getTransparentColor());
+
+	// The pixels are stored in native byte order, the cache is only read
+	// back on the system which wrote it
+	for (int y = 0; y < surface->h; ++y)
+		stream.write(surface->getBasePtr(0, y), surface->w * format.bytesPerPixel);
+}
+
+Graphics::ManagedSurface *ThemeCache::readSurface(Common::SeekableReadStream &stream) {
+	if (!stream.readByte())
+		return nullptr;
+
+	const uint16 w = stream.readUint16BE();
+	const uint16 h = stream.readUint16BE();
+	Graphics::PixelFormat format;
+	format.bytesPerPixel = stream.readByte();
+	format.rLoss = stream.readByte();
+	format.gLoss = stream.readByte();
+	format.bLoss = stream.readByte();
+	format.aLoss = stream.readByte();
+	format.rShift = stream.readByte();
+	format.gShift = stream.readByte();
+	format.bShift = stream.readByte();
+	format.aShift = stream.readByte();
+	const bool hasTransparentColor = stream.readByte() != 0;
+	const uint32 transparentColor = stream.readUint32BE();
+
+	if (stream.err() || format.bytesPerPixel < 2 || format.bytesPerPixel > 4 ||
+	    stream.size() - stream.pos() < (int64)w * h * format.bytesPerPixel)
+		return nullptr;
+
+	Graphics::ManagedSurface *surface = new Graphics::ManagedSurface(w, h, format);
+	for (int y = 0; y < h; ++y)
+		stream.read(surface->getBasePtr(0, y), w * format.bytesPerPixel);
+
+	if (hasTransparentColor)
+		surface->setTransparentColor(transparentColor);
+
+	return surface;
+}
+
+bool ThemeCache::save(Common::WriteStream &stream, const Common::String &key, const ThemeEngine::ImagesMap &bitmaps) {
+	stream.writeUint32BE(kThemeCacheTag);
+	stream.writeUint32BE(kThemeCacheVersion);
+	writeCacheString(stream, key);
+
+	stream.writeUint32BE(_bitmapNames.size());
+	for (uint i = 0; i < _bitmapNames.size(); ++i) {
+		writeCacheString(stream, _bitmapNames[i]);
+		writeSurface(stream, bitmaps.getValOrDefault(_bitmapNames[i], nullptr));
+	}
+
+	stream.writeUint32BE(_callCount);
+	stream.writeUint32BE(_calls.size());
+	stream.write(_calls.getData(), _calls.size());
+
+	return !stream.err();
+}
+
+bool ThemeCache::load(Common::SeekableReadStream &stream, const Common::String &key) {
+	// Only an empty cache can be loaded
+	if (_callCount || !_bitmaps.empty())
+		return false;
+
+	// Nothing is kept from a cache which could not be loaded entirely
+	if (!loadData(stream, key)) {
+		clearBitmaps();
+		return false;
+	}
+	return true;
+}
+
+bool ThemeCache::loadData(Common::SeekableReadStream &stream, const Common::String &key) {
+	if (stream.readUint32BE() != kThemeCacheTag || stream.readUint32BE() != kThemeCacheVersion)
+		return false;
+
+	if (stream.readString() != key)
+		return false;
+
+	const uint32 bitmapCount = stream.readUint32BE();
+	for (uint32 i = 0; i < bitmapCount && !stream.err() && !stream.eos(); ++i) {
+		Bitmap bitmap;
+		bitmap.filename = stream.readString();
+		bitmap.surface = readSurface(stream);
+		_bitmaps.push_back(bitmap);
+	}
+
+	const uint32 callCount = stream.readUint32BE();
+	const uint32 size = stream.readUint32BE();
+	if (stream.err() || stream.eos() || _bitmaps.size() != bitmapCount || stream.size() - stream.pos() != size)
+		return false;
+
+	// The calls are only added once all of them were read
+	if (size) {
+		byte *calls = (byte *)malloc(size);
+		if (!calls)
+			return false;
+		if (stream.read(calls, size) != size || stream.err()) {
+			free(calls);
+			return false;
+		}
+		_calls.write(calls, size);
+		free(calls);
+	}
+	_callCount = callCount;
+
+	return true;
+}
+
+} // End of namespace GUI
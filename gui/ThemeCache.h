@@ -0,0 +1,150 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GUI_THEME_CACHE_H
+#define GUI_THEME_CACHE_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "gui/ThemeEngine.h"
+#include "gui/ThemeLayout.h"
+
+namespace GUI {
+
+/**
+ * A binary copy of a parsed theme.
+ *
+ * While a theme is parsed, the calls the parser makes to the ThemeEngine
+ * and to its ThemeEval are recorded, with the values already evaluated for
+ * the current resolution and scale factor. The cache stores them together
+ * with the scaled bitmaps of the theme, and replaying them loads the theme
+ * again without parsing any XML or decoding any image.
+ *
+ * The cache is only valid for the key it was saved with, which the
+ * ThemeEngine builds from everything the parser depends on.
+ */
+class ThemeCache {
+public:
+	ThemeCache();
+	~ThemeCache();
+
+	/**
+	 * Recording interface for the ThemeEngine and the ThemeEval, called with
+	 * the same parameters as their own functions. Draw steps are recorded
+	 * with the names of their drawing function and of their bitmap.
+	 */
+	void recordDrawData(const Common::String &data, bool cached);
+	void recordDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step, const Common::String &function, const Common::String &bitmap);
+	void recordTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, ThemeEngine::TextAlignVertical alignV);
+	void recordFont(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void recordFontNames(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, int pointsize);
+	void recordTextColor(TextColor colorId, int r, int g, int b);
+	void recordBitmap(const Common::String &filename, const Common::String &scalablefile, int width, int height);
+	void recordCursor(const Common::String &filename, int hotspotX, int hotspotY);
+
+	void recordVar(const Common::String &name, int val);
+	void recordDialog(const Common::String &name, const Common::String &overlays, int16 maxWidth, int16 maxHeight, int inset);
+	void recordLayout(ThemeLayout::LayoutType type, int spacing, ThemeLayout::ItemAlign itemAlign);
+	void recordWidget(const Common::String &name, const Common::String &type, int w, int h, Graphics::TextAlign align, bool useRTL);
+	void recordImportedLayout(const Common::String &name);
+	void recordSpace(int size);
+	void recordPadding(int16 l, int16 r, int16 t, int16 b);
+	void recordCloseLayout();
+	void recordCloseDialog();
+
+	/** Get the number of calls recorded or loaded. */
+	uint32 getCallCount() const { return _callCount; }
+
+	/**
+	 * Write the recorded calls and the bitmaps they load to a stream.
+	 *
+	 * @param stream  Stream to write the cache to.
+	 * @param key     Key the cache is valid for.
+	 * @param bitmaps Bitmaps loaded by the theme engine.
+	 */
+	bool save(Common::WriteStream &stream, const Common::String &key, const ThemeEngine::ImagesMap &bitmaps);
+
+	/**
+	 * Read a cache written by save() into an empty cache. This fails if the
+	 * cache was written with a different key, or by a different version of
+	 * this class, in which case the cache is left empty.
+	 */
+	bool load(Common::SeekableReadStream &stream, const Common::String &key);
+
+	/**
+	 * Replay the loaded calls on a theme engine, whose current theme must
+	 * be unloaded. The bitmaps it has not loaded yet are handed over to it.
+	 *
+	 * @return false if one of the calls failed, in which case the theme
+	 *         is left partially loaded.
+	 */
+	bool replay(ThemeEngine &theme);
+
+private:
+	enum Call {
+		kCallDrawData = 1,
+		kCallDrawStep,
+		kCallTextData,
+		kCallFont,
+		kCallFontNames,
+		kCallTextColor,
+		kCallBitmap,
+		kCallCursor,
+		kCallVar,
+		kCallDialog,
+		kCallLayout,
+		kCallWidget,
+		kCallImportedLayout,
+		kCallSpace,
+		kCallPadding,
+		kCallCloseLayout,
+		kCallCloseDialog
+	};
+
+	struct Bitmap {
+		Common::String filename;
+		Graphics::ManagedSurface *surface;
+	};
+
+	void startCall(Call call);
+	void clearBitmaps();
+	bool loadData(Common::SeekableReadStream &stream, const Common::String &key);
+
+	static void writeSurface(Common::WriteStream &stream, const Graphics::ManagedSurface *surface);
+	static Graphics::ManagedSurface *readSurface(Common::SeekableReadStream &stream);
+	static void writeDrawStep(Common::WriteStream &stream, const Graphics::DrawStep &step, const Common::String &function, const Common::String &bitmap);
+	static bool readDrawStep(Common::SeekableReadStream &stream, Graphics::DrawStep &step, Common::String &bitmap);
+
+	Common::MemoryWriteStreamDynamic _calls;
+	uint32 _callCount;
+
+	// The bitmaps loaded by the recorded calls, in order
+	Common::Array<Common::String> _bitmapNames;
+	// The bitmaps read from a cache
+	Common::Array<Bitmap> _bitmaps;
+};
+
+} // End of namespace GUI
+
+#endif
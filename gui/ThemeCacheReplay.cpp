@@ -0,0 +1,232 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "gui/ThemeCache.h"
+#include "gui/ThemeEval.h"
+#include "gui/ThemeParser.h"
+
+#include "graphics/VectorRenderer.h"
+
+#include "common/memstream.h"
+
+namespace GUI {
+
+// Replaying the calls is kept apart from recording and storing them, which
+// do not depend on the rest of the GUI
+
+static void readColor(Common::SeekableReadStream &stream, Graphics::DrawStep::Color &color) {
+	color.r = stream.readByte();
+	color.g = stream.readByte();
+	color.b = stream.readByte();
+	color.set = stream.readByte() != 0;
+}
+
+static void readRect(Common::SeekableReadStream &stream, Common::Rect &r) {
+	r.left = stream.readSint16BE();
+	r.top = stream.readSint16BE();
+	r.right = stream.readSint16BE();
+	r.bottom = stream.readSint16BE();
+}
+
+bool ThemeCache::readDrawStep(Common::SeekableReadStream &stream, Graphics::DrawStep &step, Common::String &bitmap) {
+	step.drawingCall = ThemeParser::getDrawingFunctionCallback(stream.readString());
+	bitmap = stream.readString();
+	step.alphaType = (Graphics::AlphaType)stream.readByte();
+
+	readColor(stream, step.fgColor);
+	readColor(stream, step.bgColor);
+	readColor(stream, step.gradColor1);
+	readColor(stream, step.gradColor2);
+	readColor(stream, step.bevelColor);
+
+	step.autoWidth = stream.readByte() != 0;
+	step.autoHeight = stream.readByte() != 0;
+	step.x = stream.readSint16BE();
+	step.y = stream.readSint16BE();
+	step.w = stream.readSint16BE();
+	step.h = stream.readSint16BE();
+	readRect(stream, step.padding);
+	readRect(stream, step.clip);
+	step.xAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+	step.yAlign = (Graphics::DrawStep::VectorAlignment)stream.readByte();
+
+	step.shadow = stream.readByte();
+	step.stroke = stream.readByte();
+	step.factor = stream.readByte();
+	step.radius = stream.readByte();
+	step.bevel = stream.readByte();
+	step.fillMode = stream.readByte();
+	step.shadowFillMode = stream.readByte();
+	step.extraData = stream.readUint32BE();
+	step.scale = stream.readUint32BE();
+	step.shadowIntensity = stream.readUint32BE();
+	step.autoscale = (ThemeEngine::AutoScaleMode)stream.readByte();
+
+	return step.drawingCall != nullptr && !stream.err();
+}
+
+/**********************************************************
+ * Replaying
+ *********************************************************/
+bool ThemeCache::replay(ThemeEngine &theme) {
+	// Hand the bitmaps over first, so that loading them is skipped
+	for (uint i = 0; i < _bitmaps.size(); ++i) {
+		if (_bitmaps[i].surface && !theme._bitmaps.contains(_bitmaps[i].filename)) {
+			theme._bitmaps[_bitmaps[i].filename] = _bitmaps[i].surface;
+			_bitmaps[i].surface = nullptr;
+		}
+	}
+	clearBitmaps();
+
+	ThemeEval *eval = theme.getEvaluator();
+	Common::MemoryReadStream stream(_calls.getData(), _calls.size());
+	for (uint32 i = 0; i < _callCount; ++i) {
+		bool result = true;
+		const Call call = (Call)stream.readByte();
+
+		switch (call) {
+		case kCallDrawData: {
+			const Common::String data = stream.readString();
+			result = theme.addDrawData(data, stream.readByte() != 0);
+			break;
+		}
+		case kCallDrawStep: {
+			const Common::String drawDataId = stream.readString();
+			Graphics::DrawStep step;
+			Common::String bitmap;
+			result = readDrawStep(stream, step, bitmap);
+			if (result && !bitmap.empty()) {
+				step.blitSrc = theme.getImageSurface(bitmap);
+				result = step.blitSrc != nullptr;
+			}
+			if (result)
+				theme.addDrawStep(drawDataId, step);
+			break;
+		}
+		case kCallTextData: {
+			const Common::String drawDataId = stream.readString();
+			const TextData textId = (TextData)stream.readSint32BE();
+			const TextColor colorId = (TextColor)stream.readSint32BE();
+			const Graphics::TextAlign alignH = (Graphics::TextAlign)stream.readSint32BE();
+			const ThemeEngine::TextAlignVertical alignV = (ThemeEngine::TextAlignVertical)stream.readSint32BE();
+			result = theme.addTextData(drawDataId, textId, colorId, alignH, alignV);
+			break;
+		}
+		case kCallFont:
+		case kCallFontNames: {
+			const TextData textId = (TextData)stream.readSint32BE();
+			const Common::String language = stream.readString();
+			const Common::String file = stream.readString();
+			const Common::String scalableFile = stream.readString();
+			const int pointsize = stream.readSint32BE();
+			if (call == kCallFont)
+				result = theme.addFont(textId, language, file, scalableFile, pointsize);
+			else
+				theme.storeFontNames(textId, language, file, scalableFile, pointsize);
+			break;
+		}
+		case kCallTextColor: {
+			const TextColor colorId = (TextColor)stream.readSint32BE();
+			const int r = stream.readSint32BE();
+			const int g = stream.readSint32BE();
+			const int b = stream.readSint32BE();
+			result = theme.addTextColor(colorId, r, g, b);
+			break;
+		}
+		case kCallBitmap: {
+			const Common::String filename = stream.readString();
+			const Common::String scalablefile = stream.readString();
+			const int width = stream.readSint32BE();
+			const int height = stream.readSint32BE();
+			result = theme.addBitmap(filename, scalablefile, width, height);
+			break;
+		}
+		case kCallCursor: {
+			const Common::String filename = stream.readString();
+			const int hotspotX = stream.readSint32BE();
+			const int hotspotY = stream.readSint32BE();
+			result = theme.createCursor(filename, hotspotX, hotspotY);
+			break;
+		}
+		case kCallVar: {
+			const Common::String name = stream.readString();
+			eval->setVar(name, stream.readSint32BE());
+			break;
+		}
+		case kCallDialog: {
+			const Common::String name = stream.readString();
+			const Common::String overlays = stream.readString();
+			const int16 maxWidth = stream.readSint16BE();
+			const int16 maxHeight = stream.readSint16BE();
+			eval->addDialog(name, overlays, maxWidth, maxHeight, stream.readSint32BE());
+			break;
+		}
+		case kCallLayout: {
+			const ThemeLayout::LayoutType type = (ThemeLayout::LayoutType)stream.readSint32BE();
+			const int spacing = stream.readSint32BE();
+			eval->addLayout(type, spacing, (ThemeLayout::ItemAlign)stream.readSint32BE());
+			break;
+		}
+		case kCallWidget: {
+			const Common::String name = stream.readString();
+			const Common::String type = stream.readString();
+			const int w = stream.readSint32BE();
+			const int h = stream.readSint32BE();
+			const Graphics::TextAlign align = (Graphics::TextAlign)stream.readSint32BE();
+			eval->addWidget(name, type, w, h, align, stream.readByte() != 0);
+			break;
+		}
+		case kCallImportedLayout: {
+			const Common::String name = stream.readString();
+			result = eval->hasDialog(name);
+			if (result)
+				eval->addImportedLayout(name);
+			break;
+		}
+		case kCallSpace:
+			eval->addSpace(stream.readSint32BE());
+			break;
+		case kCallPadding: {
+			const int16 l = stream.readSint16BE();
+			const int16 r = stream.readSint16BE();
+			const int16 t = stream.readSint16BE();
+			eval->addPadding(l, r, t, stream.readSint16BE());
+			break;
+		}
+		case kCallCloseLayout:
+			eval->closeLayout();
+			break;
+		case kCallCloseDialog:
+			eval->closeDialog();
+			break;
+		default:
+			result = false;
+			break;
+		}
+
+		if (!result || stream.err() || stream.eos())
+			return false;
+	}
+
+	return true;
+}
+
+} // End of namespace GUI
@@ -19,8 +19,11 @@
  *
  */
 
+#include "base/version.h"
+
 #include "common/system.h"
 #include "common/config-manager.h"
+#include "common/crc.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/compression/unzip.h"
@@ -41,6 +44,7 @@
 #include "image/png.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -106,6 +110,13 @@ struct DrawDataInfo {
 	DrawData parent;    ///< Parent DrawData item, for items that overlay. E.g. kDDButtonIdle -> kDDButtonHover
 };
 
+/**
+ * Number of bytes of decompressed theme files kept in memory. This is
+ * enough for the whole of the bundled themes, so that the files read
+ * again when the theme is reloaded are not decompressed again.
+ */
+static const uint32 kThemeArchiveCacheSize = 1024 * 1024;
+
 /**
  * Default values for each DrawData item.
  */
@@ -198,6 +209,7 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_parser = new ThemeParser(this);
 	_themeEval = new GUI::ThemeEval();
 	_themeEval->setScaleFactor(_scaleFactor);
+	_themeCache = nullptr;
 
 	_useCursor = false;
 
@@ -258,6 +270,7 @@ ThemeEngine::~ThemeEngine() {
 
 	delete _parser;
 	delete _themeEval;
+	delete _themeCache;
 	delete[] _cursor;
 }
 
@@ -346,20 +359,27 @@ bool ThemeEngine::init() {
 			// Look for the zip file via SearchMan
 			Common::ArchiveMemberPtr member = SearchMan.getMember(_themeFile);
 			if (member) {
-				_themeArchive = Common::makeZipArchive(member->createReadStream());
+				_themeArchive = Common::makeZipArchive(member->createReadStream(), false, kThemeArchiveCacheSize);
 				if (!_themeArchive) {
 					warning("Failed to open Zip archive '%s'.", member->getName().c_str());
 				}
 			} else {
-				_themeArchive = Common::makeZipArchive(node);
+				_themeArchive = Common::makeZipArchive(node, false, kThemeArchiveCacheSize);
 				if (!_themeArchive) {
 					warning("Failed to open Zip archive '%s'.", node.getPath().toString(Common::Path::kNativeSeparator).c_str());
 				}
 			}
 		}
 
-		if (_themeArchive)
+		if (_themeArchive) {
+			// Most of the theme is read while loading it, so decompress
+			// it all at once on several threads
+			Common::ArchiveMemberList members;
+			_themeArchive->listMembers(members);
+			_themeArchive->prefetchMembers(members);
+
 			_themeFiles.add("theme_archive", _themeArchive, 1, true);
+		}
 	}
 
 	// Load the theme
@@ -504,6 +524,15 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
  * Theme elements management
  *********************************************************/
 void ThemeEngine::addDrawStep(const Common::String &drawDataId, const Graphics::DrawStep &step) {
+	if (_themeCache) {
+		Common::String bitmap;
+		for (ImagesMap::const_iterator i = _bitmaps.begin(); step.blitSrc && i != _bitmaps.end(); ++i) {
+			if (i->_value == step.blitSrc)
+				bitmap = i->_key;
+		}
+		_themeCache->recordDrawStep(drawDataId, step, ThemeParser::getDrawingFunctionName(step.drawingCall), bitmap);
+	}
+
 	DrawData id = parseDrawDataId(drawDataId);
 
 	assert(id != kDDNone && _widgets[id] != nullptr);
@@ -511,6 +540,9 @@ void ThemeEngine::addDrawStep(const Common::String &drawDataId, const Graphics::
 }
 
 bool ThemeEngine::addTextData(const Common::String &drawDataId, TextData textId, TextColor colorId, Graphics::TextAlign alignH, TextAlignVertical alignV) {
+	if (_themeCache)
+		_themeCache->recordTextData(drawDataId, textId, colorId, alignH, alignV);
+
 	DrawData id = parseDrawDataId(drawDataId);
 
 	if (id == -1 || textId == -1 || colorId == kTextColorMAX || !_widgets[id])
@@ -525,6 +557,9 @@ bool ThemeEngine::addTextData(const Common::String &drawDataId, TextData textId,
 }
 
 bool ThemeEngine::addFont(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, const int pointsize) {
+	if (_themeCache)
+		_themeCache->recordFont(textId, language, file, scalableFile, pointsize);
+
 	if (textId == -1)
 		return false;
 
@@ -604,6 +639,9 @@ Common::Array<Common::Language> getLangIdentifiers(const Common::String &languag
 }
 
 void ThemeEngine::storeFontNames(TextData textId, const Common::String &language, const Common::String &file, const Common::String &scalableFile, const int pointsize) {
+	if (_themeCache)
+		_themeCache->recordFontNames(textId, language, file, scalableFile, pointsize);
+
 	if (language.empty())
 		return;
 
@@ -630,6 +668,9 @@ bool ThemeEngine::loadExtraFont(FontStyle style, Common::Language lang) {
 }
 
 bool ThemeEngine::addTextColor(TextColor colorId, int r, int g, int b) {
+	if (_themeCache)
+		_themeCache->recordTextColor(colorId, r, g, b);
+
 	if (colorId >= kTextColorMAX)
 		return false;
 
@@ -646,6 +687,9 @@ bool ThemeEngine::addTextColor(TextColor colorId, int r, int g, int b) {
 }
 
 bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String &scalablefile, int width, int height) {
+	if (_themeCache)
+		_themeCache->recordBitmap(filename, scalablefile, width, height);
+
 	// Nothing has to be done if the bitmap already has been loaded.
 	Graphics::ManagedSurface *surf = _bitmaps[filename];
 	if (surf) {
@@ -738,6 +782,9 @@ bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String
 }
 
 bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
+	if (_themeCache)
+		_themeCache->recordDrawData(data, cached);
+
 	DrawData id = parseDrawDataId(data);
 
 	if (id == -1)
@@ -816,6 +863,112 @@ void ThemeEngine::unloadExtraFont() {
 	_texts[kTextDataExtraLang] = nullptr;
 }
 
+static uint32 getStreamCRC(Common::ReadStream &stream) {
+	Common::CRC32 crc;
+	uint32 remainder = crc.getInitRemainder();
+
+	byte buffer[4096];
+	uint32 len;
+	while ((len = stream.read(buffer, sizeof(buffer))) > 0) {
+		for (uint32 i = 0; i < len; ++i)
+			remainder = crc.processByte(buffer[i], remainder);
+	}
+
+	return crc.finalize(remainder);
+}
+
+static Common::Path getThemeCachePath(const Common::String &themeId) {
+	// The cache lives next to the downloaded icons, with one file per theme
+	// which is overwritten whenever the theme or the screen changes. Only
+	// some backends have an icons path, the others use the save path.
+	Common::Path dir = ConfMan.getPath("iconspath");
+	if (dir.empty())
+		dir = ConfMan.getPath("savepath");
+	if (dir.empty()) {
+		debug(6, "Theme cache disabled, there is no icons or save path");
+		return Common::Path();
+	}
+
+	Common::String filename = "theme-";
+	for (uint i = 0; i < themeId.size(); ++i)
+		filename += Common::isAlnum(themeId[i]) ? themeId[i] : '_';
+	filename += ".cache";
+
+	return dir.join(filename);
+}
+
+Common::String ThemeEngine::getThemeCacheKey(const Common::String &themeId, const Common::String &stamp) const {
+	if (!ConfMan.getBool("gui_theme_cache") || getThemeCachePath(themeId).empty())
+		return Common::String();
+
+	// The parser evaluates the theme for the base resolution and the scale
+	// factor, and the bitmaps are converted to the overlay format
+	return Common::String::format("%s|%s|%s|%dx%d|%f|%s", gScummVMFullVersion, themeId.c_str(), stamp.c_str(),
+	                              _baseWidth, _baseHeight, _scaleFactor, _overlayFormat.toString().c_str());
+}
+
+bool ThemeEngine::loadThemeCache(const Common::String &themeId, const Common::String &key) {
+	if (key.empty())
+		return false;
+
+	const Common::FSNode node(getThemeCachePath(themeId));
+	Common::SeekableReadStream *file = node.exists() ? node.createReadStream() : nullptr;
+	if (!file)
+		return false;
+
+	// A cache written for another key is overwritten once the theme is parsed
+	ThemeCache cache;
+	bool result = cache.load(*file, key);
+	delete file;
+
+	if (result) {
+		result = cache.replay(*this);
+		if (!result) {
+			// Throw away whatever was loaded, the theme is parsed instead
+			warning("Invalid cached copy of the theme, parsing it again");
+			_themeOk = true;
+			unloadTheme();
+		}
+	}
+
+	debug(6, "Theme cache %s: %s", node.getPath().toString(Common::Path::kNativeSeparator).c_str(), result ? "loaded" : "not loaded");
+	return result;
+}
+
+void ThemeEngine::startThemeCache(const Common::String &key) {
+	delete _themeCache;
+	_themeCache = nullptr;
+
+	if (key.empty())
+		return;
+
+	_themeCache = new ThemeCache();
+	_themeEval->setCache(_themeCache);
+}
+
+void ThemeEngine::finishThemeCache(const Common::String &themeId, const Common::String &key, bool parsed) {
+	if (!_themeCache)
+		return;
+
+	ThemeCache *cache = _themeCache;
+	_themeCache = nullptr;
+	_themeEval->setCache(nullptr);
+
+	if (parsed) {
+		const Common::FSNode node(getThemeCachePath(themeId));
+		Common::SeekableWriteStream *file = node.createWriteStream();
+		if (file) {
+			cache->save(*file, key, _bitmaps);
+			file->finalize();
+			if (file->err())
+				warning("Couldn't write the cached copy of the theme");
+			delete file;
+		}
+	}
+
+	delete cache;
+}
+
 bool ThemeEngine::loadDefaultXML() {
 
 	// The default XML theme is included on runtime from a pregenerated
@@ -826,8 +979,22 @@ bool ThemeEngine::loadDefaultXML() {
 #include "themes/default.inc"
 	int xmllen = 0;
 
-	for (int i = 0; i < ARRAYSIZE(defaultXML); i++)
-		xmllen += strlen(defaultXML[i]);
+	// The builtin theme changes between development builds of the same
+	// version, so its cached copy is stamped with a checksum of it
+	Common::CRC32 crc;
+	uint32 remainder = crc.getInitRemainder();
+	for (int i = 0; i < ARRAYSIZE(defaultXML); i++) {
+		for (const char *c = defaultXML[i]; *c; c++, xmllen++)
+			remainder = crc.processByte((byte)*c, remainder);
+	}
+
+	const Common::String cacheKey = getThemeCacheKey("builtin", Common::String::format("%d:%08x", xmllen, crc.finalize(remainder)));
+	if (loadThemeCache("builtin", cacheKey)) {
+		_themeName = "ScummVM Classic Theme (Builtin Version)";
+		_themeId = "builtin";
+		_themeFile.clear();
+		return true;
+	}
 
 	byte *tmpXML = (byte *)malloc(xmllen + 1);
 	tmpXML[0] = '\0';
@@ -845,8 +1012,10 @@ bool ThemeEngine::loadDefaultXML() {
 	_themeId = "builtin";
 	_themeFile.clear();
 
+	startThemeCache(cacheKey);
 	bool result = _parser->parse();
 	_parser->close();
+	finishThemeCache("builtin", cacheKey, result);
 
 	free(tmpXML);
 
@@ -886,26 +1055,44 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		return false;
 	}
 
+	//
+	// Use the cached copy of the theme, unless the STX files changed
+	//
+	Common::String stamp = stxHeader;
+	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		stamp += Common::String::format("|%s:%08x", (*i)->getName().c_str(), stream ? getStreamCRC(*stream) : 0);
+		delete stream;
+	}
+
+	const Common::String cacheKey = getThemeCacheKey(themeId, stamp);
+	if (loadThemeCache(themeId, cacheKey))
+		return true;
+
 	//
 	// Loop over all STX files, load and parse them
 	//
+	startThemeCache(cacheKey);
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
 		if (_parser->loadStream((*i)->createReadStream()) == false) {
 			warning("Failed to load STX file '%s'", (*i)->getName().c_str());
 			_parser->close();
+			finishThemeCache(themeId, cacheKey, false);
 			return false;
 		}
 
 		if (_parser->parse() == false) {
 			warning("Failed to parse STX file '%s'", (*i)->getName().c_str());
 			_parser->close();
+			finishThemeCache(themeId, cacheKey, false);
 			return false;
 		}
 
 		_parser->close();
 	}
+	finishThemeCache(themeId, cacheKey, true);
 
 	assert(!_themeName.empty());
 	return true;
@@ -1580,6 +1767,9 @@ void ThemeEngine::applyScreenShading(ShadingStyle style) {
 }
 
 bool ThemeEngine::createCursor(const Common::String &filename, int hotspotX, int hotspotY) {
+	if (_themeCache)
+		_themeCache->recordCursor(filename, hotspotX, hotspotY);
+
 	// Try to locate the specified file among all loaded bitmaps
 	const Graphics::ManagedSurface *cursor = _bitmaps[filename];
 	if (!cursor)
@@ -51,6 +51,7 @@ struct WidgetDrawData;
 struct TextDrawData;
 class Dialog;
 class GuiObject;
+class ThemeCache;
 class ThemeEval;
 class ThemeParser;
 
@@ -212,6 +213,7 @@ protected:
 
 	friend class GUI::Dialog;
 	friend class GUI::GuiObject;
+	friend class GUI::ThemeCache;
 
 public:
 	/// Vertical alignment of the text.
@@ -688,6 +690,34 @@ protected:
 	 */
 	void unloadTheme();
 
+	/**
+	 * Get the key of the cached copy of a theme, which covers everything
+	 * the theme parser depends on.
+	 *
+	 * @param themeId Theme identifier.
+	 * @param stamp Checksums of the theme files.
+	 * @returns the key, or an empty string if themes are not cached.
+	 */
+	Common::String getThemeCacheKey(const Common::String &themeId, const Common::String &stamp) const;
+
+	/**
+	 * Loads the theme from its cached copy, instead of parsing it.
+	 *
+	 * @param themeId Theme identifier.
+	 * @param key Key of the cached copy, see getThemeCacheKey().
+	 * @returns true if the theme was successfully loaded.
+	 */
+	bool loadThemeCache(const Common::String &themeId, const Common::String &key);
+
+	/** Starts recording the theme while it is parsed. */
+	void startThemeCache(const Common::String &key);
+
+	/**
+	 * Stops recording the theme, and saves its cached copy if it was
+	 * parsed successfully. This replaces the copy saved for another key.
+	 */
+	void finishThemeCache(const Common::String &themeId, const Common::String &key, bool parsed);
+
 	/**
 	 * Unload the language specific font loaded via loadExtraFont()
 	*/
@@ -756,6 +786,9 @@ protected:
 	/** Theme getEvaluator (changed from GUI::Eval to add functionality) */
 	GUI::ThemeEval *_themeEval;
 
+	/** Records the theme while it is parsed, so that it can be cached */
+	GUI::ThemeCache *_themeCache;
+
 	/** Main screen surface. This is blitted straight into the overlay. */
 	Graphics::ManagedSurface _screen;
 
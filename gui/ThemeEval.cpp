@@ -19,6 +19,7 @@
  *
  */
 
+#include "gui/ThemeCache.h"
 #include "gui/ThemeEval.h"
 
 #include "graphics/scaler.h"
@@ -38,6 +39,13 @@ void ThemeEval::buildBuiltinVars() {
 	_builtin["kThumbnailHeight2"] = kThumbnailHeight2;
 }
 
+void ThemeEval::setVar(const Common::String &name, int val) {
+	if (_cache)
+		_cache->recordVar(name, val);
+
+	_vars[name] = val;
+}
+
 void ThemeEval::reset() {
 	_vars.clear();
 	_curDialog.clear();
@@ -86,6 +94,9 @@ Graphics::TextAlign ThemeEval::getWidgetTextHAlign(const Common::String &widget)
 }
 
 ThemeEval &ThemeEval::addWidget(const Common::String &name, const Common::String &type, int w, int h, Graphics::TextAlign align, bool useRTL) {
+	if (_cache)
+		_cache->recordWidget(name, type, w, h, align, useRTL);
+
 	int typeW = -1;
 	int typeH = -1;
 	Graphics::TextAlign typeAlign = Graphics::kTextAlignInvalid;
@@ -122,6 +133,9 @@ ThemeEval &ThemeEval::addWidget(const Common::String &name, const Common::String
 }
 
 ThemeEval &ThemeEval::addDialog(const Common::String &name, const Common::String &overlays, int16 width, int16 height, int inset) {
+	if (_cache)
+		_cache->recordDialog(name, overlays, width, height, inset);
+
 	Common::String var = "Dialog." + name;
 
 	ThemeLayout *layout = new ThemeLayoutMain(name, overlays, width, height, inset);
@@ -145,6 +159,9 @@ ThemeEval &ThemeEval::addDialog(const Common::String &name, const Common::String
 }
 
 ThemeEval &ThemeEval::addLayout(ThemeLayout::LayoutType type, int spacing, ThemeLayout::ItemAlign itemAlign) {
+	if (_cache)
+		_cache->recordLayout(type, spacing, itemAlign);
+
 	ThemeLayout *layout = nullptr;
 
 	if (spacing == -1)
@@ -168,6 +185,9 @@ ThemeEval &ThemeEval::addLayout(ThemeLayout::LayoutType type, int spacing, Theme
 }
 
 ThemeEval &ThemeEval::addSpace(int size) {
+	if (_cache)
+		_cache->recordSpace(size);
+
 	ThemeLayout *space = new ThemeLayoutSpacing(_curLayout.top(), size);
 	_curLayout.top()->addChild(space);
 
@@ -177,11 +197,31 @@ ThemeEval &ThemeEval::addSpace(int size) {
 #define SCALEVALUE(val) (val > 0 ? val * _scaleFactor : val)
 
 ThemeEval &ThemeEval::addPadding(int16 l, int16 r, int16 t, int16 b) {
+	if (_cache)
+		_cache->recordPadding(l, r, t, b);
+
 	_curLayout.top()->setPadding(SCALEVALUE(l), SCALEVALUE(r), SCALEVALUE(t), SCALEVALUE(b));
 
 	return *this;
 }
 
+ThemeEval &ThemeEval::closeLayout() {
+	if (_cache)
+		_cache->recordCloseLayout();
+
+	_curLayout.pop();
+	return *this;
+}
+
+ThemeEval &ThemeEval::closeDialog() {
+	if (_cache)
+		_cache->recordCloseDialog();
+
+	_curLayout.pop();
+	_curDialog.clear();
+	return *this;
+}
+
 bool ThemeEval::hasDialog(const Common::String &name) {
 	Common::StringTokenizer tokenizer(name, ".");
 
@@ -202,6 +242,9 @@ void ThemeEval::reflowDialogLayout(const Common::String &name, Widget *widgetCha
 }
 
 ThemeEval &ThemeEval::addImportedLayout(const Common::String &name) {
+	if (_cache)
+		_cache->recordImportedLayout(name);
+
 	ThemeLayout *importedLayout = _layouts[name];
 	assert(importedLayout);
 
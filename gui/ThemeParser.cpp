@@ -386,34 +386,41 @@ bool ThemeParser::parserCallback_color(ParserNode *node) {
 }
 
 
-static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name) {
-
-	if (name == "circle")
-		return &Graphics::VectorRenderer::drawCallback_CIRCLE;
-	if (name == "square")
-		return &Graphics::VectorRenderer::drawCallback_SQUARE;
-	if (name == "roundedsq")
-		return &Graphics::VectorRenderer::drawCallback_ROUNDSQ;
-	if (name == "bevelsq")
-		return &Graphics::VectorRenderer::drawCallback_BEVELSQ;
-	if (name == "line")
-		return &Graphics::VectorRenderer::drawCallback_LINE;
-	if (name == "triangle")
-		return &Graphics::VectorRenderer::drawCallback_TRIANGLE;
-	if (name == "fill")
-		return &Graphics::VectorRenderer::drawCallback_FILLSURFACE;
-	if (name == "tab")
-		return &Graphics::VectorRenderer::drawCallback_TAB;
-	if (name == "void")
-		return &Graphics::VectorRenderer::drawCallback_VOID;
-	if (name == "bitmap")
-		return &Graphics::VectorRenderer::drawCallback_BITMAP;
-	if (name == "cross")
-		return &Graphics::VectorRenderer::drawCallback_CROSS;
+struct DrawingFunctionInfo {
+	const char *name;
+	Graphics::DrawingFunctionCallback callback;
+};
+
+static const DrawingFunctionInfo kDrawingFunctions[] = {
+	{ "circle",		&Graphics::VectorRenderer::drawCallback_CIRCLE },
+	{ "square",		&Graphics::VectorRenderer::drawCallback_SQUARE },
+	{ "roundedsq",	&Graphics::VectorRenderer::drawCallback_ROUNDSQ },
+	{ "bevelsq",	&Graphics::VectorRenderer::drawCallback_BEVELSQ },
+	{ "line",		&Graphics::VectorRenderer::drawCallback_LINE },
+	{ "triangle",	&Graphics::VectorRenderer::drawCallback_TRIANGLE },
+	{ "fill",		&Graphics::VectorRenderer::drawCallback_FILLSURFACE },
+	{ "tab",		&Graphics::VectorRenderer::drawCallback_TAB },
+	{ "void",		&Graphics::VectorRenderer::drawCallback_VOID },
+	{ "bitmap",		&Graphics::VectorRenderer::drawCallback_BITMAP },
+	{ "cross",		&Graphics::VectorRenderer::drawCallback_CROSS }
+};
+
+Graphics::DrawingFunctionCallback ThemeParser::getDrawingFunctionCallback(const Common::String &name) {
+	for (int i = 0; i < ARRAYSIZE(kDrawingFunctions); ++i)
+		if (name == kDrawingFunctions[i].name)
+			return kDrawingFunctions[i].callback;
 
 	return nullptr;
 }
 
+const char *ThemeParser::getDrawingFunctionName(Graphics::DrawingFunctionCallback callback) {
+	for (int i = 0; i < ARRAYSIZE(kDrawingFunctions); ++i)
+		if (callback == kDrawingFunctions[i].callback)
+			return kDrawingFunctions[i].name;
+
+	return "";
+}
+
 
 bool ThemeParser::parserCallback_drawstep(ParserNode *node) {
 	Graphics::DrawStep *drawstep = newDrawStep();
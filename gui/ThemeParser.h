@@ -25,6 +25,8 @@
 #include "common/scummsys.h"
 #include "common/formats/xmlparser.h"
 
+#include "graphics/VectorRenderer.h"
+
 namespace GUI {
 
 class ThemeEngine;
@@ -52,6 +54,12 @@ public:
 		return true;
 	}
 
+	/** Get the drawing function with the given name in the theme files. */
+	static Graphics::DrawingFunctionCallback getDrawingFunctionCallback(const Common::String &name);
+
+	/** Get the name of a drawing function in the theme files. */
+	static const char *getDrawingFunctionName(Graphics::DrawingFunctionCallback callback);
+
 protected:
 	ThemeEngine *_theme;
 
@@ -61,6 +61,8 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
+	_scanStartTime(0),
+	_scanTime(0),
 	_okButton(nullptr),
 	_dirProgressText(nullptr),
 	_gameProgressText(nullptr) {
@@ -183,11 +185,19 @@ void MassAddDialog::updateGameList() {
 	}
 }
 
+uint MassAddDialog::getThroughput() const {
+	// Games which were added before are detected all the same
+	uint games = _games.size() + _oldGamesCount;
+	return _scanTime ? (uint)((uint64)games * 10000 / _scanTime) : 0;
+}
+
 void MassAddDialog::handleTickle() {
 	if (_scanStack.empty())
 		return;	// We have finished scanning
 
 	uint32 t = g_system->getMillis();
+	if (!_scanStartTime)
+		_scanStartTime = t;
 
 	// Perform a breadth-first scan of the filesystem.
 	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
@@ -273,6 +283,8 @@ void MassAddDialog::handleTickle() {
 	}
 
 
+	_scanTime = g_system->getMillis() - _scanStartTime;
+
 	// Update the dialog
 	Common::U32String buf;
 
@@ -280,7 +292,10 @@ void MassAddDialog::handleTickle() {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
-		buf = _("Scan complete!");
+		uint throughput = getThroughput();
+		debug(1, "Mass add: scanned %d directories in %u ms, %u.%u games/s", _dirsScanned, _scanTime, throughput / 10, throughput % 10);
+
+		buf = Common::U32String::format(_("Scan complete! Scanned %d directories, %u.%u games/s."), _dirsScanned, throughput / 10, throughput % 10);
 		_dirProgressText->setLabel(buf);
 
 		buf = Common::U32String::format(_("Discovered %d new games, ignored %d previously added games."), _games.size(), _oldGamesCount);
@@ -65,6 +65,11 @@ private:
 	int _dirsScanned;
 	int _oldGamesCount;
 	int _dirTotal;
+	uint32 _scanStartTime;
+	uint32 _scanTime;
+
+	/** Return the number of games detected per second so far, in tenths. */
+	uint getThroughput() const;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
@@ -27,6 +27,8 @@ MODULE_OBJS := \
 	shaderbrowser-dialog.o \
 	textviewer.o \
 	themebrowser.o \
+	ThemeCache.o \
+	ThemeCacheReplay.o \
 	ThemeEngine.o \
 	ThemeEval.o \
 	ThemeLayout.o \
@@ -0,0 +1,85 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+#include "common/random.h"
+
+#include "test/instrset_detect.h"
+
+class MixKernelTestSuite : public CxxTest::TestSuite {
+private:
+	typedef void(*MixFunc)(Audio::st_sample_t *, const Audio::st_sample_t *, uint, Audio::st_volume_t, Audio::st_volume_t, bool, bool);
+
+	// Mixes random samples with both the generic kernel and @p func and
+	// checks that both produce exactly the same output.
+	void compareWithGeneric(MixFunc func) {
+		Common::RandomSource rnd("mixkernel");
+
+		// Odd frame counts to exercise the scalar tail of the SIMD kernels
+		const uint numFrames = 1021;
+		int16 *src = new int16[numFrames * 2];
+		int16 *dstGeneric = new int16[numFrames * 2];
+		int16 *dstFunc = new int16[numFrames * 2];
+
+		const Audio::st_volume_t volumes[] = { 0, 1, 127, 255, Audio::Mixer::kMaxMixerVolume };
+
+		for (int pass = 0; pass < 4; pass++) {
+			const bool inStereo = (pass & 1) != 0;
+			const bool reverseStereo = (pass & 2) != 0;
+
+			for (int vl = 0; vl < ARRAYSIZE(volumes); vl++) {
+				for (int vr = 0; vr < ARRAYSIZE(volumes); vr++) {
+					for (uint i = 0; i < numFrames * 2; i++) {
+						// Include the extremes, which saturate on accumulation
+						src[i] = (i % 17 == 0) ? (int16)(i & 1 ? 32767 : -32768) : (int16)rnd.getRandomNumber(65535);
+						dstGeneric[i] = dstFunc[i] = (int16)rnd.getRandomNumber(65535);
+					}
+
+					Audio::MixKernel::mixGeneric(dstGeneric, src, numFrames, volumes[vl], volumes[vr], inStereo, reverseStereo);
+					func(dstFunc, src, numFrames, volumes[vl], volumes[vr], inStereo, reverseStereo);
+
+					TS_ASSERT_EQUALS(memcmp(dstGeneric, dstFunc, numFrames * 2 * sizeof(int16)), 0);
+				}
+			}
+		}
+
+		delete[] src;
+		delete[] dstGeneric;
+		delete[] dstFunc;
+	}
+
+public:
+	void test_generic_matches_clamped_add() {
+		const int16 src[] = { 32767, -32768, 1000, -1000, -1, 1, 0, 12345 };
+		int16 dst[] = { 32767, -32768, 0, 0, 100, -100, 5, -5 };
+		int16 expected[8];
+
+		for (int i = 0; i < 8; i++) {
+			expected[i] = dst[i];
+			const Audio::st_volume_t vol = (i & 1) ? 200 : 255;
+			Audio::clampedAdd(expected[i], (int16)((src[i] * (int)vol) / Audio::Mixer::kMaxMixerVolume));
+		}
+
+		Audio::MixKernel::mixGeneric(dst, src, 4, 255, 200, true, false);
+		TS_ASSERT_EQUALS(memcmp(dst, expected, sizeof(dst)), 0);
+	}
+
+	void test_simd_matches_generic() {
+		// The SIMD kernels are never selected for unsigned output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_NEON
+		compareWithGeneric(Audio::MixKernel::mixNEON);
+#endif
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			compareWithGeneric(Audio::MixKernel::mixSSE2);
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			compareWithGeneric(Audio::MixKernel::mixAVX2);
+		}
+#endif
+#endif
+	}
+};
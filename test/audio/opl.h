@@ -0,0 +1,282 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "audio/softsynth/opl/mame.h"
+#include "audio/softsynth/opl/nuked.h"
+
+#include "../null_osystem.h"
+
+class OPLTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kRate = 44100,
+		kTickSamples = kRate / 70
+	};
+
+	struct RegisterWrite {
+		uint16 reg;
+		uint8 val;
+	};
+
+	// A deterministic register dump: instruments on all channels, notes
+	// starting and stopping every tick, and rhythm mode switched on and off.
+	// With opl3, the second register bank and 4 operator channels are used.
+	class Song {
+	public:
+		Song(bool opl3) : _opl3(opl3), _seed(0x12345678), _tick(0) {}
+
+		void start(Common::Array<RegisterWrite> &writes) {
+			writes.push_back(makeWrite(0x01, 0x20));
+			if (_opl3) {
+				writes.push_back(makeWrite(0x105, 0x01));
+				writes.push_back(makeWrite(0x104, 0x09));
+			}
+			for (int bank = 0; bank < (_opl3 ? 2 : 1); bank++) {
+				for (int ch = 0; ch < 9; ch++) {
+					const uint16 base = bank * 0x100;
+					const uint16 op = (ch % 3) + (ch / 3) * 8;
+					for (int i = 0; i < 2; i++) {
+						writes.push_back(makeWrite(base + 0x20 + op + i * 3, getRandom() & 0xff));
+						writes.push_back(makeWrite(base + 0x40 + op + i * 3, getRandom() & (i ? 0xdf : 0xff)));
+						writes.push_back(makeWrite(base + 0x60 + op + i * 3, getRandom() | 0x44));
+						writes.push_back(makeWrite(base + 0x80 + op + i * 3, getRandom() & 0xff));
+						writes.push_back(makeWrite(base + 0xe0 + op + i * 3, getRandom() & 0x07));
+					}
+					writes.push_back(makeWrite(base + 0xc0 + ch, (getRandom() & 0x0f) | (_opl3 ? 0x30 : 0x00)));
+				}
+			}
+		}
+
+		void tick(Common::Array<RegisterWrite> &writes) {
+			_tick++;
+			if (_tick % 64 == 0)
+				writes.push_back(makeWrite(0xbd, (_tick & 64) ? 0xe0 | (getRandom() & 0x1f) : 0x00));
+
+			for (int i = 0; i < 3; i++) {
+				const uint32 r = getRandom();
+				const uint16 base = (_opl3 && (r & 0x100)) ? 0x100 : 0x000;
+				const uint16 ch = (r >> 9) % 9;
+				if (r & 1) {
+					writes.push_back(makeWrite(base + 0xa0 + ch, r >> 16));
+					writes.push_back(makeWrite(base + 0xb0 + ch, 0x20 | ((r >> 24) & 0x1f)));
+				} else {
+					writes.push_back(makeWrite(base + 0xb0 + ch, (r >> 24) & 0x1f));
+				}
+			}
+			if (_tick % 16 == 0) {
+				// Change the volume and waveform of an operator
+				const uint32 r = getRandom();
+				const uint16 op = (r % 9 % 3) + (r % 9 / 3) * 8;
+				writes.push_back(makeWrite(0x40 + op, r >> 8));
+				writes.push_back(makeWrite(0xe0 + op + 3, r >> 16));
+			}
+		}
+
+	private:
+		static RegisterWrite makeWrite(uint16 reg, uint8 val) {
+			RegisterWrite write;
+			write.reg = reg;
+			write.val = val;
+			return write;
+		}
+
+		uint32 getRandom() {
+			_seed = _seed * 1103515245 + 12345;
+			return _seed >> 1;
+		}
+
+		bool _opl3;
+		uint32 _seed;
+		uint32 _tick;
+	};
+
+	// Renders the song through Nuked OPL3, and returns the number of
+	// stereo samples rendered
+	static uint32 renderNuked(OPL::NUKED::opl3_chip *chip, bool opl3, bool block, int16 *buffer, int ticks, int rate) {
+		Song song(opl3);
+		Common::Array<RegisterWrite> writes;
+		OPL::NUKED::OPL3_Reset(chip, rate);
+		song.start(writes);
+
+		// Render the ticks in irregular chunks, as the mixer does
+		const uint32 tickSamples = rate / 70;
+		uint32 pos = 0;
+		for (int i = 0; i < ticks; i++) {
+			for (uint j = 0; j < writes.size(); j++)
+				OPL::NUKED::OPL3_WriteRegBuffered(chip, writes[j].reg, writes[j].val);
+			writes.clear();
+			song.tick(writes);
+
+			const uint32 first = (i * 37) % tickSamples;
+			if (block) {
+				OPL::NUKED::OPL3_GenerateStreamBlock(chip, buffer + pos * 2, first);
+				OPL::NUKED::OPL3_GenerateStreamBlock(chip, buffer + (pos + first) * 2, tickSamples - first);
+			} else {
+				OPL::NUKED::OPL3_GenerateStream(chip, buffer + pos * 2, tickSamples);
+			}
+			pos += tickSamples;
+		}
+		return pos;
+	}
+
+	static double realTimeFactor(uint32 samples, uint32 time) {
+		return (double)samples / kRate * 1000.0 / MAX<uint32>(time, 1);
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_nuked_block_matches() {
+#ifndef DISABLE_NUKED_OPL
+		const int ticks = 500;
+		const int rates[] = { 22050, 44100, 49716 };
+
+		OPL::NUKED::opl3_chip *chip = new OPL::NUKED::opl3_chip;
+		for (int r = 0; r < ARRAYSIZE(rates); r++) {
+			const uint32 samples = ticks * (rates[r] / 70);
+			int16 *reference = new int16[samples * 2];
+			int16 *block = new int16[samples * 2];
+
+			for (int opl3 = 0; opl3 < 2; opl3++) {
+				renderNuked(chip, opl3, false, reference, ticks, rates[r]);
+				renderNuked(chip, opl3, true, block, ticks, rates[r]);
+
+				uint32 i = 0;
+				while (i < samples * 2 && reference[i] == block[i])
+					i++;
+				if (i != samples * 2)
+					TS_FAIL(Common::String::format("%s at %d Hz differs at sample %u", opl3 ? "OPL3" : "OPL2", rates[r], i / 2).c_str());
+			}
+
+			delete[] reference;
+			delete[] block;
+		}
+		delete chip;
+#endif
+	}
+
+	void test_nuked_native_block_matches() {
+#ifndef DISABLE_NUKED_OPL
+		OPL::NUKED::opl3_chip *reference = new OPL::NUKED::opl3_chip;
+		OPL::NUKED::opl3_chip *block = new OPL::NUKED::opl3_chip;
+		OPL::NUKED::OPL3_Reset(reference, 49716);
+		OPL::NUKED::OPL3_Reset(block, 49716);
+
+		Song song(true);
+		Common::Array<RegisterWrite> writes;
+		song.start(writes);
+
+		int16 samples[4], blockSamples[710 * 4];
+		int errors = 0;
+		for (int i = 0; i < 200; i++) {
+			for (uint j = 0; j < writes.size(); j++) {
+				OPL::NUKED::OPL3_WriteRegBuffered(reference, writes[j].reg, writes[j].val);
+				OPL::NUKED::OPL3_WriteRegBuffered(block, writes[j].reg, writes[j].val);
+			}
+			writes.clear();
+			song.tick(writes);
+
+			// All four channels are compared
+			OPL::NUKED::OPL3_Generate4ChBlock(block, blockSamples, 710);
+			for (int j = 0; j < 710; j++) {
+				OPL::NUKED::OPL3_Generate4Ch(reference, samples);
+				if (memcmp(samples, blockSamples + j * 4, sizeof(samples)) != 0)
+					errors++;
+			}
+		}
+		TS_ASSERT_EQUALS(errors, 0);
+
+		delete reference;
+		delete block;
+#endif
+	}
+
+	void test_adlib_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const int ticks = 70 * 60;
+#else
+		const int ticks = 70;
+#endif
+		const uint32 samples = ticks * kTickSamples;
+		int16 *buffer = new int16[samples * 2];
+
+#ifndef DISABLE_NUKED_OPL
+		OPL::NUKED::opl3_chip *chip = new OPL::NUKED::opl3_chip;
+		for (int block = 0; block < 2; block++) {
+			for (int opl3 = 0; opl3 < 2; opl3++) {
+				uint32 start = g_system->getMillis();
+				renderNuked(chip, opl3, block, buffer, ticks, kRate);
+				uint32 time = g_system->getMillis() - start;
+				debug("AdLib Nuked %s, %s: %u samples in %u ms (%fx real time)", opl3 ? "OPL3" : "OPL2",
+				      block ? "blocks" : "single samples", samples, time, realTimeFactor(samples, time));
+			}
+		}
+		delete chip;
+#endif
+
+#ifndef DISABLE_DOSBOX_OPL
+		for (int opl3 = 0; opl3 < 2; opl3++) {
+			OPL::DOSBox::DBOPL::Chip *dbopl = new OPL::DOSBox::DBOPL::Chip;
+			dbopl->Setup(kRate);
+			Song song(opl3);
+			Common::Array<RegisterWrite> writes;
+			song.start(writes);
+			int32 *temp = new int32[kTickSamples * 2];
+
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < ticks; i++) {
+				for (uint j = 0; j < writes.size(); j++)
+					dbopl->WriteReg(writes[j].reg, writes[j].val);
+				writes.clear();
+				song.tick(writes);
+
+				// Blocks are limited to 512 samples
+				for (uint32 pos = 0; pos < kTickSamples; pos += 512) {
+					if (dbopl->opl3Active)
+						dbopl->GenerateBlock3(MIN<uint32>(kTickSamples - pos, 512), temp);
+					else
+						dbopl->GenerateBlock2(MIN<uint32>(kTickSamples - pos, 512), temp);
+				}
+			}
+			uint32 time = g_system->getMillis() - start;
+			debug("AdLib DOSBox %s: %u samples in %u ms (%fx real time)", opl3 ? "OPL3" : "OPL2",
+			      samples, time, realTimeFactor(samples, time));
+
+			delete[] temp;
+			delete dbopl;
+		}
+#endif
+
+		OPL::MAME::FM_OPL *mame = OPL::MAME::makeAdLibOPL(kRate);
+		TS_ASSERT(mame != nullptr);
+		if (mame) {
+			Song song(false);
+			Common::Array<RegisterWrite> writes;
+			song.start(writes);
+
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < ticks; i++) {
+				for (uint j = 0; j < writes.size(); j++)
+					OPL::MAME::OPLWriteReg(mame, writes[j].reg, writes[j].val);
+				writes.clear();
+				song.tick(writes);
+				OPL::MAME::YM3812UpdateOne(mame, buffer, kTickSamples);
+			}
+			uint32 time = g_system->getMillis() - start;
+			debug("AdLib MAME OPL2: %u samples in %u ms (%fx real time)", samples, time, realTimeFactor(samples, time));
+			OPL::MAME::OPLDestroy(mame);
+		}
+
+		delete[] buffer;
+#endif
+	}
+};
@@ -0,0 +1,154 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mix.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "common/memstream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "helper.h"
+#include "test/instrset_detect.h"
+#include "../null_osystem.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite {
+private:
+	static Audio::SeekableAudioStream *createConstantStream(int16 value, int rate, int numSamples) {
+		int16 *data = (int16 *)malloc(numSamples * sizeof(int16));
+		for (int i = 0; i < numSamples; i++)
+			WRITE_LE_INT16(&data[i], value);
+
+		return Audio::makeRawStream(new Common::MemoryReadStream((const byte *)data, numSamples * sizeof(int16), DisposeAfterUse::YES),
+		                            rate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+	}
+
+	// Converts the whole stream, and returns the number of stereo frames written
+	static int convertAll(Audio::RateConverter *converter, Audio::AudioStream *stream, int16 *out, int maxFrames) {
+		int total = 0;
+		while (total < maxFrames && (!stream->endOfData() || converter->needsDraining())) {
+			int res = converter->convert(*stream, out + total * 2, MIN(maxFrames - total, 1000), Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			if (res == 0)
+				break;
+			total += res;
+		}
+		return total;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		// The null backend can not report CPU features, so pick the
+		// kernels here instead of leaving it to MixKernel.
+		Audio::MixKernel::mixFunc = Audio::MixKernel::mixGeneric;
+		Audio::MixKernel::dotProductFunc = Audio::MixKernel::dotProductGeneric;
+	}
+
+	void test_sinc_passes_dc() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Audio::SeekableAudioStream *stream = createConstantStream(10000, 22050, 22050);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, false, true, false, Audio::kResamplerSinc);
+
+		const int maxFrames = 50000;
+		int16 *out = new int16[maxFrames * 2];
+		memset(out, 0, maxFrames * 2 * sizeof(int16));
+
+		int frames = convertAll(converter, stream, out, maxFrames);
+
+		// The filter delay is compensated, and its tail is drained at the end
+		TS_ASSERT_LESS_THAN_EQUALS(44099, frames);
+		TS_ASSERT_LESS_THAN_EQUALS(frames, 44101);
+
+		// Away from the edges, the unity DC gain reproduces the input exactly
+		for (int i = 1000; i < 43000; i++) {
+			TS_ASSERT_EQUALS(out[i * 2], 10000);
+			TS_ASSERT_EQUALS(out[i * 2 + 1], 10000);
+		}
+
+		delete[] out;
+		delete converter;
+		delete stream;
+#endif
+	}
+
+	void test_fast_picks_input_samples() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(11025, 1, nullptr, true, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 48000, false, true, false, Audio::kResamplerFast);
+
+		int16 *in = new int16[11025];
+		Audio::SeekableAudioStream *ref = createSineStream<int16>(11025, 1, nullptr, true, false);
+		TS_ASSERT_EQUALS(ref->readBuffer(in, 11025), 11025);
+		delete ref;
+
+		const int maxFrames = 48000;
+		int16 *out = new int16[maxFrames * 2];
+		memset(out, 0, maxFrames * 2 * sizeof(int16));
+
+		int frames = convertAll(converter, stream, out, maxFrames);
+		TS_ASSERT_LESS_THAN(47000, frames);
+
+		// Every output sample has to be one of the neighbouring inputs. The
+		// position is stepped the same way as the converter does it, with
+		// 15 fractional bits.
+		for (int i = 1; i < frames; i++) {
+			const int pos = (int)(((int64)i * ((11025 << 15) / 48000)) >> 15);
+			TS_ASSERT(out[i * 2] == in[pos] || (pos > 0 && out[i * 2] == in[pos - 1]) || (pos < 11024 && out[i * 2] == in[pos + 1]));
+		}
+
+		delete[] in;
+		delete[] out;
+		delete converter;
+		delete stream;
+#endif
+	}
+
+	void test_resampler_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			Audio::MixKernel::mixFunc = Audio::MixKernel::mixSSE2;
+			Audio::MixKernel::dotProductFunc = Audio::MixKernel::dotProductSSE2;
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			Audio::MixKernel::mixFunc = Audio::MixKernel::mixAVX2;
+			Audio::MixKernel::dotProductFunc = Audio::MixKernel::dotProductAVX2;
+		}
+#endif
+
+#ifdef SLOW_TESTS
+		const int seconds = 30;
+#else
+		const int seconds = 1;
+#endif
+		const char *names[] = { "fast", "linear", "sinc" };
+		const Audio::ResamplerMode modes[] = { Audio::kResamplerFast, Audio::kResamplerLinear, Audio::kResamplerSinc };
+
+		const int maxFrames = 44100 * seconds + 1000;
+		int16 *out = new int16[maxFrames * 2];
+
+		for (int mode = 0; mode < ARRAYSIZE(modes); mode++) {
+			Audio::SeekableAudioStream *stream = createSineStream<int16>(22050, seconds, nullptr, true, true);
+			Audio::RateConverter *converter = Audio::makeRateConverter(22050, 44100, true, true, false, modes[mode]);
+			memset(out, 0, maxFrames * 2 * sizeof(int16));
+
+			uint32 start = g_system->getMillis();
+			int frames = convertAll(converter, stream, out, maxFrames);
+			uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			TS_ASSERT_LESS_THAN(44100 * seconds - 100, frames);
+			debug("RateConverter %s: %d output frames in %d ms (%f samples/s)", names[mode], frames, time, frames * 1000.0 / time);
+
+			delete converter;
+			delete stream;
+		}
+
+		delete[] out;
+#endif
+	}
+};
@@ -0,0 +1,337 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/mutex.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "backends/timer/default/default-timer.h"
+
+#include "../null_osystem.h"
+
+class TimerTestSuite : public CxxTest::TestSuite {
+private:
+	// A timer manager with a clock which only moves when told to
+	class FakeClockTimerManager : public DefaultTimerManager {
+	public:
+		FakeClockTimerManager(bool workerAllowed) : _now(1000000) {
+			_workerAllowed = workerAllowed;
+		}
+
+		void advance(uint64 micros) {
+			_now += micros;
+		}
+
+	protected:
+		uint64 getMicros() override {
+			return _now;
+		}
+
+	private:
+		uint64 _now;
+	};
+
+	struct Counter {
+		Counter() : manager(nullptr), calls(0), work(0), removeAfter(0) {}
+
+		FakeClockTimerManager *manager;
+		int calls;
+		uint32 work;        // Microseconds each call takes
+		int removeAfter;    // Remove the timer after this many calls
+	};
+
+	static void countProc(void *refCon) {
+		Counter *counter = (Counter *)refCon;
+		counter->calls++;
+		if (counter->work)
+			counter->manager->advance(counter->work);
+		if (counter->calls == counter->removeAfter)
+			counter->manager->removeTimerProc(countProc);
+	}
+
+	static void otherProc(void *refCon) {
+		((Counter *)refCon)->calls++;
+	}
+
+	static void blockedProc(void *refCon) {
+		Common::StackLock lock(*(Common::Mutex *)refCon);
+	}
+
+	static const TimerStats *findStats(const Common::Array<TimerStats> &stats, const char *id) {
+		for (uint i = 0; i < stats.size(); i++) {
+			if (stats[i].id == id)
+				return &stats[i];
+		}
+		return nullptr;
+	}
+
+	// Measures how late a light timer is called while a slow timer is
+	// installed next to it
+	struct JitterResult {
+		uint32 calls;
+		uint32 averageLateness;
+		uint32 maxLateness;
+	};
+
+	static void lightProc(void *refCon) {
+	}
+
+	static void slowProc(void *refCon) {
+		g_system->delayMillis(8);
+	}
+
+	class JitterTimerManager : public DefaultTimerManager {
+	public:
+		JitterTimerManager() {
+			_workerAllowed = true;
+		}
+	};
+
+	static JitterResult measureJitter(bool heavy, bool adaptive, uint32 duration) {
+		JitterTimerManager manager;
+		manager.installTimerProc(lightProc, 1000000 / 60, nullptr, "light");
+		manager.installTimerProc(slowProc, 1000000 / 20, nullptr, "slow");
+		manager.setHeavyTimerProc(slowProc, heavy);
+
+		// Call the handler the way the SDL backend does, or every 10 ms
+		const uint32 end = g_system->getMillis() + duration;
+		while (g_system->getMillis() < end) {
+			const uint32 wait = manager.handler();
+			g_system->delayMillis(adaptive ? CLIP<uint32>((wait + 999) / 1000, 1, 10) : 10);
+		}
+
+		Common::Array<TimerStats> stats;
+		manager.getTimerStats(stats);
+		const TimerStats *light = findStats(stats, "light");
+
+		JitterResult result;
+		result.calls = light ? light->calls : 0;
+		result.averageLateness = light && light->calls ? light->totalLateness / light->calls : 0;
+		result.maxLateness = light ? light->maxLateness : 0;
+		manager.removeTimerProc(slowProc);
+		manager.removeTimerProc(lightProc);
+		return result;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_no_drift() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(false);
+		Counter counter;
+		counter.manager = &manager;
+
+		// 60 Hz, with the handler called at irregular times
+		const uint32 interval = 16667;
+		manager.installTimerProc(countProc, interval, &counter, "count");
+		uint64 elapsed = 0;
+		for (int i = 0; i < 10000; i++) {
+			const uint32 step = 3000 + (i * 7919) % 9000;
+			manager.advance(step);
+			elapsed += step;
+			manager.handler();
+		}
+		TS_ASSERT_EQUALS((uint64)counter.calls, elapsed / interval);
+
+		Common::Array<TimerStats> stats;
+		manager.getTimerStats(stats);
+		TS_ASSERT_EQUALS(stats.size(), 1u);
+		TS_ASSERT_EQUALS(stats[0].calls, (uint32)counter.calls);
+		TS_ASSERT_EQUALS(stats[0].skipped, 0u);
+		TS_ASSERT_LESS_THAN(stats[0].maxLateness, 12000u);
+
+		manager.removeTimerProc(countProc);
+#endif
+	}
+
+	void test_catch_up() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(false);
+		Counter counter;
+		counter.manager = &manager;
+		manager.installTimerProc(countProc, 10000, &counter, "count");
+
+		// Missed calls are made up for
+		manager.advance(50000);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 5);
+
+		// Until the timer is too far behind
+		manager.advance(1000000);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 6);
+
+		Common::Array<TimerStats> stats;
+		manager.getTimerStats(stats);
+		TS_ASSERT_EQUALS(stats[0].skipped, 99u);
+
+		// The timer keeps its phase
+		TS_ASSERT_EQUALS(manager.handler(), 10000u);
+		manager.advance(9999);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 6);
+		manager.advance(1);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 7);
+
+		manager.removeTimerProc(countProc);
+#endif
+	}
+
+	void test_order_and_removal() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(false);
+		Counter counter, other;
+		counter.manager = &manager;
+		counter.removeAfter = 3;
+		manager.installTimerProc(countProc, 10000, &counter, "count");
+		manager.installTimerProc(otherProc, 25000, &other, "other");
+
+		// Timers removing themselves are not called again
+		for (int i = 0; i < 100; i++) {
+			manager.advance(1000);
+			TS_ASSERT_LESS_THAN_EQUALS(manager.handler(), 25000u);
+		}
+		TS_ASSERT_EQUALS(counter.calls, 3);
+		TS_ASSERT_EQUALS(other.calls, 4);
+
+		// The same callback can be installed again once removed
+		counter.calls = 0;
+		counter.removeAfter = 0;
+		manager.installTimerProc(countProc, 10000, &counter, "count");
+		manager.advance(20000);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 2);
+
+		manager.removeTimerProc(otherProc);
+		manager.removeTimerProc(countProc);
+		manager.advance(100000);
+		manager.handler();
+		TS_ASSERT_EQUALS(counter.calls, 2);
+		TS_ASSERT_EQUALS(other.calls, 4);
+#endif
+	}
+
+	void test_stats() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(false);
+		Counter counter;
+		counter.manager = &manager;
+		counter.work = 500;
+		manager.installTimerProc(countProc, 10000, &counter, "count");
+
+		manager.advance(30000);
+		manager.handler();
+
+		Common::Array<TimerStats> stats;
+		manager.getTimerStats(stats);
+		TS_ASSERT_EQUALS(stats[0].id, "count");
+		TS_ASSERT_EQUALS(stats[0].interval, 10000u);
+		TS_ASSERT(!stats[0].heavy);
+		TS_ASSERT_EQUALS(stats[0].calls, 3u);
+		TS_ASSERT_EQUALS(stats[0].totalTime, 1500u);
+		TS_ASSERT_EQUALS(stats[0].maxTime, 500u);
+		// The first call is the latest
+		TS_ASSERT_EQUALS(stats[0].maxLateness, 20000u);
+		TS_ASSERT_EQUALS(stats[0].totalLateness, 31500u);
+
+		manager.resetTimerStats();
+		manager.getTimerStats(stats);
+		TS_ASSERT_EQUALS(stats[0].calls, 0u);
+		TS_ASSERT_EQUALS(stats[0].maxTime, 0u);
+
+		manager.removeTimerProc(countProc);
+#endif
+	}
+
+	void test_heavy_timer() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(true);
+		Counter other;
+		manager.installTimerProc(otherProc, 10000, &other, "other");
+		manager.setHeavyTimerProc(otherProc, true);
+
+		manager.advance(50000);
+		manager.handler();
+
+		// Wait for the worker to run the queued call. The timer fired five
+		// times, and the fires after the first one were coalesced with it
+		// unless the worker had already taken it.
+		Common::Array<TimerStats> stats;
+		for (int i = 0; i < 1000; i++) {
+			manager.getTimerStats(stats);
+			if (stats[0].calls > 0 && stats[0].calls + stats[0].coalesced == 5)
+				break;
+			g_system->delayMillis(1);
+		}
+
+		manager.getTimerStats(stats);
+		TS_ASSERT_LESS_THAN_EQUALS(1u, stats[0].calls);
+		TS_ASSERT_EQUALS(stats[0].calls + stats[0].coalesced, 5u);
+		TS_ASSERT_EQUALS(other.calls, (int)stats[0].calls);
+
+		// Once removed, queued calls are dropped
+		manager.advance(50000);
+		manager.handler();
+		manager.removeTimerProc(otherProc);
+		const int calls = other.calls;
+		g_system->delayMillis(10);
+		TS_ASSERT_EQUALS(other.calls, calls);
+#endif
+	}
+
+	void test_heavy_timer_backlog() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		FakeClockTimerManager manager(true);
+		Common::Mutex blocked;
+		manager.installTimerProc(blockedProc, 10000, &blocked, "blocked");
+		manager.setHeavyTimerProc(blockedProc, true);
+
+		// The callback cannot return while the timer keeps firing
+		blocked.lock();
+		for (int i = 0; i < 100; i++) {
+			manager.advance(10000);
+			manager.handler();
+		}
+		blocked.unlock();
+
+		Common::Array<TimerStats> stats;
+		for (int i = 0; i < 1000; i++) {
+			manager.getTimerStats(stats);
+			if (stats[0].calls + stats[0].coalesced == 100)
+				break;
+			g_system->delayMillis(1);
+		}
+
+		// At most the blocked call and the one queued behind it are run
+		manager.getTimerStats(stats);
+		TS_ASSERT_EQUALS(stats[0].calls + stats[0].coalesced, 100u);
+		TS_ASSERT_LESS_THAN_EQUALS(stats[0].calls, 2u);
+
+		manager.removeTimerProc(blockedProc);
+#endif
+	}
+
+	void test_jitter() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const uint32 duration = 5000;
+#else
+		const uint32 duration = 200;
+#endif
+		const char *names[] = { "fixed 10 ms ticks", "adaptive ticks", "adaptive ticks, heavy timer on worker" };
+
+		for (int i = 0; i < ARRAYSIZE(names); i++) {
+			JitterResult result = measureJitter(i == 2, i > 0, duration);
+			TS_ASSERT_LESS_THAN(0u, result.calls);
+			debug("Timer jitter, %s: %u calls of a 60 Hz timer in %u ms, %u us average lateness, %u us max", names[i],
+			      result.calls, duration, result.averageLateness, result.maxLateness);
+		}
+#endif
+	}
+};
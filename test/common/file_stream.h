@@ -0,0 +1,165 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/memstream.h"
+#include "common/substream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "backends/fs/stdiostream.h"
+
+#include "../null_osystem.h"
+
+class FileStreamTestSuite : public CxxTest::TestSuite {
+private:
+	// A read-only file copied next to the test runner by the build
+	static const char *getTestFile() {
+		return "test/engine-data/FreeSans.ttf";
+	}
+
+	// Reads the whole test file through stdio
+	static byte *readTestFile(uint32 &size) {
+		StdioStream *stream = StdioStream::makeFromPath(getTestFile(), false);
+		if (!stream)
+			return nullptr;
+
+		size = stream->size();
+		byte *data = new byte[size];
+		if (stream->read(data, size) != size) {
+			delete[] data;
+			data = nullptr;
+		}
+		delete stream;
+		return data;
+	}
+
+	// Reads from pseudo-random positions, and returns the number of bytes
+	// which did not match the reference contents
+	static uint32 randomReads(Common::SeekableReadStream *stream, const byte *reference, int reads, uint32 &bytesRead) {
+		const uint32 size = stream->size();
+		uint32 seed = 0x12345678;
+		uint32 errors = 0;
+		byte buffer[512];
+
+		for (int i = 0; i < reads; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 8) % size;
+			const uint32 len = 1 + (seed >> 4) % sizeof(buffer);
+
+			stream->seek(pos);
+			const uint32 got = stream->read(buffer, len);
+			if (got != MIN(len, size - pos))
+				errors++;
+			for (uint32 j = 0; j < got; j++) {
+				if (buffer[j] != reference[pos + j])
+					errors++;
+			}
+			bytesRead += got;
+		}
+		return errors;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_mapped_file() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+		uint32 size = 0;
+		byte *reference = readTestFile(size);
+		TS_ASSERT(reference != nullptr);
+		if (!reference)
+			return;
+
+		Common::FSNode node(getTestFile());
+		Common::SeekableReadStream *stream = node.createReadStream();
+		TS_ASSERT(stream != nullptr);
+		if (!stream) {
+			delete[] reference;
+			return;
+		}
+
+		TS_ASSERT_EQUALS(stream->size(), (int64)size);
+
+		// Files are only mapped when asked to
+		const byte *data = stream->getMappedData();
+		TS_ASSERT(data != nullptr);
+		if (data)
+			TS_ASSERT_SAME_DATA(data, reference, size);
+		TS_ASSERT_EQUALS(stream->getMappedData(), data);
+
+		// The stream itself still reads the file
+		uint32 bytesRead = 0;
+		TS_ASSERT_EQUALS(randomReads(stream, reference, 1000, bytesRead), 0u);
+
+		// Reading past the end stops at the end of the file
+		byte buffer[16];
+		TS_ASSERT(stream->seek(-4, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 4u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT_EQUALS(buffer[3], reference[size - 1]);
+
+		// Sub streams expose their part of the mapping
+		Common::SeekableSubReadStream sub(stream, 1000, 2000);
+		TS_ASSERT_EQUALS(sub.getMappedData(), data ? data + 1000 : nullptr);
+
+		delete stream;
+		delete[] reference;
+#endif
+	}
+
+	void test_memory_stream_data() {
+		byte contents[] = { 1, 2, 3, 4 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+		ms.skip(2);
+		TS_ASSERT_EQUALS(ms.getMappedData(), (const byte *)contents);
+	}
+
+	void test_random_read_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(POSIX)
+#ifdef SLOW_TESTS
+		const int reads = 2000000;
+#else
+		const int reads = 20000;
+#endif
+		uint32 size = 0;
+		byte *reference = readTestFile(size);
+		TS_ASSERT(reference != nullptr);
+		if (!reference)
+			return;
+
+		Common::FSNode node(getTestFile());
+		Common::SeekableReadStream *file = node.createReadStream();
+		const byte *data = file ? file->getMappedData() : nullptr;
+		TS_ASSERT(data != nullptr);
+
+		Common::SeekableReadStream *streams[] = {
+			StdioStream::makeFromPath(getTestFile(), false),
+			data ? new Common::MemoryReadStream(data, size) : nullptr
+		};
+		const char *names[] = { "stdio", "mapped" };
+
+		for (int i = 0; i < ARRAYSIZE(streams); i++) {
+			TS_ASSERT(streams[i] != nullptr);
+			if (!streams[i])
+				continue;
+
+			uint32 bytesRead = 0;
+			uint32 start = g_system->getMillis();
+			TS_ASSERT_EQUALS(randomReads(streams[i], reference, reads, bytesRead), 0u);
+			uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			debug("FileStream %s: %d random reads, %u bytes in %u ms (%f reads/s, %f MB/s)", names[i],
+			      reads, bytesRead, time, reads * 1000.0 / time, bytesRead / 1024.0 / 1024.0 * 1000.0 / time);
+			delete streams[i];
+		}
+
+		delete file;
+		delete[] reference;
+#endif
+	}
+};
@@ -1,7 +1,11 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/hashmap.h"
+#include "common/debug.h"
 #include "common/hash-str.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
 
 class HashMapTestSuite : public CxxTest::TestSuite
 {
@@ -230,5 +234,167 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_flat_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 1000; i++)
+			container[i * 7] = i;
+		TS_ASSERT_EQUALS(container.size(), 1000u);
+		for (int i = 0; i < 1000; i++) {
+			TS_ASSERT(container.contains(i * 7));
+			TS_ASSERT(!container.contains(i * 7 + 1));
+			TS_ASSERT_EQUALS(container.getVal(i * 7), i);
+		}
+		for (int i = 0; i < 1000; i += 2)
+			container.erase(i * 7);
+		TS_ASSERT_EQUALS(container.size(), 500u);
+		for (int i = 0; i < 1000; i++)
+			TS_ASSERT_EQUALS(container.contains(i * 7), (i & 1) != 0);
+		TS_ASSERT_EQUALS(container.getValOrDefault(0, -1), -1);
+
+		int val = 0;
+		TS_ASSERT(container.tryGetVal(7, val));
+		TS_ASSERT_EQUALS(val, 1);
+
+		container.clear(true);
+		TS_ASSERT(container.empty());
+		TS_ASSERT(container.begin() == container.end());
+	}
+
+	void test_flat_string_map() {
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container;
+		container["foo"] = "bar";
+		container["quux"] = "blub";
+		TS_ASSERT(container.contains("FOO"));
+		TS_ASSERT_EQUALS(container["Quux"], "blub");
+		container.erase("foo");
+		TS_ASSERT(!container.contains("foo"));
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> copy(container);
+		container.clear();
+		TS_ASSERT_EQUALS(copy.size(), 1u);
+		TS_ASSERT_EQUALS(copy["quux"], "blub");
+	}
+
+	void test_flat_collision() {
+		// All keys share one hash value, so the probe sequences overlap
+		// and erasing has to shift the following elements back.
+		struct ConstantHash {
+			uint operator()(int) const { return 42; }
+		};
+		Common::FlatHashMap<int, int, ConstantHash> h;
+		for (int i = 0; i < 100; i++)
+			h[i] = i;
+		for (int i = 0; i < 100; i += 3)
+			h.erase(i);
+		for (int i = 0; i < 100; i++) {
+			TS_ASSERT_EQUALS(h.contains(i), i % 3 != 0);
+			if (i % 3)
+				TS_ASSERT_EQUALS(h[i], i);
+		}
+	}
+
+	void test_flat_iterator() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 20; i++)
+			container[i] = i * 2;
+		container.erase(3);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::const_iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_value, i->_key * 2);
+			TS_ASSERT(!(found & (1 << i->_key)));
+			found |= 1 << i->_key;
+		}
+		TS_ASSERT_EQUALS(found, 0xFFFFF & ~(1 << 3));
+
+		Common::FlatHashMap<int, int>::iterator j = container.find(5);
+		TS_ASSERT(j != container.end());
+		container.erase(j);
+		TS_ASSERT(!container.contains(5));
+		TS_ASSERT(container.find(5) == container.end());
+	}
+
+	void test_flat_matches_hashmap() {
+		Common::HashMap<uint, uint> reference;
+		Common::FlatHashMap<uint, uint> container;
+
+		uint32 seed = 12345;
+		for (int i = 0; i < 20000; i++) {
+			seed = seed * 1103515245 + 12345;
+			uint key = (seed >> 8) % 4096;
+			if (seed & 0x10000) {
+				reference[key] = i;
+				container[key] = i;
+			} else {
+				reference.erase(key);
+				container.erase(key);
+			}
+		}
+
+		TS_ASSERT_EQUALS(container.size(), reference.size());
+		for (Common::HashMap<uint, uint>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(container.getValOrDefault(i->_key, 0xFFFFFFFF), i->_value);
+		for (Common::FlatHashMap<uint, uint>::const_iterator i = container.begin(); i != container.end(); ++i)
+			TS_ASSERT(reference.contains(i->_key));
+	}
+
+	template<class Map, class Key>
+	static uint32 benchmarkMap(const Key *keys, uint numKeys, uint rounds) {
+		uint32 start = g_system->getMillis();
+		uint sum = 0;
+		for (uint r = 0; r < rounds; r++) {
+			Map map;
+			for (uint i = 0; i < numKeys; i++)
+				map[keys[i]] = i;
+			// Half of the lookups miss, and they are not done in insertion
+			// order to avoid favoring pool allocated nodes.
+			for (uint n = 0; n < 4; n++) {
+				for (uint i = 0; i < numKeys * 2; i++)
+					sum += map.getValOrDefault(keys[(i * 7919) % (numKeys * 2)], 1);
+			}
+			for (uint i = 0; i < numKeys; i += 2)
+				map.erase(keys[i]);
+			sum += map.size();
+		}
+		TS_ASSERT_DIFFERS(sum, 0u);
+		return g_system->getMillis() - start;
+	}
+
+	void test_flat_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#ifdef SLOW_TESTS
+		const uint rounds = 100;
+#else
+		const uint rounds = 1;
+#endif
+		const uint maxKeys = 100000;
+		uint *intKeys = new uint[maxKeys * 2];
+		Common::String *stringKeys = new Common::String[maxKeys * 2];
+		uint32 seed = 1;
+		for (uint i = 0; i < maxKeys * 2; i++) {
+			seed = seed * 1103515245 + 12345;
+			intKeys[i] = seed ^ (seed >> 15);
+			stringKeys[i] = Common::String::format("resource%u.dat", intKeys[i]);
+		}
+
+		const uint sizes[] = { 16, 1000, maxKeys };
+		for (int i = 0; i < ARRAYSIZE(sizes); i++) {
+			const uint n = rounds * (maxKeys / sizes[i]);
+			uint32 chained = benchmarkMap<Common::HashMap<uint, uint> >(intKeys, sizes[i], n);
+			uint32 flat = benchmarkMap<Common::FlatHashMap<uint, uint> >(intKeys, sizes[i], n);
+			debug("%u int keys: HashMap %u ms, FlatHashMap %u ms", sizes[i], chained, flat);
+
+			chained = benchmarkMap<Common::HashMap<Common::String, uint> >(stringKeys, sizes[i], n);
+			flat = benchmarkMap<Common::FlatHashMap<Common::String, uint> >(stringKeys, sizes[i], n);
+			debug("%u string keys: HashMap %u ms, FlatHashMap %u ms", sizes[i], chained, flat);
+		}
+
+		delete[] intKeys;
+		delete[] stringKeys;
+#endif
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
@@ -0,0 +1,66 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/system.h"
+#include "common/thread.h"
+
+#include "../null_osystem.h"
+
+class ThreadTestSuite : public CxxTest::TestSuite {
+private:
+	struct Job {
+		Common::Array<uint> counts;
+		bool nested;
+	};
+
+	static void countTask(void *param, uint task) {
+		Job *job = (Job *)param;
+		job->counts[task]++;
+
+		// Tasks started while the workers are busy run on the calling thread
+		if (job->nested) {
+			Job inner;
+			inner.counts.resize(8);
+			inner.nested = false;
+			Common::runTasks(countTask, &inner, inner.counts.size(), 4);
+			for (uint i = 0; i < inner.counts.size(); i++)
+				job->counts[task] += inner.counts[i];
+		}
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_run_tasks() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// The same workers are used again for each call
+		for (int i = 0; i < 100; i++) {
+			Job job;
+			job.counts.resize(1 + i % 37);
+			job.nested = false;
+			Common::runTasks(countTask, &job, job.counts.size(), 4);
+
+			for (uint j = 0; j < job.counts.size(); j++)
+				TS_ASSERT_EQUALS(job.counts[j], 1u);
+		}
+#endif
+	}
+
+	void test_nested_tasks() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Job job;
+		job.counts.resize(16);
+		job.nested = true;
+		Common::runTasks(countTask, &job, job.counts.size(), 4);
+
+		for (uint i = 0; i < job.counts.size(); i++)
+			TS_ASSERT_EQUALS(job.counts[i], 9u);
+
+		Common::shutdownThreads();
+#endif
+	}
+};
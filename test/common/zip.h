@@ -0,0 +1,205 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/compression/unzip.h"
+
+#include "../null_osystem.h"
+
+class ZipArchiveTestSuite : public CxxTest::TestSuite {
+private:
+	static Common::Archive *openTheme(uint32 cacheSize) {
+		Common::FSNode node("test/engine-data/scummremastered.zip");
+		return Common::makeZipArchive(node, false, cacheSize);
+	}
+
+	// Reads all the members of the archive, and returns the number of them
+	// which differ from the reference archive
+	static int compareMembers(const Common::Archive *archive, const Common::Archive *reference, uint32 &bytesRead) {
+		Common::ArchiveMemberList members;
+		reference->listMembers(members);
+
+		int errors = 0;
+		for (Common::ArchiveMemberList::const_iterator i = members.begin(); i != members.end(); ++i) {
+			const Common::Path path = (*i)->getPathInArchive();
+			Common::SeekableReadStream *a = archive->createReadStreamForMember(path);
+			Common::SeekableReadStream *b = reference->createReadStreamForMember(path);
+			if (!a || !b || a->size() != b->size()) {
+				errors++;
+			} else {
+				byte *dataA = new byte[a->size()];
+				byte *dataB = new byte[b->size()];
+				if (a->read(dataA, a->size()) != (uint32)a->size() ||
+				    b->read(dataB, b->size()) != (uint32)b->size() ||
+				    memcmp(dataA, dataB, a->size()) != 0)
+					errors++;
+				bytesRead += a->size();
+				delete[] dataA;
+				delete[] dataB;
+			}
+			delete a;
+			delete b;
+		}
+		return errors;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_prefetched_members_match() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::Archive *reference = openTheme(0);
+		Common::Archive *archive = openTheme(1024 * 1024);
+		TS_ASSERT(reference != nullptr && archive != nullptr);
+		if (!reference || !archive) {
+			delete reference;
+			delete archive;
+			return;
+		}
+
+		Common::ArchiveMemberList members;
+		TS_ASSERT_LESS_THAN(0, archive->listMembers(members));
+		archive->prefetchMembers(members);
+
+		uint32 bytesRead = 0;
+		TS_ASSERT_EQUALS(compareMembers(archive, reference, bytesRead), 0);
+		TS_ASSERT_LESS_THAN(0u, bytesRead);
+
+		// Members kept in memory are not decompressed again
+		const Common::Path path = members.front()->getPathInArchive();
+		Common::SeekableReadStream *a = archive->createReadStreamForMember(path);
+		Common::SeekableReadStream *b = archive->createReadStreamForMember(path);
+		TS_ASSERT(a != nullptr && b != nullptr);
+		if (a && b)
+			TS_ASSERT_EQUALS(a->getMappedData(), b->getMappedData());
+		delete a;
+		delete b;
+
+		delete archive;
+		delete reference;
+#endif
+	}
+
+	void test_member_cache_budget() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::Archive *reference = openTheme(0);
+		// Less than the largest member, so that it is never kept
+		Common::Archive *archive = openTheme(64 * 1024);
+		TS_ASSERT(reference != nullptr && archive != nullptr);
+		if (!reference || !archive) {
+			delete reference;
+			delete archive;
+			return;
+		}
+
+		Common::ArchiveMemberList members;
+		archive->listMembers(members);
+		archive->prefetchMembers(members);
+
+		// Read everything twice, so that members are evicted and read again
+		uint32 bytesRead = 0;
+		TS_ASSERT_EQUALS(compareMembers(archive, reference, bytesRead), 0);
+		TS_ASSERT_EQUALS(compareMembers(archive, reference, bytesRead), 0);
+
+		((Common::MemcachingCaseInsensitiveArchive *)archive)->setMemberCacheSize(0);
+		TS_ASSERT_EQUALS(compareMembers(archive, reference, bytesRead), 0);
+
+		delete archive;
+		delete reference;
+#endif
+	}
+
+	void test_index_cache() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// The reference parses its own index, which is then dropped from
+		// the cache, so that it is not shared with the other archives
+		Common::clearZipIndexCache();
+		Common::Archive *reference = openTheme(0);
+		Common::clearZipIndexCache();
+
+		Common::ZipIndexCacheStats before, after;
+		Common::getZipIndexCacheStats(before);
+
+		Common::Archive *first = openTheme(0);
+		Common::Archive *second = openTheme(0);
+		TS_ASSERT(reference != nullptr && first != nullptr && second != nullptr);
+
+		Common::getZipIndexCacheStats(after);
+		TS_ASSERT_EQUALS(after.indexes, 1u);
+		TS_ASSERT_EQUALS(after.hits, before.hits + 1);
+
+		// The archive using the cached index reads the same members as
+		// the reference, also once the index is freed from the cache
+		uint32 bytesRead = 0;
+		if (reference && second)
+			TS_ASSERT_EQUALS(compareMembers(second, reference, bytesRead), 0);
+		Common::clearZipIndexCache();
+		if (reference && first)
+			TS_ASSERT_EQUALS(compareMembers(first, reference, bytesRead), 0);
+		TS_ASSERT_LESS_THAN(0u, bytesRead);
+
+		Common::getZipIndexCacheStats(after);
+		TS_ASSERT_EQUALS(after.indexes, 0u);
+
+		delete first;
+		delete second;
+		delete reference;
+#endif
+	}
+
+	void test_open_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const int iterations = 200;
+#else
+		const int iterations = 5;
+#endif
+		const char *names[] = { "cold", "warm" };
+
+		for (int i = 0; i < ARRAYSIZE(names); i++) {
+			uint32 bytesRead = 0;
+			uint32 start = g_system->getMillis();
+			for (int iteration = 0; iteration < iterations; iteration++) {
+				// A cold start parses the central directory each time, and
+				// reads the members one by one
+				if (i == 0)
+					Common::clearZipIndexCache();
+
+				Common::Archive *archive = openTheme(i == 0 ? 0 : 1024 * 1024);
+				TS_ASSERT(archive != nullptr);
+				if (!archive)
+					return;
+
+				Common::ArchiveMemberList members;
+				archive->listMembers(members);
+				if (i == 1)
+					archive->prefetchMembers(members);
+
+				for (Common::ArchiveMemberList::const_iterator m = members.begin(); m != members.end(); ++m) {
+					Common::SeekableReadStream *stream = (*m)->createReadStream();
+					if (stream)
+						bytesRead += stream->size();
+					delete stream;
+				}
+				delete archive;
+			}
+			uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			debug("ZipArchive %s: %d opens, %u bytes in %u ms (%f ms per open)", names[i],
+			      iterations, bytesRead, time, (float)time / iterations);
+		}
+
+		Common::ZipIndexCacheStats stats;
+		Common::getZipIndexCacheStats(stats);
+		debug("ZipArchive: %u indexes, %u hits, %u misses", stats.indexes, stats.hits, stats.misses);
+#endif
+	}
+};
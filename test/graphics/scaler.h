@@ -0,0 +1,222 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/thread.h"
+
+#include "graphics/scalerplugin.h"
+
+#include "../null_osystem.h"
+
+PluginObject *g_NORMAL_getObject();
+#ifdef USE_SCALERS
+PluginObject *g_DOTMATRIX_getObject();
+PluginObject *g_SAI_getObject();
+PluginObject *g_SUPERSAI_getObject();
+PluginObject *g_SUPEREAGLE_getObject();
+PluginObject *g_PM_getObject();
+PluginObject *g_ADVMAME_getObject();
+PluginObject *g_TV_getObject();
+#endif
+#ifdef USE_HQ_SCALERS
+PluginObject *g_HQ_getObject();
+#endif
+#ifdef USE_EDGE_SCALERS
+PluginObject *g_EDGE_getObject();
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kPadding = 4
+	};
+
+	typedef PluginObject *(*GetObjectProc)();
+
+	static Common::Array<ScalerPluginObject *> createPlugins() {
+		const GetObjectProc procs[] = {
+			g_NORMAL_getObject,
+#ifdef USE_SCALERS
+			g_DOTMATRIX_getObject,
+			g_SAI_getObject,
+			g_SUPERSAI_getObject,
+			g_SUPEREAGLE_getObject,
+			g_PM_getObject,
+			g_ADVMAME_getObject,
+			g_TV_getObject,
+#endif
+#ifdef USE_HQ_SCALERS
+			g_HQ_getObject,
+#endif
+#ifdef USE_EDGE_SCALERS
+			g_EDGE_getObject,
+#endif
+		};
+
+		Common::Array<ScalerPluginObject *> plugins;
+		for (int i = 0; i < ARRAYSIZE(procs); i++)
+			plugins.push_back((ScalerPluginObject *)procs[i]());
+		return plugins;
+	}
+
+	static void deletePlugins(Common::Array<ScalerPluginObject *> &plugins) {
+		for (uint i = 0; i < plugins.size(); i++)
+			delete plugins[i];
+		plugins.clear();
+	}
+
+	// A padded RGB565 screen with solid blocks, gradients and noise, so that
+	// the edge detecting scalers have something to work on
+	struct Screen {
+		uint16 *pixels;
+		uint32 pitch;
+
+		Screen() {
+			pitch = (kWidth + kPadding * 2) * sizeof(uint16);
+			pixels = new uint16[(kWidth + kPadding * 2) * (kHeight + kPadding * 2)];
+			fill(0x12345678);
+		}
+
+		~Screen() {
+			delete[] pixels;
+		}
+
+		void fill(uint32 seed) {
+			const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+			for (int y = 0; y < kHeight + kPadding * 2; y++) {
+				for (int x = 0; x < kWidth + kPadding * 2; x++) {
+					seed = seed * 1103515245 + 12345;
+					uint16 color;
+					if (((x / 24) + (y / 16)) % 3 == 0)
+						color = format.RGBToColor((x / 24) * 16, (y / 16) * 16, 128);
+					else if (((x / 24) + (y / 16)) % 3 == 1)
+						color = format.RGBToColor(x, y, x + y);
+					else
+						color = seed >> 16;
+					pixels[y * (pitch / sizeof(uint16)) + x] = color;
+				}
+			}
+		}
+
+		const uint8 *getBasePtr(int x, int y) const {
+			return (const uint8 *)(pixels + (y + kPadding) * (pitch / sizeof(uint16)) + x + kPadding);
+		}
+	};
+
+	static Scaler *createScaler(const ScalerPluginObject *plugin, uint factor, uint threads, const Screen &screen) {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		Scaler *scaler = plugin->createInstance(format);
+		scaler->setFactor(factor);
+		scaler->setThreadCount(threads);
+		if (plugin->useOldSource()) {
+			scaler->enableSource(true);
+			scaler->setSource((const byte *)screen.pixels, screen.pitch, kWidth, kHeight, kPadding);
+		}
+		return scaler;
+	}
+
+	static void scaleRect(Scaler *scaler, const Screen &screen, uint8 *dst, uint32 dstPitch, const Common::Rect &r) {
+		const uint factor = scaler->getFactor();
+		scaler->scale(screen.getBasePtr(r.left, r.top), screen.pitch,
+		              dst + r.top * factor * dstPitch + r.left * factor * sizeof(uint16), dstPitch,
+		              r.width(), r.height(), r.left, r.top);
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_threaded_scaling_matches() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::Array<ScalerPluginObject *> plugins = createPlugins();
+		Screen screen;
+
+		const Common::Rect rects[] = {
+			Common::Rect(kWidth, kHeight),
+			Common::Rect(7, 5, 301, 122),
+			Common::Rect(0, 0, kWidth, 40)
+		};
+
+		for (uint i = 0; i < plugins.size(); i++) {
+			const Common::Array<uint> &factors = plugins[i]->getFactors();
+			for (uint f = 0; f < factors.size(); f++) {
+				const uint32 dstPitch = kWidth * factors[f] * sizeof(uint16);
+				const uint32 dstSize = dstPitch * kHeight * factors[f];
+				uint8 *single = new uint8[dstSize]();
+				uint8 *threaded = new uint8[dstSize]();
+
+				screen.fill(0x12345678);
+				Scaler *singleScaler = createScaler(plugins[i], factors[f], 1, screen);
+				Scaler *threadedScaler = createScaler(plugins[i], factors[f], 4, screen);
+
+				// Scale changing frames, so the scalers keeping the old
+				// source have to merge them with their previous output
+				for (int r = 0; r < ARRAYSIZE(rects); r++) {
+					screen.fill(0x12345678 + r * 13);
+					scaleRect(singleScaler, screen, single, dstPitch, rects[r]);
+					scaleRect(threadedScaler, screen, threaded, dstPitch, rects[r]);
+					if (memcmp(single, threaded, dstSize) != 0) {
+						TS_FAIL(Common::String::format("%s %ux, rect %d differs", plugins[i]->getPrettyName(), factors[f], r).c_str());
+						break;
+					}
+				}
+
+				delete singleScaler;
+				delete threadedScaler;
+				delete[] single;
+				delete[] threaded;
+			}
+		}
+
+		deletePlugins(plugins);
+#endif
+	}
+
+	void test_scaler_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const int frames = 200;
+#else
+		const int frames = 4;
+#endif
+		Common::Array<ScalerPluginObject *> plugins = createPlugins();
+		Screen screens[2];
+		screens[1].fill(0x87654321);
+		const uint threads[] = { 1, 0 };
+
+		debug("Scaler: %u threads available", Common::getMaxThreads());
+		for (uint i = 0; i < plugins.size(); i++) {
+			const Common::Array<uint> &factors = plugins[i]->getFactors();
+			for (uint f = 0; f < factors.size(); f++) {
+				const uint32 dstPitch = kWidth * factors[f] * sizeof(uint16);
+				uint8 *dst = new uint8[dstPitch * kHeight * factors[f]];
+
+				for (int t = 0; t < ARRAYSIZE(threads); t++) {
+					Scaler *scaler = createScaler(plugins[i], factors[f], threads[t], screens[0]);
+
+					// Alternate between two screens, so that the scalers keeping
+					// the old source can not skip the pixels
+					uint32 start = g_system->getMillis();
+					for (int frame = 0; frame < frames; frame++)
+						scaleRect(scaler, screens[frame & 1], dst, dstPitch, Common::Rect(kWidth, kHeight));
+					uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+					debug("Scaler %s %ux, %s: %d frames in %u ms (%f ms per frame)", plugins[i]->getPrettyName(), factors[f],
+					      threads[t] == 1 ? "single thread" : "threaded", frames, time, (float)time / frames);
+					delete scaler;
+				}
+
+				delete[] dst;
+			}
+		}
+
+		deletePlugins(plugins);
+#endif
+	}
+};
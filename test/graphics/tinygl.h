@@ -0,0 +1,124 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/config-manager.h"
+#include "common/system.h"
+#include "common/thread.h"
+
+#include "graphics/surface.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/tinygl.h"
+#endif
+
+#include "../null_osystem.h"
+
+class TinyGLTestSuite : public CxxTest::TestSuite {
+private:
+#ifdef USE_TINYGL
+	static void drawScene(int frame) {
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglFrustum(-1.0, 1.0, -0.75, 0.75, 1.0, 10.0);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglTranslatef(0.0f, 0.0f, -3.0f);
+		tglRotatef(10.0f + frame * 25.0f, 0.3f, 1.0f, 0.2f);
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglShadeModel(TGL_SMOOTH);
+
+		// Intersecting triangles, which cover most of the tiles
+		tglBegin(TGL_TRIANGLES);
+		tglColor3f(1.0f, 0.0f, 0.0f);
+		tglVertex3f(-1.5f, -1.2f, 0.5f);
+		tglColor3f(0.0f, 1.0f, 0.0f);
+		tglVertex3f(1.5f, -1.0f, -0.5f);
+		tglColor3f(0.0f, 0.0f, 1.0f);
+		tglVertex3f(0.0f, 1.4f, 0.0f);
+
+		tglColor3f(1.0f, 1.0f, 0.0f);
+		tglVertex3f(-1.2f, 1.0f, -0.7f);
+		tglColor3f(0.0f, 1.0f, 1.0f);
+		tglVertex3f(1.3f, 1.1f, 0.6f);
+		tglColor3f(1.0f, 0.0f, 1.0f);
+		tglVertex3f(0.1f, -1.3f, 0.2f);
+		tglEnd();
+
+		// A blended quad in front of them
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		tglBegin(TGL_QUADS);
+		tglColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+		tglVertex3f(-0.6f, -0.4f, 0.8f);
+		tglVertex3f(0.7f, -0.5f, 0.8f);
+		tglColor4f(0.2f, 0.8f, 0.2f, 0.3f);
+		tglVertex3f(0.6f, 0.6f, 0.8f);
+		tglVertex3f(-0.5f, 0.5f, 0.8f);
+		tglEnd();
+		tglDisable(TGL_BLEND);
+	}
+
+	// Renders a few frames of the scene with the given number of raster
+	// threads, and returns a copy of the last one
+	static void renderScene(int threads, bool dirtyRects, Graphics::Surface &result) {
+		ConfMan.setInt("tinygl_threads", threads);
+		TinyGL::ContextHandle *context = TinyGL::createContext(320, 240, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), 256, false, dirtyRects);
+		ConfMan.removeKey("tinygl_threads", Common::ConfigManager::kApplicationDomain);
+
+		for (int frame = 0; frame < 3; frame++) {
+			drawScene(frame);
+			TinyGL::presentBuffer();
+		}
+
+		Graphics::Surface surface;
+		TinyGL::getSurfaceRef(surface);
+		result.copyFrom(surface);
+
+		TinyGL::destroyContext(context);
+	}
+
+	static int countDifferentPixels(const Graphics::Surface &a, const Graphics::Surface &b) {
+		int different = 0;
+		for (int y = 0; y < a.h; y++) {
+			for (int x = 0; x < a.w; x++) {
+				if (a.getPixel(x, y) != b.getPixel(x, y))
+					different++;
+			}
+		}
+		return different;
+	}
+#endif
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_tiled_matches_serial() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_TINYGL)
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			Graphics::Surface serial, tiled;
+			renderScene(1, dirtyRects, serial);
+			renderScene(4, dirtyRects, tiled);
+
+			TS_ASSERT_EQUALS(serial.w, tiled.w);
+			TS_ASSERT_EQUALS(serial.h, tiled.h);
+			TS_ASSERT_EQUALS(countDifferentPixels(serial, tiled), 0);
+
+			// The scene is not just the clear color
+			TS_ASSERT_DIFFERS(serial.getPixel(160, 120), serial.getPixel(0, 0));
+
+			serial.free();
+			tiled.free();
+		}
+
+		Common::shutdownThreads();
+#endif
+	}
+};
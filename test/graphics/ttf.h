@@ -0,0 +1,186 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/fs.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/font.h"
+#include "graphics/surface.h"
+#include "graphics/fonts/ttf.h"
+
+#include "../null_osystem.h"
+
+class TTFFontTestSuite : public CxxTest::TestSuite {
+private:
+#ifdef USE_FREETYPE2
+	static Graphics::Font *loadFont(int size) {
+		Common::FSNode node("test/engine-data/FreeSans.ttf");
+		Common::SeekableReadStream *stream = node.createReadStream();
+		if (!stream)
+			return nullptr;
+		return Graphics::loadTTFFont(stream, DisposeAfterUse::YES, size);
+	}
+
+	// Draws the string the way Font::drawString does without a string cache
+	static void drawGlyphByGlyph(const Graphics::Font *font, Graphics::Surface *dst, const Common::U32String &str, int x, int y, uint32 color) {
+		uint32 last = 0;
+		for (uint i = 0; i < str.size(); i++) {
+			x += font->getKerningOffset(last, str[i]);
+			last = str[i];
+			font->drawChar(dst, str[i], x, y, color);
+			x += font->getCharWidth(str[i]);
+		}
+	}
+
+	static bool sameSurface(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	static void createSurface(Graphics::Surface &surf, const Graphics::PixelFormat &format) {
+		surf.create(320, 40, format);
+		for (int y = 0; y < surf.h; y++)
+			for (int x = 0; x < surf.w; x++)
+				surf.setPixel(x, y, format.RGBToColor(x % 256, y * 4, 64));
+	}
+#endif
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_cached_string_matches_glyphs() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_FREETYPE2)
+		Graphics::Font *font = loadFont(16);
+		TS_ASSERT(font != nullptr);
+		if (!font)
+			return;
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)
+		};
+		const Common::U32String str("Sphinx of black quartz, judge my vow.");
+
+		for (int i = 0; i < ARRAYSIZE(formats); i++) {
+			Graphics::Surface cached, reference;
+			createSurface(cached, formats[i]);
+			createSurface(reference, formats[i]);
+			const uint32 color = formats[i].RGBToColor(255, 255, 255);
+
+			// The second call is served from the layout cache
+			font->drawString(&cached, str, 4, 2, 300, color);
+			font->drawString(&cached, str, 4, 20, 300, color);
+			drawGlyphByGlyph(font, &reference, str, 4, 2, color);
+			drawGlyphByGlyph(font, &reference, str, 4, 20, color);
+			TS_ASSERT(sameSurface(cached, reference));
+
+			cached.free();
+			reference.free();
+		}
+
+		TS_ASSERT_EQUALS(font->getStringWidth(str), font->getStringWidth(Common::String("Sphinx of black quartz, judge my vow.")));
+
+		Graphics::TTFCacheStats stats;
+		TS_ASSERT(Graphics::getTTFCacheStats(font, stats));
+		TS_ASSERT_LESS_THAN(0u, stats.stringHits);
+		TS_ASSERT_EQUALS(stats.strings, 1u);
+
+		delete font;
+#endif
+	}
+
+	void test_glyph_cache_budget() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_FREETYPE2)
+		Graphics::Font *font = loadFont(24);
+		Graphics::Font *reference = loadFont(24);
+		TS_ASSERT(font != nullptr && reference != nullptr);
+		if (!font || !reference) {
+			delete font;
+			delete reference;
+			return;
+		}
+
+		// Keep a single page, so drawing many glyphs keeps evicting them
+		Graphics::setTTFGlyphCacheSize(font, 1);
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::Surface a, b;
+		createSurface(a, format);
+		createSurface(b, format);
+
+		for (uint32 first = 0x21; first < 0x250; first += 16) {
+			for (uint32 chr = first; chr < first + 16; chr++) {
+				a.fillRect(Common::Rect(a.w, a.h), 0);
+				b.fillRect(Common::Rect(b.w, b.h), 0);
+				font->drawChar(&a, chr, 10, 4, 0xFFFFFFFF);
+				reference->drawChar(&b, chr, 10, 4, 0xFFFFFFFF);
+				TS_ASSERT(sameSurface(a, b));
+			}
+		}
+
+		Graphics::TTFCacheStats stats;
+		TS_ASSERT(Graphics::getTTFCacheStats(font, stats));
+		TS_ASSERT_EQUALS(stats.atlasPages, 1u);
+		TS_ASSERT_LESS_THAN(0u, stats.atlasEvictions);
+
+		a.free();
+		b.free();
+		delete font;
+		delete reference;
+#endif
+	}
+
+	void test_text_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_FREETYPE2)
+		Graphics::Font *font = loadFont(16);
+		TS_ASSERT(font != nullptr);
+		if (!font)
+			return;
+
+#ifdef SLOW_TESTS
+		const int iterations = 20000;
+#else
+		const int iterations = 500;
+#endif
+		const char *lines[] = {
+			"The quick brown fox jumps over the lazy dog.",
+			"Pack my box with five dozen liquor jugs!",
+			"Load game", "Save game", "Options", "Quit"
+		};
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::Surface surf;
+		surf.create(320, 200, format);
+
+		uint32 glyphs = 0;
+		uint32 start = g_system->getMillis();
+		for (int i = 0; i < iterations; i++) {
+			for (int line = 0; line < ARRAYSIZE(lines); line++) {
+				const Common::String str(lines[line]);
+				font->drawString(&surf, str, 0, line * 20, 320, 0xFFFFFFFF, Graphics::kTextAlignCenter);
+				glyphs += str.size();
+			}
+		}
+		uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		Graphics::TTFCacheStats stats;
+		TS_ASSERT(Graphics::getTTFCacheStats(font, stats));
+		debug("TTFFont: %u glyphs in %u ms (%f glyphs/s)", glyphs, time, glyphs * 1000.0 / time);
+		debug("TTFFont: %u glyphs, %u atlas pages using %u of %u bytes, %u renders, %u evictions",
+		      stats.glyphs, stats.atlasPages, stats.atlasBytes, stats.atlasBudget, stats.glyphRenders, stats.atlasEvictions);
+		debug("TTFFont: %u strings using %u bytes, %u hits, %u misses",
+		      stats.strings, stats.stringBytes, stats.stringHits, stats.stringMisses);
+
+		surf.free();
+		delete font;
+#endif
+	}
+};
@@ -0,0 +1,228 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "test/instrset_detect.h"
+#include "../null_osystem.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+private:
+	typedef Graphics::YUVToRGBKernel::RowFunc RowFunc;
+
+	enum Layout {
+		kLayout444,
+		kLayout422,
+		kLayout420,
+		kLayout420Alpha,
+		kLayout410
+	};
+
+	struct Planes {
+		byte *y, *u, *v, *a;
+		int width, height;
+
+		Planes(int w, int h) : width(w), height(h) {
+			uint32 seed = 0x12345678;
+			y = createPlane(seed);
+			u = createPlane(seed);
+			v = createPlane(seed);
+			a = createPlane(seed);
+		}
+
+		~Planes() {
+			delete[] y;
+			delete[] u;
+			delete[] v;
+			delete[] a;
+		}
+
+		byte *createPlane(uint32 &seed) {
+			byte *plane = new byte[width * height];
+			for (int i = 0; i < width * height; i++) {
+				seed = seed * 1103515245 + 12345;
+				plane[i] = seed >> 24;
+			}
+			return plane;
+		}
+	};
+
+	// The chroma planes use the same pitch as the luma plane, which is
+	// large enough for every layout
+	static void convert(Graphics::Surface &dst, Layout layout, Graphics::YUVToRGBManager::LuminanceScale scale, const Planes &planes) {
+		switch (layout) {
+		case kLayout444:
+			YUVToRGBMan.convert444(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.width, planes.width);
+			break;
+		case kLayout422:
+			YUVToRGBMan.convert422(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.width, planes.width);
+			break;
+		case kLayout420:
+			YUVToRGBMan.convert420(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.width, planes.width);
+			break;
+		case kLayout420Alpha:
+			YUVToRGBMan.convert420Alpha(&dst, scale, planes.y, planes.u, planes.v, planes.a, planes.width, planes.height, planes.width, planes.width);
+			break;
+		case kLayout410:
+			YUVToRGBMan.convert410(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.width, planes.width);
+			break;
+		}
+	}
+
+	static bool sameSurface(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	// Collects the kernels the CPU can run, the generic one first
+	static int getKernels(RowFunc *funcs, const char **names) {
+		int count = 0;
+		funcs[count] = Graphics::YUVToRGBKernel::rowGeneric;
+		names[count++] = "generic";
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			funcs[count] = Graphics::YUVToRGBKernel::rowSSE2;
+			names[count++] = "SSE2";
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			funcs[count] = Graphics::YUVToRGBKernel::rowAVX2;
+			names[count++] = "AVX2";
+		}
+#endif
+		return count;
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+		// The null backend can not report CPU features, so pick the
+		// kernel here instead of leaving it to YUVToRGBKernel.
+		Graphics::YUVToRGBKernel::rowFunc = Graphics::YUVToRGBKernel::rowGeneric;
+		YUVToRGBMan.setThreadCount(1);
+	}
+
+	void tearDown() {
+		YUVToRGBMan.setThreadCount(1);
+	}
+
+	void test_kernels_match() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		RowFunc funcs[3];
+		const char *names[3];
+		const int numKernels = getKernels(funcs, names);
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull, Graphics::YUVToRGBManager::kScaleITU
+		};
+
+		// Wider than a chunk, and not a multiple of the vector width
+		Planes planes(1096, 8);
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface reference, result;
+			reference.create(planes.width, planes.height, formats[f]);
+			result.create(planes.width, planes.height, formats[f]);
+
+			for (int s = 0; s < ARRAYSIZE(scales); s++) {
+				for (int layout = kLayout444; layout <= kLayout410; layout++) {
+					Graphics::YUVToRGBKernel::rowFunc = funcs[0];
+					convert(reference, (Layout)layout, scales[s], planes);
+
+					for (int k = 1; k < numKernels; k++) {
+						memset(result.getPixels(), 0, result.pitch * result.h);
+						Graphics::YUVToRGBKernel::rowFunc = funcs[k];
+						convert(result, (Layout)layout, scales[s], planes);
+						TSM_ASSERT(names[k], sameSurface(reference, result));
+					}
+				}
+			}
+
+			reference.free();
+			result.free();
+		}
+#endif
+	}
+
+	void test_threaded_conversion_matches() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Planes planes(1280, 720);
+		const Graphics::PixelFormat format(4, 8, 8, 8, 0, 16, 8, 0, 0);
+
+		Graphics::Surface reference, result;
+		reference.create(planes.width, planes.height, format);
+		result.create(planes.width, planes.height, format);
+
+		for (int layout = kLayout444; layout <= kLayout410; layout++) {
+			YUVToRGBMan.setThreadCount(1);
+			convert(reference, (Layout)layout, Graphics::YUVToRGBManager::kScaleITU, planes);
+
+			memset(result.getPixels(), 0, result.pitch * result.h);
+			YUVToRGBMan.setThreadCount(4);
+			convert(result, (Layout)layout, Graphics::YUVToRGBManager::kScaleITU, planes);
+			TS_ASSERT(sameSurface(reference, result));
+		}
+
+		reference.free();
+		result.free();
+#endif
+	}
+
+	void test_conversion_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const int frames = 200;
+#else
+		const int frames = 4;
+#endif
+		RowFunc funcs[3];
+		const char *names[3];
+		const int numKernels = getKernels(funcs, names);
+
+		const char *formatNames[] = { "RGB565", "XRGB8888", "ARGB8888" };
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24)
+		};
+
+		Planes planes(1280, 720);
+
+		for (int f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface surf;
+			surf.create(planes.width, planes.height, formats[f]);
+
+			for (int k = 0; k < numKernels; k++) {
+				Graphics::YUVToRGBKernel::rowFunc = funcs[k];
+
+				uint32 start = g_system->getMillis();
+				for (int i = 0; i < frames; i++)
+					convert(surf, kLayout420, Graphics::YUVToRGBManager::kScaleITU, planes);
+				uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+				const double pixels = (double)planes.width * planes.height * frames;
+				debug("YUVToRGB %s %s: %d frames in %u ms (%f megapixels/s)", names[k], formatNames[f], frames, time, pixels / 1000.0 / time);
+			}
+
+			surf.free();
+		}
+#endif
+	}
+};
@@ -0,0 +1,102 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/hashmap.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "graphics/managed_surface.h"
+
+#include "gui/ThemeCache.h"
+
+class ThemeCacheTestSuite : public CxxTest::TestSuite {
+private:
+	typedef Common::HashMap<Common::String, Graphics::ManagedSurface *> ImagesMap;
+
+	static void record(GUI::ThemeCache &cache) {
+		cache.recordTextColor(GUI::kTextColorNormal, 1, 2, 3);
+		cache.recordDialog("GlobalOptions", "", -1, -1, 0);
+		cache.recordLayout(GUI::ThemeLayout::kLayoutVertical, 8, GUI::ThemeLayout::kItemAlignStart);
+		cache.recordWidget("Ok", "Button", 72, 16, Graphics::kTextAlignCenter, false);
+		cache.recordPadding(1, 2, 3, 4);
+		cache.recordCloseLayout();
+		cache.recordCloseDialog();
+	}
+
+public:
+	void test_round_trip() {
+		GUI::ThemeCache cache;
+		record(cache);
+
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		TS_ASSERT(cache.save(data, "key", ImagesMap()));
+
+		GUI::ThemeCache loaded;
+		Common::MemoryReadStream stream(data.getData(), data.size());
+		TS_ASSERT(loaded.load(stream, "key"));
+		TS_ASSERT_EQUALS(loaded.getCallCount(), cache.getCallCount());
+
+		// The loaded calls are saved again unchanged
+		Common::MemoryWriteStreamDynamic again(DisposeAfterUse::YES);
+		TS_ASSERT(loaded.save(again, "key", ImagesMap()));
+		TS_ASSERT_EQUALS(again.size(), data.size());
+		TS_ASSERT_SAME_DATA(again.getData(), data.getData(), data.size());
+
+		// Only an empty cache can be loaded
+		stream.seek(0);
+		TS_ASSERT(!loaded.load(stream, "key"));
+	}
+
+	void test_round_trip_bitmap() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		Graphics::ManagedSurface surface(3, 2, format);
+		for (int y = 0; y < surface.h; ++y) {
+			for (int x = 0; x < surface.w; ++x)
+				surface.setPixel(x, y, format.ARGBToColor(255, x * 80, y * 100, 7));
+		}
+
+		ImagesMap bitmaps;
+		bitmaps["logo.bmp"] = &surface;
+
+		GUI::ThemeCache cache;
+		cache.recordBitmap("logo.bmp", "", 3, 2);
+		record(cache);
+
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		TS_ASSERT(cache.save(data, "key", bitmaps));
+
+		GUI::ThemeCache loaded;
+		Common::MemoryReadStream stream(data.getData(), data.size());
+		TS_ASSERT(loaded.load(stream, "key"));
+		TS_ASSERT_EQUALS(loaded.getCallCount(), cache.getCallCount());
+
+		// A truncated cache is not loaded
+		GUI::ThemeCache truncated;
+		Common::MemoryReadStream partial(data.getData(), data.size() - 1);
+		TS_ASSERT(!truncated.load(partial, "key"));
+		TS_ASSERT_EQUALS(truncated.getCallCount(), 0u);
+
+		// Nothing is kept from it, including the bitmaps read before the
+		// calls, so that the cache can still load a complete copy
+		stream.seek(0);
+		TS_ASSERT(truncated.load(stream, "key"));
+		TS_ASSERT_EQUALS(truncated.getCallCount(), cache.getCallCount());
+	}
+
+	void test_key_mismatch() {
+		GUI::ThemeCache cache;
+		record(cache);
+
+		Common::MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+		TS_ASSERT(cache.save(data, "1.0|scummremastered|THEMERC|a.stx:01234567|640x400", ImagesMap()));
+
+		GUI::ThemeCache loaded;
+		Common::MemoryReadStream stream(data.getData(), data.size());
+		TS_ASSERT(!loaded.load(stream, "1.0|scummremastered|THEMERC|a.stx:89abcdef|640x400"));
+		TS_ASSERT_EQUALS(loaded.getCallCount(), 0u);
+
+		// The cache is left empty, so that it can still load the right key
+		stream.seek(0);
+		TS_ASSERT(loaded.load(stream, "1.0|scummremastered|THEMERC|a.stx:01234567|640x400"));
+		TS_ASSERT_EQUALS(loaded.getCallCount(), cache.getCallCount());
+	}
+};
@@ -0,0 +1,352 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/intrinsics.h"
+#include "common/memstream.h"
+#include "common/random.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/thread.h"
+#include "common/util.h"
+
+#include "graphics/surface.h"
+
+#include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
+
+#include "test/instrset_detect.h"
+#include "../null_osystem.h"
+
+class BinkDSPTestSuite : public CxxTest::TestSuite {
+private:
+#ifdef USE_BINK
+	/** Writes bits the way Common::BitStream32LELSB reads them. */
+	class BitWriter {
+	public:
+		BitWriter() : _value(0), _bits(0) {}
+
+		void putBits(uint32 value, int n) {
+			for (int i = 0; i < n; i++) {
+				if (value & (1 << i))
+					_value |= 1 << _bits;
+				if (++_bits == 32)
+					flushWord();
+			}
+		}
+
+		void align() {
+			if (_bits)
+				flushWord();
+		}
+
+		const Common::Array<byte> &data() const { return _data; }
+
+	private:
+		void flushWord() {
+			for (int i = 0; i < 4; i++)
+				_data.push_back((_value >> (i * 8)) & 0xFF);
+			_value = 0;
+			_bits = 0;
+		}
+
+		Common::Array<byte> _data;
+		uint32 _value;
+		int _bits;
+	};
+
+	enum FrameType {
+		kFrameIntra,
+		kFrameInter,
+		kFrameScaled
+	};
+
+	enum {
+		kBundleBlockTypes,
+		kBundleSubBlockTypes,
+		kBundleColors,
+		kBundlePattern,
+		kBundleXOff,
+		kBundleYOff,
+		kBundleIntraDC,
+		kBundleInterDC,
+		kBundleRun,
+		kBundleMAX
+	};
+
+	static void writeDCTCoeffs(BitWriter &bits, Common::RandomSource &rnd) {
+		if (rnd.getRandomBit()) {
+			// A single bit plane with the first three AC coefficients set
+			bits.putBits(1, 4);
+			bits.putBits(0, 3);
+			for (int i = 0; i < 3; i++) {
+				bits.putBits(1, 1);
+				bits.putBits(rnd.getRandomBit(), 1);
+			}
+		} else {
+			bits.putBits(0, 4);
+		}
+		bits.putBits(rnd.getRandomNumber(15), 4);
+	}
+
+	static void writeDCs(BitWriter &bits, Common::RandomSource &rnd, uint32 n, bool hasSign) {
+		int32 v = rnd.getRandomNumber(hasSign ? 63 : 2047);
+		if (hasSign) {
+			bits.putBits(v, 10);
+			if (v)
+				bits.putBits(0, 1);
+		} else {
+			bits.putBits(v, 11);
+		}
+
+		for (uint32 i = 1; i < n; i += 8) {
+			bits.putBits(3, 4);
+			for (uint32 j = i; j < MIN<uint32>(i + 8, n); j++) {
+				const int32 delta = rnd.getRandomNumber(7);
+				bits.putBits(delta, 3);
+				if (delta) {
+					// Stay within the range the real encoder would produce
+					const bool negative = hasSign ? (v > 0) : (v > 1024);
+					bits.putBits(negative ? 1 : 0, 1);
+					v += negative ? -delta : delta;
+				}
+			}
+		}
+	}
+
+	static void writePlane(BitWriter &bits, Common::RandomSource &rnd, FrameType type, uint32 blockWidth, uint32 blockHeight, const int *countLengths) {
+		// Raw nibbles for every Huffman coded bundle
+		for (int i = 0; i < kBundleMAX; i++) {
+			if (i == kBundleColors)
+				bits.putBits(0, 16 * 4);
+			if (i != kBundleIntraDC && i != kBundleInterDC)
+				bits.putBits(0, 4);
+		}
+
+		// Values the decoder buffered but did not use yet, and whether the
+		// bundle has been switched off by a zero count.
+		uint32 buffered[kBundleMAX] = { 0 };
+		bool disabled[kBundleMAX] = { false };
+
+		for (uint32 y = 0; y < blockHeight; y++) {
+			const bool skippedRow = (type == kFrameScaled) && (y & 1);
+			const uint32 blocks = (type == kFrameScaled) ? blockWidth / 2 : blockWidth;
+
+			uint32 perRow[kBundleMAX] = { 0 };
+			perRow[kBundleBlockTypes]    = blocks;
+			perRow[kBundleSubBlockTypes] = (type == kFrameScaled) ? blocks : 0;
+			perRow[kBundleXOff]          = (type == kFrameInter) ? blocks : 0;
+			perRow[kBundleYOff]          = (type == kFrameInter) ? blocks : 0;
+			perRow[kBundleIntraDC]       = (type != kFrameInter) ? blocks : 0;
+			perRow[kBundleInterDC]       = (type == kFrameInter) ? blocks : 0;
+
+			for (int i = 0; i < kBundleMAX; i++) {
+				// The decoder only reads a new count once everything is used up
+				if (!disabled[i] && buffered[i] == 0) {
+					const uint32 n = perRow[i];
+					bits.putBits(n, countLengths[i]);
+
+					if (n == 0) {
+						disabled[i] = true;
+					} else if (i == kBundleBlockTypes) {
+						bits.putBits(1, 1);
+						bits.putBits(type == kFrameIntra ? 5 : (type == kFrameInter ? 7 : 1), 4);
+					} else if (i == kBundleSubBlockTypes) {
+						bits.putBits(1, 1);
+						bits.putBits(5, 4);
+					} else if (i == kBundleXOff || i == kBundleYOff) {
+						bits.putBits(1, 1);
+						bits.putBits(0, 4);
+					} else if (i == kBundleIntraDC || i == kBundleInterDC) {
+						writeDCs(bits, rnd, n, i == kBundleInterDC);
+					}
+
+					buffered[i] += n;
+				}
+
+				// Scaled blocks use their block type on both rows
+				if (i == kBundleBlockTypes || !skippedRow)
+					buffered[i] -= MIN(buffered[i], perRow[i]);
+			}
+
+			if (skippedRow)
+				continue;
+
+			for (uint32 x = 0; x < blocks; x++)
+				writeDCTCoeffs(bits, rnd);
+		}
+
+		bits.align();
+	}
+
+	/** Creates a BIKi file without audio, which uses intra, inter and scaled blocks. */
+	static Common::SeekableReadStream *createBinkStream(uint32 width, uint32 height, uint32 frameCount) {
+		Common::RandomSource rnd("bink");
+		rnd.setSeed(1234);
+
+		int countLengths[2][kBundleMAX];
+		const uint32 cbw[2] = { (width + 7) >> 3, (width + 15) >> 4 };
+		const uint32 cw[2]  = { width, width >> 1 };
+		for (int i = 0; i < 2; i++) {
+			const uint32 w = MAX<uint32>(cw[i], 8);
+			countLengths[i][kBundleBlockTypes]    = Common::intLog2((w >> 3) + 511) + 1;
+			countLengths[i][kBundleSubBlockTypes] = Common::intLog2(((w + 7) >> 4) + 511) + 1;
+			countLengths[i][kBundleColors]        = Common::intLog2(cbw[i] * 64 + 511) + 1;
+			countLengths[i][kBundlePattern]       = Common::intLog2((cbw[i] << 3) + 511) + 1;
+			countLengths[i][kBundleXOff]          = Common::intLog2((w >> 3) + 511) + 1;
+			countLengths[i][kBundleYOff]          = Common::intLog2((w >> 3) + 511) + 1;
+			countLengths[i][kBundleIntraDC]       = Common::intLog2((w >> 3) + 511) + 1;
+			countLengths[i][kBundleInterDC]       = Common::intLog2((w >> 3) + 511) + 1;
+			countLengths[i][kBundleRun]           = Common::intLog2(cbw[i] * 48 + 511) + 1;
+		}
+
+		Common::Array<Common::Array<byte> > frames;
+		for (uint32 f = 0; f < frameCount; f++) {
+			const FrameType type = (f == 0) ? kFrameIntra : (FrameType)(f % 3);
+
+			BitWriter bits;
+			bits.putBits(0, 32);
+			writePlane(bits, rnd, type, (width + 7) >> 3, (height + 7) >> 3, countLengths[0]);
+			for (int i = 0; i < 2; i++)
+				writePlane(bits, rnd, type, (width + 15) >> 4, (height + 15) >> 4, countLengths[1]);
+			frames.push_back(bits.data());
+		}
+
+		const uint32 headerSize = 44 + 4 * frameCount;
+		uint32 size = headerSize;
+		uint32 largestFrame = 0;
+		for (uint32 f = 0; f < frameCount; f++) {
+			size += frames[f].size();
+			largestFrame = MAX<uint32>(largestFrame, frames[f].size());
+		}
+
+		byte *data = (byte *)malloc(size);
+		WRITE_BE_UINT32(data, MKTAG('B', 'I', 'K', 'i'));
+		WRITE_LE_UINT32(data +  4, size - 8);
+		WRITE_LE_UINT32(data +  8, frameCount);
+		WRITE_LE_UINT32(data + 12, largestFrame);
+		WRITE_LE_UINT32(data + 16, 0);
+		WRITE_LE_UINT32(data + 20, width);
+		WRITE_LE_UINT32(data + 24, height);
+		WRITE_LE_UINT32(data + 28, 30);
+		WRITE_LE_UINT32(data + 32, 1);
+		WRITE_LE_UINT32(data + 36, 0); // video flags
+		WRITE_LE_UINT32(data + 40, 0); // audio tracks
+
+		uint32 offset = headerSize;
+		for (uint32 f = 0; f < frameCount; f++) {
+			WRITE_LE_UINT32(data + 44 + f * 4, offset | (f == 0 ? 1 : 0));
+			memcpy(data + offset, frames[f].begin(), frames[f].size());
+			offset += frames[f].size();
+		}
+
+		return new Common::MemoryReadStream(data, size, DisposeAfterUse::YES);
+	}
+
+	static void fillBlock(Common::RandomSource &rnd, int32 *block, int range) {
+		memset(block, 0, 64 * sizeof(int32));
+		const int count = 1 + rnd.getRandomNumber(63);
+		for (int i = 0; i < count; i++)
+			block[rnd.getRandomNumber(63)] = (int32)rnd.getRandomNumber(2 * range) - range;
+	}
+
+	typedef void (*IDCTFunc)(byte *, uint, int32 *);
+
+	static bool sameOutput(IDCTFunc a, IDCTFunc b, const int32 *block, int size) {
+		const uint pitch = 24;
+		byte destA[24 * 16], destB[24 * 16];
+		for (uint i = 0; i < sizeof(destA); i++)
+			destA[i] = destB[i] = (byte)(i * 7);
+
+		int32 blockA[64], blockB[64];
+		memcpy(blockA, block, sizeof(blockA));
+		memcpy(blockB, block, sizeof(blockB));
+		a(destA + 4, pitch, blockA);
+		b(destB + 4, pitch, blockB);
+
+		return memcmp(destA, destB, pitch * size) == 0;
+	}
+#endif
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_idct_kernels_match() {
+#if defined(USE_BINK) && defined(SCUMMVM_SSE2)
+		if (instrset_detect() < 2)
+			return;
+
+		Common::RandomSource rnd("bink");
+		rnd.setSeed(5678);
+
+		int32 block[64];
+		for (int i = 0; i < 2000; i++) {
+			// Real coefficients stay well within 16 bits, but the results
+			// have to match even when they wrap around.
+			fillBlock(rnd, block, (i & 1) ? 2048 : 32767);
+
+			TS_ASSERT(sameOutput(Video::BinkDSP::idctPutGeneric, Video::BinkDSP::idctPutSSE2, block, 8));
+			TS_ASSERT(sameOutput(Video::BinkDSP::idctAddGeneric, Video::BinkDSP::idctAddSSE2, block, 8));
+			TS_ASSERT(sameOutput(Video::BinkDSP::idctScaledPutGeneric, Video::BinkDSP::idctScaledPutSSE2, block, 16));
+		}
+#endif
+	}
+
+	void test_threaded_decode_matches() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_BINK)
+		Video::BinkDecoder single, threaded;
+		single.setThreadCount(1);
+		threaded.setThreadCount(4);
+		TS_ASSERT(single.loadStream(createBinkStream(128, 96, 6)));
+		TS_ASSERT(threaded.loadStream(createBinkStream(128, 96, 6)));
+
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		single.setOutputPixelFormat(format);
+		threaded.setOutputPixelFormat(format);
+
+		for (int f = 0; f < 6; f++) {
+			const Graphics::Surface *a = single.decodeNextFrame();
+			const Graphics::Surface *b = threaded.decodeNextFrame();
+			TS_ASSERT(a && b);
+			if (!a || !b)
+				break;
+
+			for (int y = 0; y < a->h; y++)
+				TS_ASSERT_EQUALS(memcmp(a->getBasePtr(0, y), b->getBasePtr(0, y), a->w * a->format.bytesPerPixel), 0);
+		}
+#endif
+	}
+
+	void test_decode_speed() {
+#if NULL_OSYSTEM_IS_AVAILABLE && defined(USE_BINK)
+#ifdef SLOW_TESTS
+		const uint32 frameCount = 300;
+#else
+		const uint32 frameCount = 15;
+#endif
+		const uint threads[] = { 1, 0 };
+
+		for (int i = 0; i < ARRAYSIZE(threads); i++) {
+			Video::BinkDecoder decoder;
+			decoder.setThreadCount(threads[i]);
+			TS_ASSERT(decoder.loadStream(createBinkStream(640, 480, frameCount)));
+			decoder.setOutputPixelFormat(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+			uint32 start = g_system->getMillis();
+			uint32 frames = 0;
+			while (!decoder.endOfVideo() && decoder.decodeNextFrame())
+				frames++;
+			uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			TS_ASSERT_EQUALS(frames, frameCount);
+			debug("BinkDecoder with %u threads: %u frames in %u ms (%f fps)",
+			      threads[i] ? threads[i] : Common::getMaxThreads(), frames, time, frames * 1000.0 / time);
+		}
+#endif
+	}
+};
@@ -0,0 +1,214 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/surface.h"
+
+#include "video/video_decoder.h"
+
+#include "../null_osystem.h"
+
+/**
+ * A decoder generating frames, some of which take longer to decode than
+ * others, and with a palette changing every few frames.
+ */
+class TestVideoDecoder : public Video::VideoDecoder {
+public:
+	TestVideoDecoder(int frameCount, uint spikeMillis) : _frameCount(frameCount), _spikeMillis(spikeMillis) {}
+	~TestVideoDecoder() { close(); }
+
+	bool loadStream(Common::SeekableReadStream *stream) {
+		close();
+		addTrack(new TestVideoTrack(_frameCount, _spikeMillis));
+		return true;
+	}
+
+private:
+	class TestVideoTrack : public FixedRateVideoTrack {
+	public:
+		TestVideoTrack(int frameCount, uint spikeMillis) : _frameCount(frameCount), _spikeMillis(spikeMillis), _curFrame(-1), _dirtyPalette(false) {
+			_surface.create(64, 48, Graphics::PixelFormat::createFormatCLUT8());
+			memset(_palette, 0, sizeof(_palette));
+		}
+		~TestVideoTrack() { _surface.free(); }
+
+		bool isRewindable() const { return true; }
+		bool rewind() { _curFrame = -1; return true; }
+
+		uint16 getWidth() const { return _surface.w; }
+		uint16 getHeight() const { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return _frameCount; }
+		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
+		bool hasDirtyPalette() const { return _dirtyPalette; }
+		bool canReadAhead() const { return true; }
+
+		const Graphics::Surface *decodeNextFrame() {
+			_curFrame++;
+
+			for (int y = 0; y < _surface.h; y++)
+				for (int x = 0; x < _surface.w; x++)
+					*(byte *)_surface.getBasePtr(x, y) = x + y * 3 + _curFrame * 7;
+
+			if ((_curFrame % 5) == 0) {
+				for (int i = 0; i < ARRAYSIZE(_palette); i++)
+					_palette[i] = i + _curFrame;
+				_dirtyPalette = true;
+			}
+
+			if (_spikeMillis && (_curFrame % 8) == 7)
+				g_system->delayMillis(_spikeMillis);
+
+			return &_surface;
+		}
+
+	protected:
+		Common::Rational getFrameRate() const { return 100; }
+
+	private:
+		Graphics::Surface _surface;
+		int _frameCount;
+		uint _spikeMillis;
+		int _curFrame;
+		byte _palette[256 * 3];
+		mutable bool _dirtyPalette;
+	};
+
+	int _frameCount;
+	uint _spikeMillis;
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite {
+private:
+	static bool sameFrame(const Graphics::Surface *a, const Graphics::Surface *b) {
+		if (!a || !b)
+			return a == b;
+
+		for (int y = 0; y < a->h; y++) {
+			if (memcmp(a->getBasePtr(0, y), b->getBasePtr(0, y), a->w * a->format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	// Decodes the next frame of both videos, and checks that they agree
+	static void compareNextFrame(TestVideoDecoder &reference, TestVideoDecoder &decoder) {
+		const Graphics::Surface *a = reference.decodeNextFrame();
+		const Graphics::Surface *b = decoder.decodeNextFrame();
+		TS_ASSERT(sameFrame(a, b));
+		TS_ASSERT_EQUALS(reference.getCurFrame(), decoder.getCurFrame());
+		TS_ASSERT_EQUALS(reference.endOfVideo(), decoder.endOfVideo());
+		TS_ASSERT_EQUALS(reference.hasDirtyPalette(), decoder.hasDirtyPalette());
+		if (reference.hasDirtyPalette() && decoder.hasDirtyPalette())
+			TS_ASSERT_SAME_DATA(reference.getPalette(), decoder.getPalette(), 256 * 3);
+	}
+
+public:
+	void setUp() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+#endif
+	}
+
+	void test_read_ahead_matches() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		TestVideoDecoder reference(40, 0), decoder(40, 0);
+		TS_ASSERT(reference.loadStream(nullptr));
+		TS_ASSERT(decoder.loadStream(nullptr));
+		decoder.setReadAhead(4);
+
+		for (int i = 0; i < 12; i++)
+			compareNextFrame(reference, decoder);
+
+		Video::VideoDecoder::ReadAheadStats stats;
+		decoder.getReadAheadStats(stats);
+		if (decoder.getReadAhead()) {
+			TS_ASSERT(stats.active);
+			TS_ASSERT_EQUALS(stats.maxQueued, 4u);
+			TS_ASSERT_LESS_THAN_EQUALS(12u, stats.framesDecoded);
+			TS_ASSERT_LESS_THAN_EQUALS(stats.queued, 4u);
+		}
+
+		// Rewinding drops the frames decoded ahead
+		TS_ASSERT(reference.rewind());
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT_EQUALS(reference.getCurFrame(), decoder.getCurFrame());
+		for (int i = 0; i < 12; i++)
+			compareNextFrame(reference, decoder);
+
+		// Changing the size uses up the frames already decoded first
+		decoder.setReadAhead(2);
+		for (int i = 0; i < 8; i++)
+			compareNextFrame(reference, decoder);
+
+		// Disabling it hands the decoding back to the caller
+		decoder.setReadAhead(0);
+		while (!reference.endOfVideo())
+			compareNextFrame(reference, decoder);
+
+		TS_ASSERT(decoder.endOfVideo());
+		decoder.getReadAheadStats(stats);
+		TS_ASSERT(!stats.active);
+		TS_ASSERT_EQUALS(stats.queued, 0u);
+#endif
+	}
+
+	void test_read_ahead_close() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		TestVideoDecoder decoder(100, 0);
+		TS_ASSERT(decoder.loadStream(nullptr));
+		decoder.setReadAhead(8);
+		decoder.decodeNextFrame();
+
+		// Closing has to stop the thread before the track goes away
+		decoder.close();
+		TS_ASSERT_EQUALS(decoder.getReadAhead(), 0u);
+
+		Video::VideoDecoder::ReadAheadStats stats;
+		decoder.getReadAheadStats(stats);
+		TS_ASSERT(!stats.active);
+		TS_ASSERT_EQUALS(stats.framesDecoded, 0u);
+#endif
+	}
+
+	void test_read_ahead_late_frames() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+#ifdef SLOW_TESTS
+		const int frames = 400;
+#else
+		const int frames = 40;
+#endif
+		// Every eighth frame takes longer than a frame lasts, which the
+		// frames decoded ahead make up for.
+		const uint frameMillis = 10;
+		const uint spikeMillis = 25;
+
+		for (uint depth = 0; depth <= 4; depth += 4) {
+			TestVideoDecoder decoder(frames, spikeMillis);
+			TS_ASSERT(decoder.loadStream(nullptr));
+			decoder.setReadAhead(depth);
+
+			uint late = 0;
+			uint32 start = g_system->getMillis();
+			for (int i = 0; i < frames; i++) {
+				uint32 frameStart = g_system->getMillis();
+				decoder.decodeNextFrame();
+				uint32 time = g_system->getMillis() - frameStart;
+				if (time >= frameMillis)
+					late++;
+				else
+					g_system->delayMillis(frameMillis - time);
+			}
+			uint32 time = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			Video::VideoDecoder::ReadAheadStats stats;
+			decoder.getReadAheadStats(stats);
+			debug("VideoDecoder read ahead %u: %d frames in %u ms, %u over %u ms, %u frames not ready after waiting %u ms in total",
+			      depth, frames, time, late, frameMillis, stats.lateFrames, stats.lateMillis);
+		}
+#endif
+	}
+};
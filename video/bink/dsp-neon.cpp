@@ -0,0 +1,165 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "video/bink_dsp.h"
+
+#include <arm_neon.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#if !defined(__aarch64__)
+#pragma GCC target("fpu=neon")
+#endif // !defined(__aarch64__)
+
+#endif // __GNUC__
+
+namespace Video {
+
+// One pass of the Bink IDCT, on four columns at once. With row set, the
+// outputs are rounded and scaled down like in the second pass.
+template<bool row>
+static inline void neon_transform(int32x4_t *v) {
+	const int32x4_t a0 = vaddq_s32(v[0], v[4]);
+	const int32x4_t a1 = vsubq_s32(v[0], v[4]);
+	const int32x4_t a2 = vaddq_s32(v[2], v[6]);
+	const int32x4_t a3 = vshrq_n_s32(vmulq_n_s32(vsubq_s32(v[2], v[6]), 2896), 11);
+	const int32x4_t a4 = vaddq_s32(v[5], v[3]);
+	const int32x4_t a5 = vsubq_s32(v[5], v[3]);
+	const int32x4_t a6 = vaddq_s32(v[1], v[7]);
+	const int32x4_t a7 = vsubq_s32(v[1], v[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = vshrq_n_s32(vmulq_n_s32(vaddq_s32(a5, a7), 3784), 11);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(vshrq_n_s32(vmulq_n_s32(a5, -5352), 11), b0), b1);
+	const int32x4_t b3 = vsubq_s32(vshrq_n_s32(vmulq_n_s32(vsubq_s32(a6, a4), 2896), 11), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(vshrq_n_s32(vmulq_n_s32(a7, 2217), 11), b3), b1);
+
+	const int32x4_t c0 = vaddq_s32(a0, a2);
+	const int32x4_t c1 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t c2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+	const int32x4_t c3 = vsubq_s32(a0, a2);
+
+	v[0] = vaddq_s32(c0, b0);
+	v[1] = vaddq_s32(c1, b2);
+	v[2] = vaddq_s32(c2, b3);
+	v[3] = vsubq_s32(c3, b4);
+	v[4] = vaddq_s32(c3, b4);
+	v[5] = vsubq_s32(c2, b3);
+	v[6] = vsubq_s32(c1, b2);
+	v[7] = vsubq_s32(c0, b0);
+
+	if (row) {
+		const int32x4_t round = vdupq_n_s32(0x7F);
+		for (int i = 0; i < 8; i++)
+			v[i] = vshrq_n_s32(vaddq_s32(v[i], round), 8);
+	}
+}
+
+static inline void neon_transpose(int32x4_t &a, int32x4_t &b, int32x4_t &c, int32x4_t &d) {
+	const int32x4x2_t ab = vtrnq_s32(a, b);
+	const int32x4x2_t cd = vtrnq_s32(c, d);
+	a = vcombine_s32(vget_low_s32(ab.val[0]), vget_low_s32(cd.val[0]));
+	b = vcombine_s32(vget_low_s32(ab.val[1]), vget_low_s32(cd.val[1]));
+	c = vcombine_s32(vget_high_s32(ab.val[0]), vget_high_s32(cd.val[0]));
+	d = vcombine_s32(vget_high_s32(ab.val[1]), vget_high_s32(cd.val[1]));
+}
+
+// Runs both IDCT passes and returns the low byte of every output value,
+// one row per vector.
+static inline void neon_idct(const int32 *block, uint8x8_t *rows) {
+	// left[i] and right[i] hold columns 0-3 and 4-7 of row i
+	int32x4_t left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		left[i]  = vld1q_s32(block + i * 8);
+		right[i] = vld1q_s32(block + i * 8 + 4);
+	}
+
+	neon_transform<false>(left);
+	neon_transform<false>(right);
+
+	// Transpose, so that top[i] and bottom[i] hold rows 0-3 and 4-7 of column i
+	int32x4_t top[8], bottom[8];
+	for (int i = 0; i < 4; i++) {
+		top[i]        = left[i];
+		top[i + 4]    = right[i];
+		bottom[i]     = left[i + 4];
+		bottom[i + 4] = right[i + 4];
+	}
+	neon_transpose(top[0], top[1], top[2], top[3]);
+	neon_transpose(top[4], top[5], top[6], top[7]);
+	neon_transpose(bottom[0], bottom[1], bottom[2], bottom[3]);
+	neon_transpose(bottom[4], bottom[5], bottom[6], bottom[7]);
+
+	neon_transform<true>(top);
+	neon_transform<true>(bottom);
+
+	// And back to rows
+	neon_transpose(top[0], top[1], top[2], top[3]);
+	neon_transpose(top[4], top[5], top[6], top[7]);
+	neon_transpose(bottom[0], bottom[1], bottom[2], bottom[3]);
+	neon_transpose(bottom[4], bottom[5], bottom[6], bottom[7]);
+
+	// Narrowing keeps the low half, which matches storing into a byte
+	for (int i = 0; i < 4; i++) {
+		rows[i]     = vmovn_u16(vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(top[i]), vmovn_s32(top[i + 4]))));
+		rows[i + 4] = vmovn_u16(vreinterpretq_u16_s16(vcombine_s16(vmovn_s32(bottom[i]), vmovn_s32(bottom[i + 4]))));
+	}
+}
+
+void BinkDSP::idctPutNEON(byte *dest, uint pitch, int32 *block) {
+	uint8x8_t rows[8];
+	neon_idct(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, rows[i]);
+}
+
+void BinkDSP::idctAddNEON(byte *dest, uint pitch, int32 *block) {
+	uint8x8_t rows[8];
+	neon_idct(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), rows[i]));
+}
+
+void BinkDSP::idctScaledPutNEON(byte *dest, uint pitch, int32 *block) {
+	uint8x8_t rows[8];
+	neon_idct(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch * 2) {
+		const uint8x8x2_t pixels = vzip_u8(rows[i], rows[i]);
+		const uint8x16_t wide = vcombine_u8(pixels.val[0], pixels.val[1]);
+		vst1q_u8(dest, wide);
+		vst1q_u8(dest + pitch, wide);
+	}
+}
+
+} // End of namespace Video
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
+
+#endif // SCUMMVM_NEON
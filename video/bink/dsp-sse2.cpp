@@ -0,0 +1,178 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "video/bink_dsp.h"
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC push_options
+
+#ifndef __x86_64__
+#pragma GCC target("sse2")
+#endif
+
+#endif
+
+namespace Video {
+
+// Returns the low 32 bits of the products, like the int multiplications of
+// the generic code. SSE2 has no 32-bit multiply, so the even and odd lanes
+// are multiplied separately.
+static FORCEINLINE __m128i sse2_mul(__m128i a, int32 c) {
+	const __m128i k = _mm_set1_epi32(c);
+	__m128i even = _mm_mul_epu32(a, k);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), k);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// One pass of the Bink IDCT, on four columns at once. With row set, the
+// outputs are rounded and scaled down like in the second pass.
+template<bool row>
+static FORCEINLINE void sse2_transform(__m128i *v) {
+	const __m128i a0 = _mm_add_epi32(v[0], v[4]);
+	const __m128i a1 = _mm_sub_epi32(v[0], v[4]);
+	const __m128i a2 = _mm_add_epi32(v[2], v[6]);
+	const __m128i a3 = _mm_srai_epi32(sse2_mul(_mm_sub_epi32(v[2], v[6]), 2896), 11);
+	const __m128i a4 = _mm_add_epi32(v[5], v[3]);
+	const __m128i a5 = _mm_sub_epi32(v[5], v[3]);
+	const __m128i a6 = _mm_add_epi32(v[1], v[7]);
+	const __m128i a7 = _mm_sub_epi32(v[1], v[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(sse2_mul(_mm_add_epi32(a5, a7), 3784), 11);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(sse2_mul(a5, -5352), 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(sse2_mul(_mm_sub_epi32(a6, a4), 2896), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(sse2_mul(a7, 2217), 11), b3), b1);
+
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+
+	v[0] = _mm_add_epi32(c0, b0);
+	v[1] = _mm_add_epi32(c1, b2);
+	v[2] = _mm_add_epi32(c2, b3);
+	v[3] = _mm_sub_epi32(c3, b4);
+	v[4] = _mm_add_epi32(c3, b4);
+	v[5] = _mm_sub_epi32(c2, b3);
+	v[6] = _mm_sub_epi32(c1, b2);
+	v[7] = _mm_sub_epi32(c0, b0);
+
+	if (row) {
+		const __m128i round = _mm_set1_epi32(0x7F);
+		for (int i = 0; i < 8; i++)
+			v[i] = _mm_srai_epi32(_mm_add_epi32(v[i], round), 8);
+	}
+}
+
+static FORCEINLINE void sse2_transpose(__m128i &a, __m128i &b, __m128i &c, __m128i &d) {
+	const __m128i t0 = _mm_unpacklo_epi32(a, b);
+	const __m128i t1 = _mm_unpacklo_epi32(c, d);
+	const __m128i t2 = _mm_unpackhi_epi32(a, b);
+	const __m128i t3 = _mm_unpackhi_epi32(c, d);
+	a = _mm_unpacklo_epi64(t0, t1);
+	b = _mm_unpackhi_epi64(t0, t1);
+	c = _mm_unpacklo_epi64(t2, t3);
+	d = _mm_unpackhi_epi64(t2, t3);
+}
+
+// Runs both IDCT passes and returns each output row as eight 16-bit values,
+// which hold the low byte of the 32-bit results.
+static FORCEINLINE void sse2_idct(const int32 *block, __m128i *rows) {
+	// left[i] and right[i] hold columns 0-3 and 4-7 of row i
+	__m128i left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		left[i]  = _mm_loadu_si128((const __m128i *)(block + i * 8));
+		right[i] = _mm_loadu_si128((const __m128i *)(block + i * 8 + 4));
+	}
+
+	sse2_transform<false>(left);
+	sse2_transform<false>(right);
+
+	// Transpose, so that top[i] and bottom[i] hold rows 0-3 and 4-7 of column i
+	__m128i top[8], bottom[8];
+	for (int i = 0; i < 4; i++) {
+		top[i]        = left[i];
+		top[i + 4]    = right[i];
+		bottom[i]     = left[i + 4];
+		bottom[i + 4] = right[i + 4];
+	}
+	sse2_transpose(top[0], top[1], top[2], top[3]);
+	sse2_transpose(top[4], top[5], top[6], top[7]);
+	sse2_transpose(bottom[0], bottom[1], bottom[2], bottom[3]);
+	sse2_transpose(bottom[4], bottom[5], bottom[6], bottom[7]);
+
+	sse2_transform<true>(top);
+	sse2_transform<true>(bottom);
+
+	// And back to rows
+	sse2_transpose(top[0], top[1], top[2], top[3]);
+	sse2_transpose(top[4], top[5], top[6], top[7]);
+	sse2_transpose(bottom[0], bottom[1], bottom[2], bottom[3]);
+	sse2_transpose(bottom[4], bottom[5], bottom[6], bottom[7]);
+
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	for (int i = 0; i < 4; i++) {
+		rows[i]     = _mm_packs_epi32(_mm_and_si128(top[i], mask), _mm_and_si128(top[i + 4], mask));
+		rows[i + 4] = _mm_packs_epi32(_mm_and_si128(bottom[i], mask), _mm_and_si128(bottom[i + 4], mask));
+	}
+}
+
+void BinkDSP::idctPutSSE2(byte *dest, uint pitch, int32 *block) {
+	__m128i rows[8];
+	sse2_idct(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(rows[i], rows[i]));
+}
+
+void BinkDSP::idctAddSSE2(byte *dest, uint pitch, int32 *block) {
+	__m128i rows[8];
+	sse2_idct(block, rows);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi16(0xFF);
+	for (int i = 0; i < 8; i++, dest += pitch) {
+		__m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), zero);
+		pixels = _mm_and_si128(_mm_add_epi16(pixels, rows[i]), mask);
+		_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(pixels, pixels));
+	}
+}
+
+void BinkDSP::idctScaledPutSSE2(byte *dest, uint pitch, int32 *block) {
+	__m128i rows[8];
+	sse2_idct(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch * 2) {
+		__m128i pixels = _mm_packus_epi16(rows[i], rows[i]);
+		pixels = _mm_unpacklo_epi8(pixels, pixels);
+		_mm_storeu_si128((__m128i *)dest, pixels);
+		_mm_storeu_si128((__m128i *)(dest + pitch), pixels);
+	}
+}
+
+} // End of namespace Video
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
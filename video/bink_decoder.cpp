@@ -36,6 +36,7 @@
 #include "common/bitstream.h"
 #include "common/compression/huffman.h"
 #include "common/system.h"
+#include "common/thread.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
@@ -45,6 +46,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -63,6 +65,10 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_threadCount = 0;
+
+	// Not done lazily, as the transforms run on several threads
+	BinkDSP::selectFuncs();
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -102,8 +108,10 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	uint32 videoFlags = _bink->readUint32LE();
 
 	// BIKh and BIKi swap the chroma planes
-	addTrack(new BinkVideoTrack(width, height, frameCount,
-			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id));
+	BinkVideoTrack *videoTrack = new BinkVideoTrack(width, height, frameCount,
+			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id);
+	videoTrack->setThreadCount(_threadCount);
+	addTrack(videoTrack);
 
 	uint32 audioTrackCount = _bink->readUint32LE();
 
@@ -144,6 +152,13 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 	return true;
 }
 
+void BinkDecoder::setThreadCount(uint count) {
+	_threadCount = count;
+
+	if (isVideoLoaded())
+		((BinkVideoTrack *)getTrack(0))->setThreadCount(count);
+}
+
 void BinkDecoder::close() {
 	VideoDecoder::close();
 
@@ -243,7 +258,8 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 }
 
 BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
-		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr) {
+		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr),
+		_threadCount(0), _deferIDCT(false), _idctJobCount(0) {
 	_curFrame = -1;
 
 	for (int i = 0; i < 16; i++)
@@ -459,6 +475,12 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		_surface->w = _width;
 	}
 
+	// The bitstream has to be read in order, but with several threads, the
+	// inverse DCTs are only collected here and run in parallel afterwards.
+	const uint numThreads = _threadCount ? _threadCount : Common::getMaxThreads();
+	_deferIDCT = numThreads > 1;
+	_idctJobCount = 0;
+
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
@@ -478,18 +500,10 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
-	// Convert the YUV data we have to our format
-	// The width used here is the surface-width, and not the video-width
-	// to allow for odd-sized videos.
-	if (_hasAlpha) {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-		YUVToRGBMan.convert420Alpha(_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	} else {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-		YUVToRGBMan.convert420(_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	}
+	if (_deferIDCT)
+		flushIDCTJobs(numThreads);
+
+	convertFrame(numThreads);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -815,17 +829,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
-
-	int32 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	runIDCT(ctx, kIDCTScaledPut, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
@@ -960,7 +964,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	runIDCT(ctx, kIDCTPut, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -981,7 +985,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	runIDCT(ctx, kIDCTAdd, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -1410,88 +1414,100 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-	const int a0 = (src)[s0] + (src)[s4]; \
-	const int a1 = (src)[s0] - (src)[s4]; \
-	const int a2 = (src)[s2] + (src)[s6]; \
-	const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-	const int a4 = (src)[s5] + (src)[s3]; \
-	const int a5 = (src)[s5] - (src)[s3]; \
-	const int a6 = (src)[s1] + (src)[s7]; \
-	const int a7 = (src)[s1] - (src)[s7]; \
-	const int b0 = a4 + a6; \
-	const int b1 = (A3*(a5 + a7)) >> 11; \
-	const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-	const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-	const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-	(dest)[d0] = munge(a0+a2   +b0); \
-	(dest)[d1] = munge(a1+a3-a2+b2); \
-	(dest)[d2] = munge(a1-a3+a2+b3); \
-	(dest)[d3] = munge(a0-a2   -b4); \
-	(dest)[d4] = munge(a0-a2   +b4); \
-	(dest)[d5] = munge(a1-a3+a2-b3); \
-	(dest)[d6] = munge(a1+a3-a2-b2); \
-	(dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int32 *dest, const int32 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
+void BinkDecoder::BinkVideoTrack::runIDCT(DecodeContext &ctx, IDCTType type, int32 *block) {
+	if (!_deferIDCT) {
+		transformBlock(ctx.dest, ctx.pitch, type, block);
+		return;
+	}
+
+	if (_idctJobCount == _idctJobs.size())
+		_idctJobs.resize(MAX<uint32>(_idctJobCount * 2, 256));
+
+	IDCTJob &job = _idctJobs[_idctJobCount++];
+	job.dest  = ctx.dest;
+	job.pitch = ctx.pitch;
+	job.type  = type;
+	memcpy(job.block, block, sizeof(job.block));
+}
+
+void BinkDecoder::BinkVideoTrack::transformBlock(byte *dest, uint32 pitch, IDCTType type, int32 *block) {
+	switch (type) {
+	case kIDCTPut:
+		BinkDSP::idctPut(dest, pitch, block);
+		break;
+	case kIDCTAdd:
+		BinkDSP::idctAdd(dest, pitch, block);
+		break;
+	case kIDCTScaledPut:
+		BinkDSP::idctScaledPut(dest, pitch, block);
+		break;
+	default:
+		break;
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
-	int i;
-	int32 temp[64];
+void BinkDecoder::BinkVideoTrack::flushIDCTJobs(uint numThreads) {
+	// Every block is written by exactly one job, so they can run in any order
+	const uint numTasks = (_idctJobCount + kIDCTJobsPerTask - 1) / kIDCTJobsPerTask;
+	Common::runTasks(runIDCTJobs, this, numTasks, numThreads);
+	_idctJobCount = 0;
+}
 
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
+void BinkDecoder::BinkVideoTrack::runIDCTJobs(void *param, uint task) {
+	BinkVideoTrack *track = (BinkVideoTrack *)param;
+
+	const uint32 start = task * kIDCTJobsPerTask;
+	const uint32 end   = MIN(start + kIDCTJobsPerTask, track->_idctJobCount);
+	for (uint32 i = start; i < end; i++) {
+		IDCTJob &job = track->_idctJobs[i];
+		transformBlock(job.dest, job.pitch, job.type, job.block);
 	}
 }
 
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
-	int i, j;
+void BinkDecoder::BinkVideoTrack::convertFrame(uint numThreads) {
+	// Convert the YUV data we have to our format
+	// The width used here is the surface-width, and not the video-width
+	// to allow for odd-sized videos.
+	const uint numBands = (_surfaceHeight + kConvertBandHeight - 1) / kConvertBandHeight;
+	if (numThreads <= 1 || numBands <= 1) {
+		convertRows(0, _surfaceHeight);
+		return;
+	}
 
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
-	int i;
-	int32 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
+	// The first band sets up the conversion tables, which is not safe to
+	// do from several threads, so it is always converted here.
+	convertRows(0, kConvertBandHeight);
+	Common::runTasks(convertBand, this, numBands - 1, numThreads);
+}
+
+void BinkDecoder::BinkVideoTrack::convertRows(int y, int rows) {
+	Graphics::Surface band;
+	band.init(_surfaceWidth, rows, _surface->pitch, _surface->getBasePtr(0, y), _surface->format);
+
+	const uint32 yPitch  = _yBlockWidth  * 8;
+	const uint32 uvPitch = _uvBlockWidth * 8;
+
+	if (_hasAlpha) {
+		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
+		YUVToRGBMan.convert420Alpha(&band, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0] + y * yPitch,
+				_curPlanes[1] + (y / 2) * uvPitch, _curPlanes[2] + (y / 2) * uvPitch, _curPlanes[3] + y * yPitch,
+				_surfaceWidth, rows, yPitch, uvPitch);
+	} else {
+		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
+		YUVToRGBMan.convert420(&band, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0] + y * yPitch,
+				_curPlanes[1] + (y / 2) * uvPitch, _curPlanes[2] + (y / 2) * uvPitch,
+				_surfaceWidth, rows, yPitch, uvPitch);
 	}
 }
 
+void BinkDecoder::BinkVideoTrack::convertBand(void *param, uint task) {
+	BinkVideoTrack *track = (BinkVideoTrack *)param;
+
+	// Band 0 has already been converted by convertFrame()
+	const int y = (task + 1) * kConvertBandHeight;
+	track->convertRows(y, MIN(kConvertBandHeight, track->_surfaceHeight - y));
+}
+
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audioInfo(&audio) {
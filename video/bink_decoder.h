@@ -76,6 +76,16 @@ public:
 
 	Common::Rational getFrameRate();
 
+	/**
+	 * Set the number of threads used to decode the video frames.
+	 *
+	 * The bitstream is always read on the calling thread, but the inverse
+	 * DCTs and the color conversion of a frame can be spread across
+	 * several threads. 0, the default, uses Common::getMaxThreads(), and
+	 * 1 decodes everything on the calling thread.
+	 */
+	void setThreadCount(uint count);
+
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -161,6 +171,7 @@ private:
 		bool seek(const Audio::Timestamp &time) override { return true; }
 		bool rewind() override;
 		void setCurFrame(uint32 frame) { _curFrame = frame; }
+		void setThreadCount(uint count) { _threadCount = count; }
 
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
@@ -168,6 +179,9 @@ private:
 		Common::Rational getFrameRate() const override { return _frameRate; }
 
 	private:
+		static const uint32 kIDCTJobsPerTask  = 64; ///< Deferred inverse DCTs run by one task.
+		static const int    kConvertBandHeight = 32; ///< Rows converted by one task.
+
 		/** A decoder state. */
 		struct DecodeContext {
 			VideoFrame *video;
@@ -227,6 +241,21 @@ private:
 			byte symbols[16]; ///< Huffman symbol => Bink symbol tranlation list.
 		};
 
+		/** The kinds of inverse DCT a block can use. */
+		enum IDCTType {
+			kIDCTPut,      ///< Store the transformed 8x8 block.
+			kIDCTAdd,      ///< Add the transformed 8x8 block to the pixels.
+			kIDCTScaledPut ///< Store the transformed block scaled up to 16x16.
+		};
+
+		/** An inverse DCT deferred until the whole frame has been read. */
+		struct IDCTJob {
+			byte *dest;
+			uint32 pitch;
+			IDCTType type;
+			int32 block[64];
+		};
+
 		/** Data structure used for decoding a single Bink data type. */
 		struct Bundle {
 			int countLengths[2]; ///< Lengths of number of entries to decode (in bits).
@@ -275,6 +304,12 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		uint _threadCount; ///< Number of threads to decode with, 0 for all.
+		bool _deferIDCT;   ///< Are the inverse DCTs of the current frame deferred?
+
+		Common::Array<IDCTJob> _idctJobs; ///< The deferred inverse DCTs.
+		uint32 _idctJobCount;             ///< Number of used entries in _idctJobs.
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -332,9 +367,16 @@ private:
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
 
 		// Bink video IDCT
-		void IDCT(int32 *block);
-		void IDCTPut(DecodeContext &ctx, int32 *block);
-		void IDCTAdd(DecodeContext &ctx, int32 *block);
+		void runIDCT(DecodeContext &ctx, IDCTType type, int32 *block);
+		void flushIDCTJobs(uint numThreads);
+		static void transformBlock(byte *dest, uint32 pitch, IDCTType type, int32 *block);
+		static void runIDCTJobs(void *param, uint task);
+
+		/** Convert the YUV(A) planes into the surface. */
+		void convertFrame(uint numThreads);
+		/** Convert the YUV(A) planes of an even number of rows into the surface. */
+		void convertRows(int y, int rows);
+		static void convertBand(void *param, uint task);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -373,6 +415,8 @@ private:
 
 	Common::SeekableReadStream *_bink;
 
+	uint _threadCount;
+
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
@@ -0,0 +1,94 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+#include "common/scummsys.h"
+
+class BinkDSPTestSuite;
+
+namespace Video {
+
+/**
+ * The inverse DCT kernels of the Bink video decoder.
+ *
+ * Every implementation produces exactly the same output as the generic
+ * one, including the wrap-around when storing the results into bytes.
+ */
+class BinkDSP {
+private:
+#ifdef SCUMMVM_NEON
+	static void idctPutNEON(byte *dest, uint pitch, int32 *block);
+	static void idctAddNEON(byte *dest, uint pitch, int32 *block);
+	static void idctScaledPutNEON(byte *dest, uint pitch, int32 *block);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void idctPutSSE2(byte *dest, uint pitch, int32 *block);
+	static void idctAddSSE2(byte *dest, uint pitch, int32 *block);
+	static void idctScaledPutSSE2(byte *dest, uint pitch, int32 *block);
+#endif
+	static void idctPutGeneric(byte *dest, uint pitch, int32 *block);
+	static void idctAddGeneric(byte *dest, uint pitch, int32 *block);
+	static void idctScaledPutGeneric(byte *dest, uint pitch, int32 *block);
+
+	typedef void (*IDCTFunc)(byte *, uint, int32 *);
+	static IDCTFunc idctPutFunc;
+	static IDCTFunc idctAddFunc;
+	static IDCTFunc idctScaledPutFunc;
+	friend class ::BinkDSPTestSuite;
+
+public:
+	/**
+	 * Selects the kernels for the CPU. This must be called before any of
+	 * the transforms, and before they are run on several threads.
+	 */
+	static void selectFuncs();
+
+	/**
+	 * Transforms an 8x8 block of dequantized DCT coefficients and stores
+	 * the result at @p dest. The block is used as scratch space.
+	 */
+	static void idctPut(byte *dest, uint pitch, int32 *block) {
+		idctPutFunc(dest, pitch, block);
+	}
+
+	/**
+	 * Transforms an 8x8 block of dequantized DCT coefficients and adds the
+	 * result to the pixels at @p dest. The block is used as scratch space.
+	 */
+	static void idctAdd(byte *dest, uint pitch, int32 *block) {
+		idctAddFunc(dest, pitch, block);
+	}
+
+	/**
+	 * Transforms an 8x8 block of dequantized DCT coefficients and stores
+	 * the result scaled up to 16x16 at @p dest. The block is used as
+	 * scratch space.
+	 */
+	static void idctScaledPut(byte *dest, uint pitch, int32 *block) {
+		idctScaledPutFunc(dest, pitch, block);
+	}
+};
+
+} // End of namespace Video
+
+#endif
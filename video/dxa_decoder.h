@@ -70,6 +70,7 @@ private:
 		const Graphics::Surface *decodeNextFrame();
 		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
 		bool hasDirtyPalette() const { return _dirtyPalette; }
+		bool canReadAhead() const { return true; }
 
 		void setFrameStartPos();
 
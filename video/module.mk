@@ -18,7 +18,18 @@ MODULE_OBJS := \
 
 ifdef USE_BINK
 MODULE_OBJS += \
-	bink_decoder.o
+	bink_decoder.o \
+	bink/dsp.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	bink/dsp-sse2.o
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	bink/dsp-neon.o
+endif
 endif
 
 ifdef USE_THEORADEC
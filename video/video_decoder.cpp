@@ -25,11 +25,58 @@
 #include "audio/mixer.h" // for kMaxChannelVolume
 
 #include "common/rational.h"
+#include "common/debug.h"
 #include "common/file.h"
+#include "common/mutex.h"
 #include "common/system.h"
+#include "common/thread.h"
+
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * The frames decoded ahead of time, in a ring of one slot more than the
+ * number of frames to decode ahead. The slot of the frame taken last is
+ * left alone until the next one is taken, as it may still be displayed.
+ */
+struct VideoDecoder::ReadAheadQueue {
+	struct Frame {
+		Graphics::Surface surface;
+		bool hasSurface;
+		bool dirtyPalette;
+		byte palette[256 * 3];
+
+		// The state of the track after decoding the frame
+		int curFrame;
+		uint32 nextFrameStartTime;
+		bool endOfTrack;
+	};
+
+	VideoTrack *track;
+	Common::ThreadInternal *thread;
+	Common::SemaphoreInternal *frameTaken;   // Posted when the thread waits for a free slot
+	Common::SemaphoreInternal *frameDecoded; // Posted when the decoder waits for a frame
+	Common::Mutex mutex;
+
+	// Shared with the thread, protected by the mutex
+	Common::Array<Frame> frames;
+	uint first;
+	uint count;
+	bool stop;
+	bool ended;
+	bool threadWaiting;
+	bool decoderWaiting;
+	uint framesDecoded;
+
+	// Only used by the decoder: the state of the track after the frame
+	// taken last, and whether it differs from the one of the track
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+	bool active;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -47,12 +94,24 @@ VideoDecoder::VideoDecoder() {
 	_mainAudioTrack = 0;
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
+	_readAhead = nullptr;
+	_readAheadFrames = 0;
+	memset(&_readAheadStats, 0, sizeof(_readAheadStats));
+}
+
+VideoDecoder::~VideoDecoder() {
+	freeReadAhead();
 }
 
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	// The thread has to be stopped before its track is deleted
+	freeReadAhead();
+	_readAheadFrames = 0;
+	memset(&_readAheadStats, 0, sizeof(_readAheadStats));
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -218,11 +277,24 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	if (!_nextVideoTrack)
 		return 0;
 
-	const Graphics::Surface *frame = _nextVideoTrack->decodeNextFrame();
+	// A queue which ran empty after being stopped is no longer needed,
+	// and a new one may be started in its place.
+	if (_readAhead && !_readAhead->active)
+		freeReadAhead();
+	if (_readAheadFrames && !_readAhead)
+		startReadAhead();
 
-	if (_nextVideoTrack->hasDirtyPalette()) {
-		_palette = _nextVideoTrack->getPalette();
-		_dirtyPalette = true;
+	const Graphics::Surface *frame;
+
+	if (isReadAheadTrack(_nextVideoTrack)) {
+		frame = takeReadAheadFrame();
+	} else {
+		frame = _nextVideoTrack->decodeNextFrame();
+
+		if (_nextVideoTrack->hasDirtyPalette()) {
+			_palette = _nextVideoTrack->getPalette();
+			_dirtyPalette = true;
+		}
 	}
 
 	// Look for the next video track here for the next decode.
@@ -239,6 +311,9 @@ bool VideoDecoder::setReverse(bool reverse) {
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
+			if (isReadAheadTrack(*it))
+				stopReadAhead(true);
+
 			if (!((VideoTrack *)*it)->setReverse(reverse))
 				return false;
 
@@ -260,7 +335,7 @@ int VideoDecoder::getCurFrame() const {
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
-			frame += ((VideoTrack *)*it)->getCurFrame() + 1;
+			frame += getTrackCurFrame((VideoTrack *)*it) + 1;
 
 	return frame;
 }
@@ -301,7 +376,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getTrackNextFrameStartTime(_nextVideoTrack);
 
 	if (_nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
@@ -322,8 +397,8 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && getTrackNextFrameStartTime((const VideoTrack *)track) >= (uint)_endTime.msecs();
+		bool endReached = isTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return false;
 	}
@@ -350,6 +425,8 @@ bool VideoDecoder::rewind() {
 	if (isPlaying())
 		stopAudio();
 
+	stopReadAhead(true);
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if (!(*it)->rewind())
 			return false;
@@ -384,6 +461,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
+	stopReadAhead(true);
+
 	// Do the actual seeking
 	if (!seekIntern(time))
 		return false;
@@ -932,7 +1011,7 @@ void VideoDecoder::setEndFrame(uint frame) {
 
 void VideoDecoder::resetStartTime() {
 	if (_nextVideoTrack) {
-		Audio::Timestamp curTime = _nextVideoTrack->getFrameTime(_nextVideoTrack->getCurFrame());
+		Audio::Timestamp curTime = _nextVideoTrack->getFrameTime(getTrackCurFrame(_nextVideoTrack));
 		if (isPlaying()) {
 			_startTime = g_system->getMillis() - (curTime.msecs() / _playbackRate).toInt();
 		}
@@ -955,7 +1034,7 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 
 bool VideoDecoder::endOfVideoTracks() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !isTrackEnded(*it))
 			return false;
 
 	return true;
@@ -966,9 +1045,9 @@ VideoDecoder::VideoTrack *VideoDecoder::findNextVideoTrack() {
 	uint32 bestTime = 0xFFFFFFFF;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack()) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !isTrackEnded(*it)) {
 			VideoTrack *track = (VideoTrack *)*it;
-			uint32 time = track->getNextFrameStartTime();
+			uint32 time = getTrackNextFrameStartTime(track);
 
 			if (time < bestTime) {
 				bestTime = time;
@@ -1022,8 +1101,8 @@ bool VideoDecoder::hasFramesLeft() const {
 
 		const VideoTrack *track = (const VideoTrack *)*it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && getTrackNextFrameStartTime(track) >= (uint)_endTime.msecs();
+		bool endReached = isTrackEnded(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -1039,7 +1118,259 @@ bool VideoDecoder::hasAudio() const {
 	return false;
 }
 
+void VideoDecoder::setReadAhead(uint frames) {
+	if (frames == _readAheadFrames)
+		return;
+
+	// The frames already decoded are still used, and a queue of the new
+	// size is started once they are gone.
+	stopReadAhead(false);
+	_readAheadFrames = frames;
+}
+
+void VideoDecoder::getReadAheadStats(ReadAheadStats &stats) const {
+	stats = _readAheadStats;
+	stats.maxQueued = _readAheadFrames;
+
+	if (_readAhead) {
+		Common::StackLock lock(_readAhead->mutex);
+		stats.active = _readAhead->thread != nullptr;
+		stats.queued = _readAhead->count;
+		stats.framesDecoded += _readAhead->framesDecoded;
+	}
+}
+
+void VideoDecoder::startReadAhead() {
+	VideoTrack *track = nullptr;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Only a single video track can be decoded ahead
+			if (track)
+				return;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || !track->canReadAhead() || track->isReversed())
+		return;
+
+	ReadAheadQueue *queue = new ReadAheadQueue();
+	queue->track = track;
+	queue->frames.resize(_readAheadFrames + 1);
+	queue->first = 0;
+	queue->count = 0;
+	queue->stop = false;
+	queue->ended = track->endOfTrack();
+	queue->threadWaiting = false;
+	queue->decoderWaiting = false;
+	queue->framesDecoded = 0;
+	queue->curFrame = track->getCurFrame();
+	queue->nextFrameStartTime = track->getNextFrameStartTime();
+	queue->endOfTrack = queue->ended;
+	queue->active = true;
+
+	queue->thread = nullptr;
+	queue->frameTaken = g_system->createSemaphore();
+	queue->frameDecoded = g_system->createSemaphore();
+	if (queue->frameTaken && queue->frameDecoded)
+		queue->thread = g_system->createThread(readAheadThread, queue);
+	if (!queue->thread) {
+		// Don't try again for every frame
+		debug(3, "VideoDecoder: Threads are not supported, frames are not decoded ahead");
+		delete queue->frameTaken;
+		delete queue->frameDecoded;
+		delete queue;
+		_readAheadFrames = 0;
+		return;
+	}
+
+	_readAhead = queue;
+}
+
+void VideoDecoder::stopReadAhead(bool discard) {
+	if (!_readAhead)
+		return;
+
+	if (_readAhead->thread) {
+		{
+			Common::StackLock lock(_readAhead->mutex);
+			_readAhead->stop = true;
+			if (_readAhead->threadWaiting) {
+				_readAhead->threadWaiting = false;
+				_readAhead->frameTaken->post();
+			}
+		}
+		_readAhead->thread->wait();
+		delete _readAhead->thread;
+		_readAhead->thread = nullptr;
+	}
+
+	// Without any frames left, the track holds the state seen by the
+	// caller again. The queue itself is kept until the next frame is
+	// decoded, since the caller may still use the frame taken last.
+	if (discard)
+		_readAhead->count = 0;
+	if (!_readAhead->count)
+		_readAhead->active = false;
+}
+
+void VideoDecoder::freeReadAhead() {
+	if (!_readAhead)
+		return;
+
+	stopReadAhead(true);
+	_readAheadStats.framesDecoded += _readAhead->framesDecoded;
+
+	for (uint i = 0; i < _readAhead->frames.size(); i++)
+		_readAhead->frames[i].surface.free();
+
+	delete _readAhead->frameTaken;
+	delete _readAhead->frameDecoded;
+	delete _readAhead;
+	_readAhead = nullptr;
+}
+
+void VideoDecoder::readAheadThread(void *param) {
+	ReadAheadQueue *queue = (ReadAheadQueue *)param;
+
+	for (;;) {
+		uint slot;
+		{
+			Common::StackLock lock(queue->mutex);
+			if (queue->stop || queue->ended)
+				return;
+
+			slot = (queue->first + queue->count) % queue->frames.size();
+			if (queue->count + 1 >= queue->frames.size()) {
+				slot = queue->frames.size();
+				queue->threadWaiting = true;
+			}
+		}
+
+		if (slot == queue->frames.size()) {
+			// The queue is full, wait for a frame to be taken
+			queue->frameTaken->wait();
+			continue;
+		}
+
+		// The slot is not used by the decoder until the frame is counted
+		ReadAheadQueue::Frame &frame = queue->frames[slot];
+		const Graphics::Surface *surface = queue->track->decodeNextFrame();
+
+		frame.hasSurface = surface != nullptr;
+		if (surface) {
+			if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+				frame.surface.free();
+				frame.surface.create(surface->w, surface->h, surface->format);
+			}
+			frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+		}
+
+		frame.dirtyPalette = queue->track->hasDirtyPalette();
+		if (frame.dirtyPalette)
+			memcpy(frame.palette, queue->track->getPalette(), sizeof(frame.palette));
+
+		frame.curFrame = queue->track->getCurFrame();
+		frame.nextFrameStartTime = queue->track->getNextFrameStartTime();
+		frame.endOfTrack = queue->track->endOfTrack();
+
+		Common::StackLock lock(queue->mutex);
+		queue->count++;
+		queue->ended = frame.endOfTrack;
+		queue->framesDecoded++;
+		if (queue->decoderWaiting) {
+			queue->decoderWaiting = false;
+			queue->frameDecoded->post();
+		}
+	}
+}
+
+const Graphics::Surface *VideoDecoder::takeReadAheadFrame() {
+	ReadAheadQueue *queue = _readAhead;
+	uint32 waitStart = 0;
+	uint slot;
+
+	for (;;) {
+		{
+			Common::StackLock lock(queue->mutex);
+			if (queue->count) {
+				slot = queue->first;
+				queue->first = (queue->first + 1) % queue->frames.size();
+				queue->count--;
+				if (queue->threadWaiting) {
+					queue->threadWaiting = false;
+					queue->frameTaken->post();
+				}
+				break;
+			}
+
+			// Nothing is left to decode
+			if (queue->ended || !queue->thread)
+				return nullptr;
+
+			queue->decoderWaiting = true;
+		}
+
+		// The frame is being decoded right now
+		if (!waitStart)
+			waitStart = g_system->getMillis();
+		queue->frameDecoded->wait();
+	}
+
+	if (waitStart) {
+		_readAheadStats.lateFrames++;
+		_readAheadStats.lateMillis += g_system->getMillis() - waitStart;
+	}
+
+	const ReadAheadQueue::Frame &frame = queue->frames[slot];
+	queue->curFrame = frame.curFrame;
+	queue->nextFrameStartTime = frame.nextFrameStartTime;
+	queue->endOfTrack = frame.endOfTrack;
+
+	if (frame.dirtyPalette) {
+		memcpy(_readAheadPalette, frame.palette, sizeof(_readAheadPalette));
+		_palette = _readAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	// Once a stopped queue runs empty, the track is in sync again
+	if (!queue->thread && !queue->count)
+		queue->active = false;
+
+	return frame.hasSurface ? &frame.surface : nullptr;
+}
+
+bool VideoDecoder::isReadAheadTrack(const Track *track) const {
+	return _readAhead && _readAhead->active && _readAhead->track == track;
+}
+
+bool VideoDecoder::isTrackEnded(const Track *track) const {
+	if (isReadAheadTrack(track))
+		return _readAhead->endOfTrack;
+
+	return track->endOfTrack();
+}
+
+int VideoDecoder::getTrackCurFrame(const VideoTrack *track) const {
+	if (isReadAheadTrack(track))
+		return _readAhead->curFrame;
+
+	return track->getCurFrame();
+}
+
+uint32 VideoDecoder::getTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (isReadAheadTrack(track))
+		return _readAhead->nextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 void VideoDecoder::eraseTrack(Track *track) {
+	if (_readAhead && _readAhead->track == track)
+		freeReadAhead();
+
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
 			_externalTracks.remove_at(idx);
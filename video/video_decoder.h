@@ -52,7 +52,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -406,6 +406,46 @@ public:
 	 */
 	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
+	/**
+	 * Decode frames ahead of time on a background thread.
+	 *
+	 * Up to @p frames decoded frames are kept in a queue, so that a frame
+	 * which takes long to decode does not delay the ones around it. The
+	 * queue is only used if the video has a single video track which
+	 * supports it (see VideoTrack::canReadAhead()) and the backend can
+	 * create threads. Otherwise, frames are decoded by decodeNextFrame()
+	 * as usual.
+	 *
+	 * This setting remains until close() is called.
+	 *
+	 * @param frames The number of frames to decode ahead, or 0 to disable it
+	 */
+	void setReadAhead(uint frames);
+
+	/**
+	 * Get the number of frames decoded ahead of time.
+	 * @see setReadAhead()
+	 */
+	uint getReadAhead() const { return _readAheadFrames; }
+
+	/**
+	 * Statistics about decoding ahead of time.
+	 */
+	struct ReadAheadStats {
+		bool active;        ///< Are frames currently decoded by a background thread?
+		uint queued;        ///< The number of decoded frames waiting to be displayed
+		uint maxQueued;     ///< The size of the queue
+		uint framesDecoded; ///< The number of frames decoded by the background thread
+		uint lateFrames;    ///< The number of frames which were not decoded yet when requested
+		uint32 lateMillis;  ///< The total time spent waiting for those frames
+	};
+
+	/**
+	 * Get the statistics about decoding ahead of time, which are reset by
+	 * close().
+	 */
+	void getReadAheadStats(ReadAheadStats &stats) const;
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -665,6 +705,20 @@ protected:
 		 * Activate dithering mode with a palette
 		 */
 		virtual void setDither(const byte *palette) {}
+
+		/**
+		 * Can the frames of this track be decoded ahead of time?
+		 *
+		 * If this returns true, decodeNextFrame() may be called from a
+		 * background thread, while the decoder keeps track of what was
+		 * displayed. This is only safe if decodeNextFrame() does all the
+		 * work of reading and decoding the frame, readNextPacket() does
+		 * not feed the track, and the decoder does not access the track
+		 * between frames.
+		 *
+		 * @see VideoDecoder::setReadAhead()
+		 */
+		virtual bool canReadAhead() const { return false; }
 	};
 
 	/**
@@ -1011,6 +1065,26 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decoding ahead of time
+	struct ReadAheadQueue;
+	ReadAheadQueue *_readAhead;
+	uint _readAheadFrames;
+	ReadAheadStats _readAheadStats;
+	byte _readAheadPalette[256 * 3];
+
+	static void readAheadThread(void *param);
+	void startReadAhead();
+	void stopReadAhead(bool discard);
+	void freeReadAhead();
+	const Graphics::Surface *takeReadAheadFrame();
+	bool isReadAheadTrack(const Track *track) const;
+
+	// The state of a video track as seen by the caller, which differs from
+	// the one of the track while it is decoded ahead of time
+	bool isTrackEnded(const Track *track) const;
+	int getTrackCurFrame(const VideoTrack *track) const;
+	uint32 getTrackNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video